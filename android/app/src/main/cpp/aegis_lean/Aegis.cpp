@@ -1,4 +1,6 @@
 #include "Aegis.h"
+#include "ChessTT.h"
+#include <algorithm>
 #include <iostream>
 
 namespace aegis {
@@ -6,39 +8,244 @@ namespace aegis {
 bool Aegis::init(const AegisConfig& config) {
     m_config = config;
 
+    // The chess table is process-wide: only an explicit budget resizes it
+    // (which clears it), and without waiting for running searches since
+    // init runs on the FFI caller's thread
+    auto& chessTable = chess::sharedTranspositionTable();
+    if (m_config.chessHashMb && chessTable.sizeMb() != m_config.chessHashMb) {
+        chessTable.requestResize(m_config.chessHashMb);
+    }
+
     // 1. Storage
     m_storage = std::make_shared<storage::StorageManager>();
     if (!m_storage->init(m_config.dbPath, m_config.encryptionKey)) {
         return false;
     }
 
+    // Append-only logs (per-match moves) live next to the main DB
+    m_log = std::make_unique<AppendLog>();
+    if (!m_log->open(m_config.dbPath + ".log")) {
+        return false;
+    }
+
+    // Anti-entropy summary of the document keyspace, same sidecar file
+    m_merkle = std::make_unique<MerkleIndex>();
+    if (!m_merkle->open(m_config.dbPath + ".log")) {
+        return false;
+    }
+    m_localClient = m_merkle->clientIndex(m_config.clientId);
+
     // 2. Queue
     m_queue = std::make_shared<sync::MutationQueue>(m_storage);
     
     // 3. Sync Manager
     m_sync = std::make_shared<sync::SyncManager>(m_queue);
+
+    m_outbound.setLimits(m_config.outboundLimits);
+    if (m_config.segmentedSpillLog) {
+        SegmentLog::Options logOptions;
+        logOptions.segmentBytes = m_config.spillSegmentBytes;
+        m_spillLog = std::make_unique<SegmentLog>();
+        if (!m_spillLog->open(m_config.dbPath + ".mlog", logOptions)) {
+            return false;
+        }
+        m_outbound.setSpillLog(m_spillLog.get());
+    }
+
+    // Delta encoder for outgoing document updates
+    m_delta = std::make_unique<DeltaSync>(m_metrics, 8, m_config.deltaHistoryBytes);
+
+    // Sync worker: SyncManager is only ever driven from this thread, never
+    // from the FFI caller (the Dart UI isolate).
+    SyncScheduler::Options schedOptions;
+    schedOptions.batchSize = m_config.syncBatchSize;
+    schedOptions.batchBytes = m_config.syncBatchBytes;
+    m_scheduler = std::make_unique<SyncScheduler>(
+        m_outbound, m_metrics,
+        [this](const std::vector<OutboundItem>& batch) {
+            for (const auto& item : batch) {
+                m_sync->onMutationAdded(item.mutation);
+            }
+            if (auto peers = peerSync()) {
+                peers->publish(batch);
+            }
+            return true;
+        },
+        [this](const OutboundQueue::Spill& spilled) {
+            m_sync->replayMutations();
+            if (auto peers = peerSync()) {
+                publishPending(*peers, spilled);
+            }
+            return true;
+        },
+        schedOptions);
     
     // Wire Notification: Queue -> SyncManager (Essential for local logic)
     m_queue->setOnMutationAdded([this](const storage::Mutation& mutation) {
-        if (m_sync) {
-            m_sync->onMutationAdded(mutation);
+        // Outgoing metadata carries an HLC stamp rather than the core's wall-clock ms
+        storage::Mutation stamped = mutation;
+        stamped.meta.timestamp = static_cast<int64_t>(m_clock.now());
+        if (m_delta) {
+            m_delta->recordLocal(stamped.key, stamped.data);
+        }
+        if (m_merkle) {
+            m_merkle->update(stamped.key, stamped.data, VersionStamp{static_cast<uint64_t>(stamped.meta.timestamp), m_localClient});
+        }
+        if (m_scheduler) {
+            m_outbound.push(stamped);
+            m_scheduler->nudge();
         }
     });
 
     // 4. Local DB API
     m_db = std::make_unique<db::LocalDB>(m_storage, m_queue, m_config.clientId);
 
-    // Wire Incoming Updates (Local Only for Lean)
-    m_sync->setOnRemoteUpdate([this](const std::string& key, const std::vector<uint8_t>& data, const storage::SyncMetadata& meta) {
-        if (m_db && m_db->applyRemoteUpdate(key, data, meta)) {
+    // Remote updates are applied in batches off the transport thread
+    m_remoteApply = std::make_unique<RemoteApplyBatcher>(
+        *m_merkle, m_clock, m_metrics,
+        [this](const std::string& key, const std::vector<uint8_t>& data, const storage::SyncMetadata& meta) {
+            return m_db->applyRemoteUpdate(key, data, meta);
+        },
+        [this](const std::string& key, const std::vector<uint8_t>& data) {
             if (m_onDataChangeCallback) {
                 m_onDataChangeCallback(key, data);
             }
+        });
+    m_remoteApply->start();
+
+    // Wire Incoming Updates (SyncManager and the loopback transport)
+    m_sync->setOnRemoteUpdate([this](const std::string& key, const std::vector<uint8_t>& data, const storage::SyncMetadata& meta) {
+        applyRemote(key, data, meta);
+    });
+
+    // Local log appends go straight to connected peers
+    m_log->setOnLocalAppend([this](const std::string& logId, const LogEntry& entry) {
+        if (auto peers = peerSync()) {
+            peers->publishLog(logId, entry);
         }
     });
+    m_log->setOnConflict([this](const std::string& logId, const LogEntry& kept, const LogEntry&) {
+        m_metrics.logConflicts++;
+        std::cerr << "[Aegis-Lean] Log " << logId << " seq " << kept.seq << " was appended by two writers" << std::endl;
+    });
+
+    m_scheduler->start();
 
-    std::cout << "[Aegis-Lean] Engine initialized (Network Stubbed). DB: " << m_config.dbPath << std::endl;
+    std::cout << "[Aegis-Lean] Engine initialized (Loopback transport). DB: " << m_config.dbPath << std::endl;
     return true;
 }
 
+void Aegis::applyRemote(const std::string& key, const std::vector<uint8_t>& data, const storage::SyncMetadata& meta) {
+    // Staged: conflict checks, store writes and change callbacks run per batch
+    if (m_remoteApply) {
+        m_remoteApply->stage(key, data, meta);
+    }
+}
+
+void Aegis::publishPending(PeerSync& peers, const OutboundQueue::Spill& spilled) {
+    // Spilled mutations never passed the batch sink, so peers get them here.
+    // Their keys are paged out of the MerkleIndex by the HLC range of the
+    // spill: keys still carrying a local write from it, each once with its
+    // current value. Keys a remote write has replaced since belong to that
+    // writer; later local writes went through the sink already.
+    if (spilled.count == 0) return;
+    size_t pageSize = std::max<size_t>(m_config.syncBatchSize, 1);
+    uint64_t after = spilled.firstHlc - 1;
+    std::vector<OutboundItem> batch;
+    for (;;) {
+        auto page = m_merkle->writtenBy(m_localClient, after, spilled.lastHlc, pageSize);
+        if (page.empty()) break;
+        after = static_cast<uint64_t>(page.back().meta.timestamp);
+        for (auto& written : page) {
+            auto value = m_db->get(written.key);
+            if (!value) continue;
+            OutboundItem item;
+            item.mutation.key = std::move(written.key);
+            item.mutation.data = std::move(*value);
+            item.mutation.meta = std::move(written.meta);
+            item.bytes = item.mutation.key.size() + item.mutation.data.size();
+            batch.push_back(std::move(item));
+        }
+        if (!batch.empty()) peers.publish(batch);
+        batch.clear();
+        if (page.size() < pageSize) break;
+    }
+}
+
+std::shared_ptr<PeerSync> Aegis::peerSync() const {
+    std::lock_guard<std::mutex> lock(m_netMutex);
+    return m_peerSync;
+}
+
+void Aegis::startNetwork() {
+    if (!m_db || peerSync()) return;
+
+    std::shared_ptr<Transport> transport;
+    std::shared_ptr<EpollTransport> sockets;
+    if (m_config.netSim.enabled) {
+        transport = std::make_shared<SimTransport>(SimNetwork::shared(m_config.netSim), m_config.clientId, m_metrics);
+    } else {
+        EpollTransport::Options options;
+        options.clientId = m_config.clientId;
+        options.port = m_config.port;
+        options.unixPath = m_config.unixSocketPath;
+        sockets = std::make_shared<EpollTransport>(options, m_metrics);
+        transport = sockets;
+    }
+
+    auto peers = std::make_shared<PeerSync>(
+        transport, *m_delta, *m_log, m_metrics,
+        [this](const std::string& key, const std::vector<uint8_t>& data, const storage::SyncMetadata& meta) {
+            applyRemote(key, data, meta);
+        });
+    peers->setAntiEntropy(m_merkle.get(), [this](const std::string& key) { return m_db->get(key); });
+    if (!transport->start(peers->handlers())) {
+        std::cerr << "[Aegis-Lean] Network start failed" << std::endl;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_netMutex);
+        m_peerSync = peers;
+    }
+    m_networkActive = true;
+    if (sockets) {
+        std::cout << "[Aegis-Lean] Network started. Port: " << sockets->boundPort() << std::endl;
+    } else {
+        std::cout << "[Aegis-Lean] Network started on simulated links as " << m_config.clientId << std::endl;
+    }
+}
+
+void Aegis::stopNetwork() {
+    std::shared_ptr<PeerSync> peers;
+    {
+        std::lock_guard<std::mutex> lock(m_netMutex);
+        peers.swap(m_peerSync);
+    }
+    if (peers) {
+        peers->transport().stop(); // Joins the event loop; no handler runs after this
+    }
+    m_networkActive = false;
+}
+
+void Aegis::triggerSync() {
+    if (m_scheduler) m_scheduler->requestReplay();
+    if (auto peers = peerSync()) {
+        for (const auto& peerId : peers->transport().peers()) {
+            peers->startAntiEntropy(peerId);
+        }
+    }
+}
+
+void Aegis::connectToPeer(const std::string& ip, int port) {
+    if (auto peers = peerSync()) {
+        peers->transport().connect(ip, port);
+    }
+}
+
+int Aegis::getConnectedPeersCount() const {
+    auto peers = peerSync();
+    return peers ? static_cast<int>(peers->transport().peerCount()) : 0;
+}
+
 } // namespace aegis
@@ -7,6 +7,19 @@
 #include "sync/sync_manager.h"
 // REMOVED: network, mesh, security includes
 #include "sync/presence.h"
+#include "AppendLog.h"
+#include "DeltaSync.h"
+#include "EpollTransport.h"
+#include "HybridClock.h"
+#include "MerkleIndex.h"
+#include "NetworkSim.h"
+#include "OutboundQueue.h"
+#include "PeerSync.h"
+#include "RemoteApplyBatcher.h"
+#include "SegmentLog.h"
+#include "SimTransport.h"
+#include "SyncScheduler.h"
+#include "SyncMetrics.h"
 #include <memory>
 #include <string>
 #include <map>
@@ -22,42 +35,82 @@ struct AegisConfig {
     bool useSSL = false;
     std::string encryptionKey = ""; 
     bool enableMesh = false; 
-    // REMOVED: NetworkChaosConfig chaos;
+    NetworkSimConfig netSim;               // simulated links (latency, loss, partitions) instead of sockets
     std::string certPath = "aegis_identity.crt";
     std::string keyPath = "aegis_identity.key";
+    size_t syncBatchSize = 64;          // mutations handed to SyncManager per worker batch
+    size_t syncBatchBytes = 256 * 1024; // byte budget per batch (one oversized item may exceed it)
+    OutboundQueue::Limits outboundLimits; // resident high-water marks and hard backlog limits
+    int backpressureTimeoutMs = 0;         // writer wait above the hard limit before rejecting
+    bool segmentedSpillLog = false;        // spill to <dbPath>.mlog segments instead of MutationQueue replay
+    size_t spillSegmentBytes = 4 * 1024 * 1024;
+    size_t deltaHistoryBytes = DeltaSync::kDefaultHistoryBytes; // delta bases kept for peers (and, separately, from them), LRU
+    std::string unixSocketPath = "";       // also listen on this Unix domain socket (loopback tests)
+    size_t chessHashMb = 0;                // chess search table, process-wide (0 = keep its size, 16 MB initially)
 };
 
 class Aegis {
 public:
+    // Engine behind the FFI. Further engines (in-process clusters, tests)
+    // are constructed directly and need their own dbPath and clientId.
     static Aegis& instance() {
         static Aegis inst;
         return inst;
     }
 
+    Aegis() = default;
+    ~Aegis() { reset(); }
+    Aegis(const Aegis&) = delete;
+    Aegis& operator=(const Aegis&) = delete;
+
     bool init(const AegisConfig& config = AegisConfig());
 
     db::ILocalDB& db() { return *m_db; }
     sync::SyncManager& syncManager() { return *m_sync; }
-
-    // Stubs
-    void startNetwork() {}
-    void stopNetwork() {}
+    DeltaSync& deltaSync() { return *m_delta; }
+    AppendLog& appendLog() { return *m_log; }
+    MerkleIndex& merkleIndex() { return *m_merkle; }
+    SyncMetrics& metrics() { return m_metrics; }
+    OutboundQueue& outbound() { return m_outbound; }
+
+    // Loopback transport (epoll, TCP / Unix sockets, no TLS)
+    void startNetwork();
+    void stopNetwork();
     void reset() {
+        stopNetwork();
+        m_remoteApply.reset(); // Drains staged remote updates
+        m_scheduler.reset(); // Joins the sync worker before its targets go away
+        m_outbound.clear();
+        m_outbound.setSpillLog(nullptr);
+        m_spillLog.reset();
         m_storage.reset();
         m_queue.reset();
         m_sync.reset();
         m_db.reset();
+        m_delta.reset();
+        m_log.reset();
+        m_merkle.reset();
+        m_metrics.reset();
         m_networkActive = false;
     }
 
     bool isNetworkActive() const { return m_networkActive; }
-    int getConnectedPeersCount() const { return 0; }
+    int getConnectedPeersCount() const;
+    // Mutations not yet handed to the sync layer (resident + spilled).
+    // Counter-based: does not copy the pending set.
     int getPendingMutationsCount() const { 
-        return m_queue ? static_cast<int>(m_queue->getAllPending().size()) : 0; 
+        return static_cast<int>(m_outbound.size() + m_outbound.spilled().count); 
+    }
+
+    // Backpressure gate for writers; false means the write must be rejected.
+    bool admitWrite(size_t bytes) {
+        return m_outbound.admit(bytes, std::chrono::milliseconds(m_config.backpressureTimeoutMs));
     }
     
-    void triggerSync() { if(m_sync) m_sync->replayMutations(); }
-    void connectToPeer(const std::string& ip, int port) {}
+    // Non-blocking: the replay runs on the sync worker; connected peers also
+    // get a summary comparison (anti-entropy) to repair missed updates
+    void triggerSync();
+    void connectToPeer(const std::string& ip, int port);
     
     // REMOVED: CertManager access
 
@@ -80,16 +133,34 @@ public:
     void setOnPeerTyping(std::function<void(const std::string& clientId, bool isTyping)> callback) {}
 
 private:
-    Aegis() = default;
+    void applyRemote(const std::string& key, const std::vector<uint8_t>& data, const storage::SyncMetadata& meta);
+    std::shared_ptr<PeerSync> peerSync() const;
+    // Sync worker, after a full replay: the spilled mutations to connected peers
+    void publishPending(PeerSync& peers, const OutboundQueue::Spill& spilled);
     
     std::shared_ptr<storage::StorageManager> m_storage;
     std::shared_ptr<sync::MutationQueue> m_queue;
     std::shared_ptr<sync::SyncManager> m_sync;
     std::unique_ptr<db::LocalDB> m_db;
+    std::unique_ptr<DeltaSync> m_delta;
+    std::unique_ptr<AppendLog> m_log;
+    std::unique_ptr<MerkleIndex> m_merkle;
+    HybridClock m_clock;
+    uint32_t m_localClient = 0; // m_config.clientId in the MerkleIndex registry
+    SyncMetrics m_metrics;
+    OutboundQueue m_outbound{m_metrics};
+    std::unique_ptr<SegmentLog> m_spillLog;
 
     DataChangeCallback m_onDataChangeCallback;
     AegisConfig m_config;
     bool m_networkActive = false;
+
+    mutable std::mutex m_netMutex;
+    std::shared_ptr<PeerSync> m_peerSync; // set while the network is up
+
+    std::unique_ptr<RemoteApplyBatcher> m_remoteApply;
+
+    std::unique_ptr<SyncScheduler> m_scheduler; // Last: destroyed (joined) first
 };
 
 } // namespace aegis
@@ -0,0 +1,501 @@
+#include "AegisChess.h"
+#include "ChessBook.h"
+#include "ChessGame.h"
+#include "ChessEval.h"
+#include "ChessMoveGen.h"
+#include "ChessNnue.h"
+#include "ChessPerft.h"
+#include "ChessSearch.h"
+#include "ChessTablebase.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+using aegis::chess::BookMove;
+using aegis::chess::Game;
+using aegis::chess::MoveList;
+using aegis::chess::Network;
+using aegis::chess::NnueAccumulators;
+using aegis::chess::OpeningBook;
+using aegis::chess::PerftOptions;
+using aegis::chess::Position;
+using aegis::chess::Search;
+using aegis::chess::SearchLimits;
+using aegis::chess::SearchResult;
+using aegis::chess::TablebaseResult;
+using aegis::chess::Tablebases;
+using aegis::chess::TTStats;
+
+struct aegis_game {
+    Game game;
+
+    // Engine, created by the first aegis_chess_go
+    std::unique_ptr<Search> search;
+    std::thread searchThread;
+    std::atomic<bool> stopSearch{false};
+    int64_t lastSearchId = 0;
+    int32_t threads = 0; // 0 = Search::defaultThreads()
+
+    ~aegis_game() { stopEngine(); }
+
+    void stopEngine() {
+        if (!searchThread.joinable()) return;
+        stopSearch = true;
+        // Called from the bestmove callback (go, stop or free on its own
+        // handle): the search is over and the thread touches nothing of
+        // this handle after the callback, so let it return on its own
+        // instead of joining itself
+        if (searchThread.get_id() == std::this_thread::get_id()) searchThread.detach();
+        else searchThread.join();
+    }
+};
+
+namespace {
+
+PerftOptions perftOptions(int32_t threads, int32_t hashMb) {
+    PerftOptions options;
+    options.threads = threads;
+    options.hashMb = hashMb > 0 ? static_cast<size_t>(hashMb) : 0;
+    return options;
+}
+
+SearchLimits searchLimits(const aegis_search_limits_t* limits) {
+    SearchLimits out;
+    if (!limits) return out;
+    out.depth = limits->depth > 0 ? limits->depth : 0;
+    out.nodes = limits->nodes > 0 ? static_cast<uint64_t>(limits->nodes) : 0;
+    out.moveTimeMs = std::max(limits->move_time_ms, 0);
+    out.timeMs[aegis::chess::White] = std::max(limits->white_time_ms, 0);
+    out.timeMs[aegis::chess::Black] = std::max(limits->black_time_ms, 0);
+    out.incMs[aegis::chess::White] = std::max(limits->white_inc_ms, 0);
+    out.incMs[aegis::chess::Black] = std::max(limits->black_inc_ms, 0);
+    out.movesToGo = std::max(limits->moves_to_go, 0);
+    return out;
+}
+
+// Mate distance in moves for the FFI, from plies
+int32_t mateInMoves(int score) {
+    int plies = aegis::chess::matePlies(score);
+    return plies > 0 ? (plies + 1) / 2 : plies < 0 ? -((1 - plies) / 2) : 0;
+}
+
+} // namespace
+
+// ==================== CHESS RULES ====================
+
+int32_t aegis_chess_legal_moves(const char* fen, uint16_t* out_moves, int32_t capacity) {
+    if (!fen || (!out_moves && capacity > 0)) return -1;
+    try {
+        Position pos;
+        if (!pos.setFen(fen)) return -1;
+
+        MoveList list;
+        aegis::chess::generateLegal(pos, list);
+        for (int i = 0; i < list.size && i < capacity; i++) out_moves[i] = list.moves[i].code();
+        return list.size;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Legal moves failed: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+int64_t aegis_chess_perft(const char* fen, int32_t depth, int32_t threads, int32_t hash_mb) {
+    if (!fen || depth < 0) return -1;
+    try {
+        Position pos;
+        if (!pos.setFen(fen)) return -1;
+        return static_cast<int64_t>(aegis::chess::perftParallel(pos, depth, perftOptions(threads, hash_mb)));
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Perft failed: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+const char* aegis_chess_perft_divide(const char* fen, int32_t depth, int32_t threads, int32_t hash_mb,
+                                     int32_t* out_len) {
+    if (!out_len) return nullptr;
+    *out_len = 0;
+    if (!fen || depth < 1) return nullptr;
+    try {
+        Position pos;
+        if (!pos.setFen(fen)) return nullptr;
+
+        auto start = std::chrono::steady_clock::now();
+        auto entries = aegis::chess::perftDivide(pos, depth, perftOptions(threads, hash_mb));
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        uint64_t total = 0;
+        nlohmann::json moves = nlohmann::json::object();
+        for (const auto& entry : entries) {
+            moves[Position::toUci(entry.move)] = entry.nodes;
+            total += entry.nodes;
+        }
+        nlohmann::json j = {
+            {"nodes", total},
+            {"timeMs", std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()},
+            {"moves", moves}
+        };
+        std::string res = j.dump();
+        char* buffer = new char[res.size() + 1];
+        std::memcpy(buffer, res.c_str(), res.size() + 1);
+        *out_len = static_cast<int32_t>(res.size());
+        return buffer;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Perft divide failed: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+// ==================== GAME HANDLES ====================
+
+aegis_game_t* aegis_game_new(const char* fen) {
+    try {
+        auto* handle = new aegis_game();
+        if (fen && !handle->game.setFen(fen)) {
+            delete handle;
+            return nullptr;
+        }
+        return handle;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Game create failed: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+void aegis_game_free(aegis_game_t* game) {
+    delete game;
+}
+
+int32_t aegis_chess_game_status(const aegis_game_t* game) {
+    if (!game) return -1;
+    return static_cast<int32_t>(game->game.status());
+}
+
+bool aegis_game_make(aegis_game_t* game, const char* uci) {
+    if (!game || !uci) return false;
+    try {
+        return game->game.make(std::string_view(uci));
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Game make failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool aegis_game_unmake(aegis_game_t* game) {
+    if (!game) return false;
+    return game->game.unmake();
+}
+
+int32_t aegis_game_legal_moves(const aegis_game_t* game, uint16_t* out_moves, int32_t capacity) {
+    if (!game || (!out_moves && capacity > 0)) return -1;
+    MoveList list;
+    aegis::chess::generateLegal(game->game.position(), list);
+    for (int i = 0; i < list.size && i < capacity; i++) out_moves[i] = list.moves[i].code();
+    return list.size;
+}
+
+const char* aegis_game_fen(const aegis_game_t* game, int32_t* out_len) {
+    if (!out_len) return nullptr;
+    *out_len = 0;
+    if (!game) return nullptr;
+    try {
+        std::string res = game->game.position().fen();
+        char* buffer = new char[res.size() + 1];
+        std::memcpy(buffer, res.c_str(), res.size() + 1);
+        *out_len = static_cast<int32_t>(res.size());
+        return buffer;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Game fen failed: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+bool aegis_game_board64(const aegis_game_t* game, uint8_t* out) {
+    if (!game || !out) return false;
+    // Piece values already follow the FFI mailbox encoding
+    const Position& pos = game->game.position();
+    for (int sq = 0; sq < 64; sq++) out[sq] = pos.pieceOn(sq);
+    return true;
+}
+
+// ==================== ENGINE ====================
+
+int64_t aegis_chess_go(aegis_game_t* game, const aegis_search_limits_t* limits, AegisBestMoveCallback on_bestmove) {
+    if (!game || !on_bestmove) return -1;
+    try {
+        game->stopEngine();
+        if (!game->search) game->search = std::make_unique<Search>(aegis::chess::sharedTranspositionTable());
+        game->search->setThreads(game->threads);
+
+        int64_t id = ++game->lastSearchId;
+        game->stopSearch = false;
+        Search* search = game->search.get();
+        std::atomic<bool>* stop = &game->stopSearch;
+        game->searchThread = std::thread([search, stop, id, on_bestmove, root = game->game.position(),
+                                          keys = game->game.keys(), limits = searchLimits(limits)]() {
+            SearchResult result;
+            try {
+                result = search->run(root, keys, limits, *stop);
+            } catch (const std::exception& e) {
+                std::cerr << "[AegisChess] Search failed: " << e.what() << std::endl;
+            }
+            on_bestmove(id, result.best.code(), result.ponder.code(), result.score, mateInMoves(result.score),
+                        result.depth, static_cast<int64_t>(result.nodes), result.timeMs);
+        });
+        return id;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Go failed: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+void aegis_chess_stop(aegis_game_t* game) {
+    if (!game) return;
+    game->stopEngine();
+}
+
+void aegis_chess_set_threads(aegis_game_t* game, int32_t threads) {
+    if (!game) return;
+    game->threads = std::max(threads, 0);
+}
+
+void aegis_chess_new_game(aegis_game_t* game) {
+    if (!game) return;
+    game->stopEngine();
+    if (game->search) game->search->newGame();
+}
+
+bool aegis_chess_set_hash_size(int32_t mb) {
+    if (mb <= 0) return false;
+    try {
+        return aegis::chess::sharedTranspositionTable().requestResize(static_cast<size_t>(mb));
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Hash resize failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void aegis_chess_clear_hash() {
+    aegis::chess::sharedTranspositionTable().requestClear();
+}
+
+const char* aegis_chess_hash_stats(int32_t* out_len) {
+    if (!out_len) return nullptr;
+    *out_len = 0;
+    try {
+        TTStats stats = aegis::chess::sharedTranspositionTable().stats();
+        nlohmann::json j = {
+            {"sizeMb", stats.sizeMb},
+            {"probes", stats.probes},
+            {"hits", stats.hits},
+            {"hitRate", stats.probes ? static_cast<double>(stats.hits) / stats.probes : 0.0},
+            {"fillPermille", stats.fillPermille}
+        };
+        std::string res = j.dump();
+        char* buffer = new char[res.size() + 1];
+        std::memcpy(buffer, res.c_str(), res.size() + 1);
+        *out_len = static_cast<int32_t>(res.size());
+        return buffer;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Hash stats failed: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+// ==================== EVALUATION ====================
+
+bool aegis_chess_load_network(const char* path) {
+    try {
+        std::shared_ptr<const Network> network;
+        if (path && *path) {
+            std::string error;
+            network = Network::load(path, &error);
+            if (!network) {
+                std::cerr << "[AegisChess] Network " << path << " not loaded: " << error << std::endl;
+                return false;
+            }
+        }
+        aegis::chess::setCurrentNetwork(std::move(network));
+        aegis::chess::sharedTranspositionTable().requestClear();
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Network load failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+const char* aegis_chess_eval_info(int32_t* out_len) {
+    if (!out_len) return nullptr;
+    *out_len = 0;
+    try {
+        std::shared_ptr<const Network> network = aegis::chess::currentNetwork();
+        nlohmann::json j = {
+            {"network", network != nullptr},
+            {"hidden", network ? network->hidden() : 0},
+            {"kernel", aegis::chess::nnueKernelName()}
+        };
+        std::string res = j.dump();
+        char* buffer = new char[res.size() + 1];
+        std::memcpy(buffer, res.c_str(), res.size() + 1);
+        *out_len = static_cast<int32_t>(res.size());
+        return buffer;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Eval info failed: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+int32_t aegis_game_evaluate(const aegis_game_t* game) {
+    if (!game) return 0;
+    try {
+        const Position& pos = game->game.position();
+        std::shared_ptr<const Network> network = aegis::chess::currentNetwork();
+        if (!network) return aegis::chess::evaluate(pos);
+        NnueAccumulators accumulators(std::move(network), 0);
+        accumulators.refresh(pos);
+        return accumulators.evaluate(pos.sideToMove());
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Evaluate failed: " << e.what() << std::endl;
+        return 0;
+    }
+}
+
+// ==================== OPENING BOOK ====================
+
+namespace {
+
+int32_t probeBook(const Position& pos, aegis_book_move_t* out, int32_t capacity) {
+    std::shared_ptr<const OpeningBook> book = aegis::chess::currentBook();
+    if (!book) return 0;
+    BookMove moves[OpeningBook::kMaxMoves];
+    int count = book->probe(pos, moves, std::min<int32_t>(capacity, OpeningBook::kMaxMoves));
+    for (int i = 0; i < count; i++) out[i] = {moves[i].move.code(), moves[i].weight};
+    return count;
+}
+
+} // namespace
+
+bool aegis_book_open(const char* book_path) {
+    try {
+        if (!book_path || !*book_path) {
+            aegis::chess::setCurrentBook(nullptr);
+            return true;
+        }
+        std::string error;
+        std::shared_ptr<const OpeningBook> book = OpeningBook::open(book_path, &error);
+        if (!book) {
+            std::cerr << "[AegisChess] Book " << book_path << " not opened: " << error << std::endl;
+            return false;
+        }
+        aegis::chess::setCurrentBook(std::move(book));
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Book open failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+int32_t aegis_book_probe(const char* fen, aegis_book_move_t* out, int32_t capacity) {
+    if (!fen || (!out && capacity > 0)) return -1;
+    Position pos;
+    if (!pos.setFen(fen)) return -1;
+    return probeBook(pos, out, capacity);
+}
+
+int32_t aegis_book_probe_game(const aegis_game_t* game, aegis_book_move_t* out, int32_t capacity) {
+    if (!game || (!out && capacity > 0)) return -1;
+    return probeBook(game->game.position(), out, capacity);
+}
+
+uint16_t aegis_book_pick(const aegis_game_t* game, uint32_t random) {
+    if (!game) return 0;
+    std::shared_ptr<const OpeningBook> book = aegis::chess::currentBook();
+    return book ? book->pick(game->game.position(), random).code() : 0;
+}
+
+// ==================== ENDGAME TABLES ====================
+
+int32_t aegis_tb_generate(const char* dir, int32_t max_pieces, int32_t threads,
+                          AegisTablebaseProgressCallback on_progress) {
+    if (!dir || !*dir) return -1;
+    try {
+        std::string error;
+        int written = aegis::chess::generateTablebases(
+            dir, max_pieces, threads,
+            [on_progress](const std::string& table, int done, int total) {
+                if (on_progress) on_progress(table.c_str(), done, total);
+            },
+            &error);
+        if (written < 0) std::cerr << "[AegisChess] Tablebase generation failed: " << error << std::endl;
+        return written;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Tablebase generation failed: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+bool aegis_tb_open(const char* dir) {
+    try {
+        if (!dir || !*dir) {
+            aegis::chess::setCurrentTablebases(nullptr);
+            return true;
+        }
+        std::string error;
+        std::shared_ptr<const Tablebases> tables = Tablebases::open(dir, &error);
+        if (!tables) {
+            std::cerr << "[AegisChess] Tablebases in " << dir << " not opened: " << error << std::endl;
+            return false;
+        }
+        aegis::chess::setCurrentTablebases(std::move(tables));
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Tablebase open failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+const char* aegis_tb_info(int32_t* out_len) {
+    if (!out_len) return nullptr;
+    *out_len = 0;
+    try {
+        std::shared_ptr<const Tablebases> tables = aegis::chess::currentTablebases();
+        nlohmann::json j = {
+            {"tables", tables ? tables->tables() : 0},
+            {"maxPieces", tables ? tables->maxPieces() : 0},
+            {"names", tables ? tables->names() : std::vector<std::string>()}
+        };
+        std::string res = j.dump();
+        char* buffer = new char[res.size() + 1];
+        std::memcpy(buffer, res.c_str(), res.size() + 1);
+        *out_len = static_cast<int32_t>(res.size());
+        return buffer;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisChess] Tablebase info failed: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+bool aegis_tb_probe(const char* fen, int32_t* out_wdl, int32_t* out_dtm) {
+    if (!fen || !out_wdl || !out_dtm) return false;
+    std::shared_ptr<const Tablebases> tables = aegis::chess::currentTablebases();
+    Position pos;
+    TablebaseResult result;
+    if (!tables || !pos.setFen(fen) || !tables->probe(pos, result)) return false;
+    *out_wdl = static_cast<int32_t>(result.wdl);
+    *out_dtm = result.dtm;
+    return true;
+}
+
+bool aegis_game_tablebase(const aegis_game_t* game, int32_t* out_wdl, int32_t* out_dtm) {
+    if (!game || !out_wdl || !out_dtm) return false;
+    TablebaseResult result;
+    if (!game->game.tablebaseResult(result)) return false;
+    *out_wdl = static_cast<int32_t>(result.wdl);
+    *out_dtm = result.dtm;
+    return true;
+}
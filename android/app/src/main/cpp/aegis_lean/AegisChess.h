@@ -0,0 +1,357 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== CHESS RULES ====================
+//
+// Native move generation (ChessPosition / ChessMoveGen). Moves cross the
+// FFI as uint16: from | to << 6 | promo << 12, squares a1 = 0 .. h8 = 63,
+// promo 0 = none, 1 = knight, 2 = bishop, 3 = rook, 4 = queen. Castling is
+// the king's two-square move (e1g1).
+
+/**
+ * aegis_chess_legal_moves
+ * Generates every legal move of the side to move.
+ *
+ * @param fen Position in FEN (move counters optional)
+ * @param out_moves Receives up to capacity encoded moves (256 always suffices)
+ * @return Number of legal moves (may exceed capacity), or -1 for a malformed FEN
+ */
+int32_t aegis_chess_legal_moves(const char* fen, uint16_t* out_moves, int32_t capacity);
+
+/**
+ * aegis_chess_perft
+ * Counts leaf nodes to depth (move generator check and benchmark).
+ * Blocks until done; call from a background isolate.
+ *
+ * @param threads Workers for the root split (0 = all cores)
+ * @param hash_mb Subtree cache size, 0 = none
+ * @return Node count, or -1 for a malformed FEN or depth < 0
+ */
+int64_t aegis_chess_perft(const char* fen, int32_t depth, int32_t threads, int32_t hash_mb);
+
+/**
+ * aegis_chess_perft_divide
+ * Per root move counts:
+ * {"nodes": 0, "timeMs": 0, "moves": {"e2e4": 0, ...}}
+ * Caller must free with aegis_flutter_free_buffer.
+ */
+const char* aegis_chess_perft_divide(const char* fen, int32_t depth, int32_t threads, int32_t hash_mb,
+                                     int32_t* out_len);
+
+// ==================== GAME HANDLES ====================
+//
+// A game owns a native position plus its move history. Handles are not
+// thread-safe; use each from one isolate.
+
+typedef struct aegis_game aegis_game_t;
+
+/**
+ * aegis_game_new
+ * @param fen Starting position (NULL = standard start)
+ * @return Handle, or NULL for a malformed FEN. Release with aegis_game_free.
+ */
+aegis_game_t* aegis_game_new(const char* fen);
+
+// Stops and waits for a running search first
+void aegis_game_free(aegis_game_t* game);
+
+/**
+ * aegis_chess_game_status
+ * Cached per position, so calling it after every move costs one legal
+ * move probe at most (plus a table probe while endgame tables are open).
+ *
+ * @return 0 = ongoing, 1 = check, 2 = checkmate, 3 = stalemate,
+ *         4 = threefold repetition, 5 = fifty-move rule,
+ *         6 = insufficient material, -1 = NULL handle; with endgame
+ *         tables open (aegis_tb_open), positions they cover exactly report
+ *         7 = won, 8 = lost, 9 = drawn for the side to move instead of 0,
+ *         so the app can adjudicate. A side in check still reports 1;
+ *         aegis_game_tablebase has the verdict either way.
+ */
+int32_t aegis_chess_game_status(const aegis_game_t* game);
+
+/**
+ * aegis_game_make
+ * Plays a move given in long algebraic notation ("e2e4", "e7e8q").
+ * @return false for a NULL handle or an illegal/malformed move (the game
+ *         is left unchanged)
+ */
+bool aegis_game_make(aegis_game_t* game, const char* uci);
+
+/**
+ * aegis_game_unmake
+ * Takes back the last move.
+ * @return false for a NULL handle or when no move has been played
+ */
+bool aegis_game_unmake(aegis_game_t* game);
+
+/**
+ * aegis_game_legal_moves
+ * Same as aegis_chess_legal_moves for the game's current position,
+ * without a FEN round trip.
+ */
+int32_t aegis_game_legal_moves(const aegis_game_t* game, uint16_t* out_moves, int32_t capacity);
+
+/**
+ * aegis_game_fen
+ * Current position as FEN.
+ * Caller must free with aegis_flutter_free_buffer.
+ */
+const char* aegis_game_fen(const aegis_game_t* game, int32_t* out_len);
+
+/**
+ * aegis_game_board64
+ * Copies the board as a 64-byte mailbox into out (a Dart Uint8List),
+ * index a1 = 0 .. h8 = 63: 0 = empty, 1..6 = white pawn, knight, bishop,
+ * rook, queen, king, 7..12 = the same for black.
+ *
+ * @return false for a NULL handle or buffer
+ */
+bool aegis_game_board64(const aegis_game_t* game, uint8_t* out);
+
+// ==================== ENGINE ====================
+//
+// Native alpha-beta search (ChessSearch) for hints and the computer
+// opponent. Each game handle owns one search; all of them share one
+// process-wide transposition table (sized by aegis_engine_config_t
+// chess_hash_mb or aegis_chess_set_hash_size), so hints, the opponent and
+// analysis reuse each other's results.
+
+// Zero fields mean "no limit"; with no limit at all the search runs until
+// aegis_chess_stop (analysis)
+typedef struct {
+    int32_t depth;
+    int64_t nodes;
+    int32_t move_time_ms; // fixed time for this move, overrides the clock
+    int32_t white_time_ms;
+    int32_t black_time_ms;
+    int32_t white_inc_ms;
+    int32_t black_inc_ms;
+    int32_t moves_to_go;  // 0 = sudden death
+} aegis_search_limits_t;
+
+/**
+ * Result of aegis_chess_go, called once per search on the search thread
+ * (use NativeCallable.listener in Dart). Moves use the aegis_chess_legal_moves
+ * encoding; best_move is 0 when the side to move has no legal move.
+ * mate_in is in moves (negative when being mated), 0 when score_cp is a
+ * normal evaluation. The callback may call aegis_chess_go, aegis_chess_stop
+ * or aegis_game_free on its own handle.
+ */
+typedef void (*AegisBestMoveCallback)(int64_t search_id, uint16_t best_move, uint16_t ponder_move,
+                                      int32_t score_cp, int32_t mate_in, int32_t depth, int64_t nodes,
+                                      int64_t time_ms);
+
+/**
+ * aegis_chess_go
+ * Starts searching the game's current position in the background and
+ * returns immediately. The position and history are copied, so the game
+ * may be changed while the search runs. A search still running on this
+ * game is stopped first (its callback still fires).
+ *
+ * @param limits NULL = analyse until aegis_chess_stop
+ * @return Id passed to the callback (> 0), or -1 for a NULL handle/callback
+ */
+int64_t aegis_chess_go(aegis_game_t* game, const aegis_search_limits_t* limits, AegisBestMoveCallback on_bestmove);
+
+/**
+ * aegis_chess_stop
+ * Ends the running search early; the callback reports the best move of
+ * the last completed iteration. Blocks until the callback has returned,
+ * except when called from that callback.
+ */
+void aegis_chess_stop(aegis_game_t* game);
+
+/**
+ * aegis_chess_set_threads
+ * Search threads for this game's next aegis_chess_go (lazy SMP).
+ * @param threads 0 = default: every core but the UI thread's
+ */
+void aegis_chess_set_threads(aegis_game_t* game, int32_t threads);
+
+/**
+ * aegis_chess_new_game
+ * Clears the game's move ordering state, for when the handle is reused
+ * for an unrelated game (stops a running search).
+ */
+void aegis_chess_new_game(aegis_game_t* game);
+
+/**
+ * aegis_chess_set_hash_size
+ * Resizes (and clears) the shared transposition table. Never waits: while
+ * a search is running the resize is deferred to the next search started
+ * on an idle table, and hash stats report the old size until then.
+ * @return false for mb <= 0 or when an immediate allocation failed
+ */
+bool aegis_chess_set_hash_size(int32_t mb);
+
+// Empties the shared transposition table, deferred like a resize while a
+// search is running
+void aegis_chess_clear_hash();
+
+/**
+ * aegis_chess_hash_stats
+ * Shared table metrics since the last resize:
+ * {"sizeMb": 16, "probes": 0, "hits": 0, "hitRate": 0.0, "fillPermille": 0}
+ * fillPermille counts entries written by the most recent search.
+ * Caller must free with aegis_flutter_free_buffer.
+ */
+const char* aegis_chess_hash_stats(int32_t* out_len);
+
+// ==================== EVALUATION ====================
+//
+// Searches evaluate with a quantised NNUE-style network when one is
+// loaded (ChessNnue), else with the built-in piece-square tables.
+
+/**
+ * aegis_chess_load_network
+ * Maps a network file (format in ChessNnue.h) and makes it the evaluation
+ * for searches started afterwards. Clears the shared transposition table
+ * (deferred while a search runs), whose stored evaluations came from the
+ * previous network.
+ *
+ * @param path Filesystem path; AegisService.loadChessNetwork copies a
+ *             Flutter asset out of the APK and passes it here.
+ *             NULL or "" goes back to the piece-square evaluation
+ * @return false when the file is missing or malformed; the current
+ *         evaluation stays in use
+ */
+bool aegis_chess_load_network(const char* path);
+
+/**
+ * aegis_chess_eval_info
+ * The evaluation in use and the SIMD kernel chosen for this CPU:
+ * {"network": true, "hidden": 256, "kernel": "neon"}
+ * ("hidden" is 0 without a network; kernel is "avx2", "neon" or "scalar").
+ * Caller must free with aegis_flutter_free_buffer.
+ */
+const char* aegis_chess_eval_info(int32_t* out_len);
+
+/**
+ * aegis_game_evaluate
+ * Static evaluation of the game's current position in centipawns from
+ * the side to move's point of view (no search).
+ */
+int32_t aegis_game_evaluate(const aegis_game_t* game);
+
+// ==================== OPENING BOOK ====================
+//
+// Polyglot .bin book (ChessBook), mapped read-only and shared by every
+// caller. Probes allocate nothing; moves use the encoding above.
+
+typedef struct {
+    uint16_t move;
+    uint16_t weight; // relative frequency; 0 = listed but never picked
+} aegis_book_move_t;
+
+/**
+ * aegis_book_open
+ * Maps a standard Polyglot .bin book and makes it the current one.
+ *
+ * @param book_path NULL or "" closes the current book
+ * @return false when the file is missing or malformed; the current book
+ *         stays open
+ */
+bool aegis_book_open(const char* book_path);
+
+/**
+ * aegis_book_probe
+ * Book moves for a position, heaviest first (opening explorer).
+ *
+ * @param out Receives up to capacity moves (64 always suffices)
+ * @return Number of moves written, 0 out of book or without a book, or -1
+ *         for a malformed FEN
+ */
+int32_t aegis_book_probe(const char* fen, aegis_book_move_t* out, int32_t capacity);
+
+// aegis_book_probe for a game's current position
+int32_t aegis_book_probe_game(const aegis_game_t* game, aegis_book_move_t* out, int32_t capacity);
+
+/**
+ * aegis_book_pick
+ * A book move for the game's current position, chosen with probability
+ * proportional to its weight (computer opponent).
+ *
+ * @param random Uniform random value from the caller, so games can be replayed
+ * @return Encoded move, or 0 when out of book (search instead)
+ */
+uint16_t aegis_book_pick(const aegis_game_t* game, uint32_t random);
+
+// ==================== ENDGAME TABLES ====================
+//
+// Distance-to-mate tables for every ending with up to four pieces
+// (ChessTablebase), built on the device or shipped as files. Open tables
+// are mapped read-only; searches use them below the root, and game status
+// and aegis_game_tablebase report their verdict for adjudication.
+
+/**
+ * Progress of aegis_tb_generate, called on the generating thread after
+ * each table (done of total).
+ */
+typedef void (*AegisTablebaseProgressCallback)(const char* table, int32_t done, int32_t total);
+
+/**
+ * aegis_tb_generate
+ * Builds the tables into dir by retrograde analysis, skipping tables the
+ * directory already holds. Blocks until done: the 3-piece tables take
+ * about a second, the 4-piece ones about eight core-minutes and 215 MB of
+ * disk, so run it on a background isolate. Does not open the result.
+ *
+ * @param max_pieces 3 or 4 (kings included)
+ * @param threads 0 = every core
+ * @param on_progress May be NULL
+ * @return Number of tables written, or -1 on failure
+ */
+int32_t aegis_tb_generate(const char* dir, int32_t max_pieces, int32_t threads,
+                          AegisTablebaseProgressCallback on_progress);
+
+/**
+ * aegis_tb_open
+ * Maps every table in dir and makes them the ones searches, game status
+ * and aegis_game_tablebase use from then on.
+ *
+ * @param dir NULL or "" closes the current tables
+ * @return false when dir holds no tables or a malformed one; the current
+ *         tables stay open
+ */
+bool aegis_tb_open(const char* dir);
+
+/**
+ * aegis_tb_info
+ * The open tables: {"tables": 35, "maxPieces": 4, "names": ["KBNvK", ...]}
+ * Caller must free with aegis_flutter_free_buffer.
+ */
+const char* aegis_tb_info(int32_t* out_len);
+
+/**
+ * aegis_tb_probe
+ * Looks a position up in the open tables.
+ *
+ * @param out_wdl 1 = win, 0 = draw, -1 = loss for the side to move
+ * @param out_dtm Plies to mate with best play (0 for a draw)
+ * @return false when no open table covers the position (too many pieces,
+ *         castling rights or an en passant square), the result would not
+ *         be exact (en passant still possible, or the fifty-move rule
+ *         could intervene: halfmove clock + dtm > 100) or the FEN is
+ *         malformed
+ */
+bool aegis_tb_probe(const char* fen, int32_t* out_wdl, int32_t* out_dtm);
+
+/**
+ * aegis_game_tablebase
+ * Same for the game's current position, for adjudication; also when the
+ * side to move is in check, where game status reports check.
+ * @return false as for aegis_tb_probe, for a NULL handle, or once the game
+ *         is over (mate, stalemate or a draw rule)
+ */
+bool aegis_game_tablebase(const aegis_game_t* game, int32_t* out_wdl, int32_t* out_dtm);
+
+#ifdef __cplusplus
+}
+#endif
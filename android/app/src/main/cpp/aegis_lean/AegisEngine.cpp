@@ -0,0 +1,729 @@
+#include "AegisEngine.h"
+#include "Aegis.h"
+#include <iostream>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+struct aegis_engine {
+    aegis::Aegis* core = nullptr;
+    std::unique_ptr<aegis::Aegis> owned; // null for the default handle
+    bool initialized = false;
+
+    std::mutex callbackMutex;
+    AegisDataChangeCallback dataChange = nullptr;
+    AegisPeerDiscoveredCallback peerDiscovered = nullptr;
+    AegisPeerTypingCallback peerTyping = nullptr;
+};
+
+namespace {
+
+// Every entry point below runs inside try/catch, so an unusable handle
+// takes the same failure path as an engine error.
+aegis::Aegis& core(aegis_engine_t* engine) {
+    if (!engine || !engine->initialized) throw std::runtime_error("engine not initialized");
+    return *engine->core;
+}
+
+std::string orDefault(const char* value, const char* fallback) {
+    return value ? value : fallback;
+}
+
+} // namespace
+
+// ==================== LIFECYCLE ====================
+
+aegis_engine_t* aegis_engine_default() {
+    static aegis_engine* engine = [] {
+        auto* handle = new aegis_engine(); // never freed, like Aegis::instance()
+        handle->core = &aegis::Aegis::instance();
+        return handle;
+    }();
+    return engine;
+}
+
+aegis_engine_t* aegis_engine_open(const aegis_engine_config_t* config) {
+    try {
+        auto engine = std::make_unique<aegis_engine>();
+        engine->owned = std::make_unique<aegis::Aegis>();
+        engine->core = engine->owned.get();
+        if (!aegis_engine_init(engine.get(), config)) return nullptr;
+        return engine.release();
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Open failed: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+void aegis_engine_close(aegis_engine_t* engine) {
+    if (!engine) return;
+    aegis_engine_shutdown(engine);
+    if (engine != aegis_engine_default()) delete engine;
+}
+
+bool aegis_engine_init(aegis_engine_t* engine, const aegis_engine_config_t* config) {
+    if (!engine) return false;
+    try {
+        aegis::AegisConfig settings;
+        if (config) {
+            settings.dbPath = orDefault(config->db_path, "aegis.db");
+            settings.clientId = orDefault(config->client_id, "flutter_client");
+            settings.port = static_cast<uint16_t>(config->port);
+            settings.useSSL = config->use_ssl;
+            settings.encryptionKey = orDefault(config->enc_key, "");
+            settings.enableMesh = config->enable_mesh;
+            settings.unixSocketPath = orDefault(config->unix_socket_path, "");
+            if (config->chess_hash_mb > 0) settings.chessHashMb = static_cast<size_t>(config->chess_hash_mb);
+        }
+
+        engine->initialized = engine->core->init(settings);
+        if (engine->initialized) {
+            // Wire up callbacks
+            engine->core->setOnDataChange([engine](const std::string& key, const std::vector<uint8_t>& data) {
+                std::lock_guard<std::mutex> lock(engine->callbackMutex);
+                if (engine->dataChange) {
+                    engine->dataChange(key.c_str(), data.data(), static_cast<int32_t>(data.size()));
+                }
+            });
+        }
+        return engine->initialized;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Init failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void aegis_engine_start_network(aegis_engine_t* engine) {
+    try {
+        core(engine).startNetwork();
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Start network failed: " << e.what() << std::endl;
+    }
+}
+
+void aegis_engine_stop_network(aegis_engine_t* engine) {
+    try {
+        core(engine).stopNetwork();
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Stop network failed: " << e.what() << std::endl;
+    }
+}
+
+void aegis_engine_shutdown(aegis_engine_t* engine) {
+    if (!engine) return;
+    try {
+        engine->initialized = false;
+        engine->core->reset();
+        
+        // Clear callbacks
+        std::lock_guard<std::mutex> lock(engine->callbackMutex);
+        engine->dataChange = nullptr;
+        engine->peerDiscovered = nullptr;
+        engine->peerTyping = nullptr;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Shutdown failed: " << e.what() << std::endl;
+    }
+}
+
+// ==================== DATABASE CRUD ====================
+
+bool aegis_engine_put(aegis_engine_t* engine, const char* key, const uint8_t* data, int32_t len) {
+    if (!key || !data || len <= 0) return false;
+    
+    try {
+        if (!core(engine).admitWrite(std::strlen(key) + len)) {
+            std::cerr << "[AegisEngine] Put rejected: sync backlog over hard limit" << std::endl;
+            return false;
+        }
+        std::vector<uint8_t> buffer(data, data + len);
+        core(engine).db().put(key, buffer);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Put failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+
+bool aegis_engine_put_with_lane(aegis_engine_t* engine, const char* key, const uint8_t* data, int32_t len, int32_t lane) {
+    if (!key || !data || len <= 0) return false;
+    if (lane < 0 || lane >= static_cast<int32_t>(aegis::kSyncLaneCount)) return false;
+    
+    try {
+        if (!core(engine).admitWrite(std::strlen(key) + len)) {
+            std::cerr << "[AegisEngine] Put rejected: sync backlog over hard limit" << std::endl;
+            return false;
+        }
+        std::vector<uint8_t> buffer(data, data + len);
+        aegis::OutboundQueue::ScopedLane scoped(static_cast<aegis::SyncLane>(lane));
+        core(engine).db().put(key, buffer);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Put failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+// Helper: Base64 Decode
+std::vector<uint8_t> base64_decode(const std::string& in) {
+    static const std::string base64_chars = 
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+        "abcdefghijklmnopqrstuvwxyz"
+        "0123456789+/";
+
+    auto is_base64 = [](unsigned char c) {
+        return (isalnum(c) || (c == '+') || (c == '/'));
+    };
+
+    int in_len = static_cast<int>(in.size());
+    int i = 0;
+    int j = 0;
+    int in_ = 0;
+    unsigned char char_array_4[4], char_array_3[3];
+    std::vector<uint8_t> ret;
+
+    while (in_len-- && ( in[in_] != '=') && is_base64(in[in_])) {
+        char_array_4[i++] = in[in_]; in_++;
+        if (i ==4) {
+            for (i = 0; i <4; i++)
+                char_array_4[i] = (unsigned char)base64_chars.find(char_array_4[i]);
+
+            char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
+            char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
+            char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+
+            for (i = 0; (i < 3); i++)
+                ret.push_back(char_array_3[i]);
+            i = 0;
+        }
+    }
+
+    if (i) {
+        for (j = i; j <4; j++)
+            char_array_4[j] = 0;
+
+        for (j = 0; j <4; j++)
+            char_array_4[j] = (unsigned char)base64_chars.find(char_array_4[j]);
+
+        char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
+        char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
+        char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+
+        for (j = 0; (j < i - 1); j++) ret.push_back(char_array_3[j]);
+    }
+
+    return ret;
+}
+
+bool aegis_engine_put_batch(aegis_engine_t* engine, const char* json_items) {
+    if (!json_items) return false;
+    
+    try {
+        auto j = nlohmann::json::parse(json_items);
+        if (!j.is_array()) return false;
+        
+        std::vector<std::pair<std::string, std::vector<uint8_t>>> batch;
+        batch.reserve(j.size());
+        
+        for (const auto& item : j) {
+            if (item.contains("id") && item.contains("data")) {
+                std::string id = item["id"];
+                std::string b64 = item["data"];
+                batch.emplace_back(id, base64_decode(b64));
+            }
+        }
+        
+        size_t bytes = 0;
+        for (const auto& [id, data] : batch) bytes += id.size() + data.size();
+        if (!core(engine).admitWrite(bytes)) {
+            std::cerr << "[SDK] PutBatch rejected: sync backlog over hard limit" << std::endl;
+            return false;
+        }
+        
+        return core(engine).db().putBatch(batch);
+    } catch (const std::exception& e) {
+        std::cerr << "[SDK] PutBatch Failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+const uint8_t* aegis_engine_get(aegis_engine_t* engine, const char* key, int32_t* out_len) {
+    if (!key || !out_len) return nullptr;
+    
+    try {
+        auto maybeData = core(engine).db().get(key);
+        
+        // Check if optional has value
+        if (!maybeData.has_value()) {
+            *out_len = 0;
+            return nullptr;
+        }
+        
+        // Get the actual vector from optional
+        const auto& data = maybeData.value();
+        
+        if (data.empty()) {
+            *out_len = 0;
+            return nullptr;
+        }
+        
+        // Allocate buffer for Dart (caller must free)
+        uint8_t* buffer = new uint8_t[data.size()];
+        std::memcpy(buffer, data.data(), data.size());
+        *out_len = static_cast<int32_t>(data.size());
+        
+        return buffer;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Get failed: " << e.what() << std::endl;
+        *out_len = 0;
+        return nullptr;
+    }
+}
+
+bool aegis_engine_delete(aegis_engine_t* engine, const char* key) {
+    if (!key) return false;
+    
+    try {
+        core(engine).db().del(key);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Delete failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+// ==================== QUERY ENGINE & ATTACHMENTS (Phase 13) ====================
+
+#include "db/query.h"
+
+// Helper to parse query JSON into Query struct
+aegis::db::Query parse_query_json(const char* json_str) {
+    aegis::db::Query q;
+    try {
+        auto j = nlohmann::json::parse(json_str);
+        
+        // Parse filters
+        if (j.contains("filters") && j["filters"].is_object()) {
+            for (auto& [key, val] : j["filters"].items()) {
+                aegis::db::QueryFilter filter;
+                filter.field = key;
+                
+                // Simplified dynamic filter parsing for MVP
+                // Expecting object: { "op": "EQ", "val": ... }
+                // Or simple value (implies EQ)
+                if (val.is_object() && val.contains("op") && val.contains("val")) {
+                    std::string opStr = val["op"];
+                    if (opStr == "EQ") filter.op = aegis::db::FilterOp::EQ;
+                    else if (opStr == "GT") filter.op = aegis::db::FilterOp::GT;
+                    else if (opStr == "LT") filter.op = aegis::db::FilterOp::LT;
+                    else if (opStr == "CONTAINS") filter.op = aegis::db::FilterOp::CONTAINS;
+                    
+                    auto v = val["val"];
+                    if (v.is_number_float()) filter.value = v.get<double>();
+                    else if (v.is_number_integer()) filter.value = v.get<int64_t>();
+                    else if (v.is_string()) filter.value = v.get<std::string>();
+                } else {
+                    // Default EQ
+                    filter.op = aegis::db::FilterOp::EQ;
+                    if (val.is_number_float()) filter.value = val.get<double>();
+                    else if (val.is_number_integer()) filter.value = val.get<int64_t>();
+                    else if (val.is_string()) filter.value = val.get<std::string>();
+                }
+                q.filters.push_back(filter);
+            }
+        }
+        
+        // Parse Sort
+        if (j.contains("sort_by") && j["sort_by"].is_string()) {
+            q.sort_by = j["sort_by"].get<std::string>();
+        }
+        if (j.contains("sort_ascending") && j["sort_ascending"].is_boolean()) {
+            q.sort_ascending = j["sort_ascending"].get<bool>();
+        }
+
+        // Parse Limit
+        if (j.contains("limit") && j["limit"].is_number_integer()) {
+            q.limit = j["limit"].get<int>();
+        }
+        
+    } catch (const std::exception& e) {
+        std::cerr << "[SDK] Query Parse Error: " << e.what() << std::endl;
+    }
+    return q;
+}
+
+const char* aegis_engine_query(aegis_engine_t* engine, const char* json_query, int32_t* out_len) {
+    if (!json_query || !out_len) return nullptr;
+    
+    try {
+        auto query = parse_query_json(json_query);
+        auto results = core(engine).db().query(query);
+        
+        // Serialize results to JSON array
+        nlohmann::json j_results = nlohmann::json::array();
+        for (const auto& doc : results) {
+            try {
+                // Parse the raw doc bytes as JSON to embed directly
+                auto doc_json = nlohmann::json::parse(reinterpret_cast<const char*>(doc.data()), 
+                                                    reinterpret_cast<const char*>(doc.data() + doc.size()));
+                j_results.push_back(doc_json);
+            } catch (...) {
+                // Skip invalid docs
+            }
+        }
+        
+        std::string res_str = j_results.dump();
+        
+        // Allocate buffer (caller frees via free_buffer? No, this is char*... we need a specific free for string or reuse free_buffer)
+        // Reusing free_buffer but casting to uint8_t* is safe given standard allocators.
+        char* buffer = new char[res_str.size() + 1];
+        std::memcpy(buffer, res_str.c_str(), res_str.size() + 1);
+        
+        *out_len = static_cast<int32_t>(res_str.size());
+        return buffer;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "[SDK] Query Failed: " << e.what() << std::endl;
+        *out_len = 0;
+        return nullptr;
+    }
+}
+
+bool aegis_engine_put_attachment(aegis_engine_t* engine, const char* doc_id, const uint8_t* data, int32_t len) {
+    if (!doc_id || !data || len <= 0) return false;
+    try {
+        if (!core(engine).admitWrite(std::strlen(doc_id) + len)) return false;
+        std::vector<uint8_t> buffer(data, data + len);
+        aegis::OutboundQueue::ScopedLane scoped(aegis::SyncLane::Bulk);
+        return core(engine).db().putAttachment(doc_id, buffer);
+    } catch (...) { return false; }
+}
+
+const uint8_t* aegis_engine_get_attachment(aegis_engine_t* engine, const char* doc_id, int32_t* out_len) {
+    if (!doc_id || !out_len) return nullptr;
+    try {
+        auto maybeData = core(engine).db().getAttachment(doc_id);
+        if (!maybeData.has_value() || maybeData->empty()) {
+            *out_len = 0;
+            return nullptr;
+        }
+        const auto& data = maybeData.value();
+        uint8_t* buffer = new uint8_t[data.size()];
+        std::memcpy(buffer, data.data(), data.size());
+        *out_len = static_cast<int32_t>(data.size());
+        return buffer;
+    } catch (...) {
+        *out_len = 0;
+        return nullptr;
+    }
+}
+
+// ==================== CALLBACKS ====================
+
+void aegis_engine_set_data_change_callback(aegis_engine_t* engine, AegisDataChangeCallback callback) {
+    if (!engine) return;
+    std::lock_guard<std::mutex> lock(engine->callbackMutex);
+    engine->dataChange = callback;
+}
+
+void aegis_engine_set_peer_discovered_callback(aegis_engine_t* engine, AegisPeerDiscoveredCallback callback) {
+    if (!engine) return;
+    std::lock_guard<std::mutex> lock(engine->callbackMutex);
+    engine->peerDiscovered = callback;
+}
+
+void aegis_engine_set_peer_typing_callback(aegis_engine_t* engine, AegisPeerTypingCallback callback) {
+    if (!engine) return;
+    std::lock_guard<std::mutex> lock(engine->callbackMutex);
+    engine->peerTyping = callback;
+}
+
+// Helper to trigger peer discovered callback
+void aegis_engine_internal_trigger_peer_discovered(aegis_engine_t* engine, const char* peer_name, const char* ip, int port) {
+    if (!engine) return;
+    std::lock_guard<std::mutex> lock(engine->callbackMutex);
+    if (engine->peerDiscovered) {
+        engine->peerDiscovered(peer_name, ip, port);
+    }
+}
+
+// ==================== STATUS ====================
+
+bool aegis_engine_is_network_active(aegis_engine_t* engine) {
+    try {
+        return core(engine).isNetworkActive();
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Status check failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+int32_t aegis_engine_get_connected_peers_count(aegis_engine_t* engine) {
+    try {
+        return core(engine).getConnectedPeersCount();
+    } catch (...) { return 0; }
+}
+
+int32_t aegis_engine_get_pending_mutations_count(aegis_engine_t* engine) {
+    try {
+        return core(engine).getPendingMutationsCount();
+    } catch (...) { return 0; }
+}
+
+// ==================== SYNC CONTROL ====================
+
+void aegis_engine_connect_to_peer(aegis_engine_t* engine, const char* ip, int port) {
+    if (!ip) return;
+    
+    try {
+        core(engine).connectToPeer(ip, port);
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Connect to peer failed: " << e.what() << std::endl;
+    }
+}
+
+void aegis_engine_set_sync_lane(aegis_engine_t* engine, const char* prefix, int32_t lane) {
+    if (!prefix) return;
+    if (lane < 0 || lane >= static_cast<int32_t>(aegis::kSyncLaneCount)) return;
+    try {
+        core(engine).outbound().setLaneForPrefix(prefix, static_cast<aegis::SyncLane>(lane));
+    } catch (...) {}
+}
+
+void aegis_engine_trigger_sync(aegis_engine_t* engine) {
+    try {
+        core(engine).triggerSync();
+    } catch (...) {}
+}
+
+// ==================== PAIRING & SECURITY (Phase 20) ====================
+
+void aegis_engine_start_pairing(aegis_engine_t* engine, int role, const char* pin) {
+    if (!pin) return;
+    try {
+        core(engine).startPairing(role, pin);
+    } catch (...) {}
+}
+
+void aegis_engine_confirm_pairing(aegis_engine_t* engine) {
+    try {
+        core(engine).confirmPairing();
+    } catch (...) {}
+}
+
+void aegis_engine_cancel_pairing(aegis_engine_t* engine) {
+     try {
+        core(engine).cancelPairing();
+    } catch (...) {}
+}
+
+int aegis_engine_get_pairing_status(aegis_engine_t* engine) {
+     try {
+        return static_cast<int>(core(engine).getPairingStatus());
+    } catch (...) { return 0; }
+}
+
+void aegis_engine_pin_peer(aegis_engine_t* engine, const char* peerId, const char* fingerprint) {
+}
+
+// ==================== PRESENCE & TYPING (Phase 25/26) ====================
+
+const char* aegis_engine_get_online_peers(aegis_engine_t* engine, int32_t* out_len) {
+    if (!out_len) return nullptr;
+    try {
+        auto peers = core(engine).getOnlinePeers();
+        nlohmann::json j_peers = nlohmann::json::array();
+        for (const auto& p : peers) {
+            j_peers.push_back({
+                {"clientId", p.clientId},
+                {"status", p.status},
+                {"currentDoc", p.currentDocId},
+                {"lastSeen", p.lastSeen}
+            });
+        }
+        std::string res = j_peers.dump();
+        char* buffer = new char[res.size() + 1];
+        std::memcpy(buffer, res.c_str(), res.size() + 1);
+        *out_len = static_cast<int32_t>(res.size());
+        return buffer;
+    } catch (...) {
+        *out_len = 0;
+        return nullptr;
+    }
+}
+
+void aegis_engine_set_presence_status(aegis_engine_t* engine, const char* status, const char* current_doc) {
+    if (!status) return;
+    try {
+        core(engine).setPresenceStatus(status, current_doc ? current_doc : "");
+    } catch (...) {}
+}
+
+void aegis_engine_set_typing_status(aegis_engine_t* engine, bool is_typing) {
+    try {
+        core(engine).setTypingStatus(is_typing);
+    } catch (...) {}
+}
+
+// ==================== OBSERVABILITY (Phase 28) ====================
+
+const char* aegis_engine_get_bandwidth_stats(aegis_engine_t* engine, int32_t* out_len) {
+    if (!out_len) return nullptr;
+    try {
+        const auto& m = core(engine).metrics();
+        nlohmann::json j = {
+            {"bytesSent", m.bytesSent.load()},
+            {"bytesReceived", m.bytesReceived.load()},
+            {"bytesSaved", m.bytesSaved.load()},
+            {"deltaFrames", m.deltaFrames.load()},
+            {"fullFrames", m.fullFrames.load()},
+            {"deltaMisses", m.deltaMisses.load()},
+            {"deltaHistoryKeys", m.deltaHistoryKeys.load()},
+            {"deltaHistoryBytes", m.deltaHistoryBytes.load()},
+            {"deltaHistoryEvictions", m.deltaHistoryEvictions.load()},
+            {"deltaReceivedBytes", m.deltaReceivedBytes.load()},
+            {"deltaReceivedEvictions", m.deltaReceivedEvictions.load()},
+            {"wireFrames", m.wireFrames.load()},
+            {"wireMutations", m.wireMutations.load()},
+            {"wireOverheadBytes", m.wireOverheadBytes.load()},
+            {"wireDecodeErrors", m.wireDecodeErrors.load()}
+        };
+        std::string res = j.dump();
+        char* buffer = new char[res.size() + 1];
+        std::memcpy(buffer, res.c_str(), res.size() + 1);
+        *out_len = static_cast<int32_t>(res.size());
+        return buffer;
+    } catch (...) {
+        *out_len = 0;
+        return nullptr;
+    }
+}
+
+const char* aegis_engine_get_sync_stats(aegis_engine_t* engine, int32_t* out_len) {
+    if (!out_len) return nullptr;
+    try {
+        const auto& m = core(engine).metrics();
+        nlohmann::json j = {
+            {"passes", m.syncPasses.load()},
+            {"batches", m.syncBatches.load()},
+            {"failures", m.syncFailures.load()},
+            {"mutationsSynced", m.mutationsSynced.load()},
+            {"pending", m.syncPending.load()},
+            {"outboundDepth", m.residentMutations.load()},
+            {"spillDepth", m.spilledPending.load()},
+            {"backoffMs", m.syncBackoffMs.load()},
+            {"lastPassUs", m.lastSyncPassUs.load()}
+        };
+        nlohmann::json lanes = nlohmann::json::object();
+        for (size_t i = 0; i < aegis::kSyncLaneCount; i++) {
+            const auto& lane = m.lanes[i];
+            uint64_t sent = lane.sent.load();
+            lanes[aegis::syncLaneName(static_cast<aegis::SyncLane>(i))] = {
+                {"depth", lane.depth.load()},
+                {"enqueued", lane.enqueued.load()},
+                {"sent", sent},
+                {"avgLatencyUs", sent ? lane.latencySumUs.load() / sent : 0},
+                {"maxLatencyUs", lane.latencyMaxUs.load()}
+            };
+        }
+        j["lanes"] = lanes;
+        j["memory"] = {
+            {"residentMutations", m.residentMutations.load()},
+            {"residentBytes", m.residentBytes.load()},
+            {"spilledPending", m.spilledPending.load()},
+            {"spilledPendingBytes", m.spilledPendingBytes.load()},
+            {"spilledTotal", m.spilledMutations.load()},
+            {"backpressureWaits", m.backpressureWaits.load()},
+            {"rejectedWrites", m.rejectedWrites.load()}
+        };
+        j["antiEntropy"] = {
+            {"digests", m.antiEntropyDigests.load()},
+            {"leaves", m.antiEntropyLeaves.load()},
+            {"keysRepaired", m.antiEntropyKeys.load()}
+        };
+        j["remoteApply"] = {
+            {"applied", m.remoteApplied.load()},
+            {"stale", m.remoteStale.load()},
+            {"coalesced", m.remoteCoalesced.load()},
+            {"clockRejects", m.remoteClockRejects.load()},
+            {"batches", m.remoteBatches.load()},
+            {"stageWaits", m.remoteStageWaits.load()},
+            {"lastBatchUs", m.lastRemoteBatchUs.load()}
+        };
+        j["appendLog"] = {
+            {"conflicts", m.logConflicts.load()}
+        };
+        std::string res = j.dump();
+        char* buffer = new char[res.size() + 1];
+        std::memcpy(buffer, res.c_str(), res.size() + 1);
+        *out_len = static_cast<int32_t>(res.size());
+        return buffer;
+    } catch (...) {
+        *out_len = 0;
+        return nullptr;
+    }
+}
+
+// ==================== APPEND LOGS ====================
+
+int64_t aegis_engine_log_append(aegis_engine_t* engine, const char* log_id, const uint8_t* data, int32_t len) {
+    if (!log_id || !data || len <= 0) return -1;
+    try {
+        std::vector<uint8_t> buffer(data, data + len);
+        uint64_t seq = core(engine).appendLog().append(log_id, buffer);
+        return seq == 0 ? -1 : static_cast<int64_t>(seq);
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Log append failed: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+const uint8_t* aegis_engine_log_read(aegis_engine_t* engine, const char* log_id, int64_t from_seq, int32_t max, int32_t* out_len) {
+    if (!log_id || !out_len) return nullptr;
+    *out_len = 0;
+    if (max <= 0) return nullptr;
+    try {
+        auto entries = core(engine).appendLog().read(
+            log_id, static_cast<uint64_t>(from_seq < 0 ? 0 : from_seq), static_cast<size_t>(max));
+        if (entries.empty()) return nullptr;
+
+        auto packed = aegis::AppendLog::pack(entries);
+        uint8_t* buffer = new uint8_t[packed.size()];
+        std::memcpy(buffer, packed.data(), packed.size());
+        *out_len = static_cast<int32_t>(packed.size());
+        return buffer;
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Log read failed: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+int64_t aegis_engine_log_head(aegis_engine_t* engine, const char* log_id) {
+    if (!log_id) return 0;
+    try {
+        return static_cast<int64_t>(core(engine).appendLog().head(log_id));
+    } catch (...) { return 0; }
+}
+
+int64_t aegis_engine_log_subscribe(aegis_engine_t* engine, const char* log_id, int64_t from_seq, AegisLogEntryCallback callback) {
+    if (!log_id || !callback) return 0;
+    try {
+        return static_cast<int64_t>(core(engine).appendLog().subscribe(
+            log_id, static_cast<uint64_t>(from_seq < 0 ? 0 : from_seq),
+            [callback](const std::string& id, const aegis::LogEntry& entry) {
+                callback(id.c_str(), static_cast<int64_t>(entry.seq), entry.data.data(),
+                         static_cast<int32_t>(entry.data.size()));
+            }));
+    } catch (const std::exception& e) {
+        std::cerr << "[AegisEngine] Log subscribe failed: " << e.what() << std::endl;
+        return 0;
+    }
+}
+
+void aegis_engine_log_unsubscribe(aegis_engine_t* engine, int64_t subscription_id) {
+    try {
+        core(engine).appendLog().unsubscribe(static_cast<uint64_t>(subscription_id));
+    } catch (...) {}
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "AegisFlutterSDK.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ==================== ENGINE HANDLES ====================
+//
+// Handle-based form of the aegis_flutter_* API. Each handle owns one engine
+// (database, sync worker, transport); handles are independent, so a process
+// can shard data across several database files with one writer each. The
+// aegis_flutter_* functions operate on aegis_engine_default().
+//
+// Buffers returned here are freed with aegis_flutter_free_buffer. A handle
+// must not be used concurrently with aegis_engine_close on it.
+
+typedef struct aegis_engine aegis_engine_t;
+
+typedef struct aegis_engine_config {
+    const char* db_path;          // SQLite database file (NULL = "aegis.db")
+    const char* client_id;        // unique per engine (NULL = "flutter_client")
+    int32_t port;                 // loopback listen port (0 = disabled)
+    bool use_ssl;
+    const char* enc_key;          // NULL or "" = no encryption
+    bool enable_mesh;
+    const char* unix_socket_path; // also listen on this Unix socket (NULL = none)
+    int32_t chess_hash_mb;        // shared chess search table (0 = keep the current size, 16 MB initially)
+} aegis_engine_config_t;
+
+/**
+ * aegis_engine_open
+ * Creates and initializes a new engine.
+ *
+ * @return Handle, or NULL if initialization failed. Release with aegis_engine_close.
+ */
+aegis_engine_t* aegis_engine_open(const aegis_engine_config_t* config);
+
+/**
+ * aegis_engine_close
+ * Shuts the engine down and frees the handle. For the default handle this
+ * only shuts down; it can be initialized again.
+ */
+void aegis_engine_close(aegis_engine_t* engine);
+
+/**
+ * aegis_engine_default
+ * @return The process-wide handle behind the aegis_flutter_* functions
+ */
+aegis_engine_t* aegis_engine_default();
+
+/**
+ * aegis_engine_init
+ * (Re)initializes an existing handle, e.g. the default one.
+ * @return true if initialization succeeded
+ */
+bool aegis_engine_init(aegis_engine_t* engine, const aegis_engine_config_t* config);
+
+/**
+ * aegis_engine_shutdown
+ * Stops the engine and clears its callbacks; the handle stays valid.
+ */
+void aegis_engine_shutdown(aegis_engine_t* engine);
+
+void aegis_engine_start_network(aegis_engine_t* engine);
+void aegis_engine_stop_network(aegis_engine_t* engine);
+
+// Database, queries and attachments: see the aegis_flutter_* equivalents
+bool aegis_engine_put(aegis_engine_t* engine, const char* key, const uint8_t* data, int32_t len);
+bool aegis_engine_put_with_lane(aegis_engine_t* engine, const char* key, const uint8_t* data, int32_t len, int32_t lane);
+bool aegis_engine_put_batch(aegis_engine_t* engine, const char* json_items);
+const uint8_t* aegis_engine_get(aegis_engine_t* engine, const char* key, int32_t* out_len);
+bool aegis_engine_delete(aegis_engine_t* engine, const char* key);
+const char* aegis_engine_query(aegis_engine_t* engine, const char* json_query, int32_t* out_len);
+bool aegis_engine_put_attachment(aegis_engine_t* engine, const char* doc_id, const uint8_t* data, int32_t len);
+const uint8_t* aegis_engine_get_attachment(aegis_engine_t* engine, const char* doc_id, int32_t* out_len);
+
+// Callbacks are per handle
+void aegis_engine_set_data_change_callback(aegis_engine_t* engine, AegisDataChangeCallback callback);
+void aegis_engine_set_peer_discovered_callback(aegis_engine_t* engine, AegisPeerDiscoveredCallback callback);
+void aegis_engine_set_peer_typing_callback(aegis_engine_t* engine, AegisPeerTypingCallback callback);
+
+// Status and sync control
+bool aegis_engine_is_network_active(aegis_engine_t* engine);
+int32_t aegis_engine_get_connected_peers_count(aegis_engine_t* engine);
+int32_t aegis_engine_get_pending_mutations_count(aegis_engine_t* engine);
+void aegis_engine_connect_to_peer(aegis_engine_t* engine, const char* ip, int port);
+void aegis_engine_set_sync_lane(aegis_engine_t* engine, const char* prefix, int32_t lane);
+void aegis_engine_trigger_sync(aegis_engine_t* engine);
+
+// Pairing, presence and typing
+void aegis_engine_start_pairing(aegis_engine_t* engine, int role, const char* pin);
+void aegis_engine_confirm_pairing(aegis_engine_t* engine);
+void aegis_engine_cancel_pairing(aegis_engine_t* engine);
+int aegis_engine_get_pairing_status(aegis_engine_t* engine);
+void aegis_engine_pin_peer(aegis_engine_t* engine, const char* peerId, const char* fingerprint);
+const char* aegis_engine_get_online_peers(aegis_engine_t* engine, int32_t* out_len);
+void aegis_engine_set_presence_status(aegis_engine_t* engine, const char* status, const char* current_doc);
+void aegis_engine_set_typing_status(aegis_engine_t* engine, bool is_typing);
+
+// Observability
+const char* aegis_engine_get_bandwidth_stats(aegis_engine_t* engine, int32_t* out_len);
+const char* aegis_engine_get_sync_stats(aegis_engine_t* engine, int32_t* out_len);
+
+// Append logs; subscription ids are only valid on the handle that issued them
+int64_t aegis_engine_log_append(aegis_engine_t* engine, const char* log_id, const uint8_t* data, int32_t len);
+const uint8_t* aegis_engine_log_read(aegis_engine_t* engine, const char* log_id, int64_t from_seq, int32_t max, int32_t* out_len);
+int64_t aegis_engine_log_head(aegis_engine_t* engine, const char* log_id);
+int64_t aegis_engine_log_subscribe(aegis_engine_t* engine, const char* log_id, int64_t from_seq, AegisLogEntryCallback callback);
+void aegis_engine_log_unsubscribe(aegis_engine_t* engine, int64_t subscription_id);
+
+#ifdef __cplusplus
+}
+#endif
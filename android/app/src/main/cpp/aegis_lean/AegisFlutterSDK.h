@@ -7,6 +7,9 @@
 extern "C" {
 #endif
 
+// These functions act on the process-wide default engine. AegisEngine.h has
+// the same API on explicit aegis_engine_t handles for multiple engines.
+
 // ==================== LIFECYCLE ====================
 
 /**
@@ -57,10 +60,20 @@ void aegis_flutter_shutdown();
  * @param key Document key/ID
  * @param data Binary data buffer
  * @param len Length of data in bytes
- * @return true if write succeeded
+ * @return true if write succeeded; false also when the unsynced backlog is
+ *         over its hard limit (see aegis_flutter_get_sync_stats "memory")
  */
 bool aegis_flutter_put(const char* key, const uint8_t* data, int32_t len);
 
+/**
+ * aegis_flutter_put_with_lane
+ * Same as aegis_flutter_put, but forces the sync priority lane instead of
+ * classifying by key prefix.
+ *
+ * @param lane 0=MOVE, 1=CLOCK, 2=PRESENCE, 3=DOCUMENT, 4=BULK
+ */
+bool aegis_flutter_put_with_lane(const char* key, const uint8_t* data, int32_t len, int32_t lane);
+
 /**
  * aegis_flutter_put_batch
  * Stores multiple documents in a single atomic transaction.
@@ -161,7 +174,7 @@ int32_t aegis_flutter_get_connected_peers_count();
 
 /**
  * aegis_flutter_get_pending_mutations_count
- * @return Number of unsynced mutations in the queue
+ * @return Number of mutations not yet handed to the sync layer
  */
 int32_t aegis_flutter_get_pending_mutations_count();
 
@@ -173,9 +186,24 @@ int32_t aegis_flutter_get_pending_mutations_count();
  */
 void aegis_flutter_connect_to_peer(const char* ip, int port);
 
+/**
+ * aegis_flutter_set_sync_lane
+ * Routes every key starting with prefix to a sync priority lane (longest
+ * prefix wins). Defaults: match_ -> MOVE, clock_ -> CLOCK,
+ * presence_/typing_ -> PRESENCE, attachment_ -> BULK, others -> DOCUMENT.
+ * Values of 256 KB or more always go to BULK.
+ *
+ * @param lane 0=MOVE, 1=CLOCK, 2=PRESENCE, 3=DOCUMENT, 4=BULK
+ */
+void aegis_flutter_set_sync_lane(const char* prefix, int32_t lane);
+
 /**
  * aegis_flutter_trigger_sync
- * Force immediate sync attempt with all connected peers
+ * Force immediate sync attempt with all connected peers.
+ * Non-blocking: wakes the sync worker, which replays pending mutations on
+ * its own thread, and starts a Merkle summary comparison with each connected
+ * peer so only divergent keys are exchanged. Progress is reported by
+ * aegis_flutter_get_sync_stats.
  */
 void aegis_flutter_trigger_sync();
 
@@ -242,10 +270,89 @@ void aegis_flutter_set_peer_typing_callback(AegisPeerTypingCallback callback);
 
 /**
  * aegis_flutter_get_bandwidth_stats
- * Returns JSON: {"bytesSent": 0, "bytesReceived": 0}
+ * Returns JSON: {"bytesSent": 0, "bytesReceived": 0, "bytesSaved": 0,
+ *                "deltaFrames": 0, "fullFrames": 0, "deltaMisses": 0,
+ *                "deltaHistoryKeys": 0, "deltaHistoryBytes": 0,
+ *                "deltaHistoryEvictions": 0, "deltaReceivedBytes": 0,
+ *                "deltaReceivedEvictions": 0,
+ *                "wireFrames": 0, "wireMutations": 0, "wireOverheadBytes": 0,
+ *                "wireDecodeErrors": 0}
+ * bytesSaved is the total size reduction from delta-encoded sync frames.
+ * deltaHistory* is the local version history kept as delta bases, capped by
+ * a byte budget (least recently written keys are evicted); deltaReceived*
+ * is the same for peers' values kept to resolve their deltas.
+ * wireOverheadBytes / wireMutations is the per-mutation framing cost.
  */
 const char* aegis_flutter_get_bandwidth_stats(int32_t* out_len);
 
+/**
+ * aegis_flutter_get_sync_stats
+ * Returns JSON describing the background sync worker:
+ * {"passes": 0, "batches": 0, "failures": 0, "mutationsSynced": 0,
+ *  "pending": 0, "outboundDepth": 0, "spillDepth": 0, "backoffMs": 0, "lastPassUs": 0,
+ *  "lanes": {"move": {"depth": 0, "enqueued": 0, "sent": 0,
+ *                     "avgLatencyUs": 0, "maxLatencyUs": 0}, ...},
+ *  "memory": {"residentMutations": 0, "residentBytes": 0, "spilledPending": 0,
+ *             "spilledPendingBytes": 0, "spilledTotal": 0,
+ *             "backpressureWaits": 0, "rejectedWrites": 0},
+ *  "antiEntropy": {"digests": 0, "leaves": 0, "keysRepaired": 0},
+ *  "remoteApply": {"applied": 0, "stale": 0, "coalesced": 0, "clockRejects": 0,
+ *                  "batches": 0, "stageWaits": 0, "lastBatchUs": 0},
+ *  "appendLog": {"conflicts": 0}}
+ * pending is what still waits for the worker: outboundDepth mutations held
+ * in memory plus spillDepth spilled ones.
+ * appendLog.conflicts counts log seqs that two writers appended
+ * concurrently (see aegis_log_subscribe).
+ * Caller must free with aegis_flutter_free_buffer.
+ */
+const char* aegis_flutter_get_sync_stats(int32_t* out_len);
+
+// ==================== APPEND LOGS ====================
+
+/**
+ * aegis_log_append
+ * Appends an entry (e.g. one move) to an append-only log such as "match_<id>".
+ *
+ * @return Assigned sequence number (starting at 1), or -1 on failure
+ */
+int64_t aegis_log_append(const char* log_id, const uint8_t* data, int32_t len);
+
+/**
+ * aegis_log_read
+ * Reads up to max entries with seq >= from_seq.
+ * Result layout, repeated per entry: [u64 seq][u32 len][len bytes], little-endian.
+ *
+ * @param out_len Output parameter for total buffer length
+ * @return Pointer to packed entries. Caller must free with aegis_flutter_free_buffer.
+ */
+const uint8_t* aegis_log_read(const char* log_id, int64_t from_seq, int32_t max, int32_t* out_len);
+
+/**
+ * aegis_log_head
+ * @return Highest sequence number in the log (0 if empty)
+ */
+int64_t aegis_log_head(const char* log_id);
+
+// Callback type for log entries
+typedef void (*AegisLogEntryCallback)(const char* log_id, int64_t seq, const uint8_t* data, int32_t len);
+
+/**
+ * aegis_log_subscribe
+ * Delivers every entry with seq >= from_seq, then each new local or remote
+ * entry as it lands. Entries may be delivered twice around the switch from
+ * backlog to live; de-duplicate by seq. A seq delivered again with other
+ * data replaces the earlier entry: two writers appended it and the peer's
+ * entry won (counted in aegis_flutter_get_sync_stats "appendLog").
+ *
+ * @return Subscription id for aegis_log_unsubscribe (0 on failure)
+ */
+int64_t aegis_log_subscribe(const char* log_id, int64_t from_seq, AegisLogEntryCallback callback);
+
+/**
+ * aegis_log_unsubscribe
+ */
+void aegis_log_unsubscribe(int64_t subscription_id);
+
 #ifdef __cplusplus
 }
 #endif
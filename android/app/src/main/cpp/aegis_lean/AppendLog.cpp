@@ -0,0 +1,322 @@
+#include "AppendLog.h"
+#include "sqlite3.h"
+#include <iostream>
+
+namespace aegis {
+
+namespace {
+
+const char* kSchema =
+    "CREATE TABLE IF NOT EXISTS log_entries ("
+    "  log_id TEXT NOT NULL,"
+    "  seq INTEGER NOT NULL,"
+    "  data BLOB NOT NULL,"
+    "  PRIMARY KEY (log_id, seq)"
+    ") WITHOUT ROWID;";
+
+bool prepare(sqlite3* db, const char* sql, sqlite3_stmt** stmt) {
+    if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "[AppendLog] Prepare failed: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+AppendLog::~AppendLog() {
+    close();
+}
+
+bool AppendLog::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_db) return true;
+
+    if (sqlite3_open(path.c_str(), &m_db) != SQLITE_OK) {
+        std::cerr << "[AppendLog] Open failed: " << sqlite3_errmsg(m_db) << std::endl;
+        sqlite3_close(m_db);
+        m_db = nullptr;
+        return false;
+    }
+
+    sqlite3_exec(m_db, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr);
+    if (sqlite3_exec(m_db, kSchema, nullptr, nullptr, nullptr) != SQLITE_OK ||
+        !prepare(m_db, "INSERT INTO log_entries (log_id, seq, data) VALUES (?, ?, ?)", &m_insert) ||
+        !prepare(m_db,
+                 "INSERT INTO log_entries (log_id, seq, data) VALUES (?, ?, ?) "
+                 "ON CONFLICT (log_id, seq) DO UPDATE SET data = excluded.data WHERE excluded.data < data",
+                 &m_merge) ||
+        !prepare(m_db, "SELECT data FROM log_entries WHERE log_id = ? AND seq = ?", &m_get) ||
+        !prepare(m_db, "SELECT seq, data FROM log_entries WHERE log_id = ? AND seq >= ? ORDER BY seq LIMIT ?", &m_read) ||
+        !prepare(m_db, "SELECT MAX(seq) FROM log_entries WHERE log_id = ?", &m_head) ||
+        !prepare(m_db, "SELECT log_id, MAX(seq) FROM log_entries GROUP BY log_id", &m_heads)) {
+        std::cerr << "[AppendLog] Schema setup failed: " << sqlite3_errmsg(m_db) << std::endl;
+        sqlite3_close_v2(m_db);
+        m_db = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void AppendLog::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto* stmt : {m_insert, m_merge, m_get, m_read, m_head, m_heads}) {
+        sqlite3_finalize(stmt);
+    }
+    m_insert = m_merge = m_get = m_read = m_head = m_heads = nullptr;
+    if (m_db) {
+        sqlite3_close_v2(m_db);
+        m_db = nullptr;
+    }
+    m_headCache.clear();
+}
+
+uint64_t AppendLog::headLocked(const std::string& logId) {
+    auto it = m_headCache.find(logId);
+    if (it != m_headCache.end()) return it->second;
+
+    uint64_t head = 0;
+    sqlite3_bind_text(m_head, 1, logId.data(), static_cast<int>(logId.size()), SQLITE_STATIC);
+    if (sqlite3_step(m_head) == SQLITE_ROW) {
+        head = static_cast<uint64_t>(sqlite3_column_int64(m_head, 0));
+    }
+    sqlite3_reset(m_head);
+    sqlite3_clear_bindings(m_head);
+    m_headCache.emplace(logId, head);
+    return head;
+}
+
+uint64_t AppendLog::head(const std::string& logId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_db) return 0;
+    return headLocked(logId);
+}
+
+std::map<std::string, uint64_t> AppendLog::heads() {
+    std::map<std::string, uint64_t> out;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_db) return out;
+    while (sqlite3_step(m_heads) == SQLITE_ROW) {
+        auto* id = reinterpret_cast<const char*>(sqlite3_column_text(m_heads, 0));
+        if (id) out[id] = static_cast<uint64_t>(sqlite3_column_int64(m_heads, 1));
+    }
+    sqlite3_reset(m_heads);
+    return out;
+}
+
+uint64_t AppendLog::append(const std::string& logId, const std::vector<uint8_t>& data) {
+    LogEntry entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_db) return 0;
+
+        entry.seq = headLocked(logId) + 1;
+        sqlite3_bind_text(m_insert, 1, logId.data(), static_cast<int>(logId.size()), SQLITE_STATIC);
+        sqlite3_bind_int64(m_insert, 2, static_cast<sqlite3_int64>(entry.seq));
+        sqlite3_bind_blob(m_insert, 3, data.data(), static_cast<int>(data.size()), SQLITE_STATIC);
+        int rc = sqlite3_step(m_insert);
+        sqlite3_reset(m_insert);
+        sqlite3_clear_bindings(m_insert);
+        if (rc != SQLITE_DONE) {
+            std::cerr << "[AppendLog] Append failed: " << sqlite3_errmsg(m_db) << std::endl;
+            return 0;
+        }
+        m_headCache[logId] = entry.seq;
+    }
+
+    entry.data = data;
+    notify(logId, {entry});
+
+    EntryCallback onLocal;
+    {
+        std::lock_guard<std::mutex> lock(m_subMutex);
+        onLocal = m_onLocalAppend;
+    }
+    if (onLocal) onLocal(logId, entry);
+    return entry.seq;
+}
+
+std::vector<LogEntry> AppendLog::read(const std::string& logId, uint64_t fromSeq, size_t max) {
+    std::vector<LogEntry> entries;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_db || max == 0) return entries;
+
+    sqlite3_bind_text(m_read, 1, logId.data(), static_cast<int>(logId.size()), SQLITE_STATIC);
+    sqlite3_bind_int64(m_read, 2, static_cast<sqlite3_int64>(fromSeq));
+    sqlite3_bind_int64(m_read, 3, static_cast<sqlite3_int64>(max));
+    while (sqlite3_step(m_read) == SQLITE_ROW) {
+        LogEntry entry;
+        entry.seq = static_cast<uint64_t>(sqlite3_column_int64(m_read, 0));
+        auto* blob = static_cast<const uint8_t*>(sqlite3_column_blob(m_read, 1));
+        int len = sqlite3_column_bytes(m_read, 1);
+        if (blob && len > 0) entry.data.assign(blob, blob + len);
+        entries.push_back(std::move(entry));
+    }
+    sqlite3_reset(m_read);
+    sqlite3_clear_bindings(m_read);
+    return entries;
+}
+
+size_t AppendLog::applyRemote(const std::string& logId, const std::vector<LogEntry>& entries) {
+    std::vector<LogEntry> changed; // replaced at or below the old head, then added past it
+    std::vector<std::pair<LogEntry, LogEntry>> conflicts; // kept, dropped
+    size_t added = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_db || entries.empty()) return 0;
+
+        uint64_t head = headLocked(logId);
+        sqlite3_exec(m_db, "BEGIN", nullptr, nullptr, nullptr);
+        for (const auto& entry : entries) {
+            if (entry.seq == 0) continue;
+            if (entry.seq <= head) {
+                // Only entries up to our head can collide with a stored one
+                LogEntry stored;
+                bool found = false;
+                sqlite3_bind_text(m_get, 1, logId.data(), static_cast<int>(logId.size()), SQLITE_STATIC);
+                sqlite3_bind_int64(m_get, 2, static_cast<sqlite3_int64>(entry.seq));
+                if (sqlite3_step(m_get) == SQLITE_ROW) {
+                    found = true;
+                    stored.seq = entry.seq;
+                    auto* blob = static_cast<const uint8_t*>(sqlite3_column_blob(m_get, 0));
+                    int len = sqlite3_column_bytes(m_get, 0);
+                    if (blob && len > 0) stored.data.assign(blob, blob + len);
+                }
+                sqlite3_reset(m_get);
+                sqlite3_clear_bindings(m_get);
+                if (found) {
+                    if (stored.data == entry.data) continue;
+                    // Same order as the merge statement's BLOB comparison
+                    if (entry.data < stored.data) {
+                        conflicts.emplace_back(entry, std::move(stored));
+                        changed.push_back(entry);
+                    } else {
+                        conflicts.emplace_back(std::move(stored), entry);
+                        continue;
+                    }
+                }
+            }
+            sqlite3_bind_text(m_merge, 1, logId.data(), static_cast<int>(logId.size()), SQLITE_STATIC);
+            sqlite3_bind_int64(m_merge, 2, static_cast<sqlite3_int64>(entry.seq));
+            sqlite3_bind_blob(m_merge, 3, entry.data.data(), static_cast<int>(entry.data.size()), SQLITE_STATIC);
+            int rc = sqlite3_step(m_merge);
+            sqlite3_reset(m_merge);
+            sqlite3_clear_bindings(m_merge);
+            if (rc != SQLITE_DONE) {
+                std::cerr << "[AppendLog] Merge failed: " << sqlite3_errmsg(m_db) << std::endl;
+                sqlite3_exec(m_db, "ROLLBACK", nullptr, nullptr, nullptr);
+                return 0;
+            }
+            if (entry.seq > head) {
+                changed.push_back(entry);
+                added++;
+            }
+        }
+        sqlite3_exec(m_db, "COMMIT", nullptr, nullptr, nullptr);
+
+        for (const auto& entry : changed) {
+            if (entry.seq > head) head = entry.seq;
+        }
+        m_headCache[logId] = head;
+    }
+
+    notify(logId, changed);
+    if (!conflicts.empty()) {
+        ConflictCallback onConflict;
+        {
+            std::lock_guard<std::mutex> lock(m_subMutex);
+            onConflict = m_onConflict;
+        }
+        if (onConflict) {
+            for (const auto& [kept, dropped] : conflicts) onConflict(logId, kept, dropped);
+        }
+    }
+    return added;
+}
+
+uint64_t AppendLog::subscribe(const std::string& logId, uint64_t fromSeq, EntryCallback callback) {
+    if (!callback) return 0;
+
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(m_subMutex);
+        id = m_nextSubscriptionId++;
+        m_subscriptions[id] = {logId, callback};
+    }
+
+    // Backlog. Entries appended while we page through may also arrive via
+    // notify(); subscribers are expected to de-duplicate by seq.
+    const size_t kPage = 256;
+    uint64_t next = fromSeq == 0 ? 1 : fromSeq;
+    for (;;) {
+        auto page = read(logId, next, kPage);
+        for (const auto& entry : page) callback(logId, entry);
+        if (page.size() < kPage) break;
+        next = page.back().seq + 1;
+    }
+    return id;
+}
+
+void AppendLog::unsubscribe(uint64_t subscriptionId) {
+    std::lock_guard<std::mutex> lock(m_subMutex);
+    m_subscriptions.erase(subscriptionId);
+}
+
+void AppendLog::setOnLocalAppend(EntryCallback callback) {
+    std::lock_guard<std::mutex> lock(m_subMutex);
+    m_onLocalAppend = std::move(callback);
+}
+
+void AppendLog::setOnConflict(ConflictCallback callback) {
+    std::lock_guard<std::mutex> lock(m_subMutex);
+    m_onConflict = std::move(callback);
+}
+
+std::vector<uint8_t> AppendLog::pack(const std::vector<LogEntry>& entries) {
+    size_t total = 0;
+    for (const auto& e : entries) total += 12 + e.data.size();
+
+    std::vector<uint8_t> out;
+    out.reserve(total);
+    for (const auto& e : entries) {
+        for (int i = 0; i < 8; i++) out.push_back(static_cast<uint8_t>(e.seq >> (8 * i)));
+        uint32_t n = static_cast<uint32_t>(e.data.size());
+        for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(n >> (8 * i)));
+        out.insert(out.end(), e.data.begin(), e.data.end());
+    }
+    return out;
+}
+
+bool AppendLog::unpack(const uint8_t* data, size_t len, std::vector<LogEntry>& out) {
+    size_t off = 0;
+    while (off < len) {
+        if (len - off < 12) return false;
+        LogEntry e;
+        for (int i = 7; i >= 0; i--) e.seq = (e.seq << 8) | data[off + i];
+        uint32_t n = 0;
+        for (int i = 3; i >= 0; i--) n = (n << 8) | data[off + 8 + i];
+        off += 12;
+        if (len - off < n) return false;
+        e.data.assign(data + off, data + off + n);
+        off += n;
+        out.push_back(std::move(e));
+    }
+    return true;
+}
+
+void AppendLog::notify(const std::string& logId, const std::vector<LogEntry>& entries) {
+    if (entries.empty()) return;
+
+    std::vector<EntryCallback> targets;
+    {
+        std::lock_guard<std::mutex> lock(m_subMutex);
+        for (const auto& [id, sub] : m_subscriptions) {
+            if (sub.logId == logId) targets.push_back(sub.callback);
+        }
+    }
+    for (const auto& callback : targets) {
+        for (const auto& entry : entries) callback(logId, entry);
+    }
+}
+
+} // namespace aegis
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace aegis {
+
+struct LogEntry {
+    uint64_t seq = 0;
+    std::vector<uint8_t> data;
+};
+
+/**
+ * AppendLog
+ * Append-only logs addressed by (log_id, seq), e.g. one log per match holding
+ * its moves. Rows live in a WITHOUT ROWID table keyed by (log_id, seq) so an
+ * append is a single small insert and a read from a sequence number is a
+ * range scan on the primary key.
+ *
+ * Replicas exchange sequence ranges (readRange/applyRemote). If two nodes
+ * append the same seq concurrently, every replica keeps the bytewise smaller
+ * payload so they converge. Such conflicts are not silent: subscribers get
+ * the seq again when its stored entry is replaced, and the conflict
+ * callback sees both sides.
+ */
+class AppendLog {
+public:
+    using EntryCallback = std::function<void(const std::string& logId, const LogEntry& entry)>;
+    // kept is the entry stored for the seq now, dropped the one that lost
+    using ConflictCallback = std::function<void(const std::string& logId, const LogEntry& kept, const LogEntry& dropped)>;
+
+    AppendLog() = default;
+    ~AppendLog();
+    AppendLog(const AppendLog&) = delete;
+    AppendLog& operator=(const AppendLog&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    // Returns the assigned sequence number (starting at 1), or 0 on failure.
+    uint64_t append(const std::string& logId, const std::vector<uint8_t>& data);
+    std::vector<LogEntry> read(const std::string& logId, uint64_t fromSeq, size_t max);
+    uint64_t head(const std::string& logId);
+    std::map<std::string, uint64_t> heads();
+
+    // Merge entries received from a peer. Returns the number of new entries
+    // (past the previous head).
+    size_t applyRemote(const std::string& logId, const std::vector<LogEntry>& entries);
+
+    // Delivers the backlog from fromSeq synchronously, then every new entry
+    // (local or remote) on the thread that added it. A seq delivered again
+    // carries the entry that replaced it after a same-seq conflict.
+    uint64_t subscribe(const std::string& logId, uint64_t fromSeq, EntryCallback callback);
+    void unsubscribe(uint64_t subscriptionId);
+
+    // Local appends only (not remote merges), e.g. to push them to peers.
+    void setOnLocalAppend(EntryCallback callback);
+    // Same-seq conflicts found by applyRemote, whichever side won.
+    void setOnConflict(ConflictCallback callback);
+
+    // Packed form used by aegis_log_read and the sync protocol:
+    // per entry [u64 seq][u32 len][len bytes], little-endian.
+    static std::vector<uint8_t> pack(const std::vector<LogEntry>& entries);
+    static bool unpack(const uint8_t* data, size_t len, std::vector<LogEntry>& out);
+
+private:
+    struct Subscription {
+        std::string logId;
+        EntryCallback callback;
+    };
+
+    uint64_t headLocked(const std::string& logId);
+    void notify(const std::string& logId, const std::vector<LogEntry>& entries);
+
+    std::mutex m_mutex;
+    sqlite3* m_db = nullptr;
+    sqlite3_stmt* m_insert = nullptr;
+    sqlite3_stmt* m_merge = nullptr;
+    sqlite3_stmt* m_get = nullptr;
+    sqlite3_stmt* m_read = nullptr;
+    sqlite3_stmt* m_head = nullptr;
+    sqlite3_stmt* m_heads = nullptr;
+    std::unordered_map<std::string, uint64_t> m_headCache;
+
+    std::mutex m_subMutex;
+    std::map<uint64_t, Subscription> m_subscriptions;
+    uint64_t m_nextSubscriptionId = 1;
+    EntryCallback m_onLocalAppend;
+    ConflictCallback m_onConflict;
+};
+
+} // namespace aegis
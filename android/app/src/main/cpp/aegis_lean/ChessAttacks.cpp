@@ -0,0 +1,151 @@
+#include "ChessAttacks.h"
+#include <mutex>
+#include <vector>
+
+namespace aegis {
+namespace chess {
+
+namespace detail {
+Magic rookMagics[64];
+Magic bishopMagics[64];
+Bitboard pawnAttacks[2][64];
+Bitboard knightAttacks[64];
+Bitboard kingAttacks[64];
+Bitboard between[64][64];
+Bitboard line[64][64];
+} // namespace detail
+
+namespace {
+
+// Fancy magics: every square's table is a slice of one array
+Bitboard g_rookTable[0x19000];  // 102400 entries
+Bitboard g_bishopTable[0x1480]; // 5248 entries
+
+const int kRookDirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+const int kBishopDirs[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+// Ray walk used only while building tables
+Bitboard slidingAttacks(const int (&dirs)[4][2], int sq, Bitboard occupied) {
+    Bitboard attacks = 0;
+    for (const auto& d : dirs) {
+        int f = fileOf(sq) + d[0], r = rankOf(sq) + d[1];
+        while (f >= 0 && f < 8 && r >= 0 && r < 8) {
+            int s = makeSquare(f, r);
+            attacks |= bit(s);
+            if (occupied & bit(s)) break;
+            f += d[0];
+            r += d[1];
+        }
+    }
+    return attacks;
+}
+
+Bitboard leaperAttacks(const int (*deltas)[2], int count, int sq) {
+    Bitboard attacks = 0;
+    for (int i = 0; i < count; i++) {
+        int f = fileOf(sq) + deltas[i][0], r = rankOf(sq) + deltas[i][1];
+        if (f >= 0 && f < 8 && r >= 0 && r < 8) attacks |= bit(makeSquare(f, r));
+    }
+    return attacks;
+}
+
+uint64_t xorshift(uint64_t& s) {
+    s ^= s >> 12;
+    s ^= s << 25;
+    s ^= s >> 27;
+    return s * 2685821657736338717ULL;
+}
+
+// Sparse candidates find magics much faster
+uint64_t sparseRandom(uint64_t& s) {
+    return xorshift(s) & xorshift(s) & xorshift(s);
+}
+
+void initMagics(const int (&dirs)[4][2], Magic* magics, Bitboard* table) {
+    std::vector<Bitboard> occupancy(4096), reference(4096);
+    std::vector<int> epoch(4096, 0);
+    uint64_t seed = 0x5DEECE66DULL;
+    int attempt = 0;
+    size_t offset = 0;
+
+    for (int sq = 0; sq < 64; sq++) {
+        Magic& m = magics[sq];
+        // Board edges never block unless the piece sits on that edge
+        Bitboard sqEdges = ((kRank1 | kRank8) & ~(kRank1 << (8 * rankOf(sq)))) |
+                           ((kFileA | kFileH) & ~(kFileA << fileOf(sq)));
+        m.mask = slidingAttacks(dirs, sq, 0) & ~sqEdges;
+        m.shift = 64 - popcount(m.mask);
+        m.attacks = table + offset;
+
+        // Carry-Rippler over every subset of the mask
+        int size = 0;
+        Bitboard b = 0;
+        do {
+            occupancy[size] = b;
+            reference[size] = slidingAttacks(dirs, sq, b);
+            size++;
+            b = (b - m.mask) & m.mask;
+        } while (b);
+
+        Bitboard* slot = table + offset;
+        for (;;) {
+            do {
+                m.magic = sparseRandom(seed);
+            } while (popcount((m.magic * m.mask) >> 56) < 6);
+
+            ++attempt;
+            bool ok = true;
+            for (int i = 0; i < size && ok; i++) {
+                unsigned idx = m.index(occupancy[i]);
+                if (epoch[idx] < attempt) {
+                    epoch[idx] = attempt;
+                    slot[idx] = reference[i];
+                } else if (slot[idx] != reference[i]) {
+                    ok = false;
+                }
+            }
+            if (ok) break;
+        }
+        offset += size_t(1) << popcount(m.mask);
+    }
+}
+
+void initTables() {
+    static const int knight[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+    static const int king[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+    static const int whitePawn[2][2] = {{-1, 1}, {1, 1}};
+    static const int blackPawn[2][2] = {{-1, -1}, {1, -1}};
+
+    for (int sq = 0; sq < 64; sq++) {
+        detail::knightAttacks[sq] = leaperAttacks(knight, 8, sq);
+        detail::kingAttacks[sq] = leaperAttacks(king, 8, sq);
+        detail::pawnAttacks[White][sq] = leaperAttacks(whitePawn, 2, sq);
+        detail::pawnAttacks[Black][sq] = leaperAttacks(blackPawn, 2, sq);
+    }
+
+    initMagics(kRookDirs, detail::rookMagics, g_rookTable);
+    initMagics(kBishopDirs, detail::bishopMagics, g_bishopTable);
+
+    for (int a = 0; a < 64; a++) {
+        for (int b = 0; b < 64; b++) {
+            detail::between[a][b] = 0;
+            detail::line[a][b] = 0;
+            if (a == b) continue;
+            for (PieceType t : {Bishop, Rook}) {
+                if (!(attacksOf(t, a, 0) & bit(b))) continue;
+                detail::line[a][b] = (attacksOf(t, a, 0) & attacksOf(t, b, 0)) | bit(a) | bit(b);
+                detail::between[a][b] = attacksOf(t, a, bit(b)) & attacksOf(t, b, bit(a));
+            }
+        }
+    }
+}
+
+} // namespace
+
+void initAttacks() {
+    static std::once_flag once;
+    std::call_once(once, initTables);
+}
+
+} // namespace chess
+} // namespace aegis
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ChessTypes.h"
+
+namespace aegis {
+namespace chess {
+
+/**
+ * Attack tables
+ * Leaper attacks are precomputed per square; sliders use magic bitboards
+ * (one multiply and shift into a shared table per lookup). The magics are
+ * searched once at startup with a fixed seed, which takes a few
+ * milliseconds and gives the same tables on every run.
+ *
+ * initAttacks() must run before any lookup; Position::setFen and the FFI
+ * entry points call it (it is cheap after the first call).
+ */
+void initAttacks();
+
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    const Bitboard* attacks;
+    unsigned shift;
+
+    unsigned index(Bitboard occupied) const {
+        return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+    }
+};
+
+namespace detail {
+extern Magic rookMagics[64];
+extern Magic bishopMagics[64];
+extern Bitboard pawnAttacks[2][64];
+extern Bitboard knightAttacks[64];
+extern Bitboard kingAttacks[64];
+extern Bitboard between[64][64]; // squares strictly between two aligned squares
+extern Bitboard line[64][64];    // full line through two aligned squares, 0 otherwise
+} // namespace detail
+
+inline Bitboard pawnAttacks(Color c, int sq) { return detail::pawnAttacks[c][sq]; }
+inline Bitboard knightAttacks(int sq) { return detail::knightAttacks[sq]; }
+inline Bitboard kingAttacks(int sq) { return detail::kingAttacks[sq]; }
+
+inline Bitboard rookAttacks(int sq, Bitboard occupied) {
+    const Magic& m = detail::rookMagics[sq];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard bishopAttacks(int sq, Bitboard occupied) {
+    const Magic& m = detail::bishopMagics[sq];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard queenAttacks(int sq, Bitboard occupied) {
+    return rookAttacks(sq, occupied) | bishopAttacks(sq, occupied);
+}
+
+inline Bitboard attacksOf(PieceType t, int sq, Bitboard occupied) {
+    switch (t) {
+        case Knight: return knightAttacks(sq);
+        case Bishop: return bishopAttacks(sq, occupied);
+        case Rook: return rookAttacks(sq, occupied);
+        case Queen: return queenAttacks(sq, occupied);
+        case King: return kingAttacks(sq);
+        default: return 0;
+    }
+}
+
+inline Bitboard between(int a, int b) { return detail::between[a][b]; }
+inline Bitboard line(int a, int b) { return detail::line[a][b]; }
+inline bool aligned(int a, int b, int c) { return (detail::line[a][b] & bit(c)) != 0; }
+
+} // namespace chess
+} // namespace aegis
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "ChessPosition.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace aegis {
+namespace chess {
+
+struct BookMove {
+    Move move;
+    uint16_t weight = 0;
+};
+
+/**
+ * PolyglotKeys
+ * Position keys as Polyglot books store them: an XOR over the format's
+ * fixed Random64 table of 781 values, 768 for (piece, square), 4 castling
+ * rights, 8 en passant files and 1 for White to move. The table is
+ * compiled in, so any standard .bin book works without side files.
+ */
+class PolyglotKeys {
+public:
+    static constexpr int kCount = 781;
+
+    static uint64_t key(const Position& pos);
+
+    // Self-check: the table reproduces the reference keys published with
+    // the Polyglot format
+    static bool verify();
+
+    PolyglotKeys() = delete;
+};
+
+/**
+ * OpeningBook
+ * A Polyglot .bin book mapped read-only. The file is an array of 16-byte
+ * big-endian entries (key, move, weight, learn) sorted by key, so a probe
+ * is a binary search straight on the mapping plus a scan of the entries
+ * sharing the key: no heap allocation, and the pages are shared with any
+ * other process mapping the same file.
+ */
+class OpeningBook {
+public:
+    static constexpr int kMaxMoves = 64;
+
+    ~OpeningBook();
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    // nullptr (and a reason in error) on a missing or malformed file
+    static std::shared_ptr<const OpeningBook> open(const std::string& path, std::string* error = nullptr);
+
+    size_t entries() const { return m_count; }
+
+    /**
+     * Book moves for pos, legal in pos, heaviest first.
+     * @return Number of moves written to out (at most capacity)
+     */
+    int probe(const Position& pos, BookMove* out, int capacity) const;
+
+    /**
+     * Picks a book move with probability proportional to its weight.
+     * @param random Any uniformly distributed value (the caller's RNG)
+     * @return Move() when pos is out of book
+     */
+    Move pick(const Position& pos, uint64_t random) const;
+
+private:
+    OpeningBook() = default;
+
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_count = 0;
+};
+
+// Process-wide book used by the engine and the explorer; nullptr = none
+std::shared_ptr<const OpeningBook> currentBook();
+void setCurrentBook(std::shared_ptr<const OpeningBook> book);
+
+} // namespace chess
+} // namespace aegis
@@ -0,0 +1,196 @@
+#include "ChessEval.h"
+
+namespace aegis {
+namespace chess {
+
+namespace {
+
+// Tables read like a diagram from White's side: first row is rank 8
+using Table = int[64];
+
+constexpr int kMaterialMg[6] = {82, 337, 365, 477, 1025, 0};
+constexpr int kMaterialEg[6] = {94, 281, 297, 512, 936, 0};
+// Non-pawn material left, 24 = all pieces on the board
+constexpr int kPhaseWeight[6] = {0, 1, 1, 2, 4, 0};
+constexpr int kMaxPhase = 24;
+constexpr int kTempo = 10;
+constexpr int kBishopPairMg = 25;
+constexpr int kBishopPairEg = 45;
+
+constexpr Table kPawnMg = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+     60,  60,  60,  60,  60,  60,  60,  60,
+     15,  20,  25,  35,  35,  25,  20,  15,
+      5,  10,  15,  28,  28,  15,  10,   5,
+      0,   0,  10,  22,  22,   5,   0,   0,
+      5,  -2,  -5,   5,   5, -10,  -2,   5,
+      5,  10,  10, -20, -20,  10,  10,   5,
+      0,   0,   0,   0,   0,   0,   0,   0,
+};
+constexpr Table kPawnEg = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+     90,  90,  85,  80,  80,  85,  90,  90,
+     50,  50,  45,  40,  40,  45,  50,  50,
+     28,  26,  22,  18,  18,  22,  26,  28,
+     14,  12,   8,   5,   5,   8,  12,  14,
+      5,   5,   0,   0,   0,   0,   5,   5,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+};
+constexpr Table kKnightMg = {
+    -50, -40, -30, -30, -30, -30, -40, -50,
+    -40, -20,   0,   5,   5,   0, -20, -40,
+    -30,   5,  10,  15,  15,  10,   5, -30,
+    -30,   0,  15,  20,  20,  15,   0, -30,
+    -30,   5,  15,  20,  20,  15,   5, -30,
+    -30,   0,  10,  15,  15,  10,   0, -30,
+    -40, -20,   0,   0,   0,   0, -20, -40,
+    -50, -30, -30, -30, -30, -30, -30, -50,
+};
+constexpr Table kKnightEg = {
+    -50, -35, -25, -20, -20, -25, -35, -50,
+    -35, -15,  -5,   0,   0,  -5, -15, -35,
+    -25,  -5,  10,  15,  15,  10,  -5, -25,
+    -20,   0,  15,  20,  20,  15,   0, -20,
+    -20,   0,  15,  20,  20,  15,   0, -20,
+    -25,  -5,  10,  15,  15,  10,  -5, -25,
+    -35, -15,  -5,   0,   0,  -5, -15, -35,
+    -50, -35, -25, -20, -20, -25, -35, -50,
+};
+constexpr Table kBishopMg = {
+    -20, -10, -10, -10, -10, -10, -10, -20,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+    -10,   0,   5,  10,  10,   5,   0, -10,
+    -10,   5,   5,  10,  10,   5,   5, -10,
+    -10,   0,  10,  10,  10,  10,   0, -10,
+    -10,  10,  10,  10,  10,  10,  10, -10,
+    -10,   5,   0,   0,   0,   0,   5, -10,
+    -20, -10, -10, -10, -10, -10, -10, -20,
+};
+constexpr Table kBishopEg = {
+    -15, -10,  -8,  -5,  -5,  -8, -10, -15,
+    -10,  -3,   0,   2,   2,   0,  -3, -10,
+     -8,   0,   5,   6,   6,   5,   0,  -8,
+     -5,   2,   6,  10,  10,   6,   2,  -5,
+     -5,   2,   6,  10,  10,   6,   2,  -5,
+     -8,   0,   5,   6,   6,   5,   0,  -8,
+    -10,  -3,   0,   2,   2,   0,  -3, -10,
+    -15, -10,  -8,  -5,  -5,  -8, -10, -15,
+};
+constexpr Table kRookMg = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+      5,  10,  10,  10,  10,  10,  10,   5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+      0,   0,   0,   5,   5,   0,   0,   0,
+};
+constexpr Table kRookEg = {
+      5,   5,   5,   5,   5,   5,   5,   5,
+     10,  10,  10,  10,  10,  10,  10,  10,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,
+};
+constexpr Table kQueenMg = {
+    -20, -10, -10,  -5,  -5, -10, -10, -20,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+    -10,   0,   5,   5,   5,   5,   0, -10,
+     -5,   0,   5,   5,   5,   5,   0,  -5,
+      0,   0,   5,   5,   5,   5,   0,  -5,
+    -10,   5,   5,   5,   5,   5,   0, -10,
+    -10,   0,   5,   0,   0,   0,   0, -10,
+    -20, -10, -10,  -5,  -5, -10, -10, -20,
+};
+constexpr Table kQueenEg = {
+    -20, -10, -10,  -5,  -5, -10, -10, -20,
+    -10,   0,   5,   5,   5,   5,   0, -10,
+    -10,   5,  10,  12,  12,  10,   5, -10,
+     -5,   5,  12,  15,  15,  12,   5,  -5,
+     -5,   5,  12,  15,  15,  12,   5,  -5,
+    -10,   5,  10,  12,  12,  10,   5, -10,
+    -10,   0,   5,   5,   5,   5,   0, -10,
+    -20, -10, -10,  -5,  -5, -10, -10, -20,
+};
+constexpr Table kKingMg = {
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -20, -30, -30, -40, -40, -30, -30, -20,
+    -10, -20, -20, -20, -20, -20, -20, -10,
+     20,  20,   0,   0,   0,   0,  20,  20,
+     20,  30,  10,   0,   0,  10,  30,  20,
+};
+constexpr Table kKingEg = {
+    -50, -40, -30, -20, -20, -30, -40, -50,
+    -30, -20, -10,   0,   0, -10, -20, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -30,   0,   0,   0,   0, -30, -30,
+    -50, -30, -30, -30, -30, -30, -30, -50,
+};
+
+constexpr const int* kMgTables[6] = {kPawnMg, kKnightMg, kBishopMg, kRookMg, kQueenMg, kKingMg};
+constexpr const int* kEgTables[6] = {kPawnEg, kKnightEg, kBishopEg, kRookEg, kQueenEg, kKingEg};
+
+// Material folded into the tables, signed for White, indexed by Piece
+struct PieceSquare {
+    int mg[13][64];
+    int eg[13][64];
+};
+
+constexpr PieceSquare makePieceSquare() {
+    PieceSquare t{};
+    for (int c = White; c <= Black; c++) {
+        for (int type = Pawn; type <= King; type++) {
+            Piece p = makePiece(static_cast<Color>(c), static_cast<PieceType>(type));
+            for (int sq = 0; sq < 64; sq++) {
+                // White reads the diagram upside down (a1 is row 7)
+                int row = c == White ? sq ^ 56 : sq;
+                int sign = c == White ? 1 : -1;
+                t.mg[p][sq] = sign * (kMaterialMg[type] + kMgTables[type][row]);
+                t.eg[p][sq] = sign * (kMaterialEg[type] + kEgTables[type][row]);
+            }
+        }
+    }
+    return t;
+}
+
+constexpr PieceSquare kPieceSquare = makePieceSquare();
+
+} // namespace
+
+int evaluate(const Position& pos) {
+    int mg = 0, eg = 0, phase = 0;
+    Bitboard occupied = pos.pieces();
+    while (occupied) {
+        int sq = popLsb(occupied);
+        Piece p = pos.pieceOn(sq);
+        mg += kPieceSquare.mg[p][sq];
+        eg += kPieceSquare.eg[p][sq];
+        phase += kPhaseWeight[typeOf(p)];
+    }
+    for (Color c : {White, Black}) {
+        if (moreThanOne(pos.pieces(c, Bishop))) {
+            int sign = c == White ? 1 : -1;
+            mg += sign * kBishopPairMg;
+            eg += sign * kBishopPairEg;
+        }
+    }
+
+    // Promotions can push the weight past the start position
+    if (phase > kMaxPhase) phase = kMaxPhase;
+    int score = (mg * phase + eg * (kMaxPhase - phase)) / kMaxPhase;
+    return (pos.sideToMove() == White ? score : -score) + kTempo;
+}
+
+} // namespace chess
+} // namespace aegis
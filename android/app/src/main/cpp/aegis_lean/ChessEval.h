@@ -0,0 +1,20 @@
+#pragma once
+
+#include "ChessPosition.h"
+
+namespace aegis {
+namespace chess {
+
+// Material values used for move ordering and exchange evaluation
+constexpr int kPieceValue[6] = {100, 320, 330, 500, 900, 0};
+
+/**
+ * evaluate
+ * Static evaluation in centipawns from the side to move's point of view:
+ * material plus piece-square tables, interpolated between middlegame and
+ * endgame by the remaining non-pawn material, and a small tempo bonus.
+ */
+int evaluate(const Position& pos);
+
+} // namespace chess
+} // namespace aegis
@@ -0,0 +1,120 @@
+#include "ChessGame.h"
+#include "ChessMoveGen.h"
+#include <algorithm>
+
+namespace aegis {
+namespace chess {
+
+Game::Game() {
+    pushKey();
+}
+
+bool Game::setFen(std::string_view fen) {
+    if (!m_pos.setFen(fen)) return false;
+    m_history.clear();
+    m_keys.clear();
+    m_reps.clear();
+    pushKey();
+    return true;
+}
+
+void Game::pushKey() {
+    // Positions before the last capture or pawn move cannot recur, and a
+    // repetition needs at least four plies
+    uint64_t key = m_pos.key();
+    int n = static_cast<int>(m_keys.size());
+    int window = std::min(m_pos.halfmoveClock(), n);
+    int reps = 0;
+    for (int back = 4; back <= window; back += 2) {
+        if (m_keys[n - back] == key) {
+            reps = m_reps[n - back] + 1;
+            break;
+        }
+    }
+    m_keys.push_back(key);
+    m_reps.push_back(reps);
+    m_statusValid = false;
+}
+
+bool Game::make(Move m) {
+    MoveList list;
+    generateLegal(m_pos, list);
+    if (std::find(list.begin(), list.end(), m) == list.end()) return false;
+    play(m);
+    return true;
+}
+
+bool Game::make(std::string_view uci) {
+    // parseUci only returns legal moves
+    Move m = m_pos.parseUci(uci);
+    if (m.isNone()) return false;
+    play(m);
+    return true;
+}
+
+void Game::play(Move m) {
+    m_history.push_back(Ply{m, Undo()});
+    m_pos.doMove(m, m_history.back().undo);
+    pushKey();
+}
+
+bool Game::unmake() {
+    if (m_history.empty()) return false;
+    const Ply& last = m_history.back();
+    m_pos.undoMove(last.move, last.undo);
+    m_history.pop_back();
+    m_keys.pop_back();
+    m_reps.pop_back();
+    m_statusValid = false;
+    return true;
+}
+
+GameStatus Game::ruleStatus() const {
+    if (m_statusValid) return m_status;
+    if (!hasLegalMove(m_pos)) m_status = m_pos.inCheck() ? GameStatus::Checkmate : GameStatus::Stalemate;
+    else if (insufficientMaterial(m_pos)) m_status = GameStatus::InsufficientMaterial;
+    else if (m_pos.halfmoveClock() >= 100) m_status = GameStatus::FiftyMoves;
+    else if (repetitions() >= 2) m_status = GameStatus::Repetition;
+    else m_status = m_pos.inCheck() ? GameStatus::Check : GameStatus::Ongoing;
+    m_statusValid = true;
+    return m_status;
+}
+
+GameStatus Game::status() const {
+    // Tables can be opened or closed at any time, so their verdict isn't
+    // cached. A side in check keeps Check; tablebaseResult has its verdict.
+    GameStatus s = ruleStatus();
+    TablebaseResult r;
+    if (s != GameStatus::Ongoing || !tablebaseResult(r)) return s;
+    if (r.wdl == Wdl::Win) return GameStatus::TablebaseWin;
+    return r.wdl == Wdl::Loss ? GameStatus::TablebaseLoss : GameStatus::TablebaseDraw;
+}
+
+bool Game::tablebaseResult(TablebaseResult& out) const {
+    GameStatus s = ruleStatus();
+    if (s != GameStatus::Ongoing && s != GameStatus::Check) return false;
+    std::shared_ptr<const Tablebases> tables = currentTablebases();
+    return tables && tables->probe(m_pos, out);
+}
+
+bool insufficientMaterial(const Position& pos) {
+    if (pos.pieces(Pawn) | pos.pieces(Rook, Queen)) return false;
+    Bitboard minors = pos.pieces(Knight, Bishop);
+    if (!moreThanOne(minors)) return true;
+    if (pos.pieces(Knight)) return false;
+    constexpr Bitboard kDark = 0xAA55AA55AA55AA55ULL;
+    Bitboard bishops = pos.pieces(Bishop);
+    return !(bishops & kDark) || !(bishops & ~kDark);
+}
+
+bool hasLegalMove(const Position& pos) {
+    MoveList list;
+    generatePseudoLegal(pos, GenType::All, list);
+    for (Move m : list) {
+        if (pos.isLegal(m)) return true;
+    }
+    return false;
+}
+
+} // namespace chess
+} // namespace aegis
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "ChessPosition.h"
+#include "ChessTablebase.h"
+#include <string_view>
+#include <vector>
+
+namespace aegis {
+namespace chess {
+
+// Values cross the FFI (aegis_chess_game_status)
+enum class GameStatus : int {
+    Ongoing = 0,
+    Check = 1,
+    Checkmate = 2,
+    Stalemate = 3,
+    Repetition = 4,          // threefold, claimable draw
+    FiftyMoves = 5,          // 100 plies without capture or pawn move
+    InsufficientMaterial = 6, // no sequence of legal moves can mate
+    // Endgame tables (currentTablebases) know the result for the side to
+    // move; only reported instead of Ongoing, never instead of Check
+    TablebaseWin = 7,
+    TablebaseLoss = 8,
+    TablebaseDraw = 9
+};
+
+/**
+ * Game
+ * A position plus the moves that led to it, for make/unmake across the
+ * FFI and for draw rules. Every ply records the key it reached and how
+ * often that key already occurred since the last irreversible move; the
+ * count is found by following the previous occurrence, so repetition and
+ * fifty-move checks are O(1) after each move. status() is cached until the
+ * next make/unmake.
+ */
+class Game {
+public:
+    Game();
+
+    // Replaces the position and clears the history
+    bool setFen(std::string_view fen);
+
+    const Position& position() const { return m_pos; }
+    size_t plies() const { return m_history.size(); }
+    // Keys of every position so far, the current one last (search draws)
+    const std::vector<uint64_t>& keys() const { return m_keys; }
+
+    // Plays m if it is legal in the current position
+    bool make(Move m);
+    // Same for long algebraic input ("e2e4", "e7e8q")
+    bool make(std::string_view uci);
+    // Takes back the last move; false at the start position
+    bool unmake();
+
+    // Earlier occurrences of the current position (same side to move)
+    int repetitions() const { return m_reps.back(); }
+    GameStatus status() const;
+    // Verdict of the endgame tables (currentTablebases) for the side to
+    // move, for adjudication; false when none is open or covers the
+    // position, or the game is already over
+    bool tablebaseResult(TablebaseResult& out) const;
+
+private:
+    struct Ply {
+        Move move;
+        Undo undo;
+    };
+
+    void play(Move m);
+    void pushKey();
+    // Status from the rules alone (cached per position)
+    GameStatus ruleStatus() const;
+
+    Position m_pos;
+    std::vector<Ply> m_history;
+    std::vector<uint64_t> m_keys; // one per position, the start included
+    std::vector<int> m_reps;      // parallel to m_keys
+
+    mutable GameStatus m_status = GameStatus::Ongoing;
+    mutable bool m_statusValid = false;
+};
+
+// No sequence of legal moves mates either side (K v K, K+minor v K,
+// bishops all on one square colour)
+bool insufficientMaterial(const Position& pos);
+
+// Whether the side to move has any legal move
+bool hasLegalMove(const Position& pos);
+
+} // namespace chess
+} // namespace aegis
@@ -0,0 +1,143 @@
+#include "ChessMoveGen.h"
+
+namespace aegis {
+namespace chess {
+
+namespace {
+
+template <int Delta> void pushPawnMoves(Bitboard targets, MoveList& list) {
+    while (targets) {
+        int to = popLsb(targets);
+        list.push(Move(to - Delta, to));
+    }
+}
+
+template <int Delta> void pushPromotions(Bitboard targets, GenType type, MoveList& list) {
+    while (targets) {
+        int to = popLsb(targets);
+        if (type != GenType::Quiets) list.push(Move(to - Delta, to, Move::Promotion, Queen));
+        if (type != GenType::Captures) {
+            list.push(Move(to - Delta, to, Move::Promotion, Rook));
+            list.push(Move(to - Delta, to, Move::Promotion, Bishop));
+            list.push(Move(to - Delta, to, Move::Promotion, Knight));
+        }
+    }
+}
+
+template <Color Us> void generatePawnMoves(const Position& pos, GenType type, Bitboard checkMask, MoveList& list) {
+    constexpr Color Them = Us == White ? Black : White;
+    constexpr int Up = Us == White ? 8 : -8;
+    constexpr int UpLeft = Us == White ? 7 : -9;
+    constexpr int UpRight = Us == White ? 9 : -7;
+    constexpr Bitboard Rank7 = Us == White ? kRank7 : kRank2;
+    constexpr Bitboard Rank3 = Us == White ? (kRank1 << 16) : (kRank1 << 40);
+
+    Bitboard pawns = pos.pieces(Us, Pawn);
+    Bitboard promoting = pawns & Rank7;
+    Bitboard rest = pawns & ~Rank7;
+    Bitboard empty = ~pos.pieces();
+    Bitboard enemies = pos.pieces(Them);
+
+    if (type != GenType::Captures) {
+        Bitboard single = shift<Up>(rest) & empty;
+        Bitboard twice = shift<Up>(single & Rank3) & empty;
+        pushPawnMoves<Up>(single & checkMask, list);
+        pushPawnMoves<Up + Up>(twice & checkMask, list);
+    }
+
+    if (promoting) {
+        pushPromotions<Up>(shift<Up>(promoting) & empty & checkMask, type, list);
+        pushPromotions<UpLeft>(shift<UpLeft>(promoting) & enemies & checkMask, type, list);
+        pushPromotions<UpRight>(shift<UpRight>(promoting) & enemies & checkMask, type, list);
+    }
+
+    if (type != GenType::Quiets) {
+        pushPawnMoves<UpLeft>(shift<UpLeft>(rest) & enemies & checkMask, list);
+        pushPawnMoves<UpRight>(shift<UpRight>(rest) & enemies & checkMask, list);
+
+        int ep = pos.epSquare();
+        // In check, en passant helps only by blocking or by taking the checker
+        if (ep != kNoSquare && (checkMask & (bit(ep) | bit(ep - Up)))) {
+            Bitboard from = rest & pawnAttacks(Them, ep);
+            while (from) list.push(Move(popLsb(from), ep, Move::EnPassant));
+        }
+    }
+}
+
+template <Color Us> void generateCastling(const Position& pos, MoveList& list) {
+    constexpr Color Them = Us == White ? Black : White;
+    constexpr uint8_t Short = Us == White ? WhiteOO : BlackOO;
+    constexpr uint8_t Long = Us == White ? WhiteOOO : BlackOOO;
+    constexpr int KingFrom = Us == White ? 4 : 60;
+
+    uint8_t rights = pos.castlingRights();
+    if (!(rights & (Short | Long))) return;
+    Bitboard occupied = pos.pieces();
+    auto attacked = [&](int sq) { return (pos.attackersTo(sq, occupied) & pos.pieces(Them)) != 0; };
+
+    if ((rights & Short) && !(occupied & (bit(KingFrom + 1) | bit(KingFrom + 2))) && !attacked(KingFrom + 1) &&
+        !attacked(KingFrom + 2)) {
+        list.push(Move(KingFrom, KingFrom + 2, Move::Castling));
+    }
+    if ((rights & Long) && !(occupied & (bit(KingFrom - 1) | bit(KingFrom - 2) | bit(KingFrom - 3))) &&
+        !attacked(KingFrom - 1) && !attacked(KingFrom - 2)) {
+        list.push(Move(KingFrom, KingFrom - 2, Move::Castling));
+    }
+}
+
+template <Color Us> void generate(const Position& pos, GenType type, MoveList& list) {
+    constexpr Color Them = Us == White ? Black : White;
+    int ksq = pos.kingSquare(Us);
+    Bitboard checkers = pos.checkers();
+    Bitboard occupied = pos.pieces();
+
+    Bitboard kinds = type == GenType::Captures ? pos.pieces(Them)
+                   : type == GenType::Quiets   ? ~occupied
+                                               : ~pos.pieces(Us);
+
+    // Double check: only the king can move
+    if (!moreThanOne(checkers)) {
+        Bitboard checkMask = checkers ? between(ksq, lsb(checkers)) | checkers : ~Bitboard(0);
+        generatePawnMoves<Us>(pos, type, checkMask, list);
+
+        Bitboard targets = kinds & checkMask;
+        for (PieceType pt : {Knight, Bishop, Rook, Queen}) {
+            Bitboard pieces = pos.pieces(Us, pt);
+            while (pieces) {
+                int from = popLsb(pieces);
+                Bitboard to = attacksOf(pt, from, occupied) & targets;
+                while (to) list.push(Move(from, popLsb(to)));
+            }
+        }
+    }
+
+    Bitboard to = kingAttacks(ksq) & kinds;
+    while (to) list.push(Move(ksq, popLsb(to)));
+
+    if (!checkers && type != GenType::Captures) generateCastling<Us>(pos, list);
+}
+
+} // namespace
+
+void generatePseudoLegal(const Position& pos, GenType type, MoveList& list) {
+    if (pos.sideToMove() == White) generate<White>(pos, type, list);
+    else generate<Black>(pos, type, list);
+}
+
+void generateLegal(const Position& pos, MoveList& list) {
+    int start = list.size;
+    generatePseudoLegal(pos, GenType::All, list);
+
+    // Only pinned pieces, king moves and en passant can be illegal here
+    Bitboard risky = pos.pinned() | pos.pieces(pos.sideToMove(), King);
+    Move* out = list.moves + start;
+    for (int i = start; i < list.size; i++) {
+        Move m = list.moves[i];
+        if (((risky & bit(m.from())) || m.kind() == Move::EnPassant) && !pos.isLegal(m)) continue;
+        *out++ = m;
+    }
+    list.size = static_cast<int>(out - list.moves);
+}
+
+} // namespace chess
+} // namespace aegis
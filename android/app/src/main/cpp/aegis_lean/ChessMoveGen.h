@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ChessPosition.h"
+
+namespace aegis {
+namespace chess {
+
+enum class GenType {
+    Captures, // captures and queen promotions (quiescence)
+    Quiets,   // everything else, including castling and under-promotions
+    All       // both; check evasions only when in check
+};
+
+/**
+ * generatePseudoLegal
+ * Appends pseudo-legal moves: pieces move by their rules, but a move may
+ * still leave the own king attacked (pinned piece, king stepping into an
+ * attack, en passant discovery). In check, only king moves and moves that
+ * capture or block a single checker are produced. Castling is only
+ * generated when its path is empty and not attacked.
+ * Filter with Position::isLegal.
+ */
+void generatePseudoLegal(const Position& pos, GenType type, MoveList& list);
+
+// Appends the legal moves
+void generateLegal(const Position& pos, MoveList& list);
+
+} // namespace chess
+} // namespace aegis
@@ -0,0 +1,359 @@
+#include "ChessNnue.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AEGIS_NNUE_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#define AEGIS_NNUE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace aegis {
+namespace chess {
+
+static_assert(std::endian::native == std::endian::little, "network files are mapped in place");
+
+namespace {
+
+constexpr char kMagic[8] = {'A', 'E', 'G', 'I', 'S', 'N', 'N', '1'};
+constexpr size_t kHeaderBytes = 16;
+constexpr int kActivationMax = 127; // clamp, and the int8 activation scale
+constexpr int kOutputWeightScale = 64;
+
+int featureIndex(Color perspective, Piece piece, int sq) {
+    if (perspective == Black) sq ^= 56;
+    return (colorOf(piece) == perspective ? 0 : 384) + typeOf(piece) * 64 + sq;
+}
+
+// ==================== KERNELS ====================
+//
+// update: dst = src + sum(add rows) - sum(sub rows), n int16 values
+// forward: sum of clamp(us[i]) * w[i] + clamp(them[i]) * w[n + i]
+
+constexpr int kMaxRows = 2;
+
+struct Kernels {
+    const char* name;
+    void (*update)(int16_t* dst, const int16_t* src, const int16_t* const* add, int addCount,
+                   const int16_t* const* sub, int subCount, int n);
+    int32_t (*forward)(const int16_t* us, const int16_t* them, const int8_t* weights, int n);
+};
+
+void updateScalar(int16_t* dst, const int16_t* src, const int16_t* const* add, int addCount,
+                  const int16_t* const* sub, int subCount, int n) {
+    for (int i = 0; i < n; i++) {
+        int v = src[i];
+        for (int k = 0; k < addCount; k++) v += add[k][i];
+        for (int k = 0; k < subCount; k++) v -= sub[k][i];
+        dst[i] = static_cast<int16_t>(v);
+    }
+}
+
+int32_t forwardScalar(const int16_t* us, const int16_t* them, const int8_t* weights, int n) {
+    int32_t sum = 0;
+    for (int i = 0; i < n; i++) {
+        sum += std::clamp<int>(us[i], 0, kActivationMax) * weights[i];
+        sum += std::clamp<int>(them[i], 0, kActivationMax) * weights[n + i];
+    }
+    return sum;
+}
+
+#ifdef AEGIS_NNUE_X86
+__attribute__((target("avx2"))) void updateAvx2(int16_t* dst, const int16_t* src, const int16_t* const* add,
+                                                int addCount, const int16_t* const* sub, int subCount, int n) {
+    for (int i = 0; i < n; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        for (int k = 0; k < addCount; k++) {
+            v = _mm256_add_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(add[k] + i)));
+        }
+        for (int k = 0; k < subCount; k++) {
+            v = _mm256_sub_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sub[k] + i)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+    }
+}
+
+// 32 activations per step: clamp, pack to uint8, then maddubs against the
+// int8 weights (127 * 128 * 2 fits the int16 pair sums)
+__attribute__((target("avx2"))) __m256i dotAvx2(const int16_t* acc, const int8_t* weights, int n, __m256i sum) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi16(kActivationMax);
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (int i = 0; i < n; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i + 16));
+        a = _mm256_min_epi16(_mm256_max_epi16(a, zero), max);
+        b = _mm256_min_epi16(_mm256_max_epi16(b, zero), max);
+        // packus interleaves 128-bit lanes; restore element order
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(packed, w), ones));
+    }
+    return sum;
+}
+
+__attribute__((target("avx2"))) int32_t forwardAvx2(const int16_t* us, const int16_t* them, const int8_t* weights,
+                                                    int n) {
+    __m256i sum = dotAvx2(us, weights, n, _mm256_setzero_si256());
+    sum = dotAvx2(them, weights + n, n, sum);
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+}
+#endif
+
+#ifdef AEGIS_NNUE_NEON
+void updateNeon(int16_t* dst, const int16_t* src, const int16_t* const* add, int addCount,
+                const int16_t* const* sub, int subCount, int n) {
+    for (int i = 0; i < n; i += 8) {
+        int16x8_t v = vld1q_s16(src + i);
+        for (int k = 0; k < addCount; k++) v = vaddq_s16(v, vld1q_s16(add[k] + i));
+        for (int k = 0; k < subCount; k++) v = vsubq_s16(v, vld1q_s16(sub[k] + i));
+        vst1q_s16(dst + i, v);
+    }
+}
+
+int32x4_t dotNeon(const int16_t* acc, const int8_t* weights, int n, int32x4_t sum) {
+    const int16x8_t zero = vdupq_n_s16(0);
+    const int16x8_t max = vdupq_n_s16(kActivationMax);
+    for (int i = 0; i < n; i += 16) {
+        int16x8_t a = vminq_s16(vmaxq_s16(vld1q_s16(acc + i), zero), max);
+        int16x8_t b = vminq_s16(vmaxq_s16(vld1q_s16(acc + i + 8), zero), max);
+        int8x16_t w = vld1q_s8(weights + i);
+        sum = vpadalq_s16(sum, vmull_s8(vmovn_s16(a), vget_low_s8(w)));
+        sum = vpadalq_s16(sum, vmull_s8(vmovn_s16(b), vget_high_s8(w)));
+    }
+    return sum;
+}
+
+int32_t forwardNeon(const int16_t* us, const int16_t* them, const int8_t* weights, int n) {
+    int32x4_t sum = dotNeon(us, weights, n, vdupq_n_s32(0));
+    sum = dotNeon(them, weights + n, n, sum);
+    int32x2_t half = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+    return vget_lane_s32(vpadd_s32(half, half), 0);
+}
+#endif
+
+constexpr Kernels kScalar{"scalar", updateScalar, forwardScalar};
+#ifdef AEGIS_NNUE_X86
+constexpr Kernels kAvx2{"avx2", updateAvx2, forwardAvx2};
+#endif
+#ifdef AEGIS_NNUE_NEON
+constexpr Kernels kNeon{"neon", updateNeon, forwardNeon};
+#endif
+
+// Kernels this build can run on this CPU, best first
+std::vector<const Kernels*> availableKernels() {
+    std::vector<const Kernels*> out;
+#ifdef AEGIS_NNUE_X86
+    if (__builtin_cpu_supports("avx2")) out.push_back(&kAvx2);
+#endif
+#ifdef AEGIS_NNUE_NEON
+    out.push_back(&kNeon);
+#endif
+    out.push_back(&kScalar);
+    return out;
+}
+
+std::atomic<const Kernels*>& selectedKernels() {
+    static std::atomic<const Kernels*> selected{availableKernels().front()};
+    return selected;
+}
+
+const Kernels& kernels() {
+    return *selectedKernels().load(std::memory_order_relaxed);
+}
+
+// ==================== NETWORK FILES ====================
+
+std::mutex g_networkMutex;
+std::shared_ptr<const Network> g_network;
+
+bool fail(std::string* error, const char* reason) {
+    if (error) *error = reason;
+    return false;
+}
+
+} // namespace
+
+Network::~Network() {
+    if (m_mapped) ::munmap(const_cast<uint8_t*>(m_mapped), m_mappedSize);
+}
+
+bool Network::parse(const uint8_t* data, size_t size, std::string* error) {
+    if (size < kHeaderBytes || std::memcmp(data, kMagic, sizeof(kMagic)) != 0) return fail(error, "not a network file");
+    uint32_t hidden;
+    int32_t scale;
+    std::memcpy(&hidden, data + 8, 4);
+    std::memcpy(&scale, data + 12, 4);
+    if (hidden == 0 || hidden % 32 != 0 || hidden > kMaxHidden) return fail(error, "unsupported hidden size");
+
+    size_t expected = kHeaderBytes + hidden * sizeof(int16_t) * (1 + kInputs) + 2 * hidden + sizeof(int32_t);
+    if (size != expected) return fail(error, "size does not match the header");
+
+    // Rows are read with unaligned loads; int16 alignment is all we need
+    if (reinterpret_cast<uintptr_t>(data) % alignof(int16_t) != 0) return fail(error, "misaligned buffer");
+    m_hidden = static_cast<int>(hidden);
+    m_scale = scale;
+    m_featureBias = reinterpret_cast<const int16_t*>(data + kHeaderBytes);
+    m_featureWeights = m_featureBias + hidden;
+    m_outputWeights = reinterpret_cast<const int8_t*>(m_featureWeights + static_cast<size_t>(kInputs) * hidden);
+    std::memcpy(&m_outputBias, m_outputWeights + 2 * hidden, sizeof(int32_t));
+    return true;
+}
+
+std::shared_ptr<const Network> Network::load(const std::string& path, std::string* error) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fail(error, "cannot open file");
+        return nullptr;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        fail(error, "cannot stat file");
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        fail(error, "mmap failed");
+        return nullptr;
+    }
+    // Every evaluation touches the weights at random; fault them in now
+    ::madvise(p, size, MADV_WILLNEED);
+
+    std::shared_ptr<Network> network(new Network());
+    network->m_mapped = static_cast<const uint8_t*>(p);
+    network->m_mappedSize = size;
+    if (!network->parse(network->m_mapped, size, error)) return nullptr;
+    return network;
+}
+
+std::shared_ptr<const Network> Network::fromBytes(std::vector<uint8_t> bytes, std::string* error) {
+    std::shared_ptr<Network> network(new Network());
+    network->m_owned = std::move(bytes);
+    if (!network->parse(network->m_owned.data(), network->m_owned.size(), error)) return nullptr;
+    return network;
+}
+
+std::shared_ptr<const Network> currentNetwork() {
+    std::lock_guard<std::mutex> lock(g_networkMutex);
+    return g_network;
+}
+
+void setCurrentNetwork(std::shared_ptr<const Network> network) {
+    std::lock_guard<std::mutex> lock(g_networkMutex);
+    g_network = std::move(network);
+}
+
+const char* nnueKernelName() {
+    return kernels().name;
+}
+
+std::vector<std::string> nnueKernelNames() {
+    std::vector<std::string> names;
+    for (const Kernels* k : availableKernels()) names.push_back(k->name);
+    return names;
+}
+
+bool setNnueKernel(const std::string& name) {
+    for (const Kernels* k : availableKernels()) {
+        if (name == k->name) {
+            selectedKernels().store(k, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ==================== ACCUMULATORS ====================
+
+NnueAccumulators::NnueAccumulators(std::shared_ptr<const Network> network, int maxPly)
+    : m_network(std::move(network)) {
+    m_stack.resize(static_cast<size_t>(maxPly + 1) * 2 * m_network->hidden());
+}
+
+void NnueAccumulators::refresh(const Position& pos) {
+    m_top = 0;
+    const Network& net = *m_network;
+    int n = net.hidden();
+    for (Color perspective : {White, Black}) {
+        // One pass over the accumulator for every piece on the board
+        const int16_t* rows[32];
+        int count = 0;
+        Bitboard occupied = pos.pieces();
+        while (occupied && count < 32) {
+            int sq = popLsb(occupied);
+            rows[count++] = net.featureWeights(featureIndex(perspective, pos.pieceOn(sq), sq));
+        }
+        kernels().update(slot(0, perspective), net.featureBias(), rows, count, nullptr, 0, n);
+    }
+}
+
+void NnueAccumulators::push(const Position& pos, Move m) {
+    Color us = pos.sideToMove();
+    int from = m.from(), to = m.to();
+    Piece piece = pos.pieceOn(from);
+
+    // Features leaving and entering the board, as (piece, square)
+    Piece addPiece[kMaxRows], subPiece[kMaxRows];
+    int addSq[kMaxRows], subSq[kMaxRows];
+    int addCount = 0, subCount = 0;
+    if (m.kind() == Move::Castling) {
+        bool kingSide = to > from;
+        Piece rook = makePiece(us, Rook);
+        subPiece[subCount] = piece, subSq[subCount++] = from;
+        subPiece[subCount] = rook, subSq[subCount++] = kingSide ? from + 3 : from - 4;
+        addPiece[addCount] = piece, addSq[addCount++] = to;
+        addPiece[addCount] = rook, addSq[addCount++] = kingSide ? from + 1 : from - 1;
+    } else {
+        subPiece[subCount] = piece, subSq[subCount++] = from;
+        addPiece[addCount] = m.kind() == Move::Promotion ? makePiece(us, m.promotion()) : piece;
+        addSq[addCount++] = to;
+        if (m.kind() == Move::EnPassant) {
+            subPiece[subCount] = makePiece(~us, Pawn), subSq[subCount++] = us == White ? to - 8 : to + 8;
+        } else if (pos.pieceOn(to) != kNoPiece) {
+            subPiece[subCount] = pos.pieceOn(to), subSq[subCount++] = to;
+        }
+    }
+
+    const Network& net = *m_network;
+    for (Color perspective : {White, Black}) {
+        const int16_t* add[kMaxRows];
+        const int16_t* sub[kMaxRows];
+        for (int i = 0; i < addCount; i++) add[i] = net.featureWeights(featureIndex(perspective, addPiece[i], addSq[i]));
+        for (int i = 0; i < subCount; i++) sub[i] = net.featureWeights(featureIndex(perspective, subPiece[i], subSq[i]));
+        kernels().update(slot(m_top + 1, perspective), slot(m_top, perspective), add, addCount, sub, subCount,
+                         net.hidden());
+    }
+    m_top++;
+}
+
+void NnueAccumulators::pushNull() {
+    size_t pair = 2 * static_cast<size_t>(m_network->hidden());
+    std::memcpy(slot(m_top + 1, White), slot(m_top, White), pair * sizeof(int16_t));
+    m_top++;
+}
+
+int NnueAccumulators::evaluate(Color side) const {
+    const Network& net = *m_network;
+    int32_t dot = kernels().forward(slot(m_top, side), slot(m_top, ~side), net.outputWeights(), net.hidden());
+    int64_t scaled = (static_cast<int64_t>(dot) + net.outputBias()) * net.scale() / (kActivationMax * kOutputWeightScale);
+    return static_cast<int>(scaled);
+}
+
+} // namespace chess
+} // namespace aegis
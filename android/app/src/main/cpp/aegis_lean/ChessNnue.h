@@ -0,0 +1,125 @@
+#pragma once
+
+#include "ChessPosition.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aegis {
+namespace chess {
+
+/**
+ * Network
+ * Weights of a 768 -> N x 2 -> 1 perspective network. Input features are
+ * (piece colour relative to the perspective, piece type, square), with
+ * Black's squares flipped vertically; each perspective sums the feature
+ * rows of every piece into an int16 accumulator of N values. The output
+ * clamps both accumulators to [0, 127], side to move first, and takes an
+ * int8 dot product with the output weights:
+ *
+ *   eval = (dot + outputBias) * scale / (127 * 64)
+ *
+ * File format (little-endian), N a multiple of 32 up to 1024:
+ *   char     magic[8] = "AEGISNN1"
+ *   uint32   N
+ *   int32    scale
+ *   int16    featureBias[N]
+ *   int16    featureWeights[768][N]
+ *   int8     outputWeights[2 * N]   (side to move half first)
+ *   int32    outputBias
+ *
+ * load() maps the file read-only and uses the weights in place, so the
+ * network costs no heap and pages are shared between processes. Flutter
+ * assets live inside the APK, so AegisService.loadChessNetwork copies a
+ * bundled network to the app's support directory and loads it from there.
+ * No network ships yet; until one does, searches use the PST evaluation.
+ */
+class Network {
+public:
+    static constexpr int kInputs = 768;
+    static constexpr int kMaxHidden = 1024;
+
+    ~Network();
+    Network(const Network&) = delete;
+    Network& operator=(const Network&) = delete;
+
+    // nullptr (and a reason in error) on a missing or malformed file
+    static std::shared_ptr<const Network> load(const std::string& path, std::string* error = nullptr);
+    static std::shared_ptr<const Network> fromBytes(std::vector<uint8_t> bytes, std::string* error = nullptr);
+
+    int hidden() const { return m_hidden; }
+    int scale() const { return m_scale; }
+    const int16_t* featureBias() const { return m_featureBias; }
+    const int16_t* featureWeights(int feature) const { return m_featureWeights + static_cast<size_t>(feature) * m_hidden; }
+    const int8_t* outputWeights() const { return m_outputWeights; }
+    int32_t outputBias() const { return m_outputBias; }
+
+private:
+    Network() = default;
+    bool parse(const uint8_t* data, size_t size, std::string* error);
+
+    // Either a read-only mapping or an owned buffer backs the weights
+    const uint8_t* m_mapped = nullptr;
+    size_t m_mappedSize = 0;
+    std::vector<uint8_t> m_owned;
+
+    int m_hidden = 0;
+    int m_scale = 0;
+    const int16_t* m_featureBias = nullptr;
+    const int16_t* m_featureWeights = nullptr;
+    const int8_t* m_outputWeights = nullptr;
+    int32_t m_outputBias = 0;
+};
+
+// Process-wide network used by new searches; nullptr = PST evaluation
+std::shared_ptr<const Network> currentNetwork();
+void setCurrentNetwork(std::shared_ptr<const Network> network);
+
+// SIMD kernel chosen at runtime for this CPU: "avx2", "neon" or "scalar"
+const char* nnueKernelName();
+// Kernels this build can run on this CPU, best (the default) first
+std::vector<std::string> nnueKernelNames();
+// Switches the kernel for tests and benchmarks, never while searches run;
+// false if it is not available here
+bool setNnueKernel(const std::string& name);
+
+/**
+ * NnueAccumulators
+ * Per search thread stack of accumulator pairs, one per ply. push() is
+ * called before Position::doMove and derives the changed features from
+ * the move (moved piece, capture, promotion, castling rook), so a move
+ * costs two or three row additions per perspective instead of a full
+ * refresh; pop() after undoMove just drops the top.
+ */
+class NnueAccumulators {
+public:
+    explicit NnueAccumulators(std::shared_ptr<const Network> network, int maxPly = 256);
+
+    const Network& network() const { return *m_network; }
+
+    // Rebuilds the bottom of the stack from scratch (search root)
+    void refresh(const Position& pos);
+    void push(const Position& pos, Move m);
+    void pushNull();
+    void pop() { m_top--; }
+
+    // Centipawns from the side to move's point of view
+    int evaluate(Color side) const;
+
+private:
+    int16_t* slot(int index, Color perspective) {
+        return m_stack.data() + (static_cast<size_t>(index) * 2 + perspective) * m_network->hidden();
+    }
+    const int16_t* slot(int index, Color perspective) const {
+        return m_stack.data() + (static_cast<size_t>(index) * 2 + perspective) * m_network->hidden();
+    }
+
+    std::shared_ptr<const Network> m_network;
+    std::vector<int16_t> m_stack;
+    int m_top = 0;
+};
+
+} // namespace chess
+} // namespace aegis
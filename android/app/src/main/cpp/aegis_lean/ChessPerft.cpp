@@ -0,0 +1,194 @@
+#include "ChessPerft.h"
+#include "ChessMoveGen.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace aegis {
+namespace chess {
+
+namespace {
+
+/**
+ * PerftCache
+ * Subtree counts by (key, depth). Entries are two relaxed atomics with the
+ * key stored XORed with the data, so a torn write from another worker
+ * fails verification instead of returning a wrong count.
+ */
+class PerftCache {
+public:
+    explicit PerftCache(size_t mb) {
+        size_t count = 1;
+        while (count * 2 * sizeof(Entry) <= mb * 1024 * 1024) count *= 2;
+        m_entries = std::make_unique<Entry[]>(count);
+        m_mask = count - 1;
+    }
+
+    bool probe(uint64_t key, int depth, uint64_t& nodes) const {
+        const Entry& e = slot(key, depth);
+        uint64_t data = e.data.load(std::memory_order_relaxed);
+        uint64_t check = e.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key || static_cast<int>(data & 0xff) != depth) return false;
+        nodes = data >> 8;
+        return true;
+    }
+
+    void store(uint64_t key, int depth, uint64_t nodes) {
+        Entry& e = slot(key, depth);
+        uint64_t data = (nodes << 8) | static_cast<uint64_t>(depth);
+        e.check.store(key ^ data, std::memory_order_relaxed);
+        e.data.store(data, std::memory_order_relaxed);
+    }
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> data{0};
+    };
+
+    Entry& slot(uint64_t key, int depth) const {
+        return m_entries[(key ^ (static_cast<uint64_t>(depth) * 0x9e3779b97f4a7c15ULL)) & m_mask];
+    }
+
+    std::unique_ptr<Entry[]> m_entries;
+    size_t m_mask = 0;
+};
+
+uint64_t perftNode(Position& pos, int depth, PerftCache* cache) {
+    if (depth <= 0) return 1;
+    uint64_t key = 0, nodes = 0;
+    if (cache && depth > 1) {
+        key = pos.key();
+        if (cache->probe(key, depth, nodes)) return nodes;
+    }
+
+    MoveList list;
+    generateLegal(pos, list);
+    if (depth == 1) return list.size;
+
+    Undo undo;
+    for (Move m : list) {
+        pos.doMove(m, undo);
+        nodes += perftNode(pos, depth - 1, cache);
+        pos.undoMove(m, undo);
+    }
+
+    if (cache) cache->store(key, depth, nodes);
+    return nodes;
+}
+
+struct Task {
+    int root;
+    Move reply; // Move() = the whole root subtree
+};
+
+// Owner pops from the back, thieves take from the front
+struct TaskDeque {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+bool nextTask(std::vector<TaskDeque>& deques, size_t self, Task& out) {
+    {
+        std::lock_guard<std::mutex> lock(deques[self].mutex);
+        if (!deques[self].tasks.empty()) {
+            out = deques[self].tasks.back();
+            deques[self].tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < deques.size(); i++) {
+        TaskDeque& victim = deques[(self + i) % deques.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            out = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    // No task is ever added after start, so empty everywhere means done
+    return false;
+}
+
+} // namespace
+
+uint64_t perft(Position& pos, int depth) {
+    return perftNode(pos, depth, nullptr);
+}
+
+std::vector<DivideEntry> perftDivide(const Position& pos, int depth, const PerftOptions& options) {
+    MoveList roots;
+    generateLegal(pos, roots);
+    std::vector<DivideEntry> result;
+    result.reserve(roots.size);
+    for (Move m : roots) result.push_back(DivideEntry{m, depth <= 1 ? 1u : 0u});
+    if (depth <= 1) return result;
+
+    std::unique_ptr<PerftCache> cache;
+    if (options.hashMb) cache = std::make_unique<PerftCache>(options.hashMb);
+
+    size_t threads = options.threads > 0 ? static_cast<size_t>(options.threads) : std::thread::hardware_concurrency();
+    if (threads <= 1) {
+        Position work = pos;
+        Undo undo;
+        for (auto& entry : result) {
+            work.doMove(entry.move, undo);
+            entry.nodes = perftNode(work, depth - 1, cache.get());
+            work.undoMove(entry.move, undo);
+        }
+        return result;
+    }
+
+    // Two plies of split give a few hundred tasks, enough to balance
+    std::vector<TaskDeque> deques(threads);
+    size_t next = 0;
+    for (int r = 0; r < roots.size; r++) {
+        if (depth < 3) {
+            deques[next++ % threads].tasks.push_back(Task{r, Move()});
+            continue;
+        }
+        Position child = pos;
+        Undo undo;
+        child.doMove(roots.moves[r], undo);
+        MoveList replies;
+        generateLegal(child, replies);
+        for (Move reply : replies) deques[next++ % threads].tasks.push_back(Task{r, reply});
+    }
+
+    std::vector<std::atomic<uint64_t>> counts(roots.size);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            Task task;
+            while (nextTask(deques, t, task)) {
+                Position work = pos;
+                Undo first, second;
+                work.doMove(roots.moves[task.root], first);
+                uint64_t nodes;
+                if (task.reply.isNone()) {
+                    nodes = perftNode(work, depth - 1, cache.get());
+                } else {
+                    work.doMove(task.reply, second);
+                    nodes = perftNode(work, depth - 2, cache.get());
+                }
+                counts[task.root].fetch_add(nodes, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    for (size_t i = 0; i < result.size(); i++) result[i].nodes = counts[i].load();
+    return result;
+}
+
+uint64_t perftParallel(const Position& pos, int depth, const PerftOptions& options) {
+    if (depth <= 0) return 1;
+    uint64_t total = 0;
+    for (const auto& entry : perftDivide(pos, depth, options)) total += entry.nodes;
+    return total;
+}
+
+} // namespace chess
+} // namespace aegis
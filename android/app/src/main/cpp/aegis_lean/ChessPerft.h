@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ChessPosition.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace aegis {
+namespace chess {
+
+struct PerftOptions {
+    int threads = 1;   // workers for the root split (0 = hardware concurrency)
+    size_t hashMb = 0; // shared subtree cache, 0 = off
+};
+
+struct DivideEntry {
+    Move move;
+    uint64_t nodes;
+};
+
+/**
+ * Perft
+ * Counts leaf nodes of the legal move tree, the standard move generator
+ * check: any bug in generation or make/unmake shows up as a count that
+ * differs from the published reference. Depth 1 is counted in bulk from
+ * the legal move list.
+ *
+ * The parallel forms split the tree two plies below the root into tasks
+ * spread over per-worker deques; idle workers steal from the others. With
+ * hashMb set, finished subtrees are cached by Zobrist key and depth in a
+ * lock-free table shared by all workers.
+ */
+uint64_t perft(Position& pos, int depth);
+
+// Per root move counts, in generation order
+std::vector<DivideEntry> perftDivide(const Position& pos, int depth, const PerftOptions& options);
+
+uint64_t perftParallel(const Position& pos, int depth, const PerftOptions& options);
+
+} // namespace chess
+} // namespace aegis
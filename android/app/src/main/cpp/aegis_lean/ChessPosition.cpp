@@ -0,0 +1,469 @@
+#include "ChessPosition.h"
+#include "ChessMoveGen.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace aegis {
+namespace chess {
+
+namespace {
+
+const char kPieceChars[] = " PNBRQKpnbrqk";
+
+// Splits on single spaces; returns the number of fields
+int splitFields(std::string_view text, std::string_view* fields, int max) {
+    int count = 0;
+    size_t pos = 0;
+    while (pos < text.size() && count < max) {
+        while (pos < text.size() && text[pos] == ' ') pos++;
+        if (pos >= text.size()) break;
+        size_t end = text.find(' ', pos);
+        if (end == std::string_view::npos) end = text.size();
+        fields[count++] = text.substr(pos, end - pos);
+        pos = end;
+    }
+    return count;
+}
+
+bool parseNumber(std::string_view text, int& out) {
+    if (text.empty() || text.size() > 6) return false;
+    int value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+    }
+    out = value;
+    return true;
+}
+
+void appendSquare(std::string& out, int sq) {
+    out += static_cast<char>('a' + fileOf(sq));
+    out += static_cast<char>('1' + rankOf(sq));
+}
+
+// Rights lost when a move starts or ends on a square
+constexpr uint8_t castlingLost(int sq) {
+    switch (sq) {
+        case 0: return WhiteOOO;
+        case 4: return WhiteOO | WhiteOOO;
+        case 7: return WhiteOO;
+        case 56: return BlackOOO;
+        case 60: return BlackOO | BlackOOO;
+        case 63: return BlackOO;
+        default: return 0;
+    }
+}
+
+struct ZobristKeys {
+    uint64_t psq[13][64]; // [piece][square], row 0 unused
+    uint64_t castling[16];
+    uint64_t epFile[8];
+    uint64_t side;
+};
+
+constexpr uint64_t splitmix(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Generated at compile time, so the keys are fixed across builds
+constexpr ZobristKeys makeZobrist() {
+    ZobristKeys keys{};
+    uint64_t state = 0x41454749534b4559ULL;
+    for (int p = 1; p < 13; p++) {
+        for (int sq = 0; sq < 64; sq++) keys.psq[p][sq] = splitmix(state);
+    }
+    uint64_t rights[4] = {splitmix(state), splitmix(state), splitmix(state), splitmix(state)};
+    for (int mask = 0; mask < 16; mask++) {
+        for (int b = 0; b < 4; b++) {
+            if (mask & (1 << b)) keys.castling[mask] ^= rights[b];
+        }
+    }
+    for (int f = 0; f < 8; f++) keys.epFile[f] = splitmix(state);
+    keys.side = splitmix(state);
+    return keys;
+}
+
+constexpr ZobristKeys kZobrist = makeZobrist();
+
+} // namespace
+
+Position::Position() {
+    clear();
+    setFen(kStartFen);
+}
+
+void Position::clear() {
+    std::memset(m_board, 0, sizeof(m_board));
+    std::memset(m_byType, 0, sizeof(m_byType));
+    std::memset(m_byColor, 0, sizeof(m_byColor));
+    m_side = White;
+    m_castling = 0;
+    m_ep = kNoSquare;
+    m_halfmove = 0;
+    m_fullmove = 1;
+    m_key = 0;
+    m_checkers = 0;
+    m_pinned = 0;
+}
+
+void Position::putPiece(Piece p, int sq) {
+    m_board[sq] = p;
+    m_byType[typeOf(p)] |= bit(sq);
+    m_byColor[colorOf(p)] |= bit(sq);
+}
+
+void Position::removePiece(int sq) {
+    Piece p = m_board[sq];
+    m_byType[typeOf(p)] ^= bit(sq);
+    m_byColor[colorOf(p)] ^= bit(sq);
+    m_board[sq] = kNoPiece;
+}
+
+void Position::movePiece(int from, int to) {
+    Piece p = m_board[from];
+    Bitboard fromTo = bit(from) | bit(to);
+    m_byType[typeOf(p)] ^= fromTo;
+    m_byColor[colorOf(p)] ^= fromTo;
+    m_board[from] = kNoPiece;
+    m_board[to] = p;
+}
+
+bool Position::setFen(std::string_view fen) {
+    initAttacks();
+    std::string_view fields[6];
+    int count = splitFields(fen, fields, 6);
+    if (count < 4) return false;
+
+    Position next = *this;
+    next.clear();
+
+    // 1. Placement, rank 8 first
+    int file = 0, rank = 7;
+    for (char c : fields[0]) {
+        if (c == '/') {
+            if (file != 8 || rank == 0) return false;
+            file = 0;
+            rank--;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+            if (file > 8) return false;
+        } else {
+            const char* found = std::strchr(kPieceChars + 1, c);
+            if (!found || c == '\0' || file > 7) return false;
+            Piece p = static_cast<Piece>(found - kPieceChars);
+            if (typeOf(p) == Pawn && (rank == 0 || rank == 7)) return false;
+            next.putPiece(p, makeSquare(file, rank));
+            file++;
+        }
+    }
+    if (rank != 0 || file != 8) return false;
+    if (popcount(next.pieces(White, King)) != 1 || popcount(next.pieces(Black, King)) != 1) return false;
+
+    // 2. Side to move
+    if (fields[1] == "w") next.m_side = White;
+    else if (fields[1] == "b") next.m_side = Black;
+    else return false;
+
+    // 3. Castling; rights without king and rook at home are dropped
+    if (fields[2] != "-") {
+        for (char c : fields[2]) {
+            switch (c) {
+                case 'K': next.m_castling |= WhiteOO; break;
+                case 'Q': next.m_castling |= WhiteOOO; break;
+                case 'k': next.m_castling |= BlackOO; break;
+                case 'q': next.m_castling |= BlackOOO; break;
+                default: return false;
+            }
+        }
+    }
+    const Piece wk = makePiece(White, King), bk = makePiece(Black, King);
+    const Piece wr = makePiece(White, Rook), br = makePiece(Black, Rook);
+    if (next.m_board[4] != wk || next.m_board[7] != wr) next.m_castling &= ~WhiteOO;
+    if (next.m_board[4] != wk || next.m_board[0] != wr) next.m_castling &= ~WhiteOOO;
+    if (next.m_board[60] != bk || next.m_board[63] != br) next.m_castling &= ~BlackOO;
+    if (next.m_board[60] != bk || next.m_board[56] != br) next.m_castling &= ~BlackOOO;
+
+    // 4. En passant; kept only when a pawn could actually capture
+    if (fields[3] != "-") {
+        if (fields[3].size() != 2 || fields[3][0] < 'a' || fields[3][0] > 'h') return false;
+        int epRank = next.m_side == White ? 5 : 2;
+        if (fields[3][1] != '1' + epRank) return false;
+        int ep = makeSquare(fields[3][0] - 'a', epRank);
+        Color them = ~next.m_side;
+        int pushed = next.m_side == White ? ep - 8 : ep + 8;
+        if (next.m_board[pushed] == makePiece(them, Pawn) && !(next.pieces() & bit(ep)) &&
+            (pawnAttacks(them, ep) & next.pieces(next.m_side, Pawn))) {
+            next.m_ep = ep;
+        }
+    }
+
+    // 5. Counters (optional)
+    if (count > 4 && !parseNumber(fields[4], next.m_halfmove)) return false;
+    if (count > 5 && (!parseNumber(fields[5], next.m_fullmove) || next.m_fullmove < 1)) return false;
+
+    // The side that just moved cannot be in check
+    Color them = ~next.m_side;
+    if (next.attackersTo(next.kingSquare(them)) & next.pieces(next.m_side)) return false;
+
+    next.m_key = next.computeKey();
+    next.updateCheckInfo();
+    *this = next;
+    return true;
+}
+
+bool Position::setPieces(const Piece* pieces, const int* squares, int count, Color side) {
+    initAttacks();
+    Position next = *this;
+    next.clear();
+    for (int i = 0; i < count; i++) {
+        int sq = squares[i];
+        if (sq < 0 || sq >= 64 || next.m_board[sq] != kNoPiece) return false;
+        if (typeOf(pieces[i]) == Pawn && (rankOf(sq) == 0 || rankOf(sq) == 7)) return false;
+        next.putPiece(pieces[i], sq);
+    }
+    if (popcount(next.pieces(White, King)) != 1 || popcount(next.pieces(Black, King)) != 1) return false;
+    next.m_side = side;
+    if (next.attackersTo(next.kingSquare(~side)) & next.pieces(side)) return false;
+
+    next.m_key = next.computeKey();
+    next.updateCheckInfo();
+    *this = next;
+    return true;
+}
+
+std::string Position::fen() const {
+    std::string out;
+    out.reserve(90);
+    for (int rank = 7; rank >= 0; rank--) {
+        int empty = 0;
+        for (int file = 0; file < 8; file++) {
+            Piece p = m_board[makeSquare(file, rank)];
+            if (p == kNoPiece) {
+                empty++;
+                continue;
+            }
+            if (empty) out += static_cast<char>('0' + empty);
+            empty = 0;
+            out += kPieceChars[p];
+        }
+        if (empty) out += static_cast<char>('0' + empty);
+        if (rank) out += '/';
+    }
+    out += m_side == White ? " w " : " b ";
+    if (!m_castling) out += '-';
+    if (m_castling & WhiteOO) out += 'K';
+    if (m_castling & WhiteOOO) out += 'Q';
+    if (m_castling & BlackOO) out += 'k';
+    if (m_castling & BlackOOO) out += 'q';
+    out += ' ';
+    if (m_ep == kNoSquare) out += '-';
+    else appendSquare(out, m_ep);
+    out += ' ';
+    out += std::to_string(m_halfmove);
+    out += ' ';
+    out += std::to_string(m_fullmove);
+    return out;
+}
+
+Bitboard Position::attackersTo(int sq, Bitboard occupied) const {
+    return (pawnAttacks(Black, sq) & pieces(White, Pawn)) | (pawnAttacks(White, sq) & pieces(Black, Pawn)) |
+           (knightAttacks(sq) & m_byType[Knight]) | (kingAttacks(sq) & m_byType[King]) |
+           (rookAttacks(sq, occupied) & pieces(Rook, Queen)) | (bishopAttacks(sq, occupied) & pieces(Bishop, Queen));
+}
+
+void Position::updateCheckInfo() {
+    Color us = m_side, them = ~us;
+    int ksq = kingSquare(us);
+    m_checkers = attackersTo(ksq) & pieces(them);
+
+    m_pinned = 0;
+    Bitboard snipers = ((rookAttacks(ksq, 0) & pieces(Rook, Queen)) | (bishopAttacks(ksq, 0) & pieces(Bishop, Queen))) &
+                       pieces(them);
+    Bitboard occupied = pieces();
+    while (snipers) {
+        int s = popLsb(snipers);
+        Bitboard blockers = between(ksq, s) & occupied;
+        if (blockers && !moreThanOne(blockers)) m_pinned |= blockers & pieces(us);
+    }
+}
+
+bool Position::isLegal(Move m) const {
+    Color us = m_side, them = ~us;
+    int from = m.from(), to = m.to();
+    int ksq = kingSquare(us);
+
+    if (m.kind() == Move::EnPassant) {
+        // Both pawns leave their squares, which can open a rank or diagonal
+        int captured = us == White ? to - 8 : to + 8;
+        Bitboard occupied = (pieces() ^ bit(from) ^ bit(captured)) | bit(to);
+        return !(rookAttacks(ksq, occupied) & pieces(them) & pieces(Rook, Queen)) &&
+               !(bishopAttacks(ksq, occupied) & pieces(them) & pieces(Bishop, Queen));
+    }
+    if (from == ksq) {
+        // Castling paths are checked by the generator
+        if (m.kind() == Move::Castling) return true;
+        return !(attackersTo(to, pieces() ^ bit(from)) & pieces(them));
+    }
+    return !(m_pinned & bit(from)) || aligned(from, to, ksq);
+}
+
+void Position::doMove(Move m, Undo& undo) {
+    undo.key = m_key;
+    undo.checkers = m_checkers;
+    undo.pinned = m_pinned;
+    undo.ep = m_ep;
+    undo.halfmove = m_halfmove;
+    undo.castling = m_castling;
+
+    Color us = m_side, them = ~us;
+    int from = m.from(), to = m.to();
+    Piece piece = m_board[from];
+    Piece captured = m.kind() == Move::EnPassant ? makePiece(them, Pawn) : m_board[to];
+    undo.captured = captured;
+
+    uint64_t key = m_key ^ kZobrist.side;
+    if (m_ep != kNoSquare) key ^= kZobrist.epFile[fileOf(m_ep)];
+    m_halfmove++;
+    m_ep = kNoSquare;
+
+    if (m.kind() == Move::Castling) {
+        bool kingSide = to > from;
+        int rookFrom = kingSide ? from + 3 : from - 4;
+        int rookTo = kingSide ? from + 1 : from - 1;
+        Piece rook = m_board[rookFrom];
+        movePiece(from, to);
+        movePiece(rookFrom, rookTo);
+        key ^= kZobrist.psq[piece][from] ^ kZobrist.psq[piece][to];
+        key ^= kZobrist.psq[rook][rookFrom] ^ kZobrist.psq[rook][rookTo];
+    } else {
+        if (captured != kNoPiece) {
+            int capturedSq = m.kind() == Move::EnPassant ? (us == White ? to - 8 : to + 8) : to;
+            removePiece(capturedSq);
+            key ^= kZobrist.psq[captured][capturedSq];
+            m_halfmove = 0;
+        }
+        movePiece(from, to);
+        key ^= kZobrist.psq[piece][from] ^ kZobrist.psq[piece][to];
+        if (typeOf(piece) == Pawn) {
+            m_halfmove = 0;
+            if ((from ^ to) == 16) {
+                // Only recorded when an enemy pawn can take, as in setFen
+                int ep = (from + to) / 2;
+                if (pawnAttacks(us, ep) & pieces(them, Pawn)) {
+                    m_ep = ep;
+                    key ^= kZobrist.epFile[fileOf(ep)];
+                }
+            } else if (m.kind() == Move::Promotion) {
+                Piece promoted = makePiece(us, m.promotion());
+                removePiece(to);
+                putPiece(promoted, to);
+                key ^= kZobrist.psq[piece][to] ^ kZobrist.psq[promoted][to];
+            }
+        }
+    }
+
+    uint8_t castling = m_castling & ~(castlingLost(from) | castlingLost(to));
+    key ^= kZobrist.castling[m_castling] ^ kZobrist.castling[castling];
+    m_castling = castling;
+    if (us == Black) m_fullmove++;
+    m_side = them;
+    m_key = key;
+    updateCheckInfo();
+}
+
+void Position::undoMove(Move m, const Undo& undo) {
+    m_side = ~m_side;
+    Color us = m_side;
+    int from = m.from(), to = m.to();
+    if (us == Black) m_fullmove--;
+
+    if (m.kind() == Move::Castling) {
+        bool kingSide = to > from;
+        movePiece(kingSide ? from + 1 : from - 1, kingSide ? from + 3 : from - 4);
+        movePiece(to, from);
+    } else {
+        if (m.kind() == Move::Promotion) {
+            removePiece(to);
+            putPiece(makePiece(us, Pawn), to);
+        }
+        movePiece(to, from);
+        if (undo.captured != kNoPiece) {
+            putPiece(undo.captured, m.kind() == Move::EnPassant ? (us == White ? to - 8 : to + 8) : to);
+        }
+    }
+
+    m_key = undo.key;
+    m_checkers = undo.checkers;
+    m_pinned = undo.pinned;
+    m_ep = undo.ep;
+    m_halfmove = undo.halfmove;
+    m_castling = undo.castling;
+}
+
+void Position::doNullMove(Undo& undo) {
+    undo.key = m_key;
+    undo.checkers = m_checkers;
+    undo.pinned = m_pinned;
+    undo.ep = m_ep;
+    undo.halfmove = m_halfmove;
+    undo.castling = m_castling;
+    undo.captured = kNoPiece;
+
+    m_key ^= kZobrist.side;
+    if (m_ep != kNoSquare) m_key ^= kZobrist.epFile[fileOf(m_ep)];
+    m_ep = kNoSquare;
+    m_halfmove++;
+    m_side = ~m_side;
+    updateCheckInfo();
+}
+
+void Position::undoNullMove(const Undo& undo) {
+    m_side = ~m_side;
+    m_key = undo.key;
+    m_checkers = undo.checkers;
+    m_pinned = undo.pinned;
+    m_ep = undo.ep;
+    m_halfmove = undo.halfmove;
+}
+
+uint64_t Position::computeKey() const {
+    uint64_t key = 0;
+    Bitboard occupied = pieces();
+    while (occupied) {
+        int sq = popLsb(occupied);
+        key ^= kZobrist.psq[m_board[sq]][sq];
+    }
+    key ^= kZobrist.castling[m_castling];
+    if (m_ep != kNoSquare) key ^= kZobrist.epFile[fileOf(m_ep)];
+    if (m_side == Black) key ^= kZobrist.side;
+    return key;
+}
+
+std::string Position::toUci(Move m) {
+    std::string out;
+    appendSquare(out, m.from());
+    appendSquare(out, m.to());
+    if (m.kind() == Move::Promotion) out += "nbrq"[m.promotion() - Knight];
+    return out;
+}
+
+Move Position::parseUci(std::string_view uci) const {
+    if (uci.size() != 4 && uci.size() != 5) return Move();
+    MoveList list;
+    generateLegal(*this, list);
+    for (Move m : list) {
+        std::string text = toUci(m);
+        if (text.size() == uci.size() &&
+            std::equal(text.begin(), text.end(), uci.begin(), [](char a, char b) { return a == std::tolower(b); })) {
+            return m;
+        }
+    }
+    return Move();
+}
+
+} // namespace chess
+} // namespace aegis
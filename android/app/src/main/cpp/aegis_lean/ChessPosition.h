@@ -0,0 +1,107 @@
+#pragma once
+
+#include "ChessAttacks.h"
+#include "ChessTypes.h"
+#include <string>
+#include <string_view>
+
+namespace aegis {
+namespace chess {
+
+// What doMove() overwrites, so undoMove() can restore it
+struct Undo {
+    uint64_t key;
+    Bitboard checkers;
+    Bitboard pinned;
+    int ep;
+    int halfmove;
+    uint8_t castling;
+    Piece captured;
+};
+
+/**
+ * Position
+ * Bitboard board state: one bitboard per piece type and per colour, a
+ * mailbox for piece-on-square lookups, side to move, castling rights, en
+ * passant square and move counters. Check and pin information for the side
+ * to move is kept up to date so legality tests are a few mask operations.
+ */
+class Position {
+public:
+    static constexpr const char* kStartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    Position();
+
+    // Returns false (and leaves the position unchanged) on a malformed FEN.
+    bool setFen(std::string_view fen);
+    std::string fen() const;
+    // Places count pieces (kings included) with no castling rights or en
+    // passant square; false if that isn't a legal position for side
+    bool setPieces(const Piece* pieces, const int* squares, int count, Color side);
+
+    Piece pieceOn(int sq) const { return m_board[sq]; }
+    Bitboard pieces() const { return m_byColor[White] | m_byColor[Black]; }
+    Bitboard pieces(Color c) const { return m_byColor[c]; }
+    Bitboard pieces(PieceType t) const { return m_byType[t]; }
+    Bitboard pieces(Color c, PieceType t) const { return m_byColor[c] & m_byType[t]; }
+    Bitboard pieces(PieceType a, PieceType b) const { return m_byType[a] | m_byType[b]; }
+    int kingSquare(Color c) const { return lsb(pieces(c, King)); }
+
+    Color sideToMove() const { return m_side; }
+    uint8_t castlingRights() const { return m_castling; }
+    int epSquare() const { return m_ep; }
+    int halfmoveClock() const { return m_halfmove; }
+    int fullmoveNumber() const { return m_fullmove; }
+
+    // Pieces of both colours attacking sq, given an occupancy
+    Bitboard attackersTo(int sq, Bitboard occupied) const;
+    Bitboard attackersTo(int sq) const { return attackersTo(sq, pieces()); }
+
+    Bitboard checkers() const { return m_checkers; }
+    bool inCheck() const { return m_checkers != 0; }
+    // Pieces of the side to move that shield its king from a slider
+    Bitboard pinned() const { return m_pinned; }
+
+    // Whether a pseudo-legal move leaves the own king safe
+    bool isLegal(Move m) const;
+
+    // Plays a legal move; undoMove(m, undo) with the same record reverts it
+    void doMove(Move m, Undo& undo);
+    void undoMove(Move m, const Undo& undo);
+    // Passes the turn (null-move pruning); never called in check
+    void doNullMove(Undo& undo);
+    void undoNullMove(const Undo& undo);
+
+    // Zobrist key, updated incrementally by doMove
+    uint64_t key() const { return m_key; }
+    // Same key computed from scratch (setFen, consistency checks)
+    uint64_t computeKey() const;
+
+    // Long algebraic ("e2e4", "e7e8q"); castling as the king's move
+    static std::string toUci(Move m);
+    // Matches against the legal moves; Move() if illegal or malformed
+    Move parseUci(std::string_view uci) const;
+
+private:
+    void clear();
+    void putPiece(Piece p, int sq);
+    void removePiece(int sq);
+    void movePiece(int from, int to);
+    void updateCheckInfo();
+
+    Piece m_board[64];
+    Bitboard m_byType[6];
+    Bitboard m_byColor[2];
+    Color m_side = White;
+    uint8_t m_castling = 0;
+    int m_ep = kNoSquare;
+    int m_halfmove = 0;
+    int m_fullmove = 1;
+
+    uint64_t m_key = 0;
+    Bitboard m_checkers = 0;
+    Bitboard m_pinned = 0;
+};
+
+} // namespace chess
+} // namespace aegis
@@ -0,0 +1,689 @@
+#include "ChessSearch.h"
+#include "ChessEval.h"
+#include "ChessGame.h"
+#include "ChessMoveGen.h"
+#include "ChessNnue.h"
+#include "ChessTablebase.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+namespace aegis {
+namespace chess {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kHistoryMax = 16384;
+constexpr uint64_t kPollInterval = 1024; // nodes between clock/stop checks
+constexpr int kAspirationWindow = 25;
+constexpr int64_t kMoveOverheadMs = 30;  // FFI and UI latency per move
+
+// Late move reductions by [depth][move number]
+struct Reductions {
+    int8_t table[64][64];
+
+    Reductions() {
+        for (int d = 0; d < 64; d++) {
+            for (int m = 0; m < 64; m++) {
+                table[d][m] = d && m ? static_cast<int8_t>(0.75 + std::log(d) * std::log(m) / 2.25) : 0;
+            }
+        }
+    }
+};
+
+const Reductions kReductions;
+
+// Lazy SMP depth skipping: helper i skips depth d when
+// ((d + kSkipPhase[j]) / kSkipSize[j]) is odd, j = (i - 1) % 20
+constexpr int kSkipSize[20] = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+constexpr int kSkipPhase[20] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+// Mate scores are stored relative to the node, not the root
+int scoreToTT(int score, int ply) {
+    if (score >= kMateBound) return score + ply;
+    if (score <= -kMateBound) return score - ply;
+    return score;
+}
+
+int scoreFromTT(int score, int ply) {
+    if (score >= kMateBound) return score - ply;
+    if (score <= -kMateBound) return score + ply;
+    return score;
+}
+
+bool isCapture(const Position& pos, Move m) {
+    return m.kind() == Move::EnPassant || pos.pieceOn(m.to()) != kNoPiece;
+}
+
+bool hasNonPawnMaterial(const Position& pos, Color c) {
+    return (pos.pieces(c) ^ pos.pieces(c, Pawn) ^ pos.pieces(c, King)) != 0;
+}
+
+// Static exchange evaluation: whether the capture sequence on m's target
+// square nets at least threshold for the side to move
+bool seeGe(const Position& pos, Move m, int threshold) {
+    if (m.kind() != Move::Normal) return threshold <= 0;
+
+    int from = m.from(), to = m.to();
+    int swap = (pos.pieceOn(to) != kNoPiece ? kPieceValue[typeOf(pos.pieceOn(to))] : 0) - threshold;
+    if (swap < 0) return false;
+    swap = kPieceValue[typeOf(pos.pieceOn(from))] - swap;
+    if (swap <= 0) return true;
+
+    Bitboard occupied = pos.pieces() ^ bit(from) ^ bit(to);
+    Bitboard attackers = pos.attackersTo(to, occupied);
+    Bitboard diagonal = pos.pieces(Bishop, Queen);
+    Bitboard straight = pos.pieces(Rook, Queen);
+    Color side = pos.sideToMove();
+    int result = 1;
+
+    while (true) {
+        side = ~side;
+        attackers &= occupied;
+        Bitboard ours = attackers & pos.pieces(side);
+        if (!ours) break;
+        result ^= 1;
+
+        // Cheapest attacker recaptures; sliders behind it join in
+        PieceType type = Pawn;
+        while (!(ours & pos.pieces(type))) type = static_cast<PieceType>(type + 1);
+        if (type == King) return (attackers & ~pos.pieces(side)) ? result ^ 1 : result;
+
+        swap = kPieceValue[type] - swap;
+        if (swap < result) break;
+        occupied ^= bit(lsb(ours & pos.pieces(type)));
+        if (type == Pawn || type == Bishop || type == Queen) attackers |= bishopAttacks(to, occupied) & diagonal;
+        if (type == Rook || type == Queen) attackers |= rookAttacks(to, occupied) & straight;
+    }
+    return result != 0;
+}
+
+// Selection sort step: brings the best remaining move to index i
+void pickMove(MoveList& list, int* scores, int i) {
+    int best = i;
+    for (int j = i + 1; j < list.size; j++) {
+        if (scores[j] > scores[best]) best = j;
+    }
+    std::swap(list.moves[i], list.moves[best]);
+    std::swap(scores[i], scores[best]);
+}
+
+} // namespace
+
+struct Search::Worker {
+    Worker(Search& search, int index) : owner(search), tt(search.m_tt), id(index) { clear(); }
+
+    void clear();
+    void prepare(const Position& root, const std::vector<uint64_t>& gameKeys, const SearchLimits& limits,
+                 const std::atomic<bool>& stop, const std::shared_ptr<const Network>& network,
+                 const std::shared_ptr<const Tablebases>& tables);
+    // Iterative deepening; only the main worker reports info
+    void iterate(const InfoCallback* onInfo);
+
+    int64_t elapsedMs() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+    }
+    void poll();
+    bool isDraw() const;
+
+    // Position changes go through these so the NNUE accumulators follow
+    void makeMove(Move m, Undo& undo);
+    void unmakeMove(Move m, const Undo& undo);
+    void makeNullMove(Undo& undo);
+    void unmakeNullMove(const Undo& undo);
+    int staticEvaluation() const { return nnue ? nnue->evaluate(pos.sideToMove()) : evaluate(pos); }
+    // Exact score from the endgame tables, when they cover pos
+    bool probeTablebase(int ply, int& score);
+
+    int search(int alpha, int beta, int depth, int ply, bool nullAllowed);
+    int qsearch(int alpha, int beta, int ply);
+
+    void scoreMoves(const MoveList& list, int* scores, Move ttMove, int ply) const;
+    void updatePv(int ply, Move m);
+    void updateQuietStats(Move best, const Move* quiets, int count, int depth, int ply);
+
+    Search& owner;
+    TranspositionTable& tt;
+    int id; // 0 = main thread
+    Position pos;
+    std::unique_ptr<NnueAccumulators> nnue; // null = PST evaluation
+    std::shared_ptr<const Tablebases> tablebases;
+    std::vector<uint64_t> keys; // game history plus the current search path
+    const std::atomic<bool>* stopFlag = nullptr;
+    SearchLimits limits;
+    Clock::time_point start;
+    int64_t softMs = 0; // don't start another iteration past this
+    int64_t hardMs = 0; // abort the running iteration
+    uint64_t nodes = 0;
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;
+    uint64_t tbHits = 0;
+    std::atomic<uint64_t> publishedNodes{0}; // nodes as of the last poll, for the main thread
+    int rootDepth = 0;
+    bool stopped = false;
+
+    // Last completed iteration
+    int completedDepth = 0;
+    int bestScore = 0;
+    Move bestMove;
+    Move ponderMove;
+
+    Move killers[kMaxPly + 1][2];
+    int history[2][64][64];
+    Move pv[kMaxPly + 1][kMaxPly + 1];
+    int pvLength[kMaxPly + 1];
+};
+
+void Search::Worker::clear() {
+    for (auto& k : killers) k[0] = k[1] = Move();
+    std::fill(&history[0][0][0], &history[0][0][0] + 2 * 64 * 64, 0);
+}
+
+void Search::Worker::prepare(const Position& root, const std::vector<uint64_t>& gameKeys, const SearchLimits& lim,
+                             const std::atomic<bool>& stop, const std::shared_ptr<const Network>& network,
+                             const std::shared_ptr<const Tablebases>& tables) {
+    pos = root;
+    if (!network) {
+        nnue.reset();
+    } else if (!nnue || &nnue->network() != network.get()) {
+        nnue = std::make_unique<NnueAccumulators>(network, kMaxPly);
+    }
+    if (nnue) nnue->refresh(root);
+    tablebases = tables;
+    keys = gameKeys;
+    if (keys.empty() || keys.back() != root.key()) keys.push_back(root.key());
+    keys.reserve(keys.size() + kMaxPly + 1);
+    stopFlag = &stop;
+    limits = lim;
+    start = Clock::now();
+    nodes = 0;
+    ttProbes = ttHits = tbHits = 0;
+    publishedNodes.store(0, std::memory_order_relaxed);
+    rootDepth = 0;
+    stopped = false;
+    completedDepth = 0;
+    bestScore = 0;
+    bestMove = ponderMove = Move();
+
+    // Killers belong to the previous root; history stays useful, damped
+    for (auto& k : killers) k[0] = k[1] = Move();
+    for (int c = 0; c < 2; c++) {
+        for (int from = 0; from < 64; from++) {
+            for (int to = 0; to < 64; to++) history[c][from][to] /= 2;
+        }
+    }
+
+    softMs = hardMs = 0;
+    Color us = root.sideToMove();
+    if (lim.moveTimeMs > 0) {
+        softMs = hardMs = lim.moveTimeMs;
+    } else if (lim.timeMs[us] > 0) {
+        int64_t available = std::max<int64_t>(lim.timeMs[us] - kMoveOverheadMs, 1);
+        int movesLeft = lim.movesToGo > 0 ? std::min(lim.movesToGo, 40) : 30;
+        softMs = std::min(available / movesLeft + lim.incMs[us] * 3 / 4, available * 3 / 4);
+        softMs = std::max<int64_t>(softMs, 1);
+        hardMs = std::max(std::min(softMs * 3, available * 3 / 4), softMs);
+    }
+}
+
+void Search::Worker::poll() {
+    publishedNodes.store(nodes, std::memory_order_relaxed);
+    if (stopFlag->load(std::memory_order_relaxed) || owner.m_helpersStop.load(std::memory_order_relaxed)) {
+        stopped = true;
+        return;
+    }
+    // Only the main thread watches the limits, and only once there is a
+    // depth 1 move to play
+    if (id != 0 || rootDepth <= 1) return;
+    if ((hardMs && elapsedMs() >= hardMs) || (limits.nodes && owner.totalNodes() >= limits.nodes)) stopped = true;
+}
+
+bool Search::Worker::isDraw() const {
+    if (pos.halfmoveClock() >= 100 || insufficientMaterial(pos)) return true;
+    // One repetition inside the search is enough to call it a draw
+    int n = static_cast<int>(keys.size()) - 1;
+    int window = std::min(pos.halfmoveClock(), n);
+    for (int back = 4; back <= window; back += 2) {
+        if (keys[n - back] == keys[n]) return true;
+    }
+    return false;
+}
+
+void Search::Worker::makeMove(Move m, Undo& undo) {
+    // The accumulator update reads the board before the move
+    if (nnue) nnue->push(pos, m);
+    pos.doMove(m, undo);
+    tt.prefetch(pos.key());
+}
+
+void Search::Worker::unmakeMove(Move m, const Undo& undo) {
+    pos.undoMove(m, undo);
+    if (nnue) nnue->pop();
+}
+
+void Search::Worker::makeNullMove(Undo& undo) {
+    if (nnue) nnue->pushNull();
+    pos.doNullMove(undo);
+    tt.prefetch(pos.key());
+}
+
+void Search::Worker::unmakeNullMove(const Undo& undo) {
+    pos.undoNullMove(undo);
+    if (nnue) nnue->pop();
+}
+
+void Search::Worker::scoreMoves(const MoveList& list, int* scores, Move ttMove, int ply) const {
+    Color us = pos.sideToMove();
+    for (int i = 0; i < list.size; i++) {
+        Move m = list.moves[i];
+        bool capture = isCapture(pos, m);
+        bool queenPromotion = m.kind() == Move::Promotion && m.promotion() == Queen;
+        if (m == ttMove) {
+            scores[i] = 1 << 30;
+        } else if (capture || queenPromotion) {
+            PieceType victim = m.kind() == Move::EnPassant ? Pawn : typeOf(pos.pieceOn(m.to()));
+            int mvvLva = (capture ? kPieceValue[victim] * 8 : 0) - typeOf(pos.pieceOn(m.from()));
+            if (queenPromotion) mvvLva += kPieceValue[Queen];
+            // Losing captures go after the quiet moves
+            scores[i] = (seeGe(pos, m, 0) ? 1 << 24 : -(1 << 24)) + mvvLva;
+        } else if (m == killers[ply][0]) {
+            scores[i] = (1 << 23) + 1;
+        } else if (m == killers[ply][1]) {
+            scores[i] = 1 << 23;
+        } else {
+            scores[i] = history[us][m.from()][m.to()];
+        }
+    }
+}
+
+void Search::Worker::updatePv(int ply, Move m) {
+    pv[ply][ply] = m;
+    for (int i = ply + 1; i < pvLength[ply + 1]; i++) pv[ply][i] = pv[ply + 1][i];
+    pvLength[ply] = std::max(pvLength[ply + 1], ply + 1);
+}
+
+void Search::Worker::updateQuietStats(Move best, const Move* quiets, int count, int depth, int ply) {
+    if (killers[ply][0] != best) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = best;
+    }
+    // History gravity keeps values inside +-kHistoryMax
+    Color us = pos.sideToMove();
+    int bonus = std::min(depth * depth, 400) * 16;
+    auto apply = [&](Move m, int delta) {
+        int& h = history[us][m.from()][m.to()];
+        h += delta - h * std::abs(delta) / kHistoryMax;
+    };
+    apply(best, bonus);
+    for (int i = 0; i < count; i++) apply(quiets[i], -bonus);
+}
+
+bool Search::Worker::probeTablebase(int ply, int& score) {
+    TablebaseResult tb;
+    if (!tablebases || popcount(pos.pieces()) > tablebases->maxPieces() || !tablebases->probe(pos, tb)) return false;
+    tbHits++;
+    // Mates count from the root like the ones the search finds
+    if (tb.wdl == Wdl::Win) score = kMateScore - ply - tb.dtm;
+    else if (tb.wdl == Wdl::Loss) score = -kMateScore + ply + tb.dtm;
+    else score = 0;
+    return true;
+}
+
+int Search::Worker::search(int alpha, int beta, int depth, int ply, bool nullAllowed) {
+    pvLength[ply] = ply;
+    if (depth <= 0) return qsearch(alpha, beta, ply);
+
+    if (++nodes % kPollInterval == 0) poll();
+    if (stopped) return 0;
+
+    bool pvNode = beta - alpha > 1;
+    bool inCheck = pos.inCheck();
+    if (ply > 0) {
+        if (isDraw()) return 0;
+        if (ply >= kMaxPly) return inCheck ? 0 : staticEvaluation();
+        // Mate distance pruning: a shorter mate is already known
+        alpha = std::max(alpha, -kMateScore + ply);
+        beta = std::min(beta, kMateScore - ply - 1);
+        if (alpha >= beta) return alpha;
+        int tbScore;
+        if (probeTablebase(ply, tbScore)) return tbScore;
+    }
+
+    TTEntry entry;
+    bool ttHit = tt.probe(pos.key(), entry);
+    ttProbes++;
+    ttHits += ttHit;
+    Move ttMove = ttHit ? entry.move : Move();
+    if (ttHit && !pvNode && entry.depth >= depth) {
+        int score = scoreFromTT(entry.score, ply);
+        if (entry.bound == Bound::Exact || (entry.bound == Bound::Lower && score >= beta) ||
+            (entry.bound == Bound::Upper && score <= alpha)) {
+            return score;
+        }
+    }
+
+    int staticEval = inCheck ? -kInfinite : ttHit ? entry.eval : staticEvaluation();
+    Color us = pos.sideToMove();
+
+    if (!pvNode && !inCheck) {
+        // Reverse futility: too far above beta for the remaining depth
+        if (depth <= 6 && staticEval - 80 * depth >= beta && std::abs(beta) < kMateBound) return staticEval;
+
+        // Null move: passing still fails high, so a real move will too
+        if (nullAllowed && depth >= 3 && staticEval >= beta && hasNonPawnMaterial(pos, us)) {
+            int r = 3 + depth / 4 + std::min(3, (staticEval - beta) / 200);
+            Undo undo;
+            makeNullMove(undo);
+            keys.push_back(pos.key());
+            int score = -search(-beta, -beta + 1, depth - 1 - r, ply + 1, false);
+            keys.pop_back();
+            unmakeNullMove(undo);
+            if (stopped) return 0;
+            if (score >= beta) return score >= kMateBound ? beta : score;
+        }
+    }
+
+    // Internal iterative reduction: without a TT move, ordering is poor
+    if (depth >= 4 && ttMove.isNone()) depth--;
+
+    MoveList list;
+    generatePseudoLegal(pos, GenType::All, list);
+    int scores[256];
+    scoreMoves(list, scores, ttMove, ply);
+
+    int originalAlpha = alpha;
+    int bestScore = -kInfinite;
+    Move best;
+    Move quiets[64];
+    int quietCount = 0;
+    int legal = 0;
+
+    for (int i = 0; i < list.size; i++) {
+        pickMove(list, scores, i);
+        Move m = list.moves[i];
+        if (!pos.isLegal(m)) continue;
+        legal++;
+
+        bool capture = isCapture(pos, m);
+        bool quiet = !capture && m.kind() != Move::Promotion;
+        if (ply > 0 && !pvNode && !inCheck && bestScore > -kMateBound) {
+            if (quiet) {
+                // Late move pruning and futility pruning near the leaves
+                if (depth <= 4 && legal > 3 + depth * depth) continue;
+                if (depth <= 3 && staticEval + 100 + 100 * depth <= alpha) continue;
+            } else if (depth <= 3 && !seeGe(pos, m, -100 * depth)) {
+                continue;
+            }
+        }
+
+        Undo undo;
+        makeMove(m, undo);
+        keys.push_back(pos.key());
+        bool givesCheck = pos.inCheck();
+        int newDepth = depth - 1;
+
+        int score;
+        if (legal == 1) {
+            score = -search(-beta, -alpha, newDepth, ply + 1, true);
+        } else {
+            int r = 0;
+            if (depth >= 3 && quiet && !inCheck && !givesCheck) {
+                r = kReductions.table[std::min(depth, 63)][std::min(legal, 63)];
+                if (pvNode) r--;
+                if (m == killers[ply][0] || m == killers[ply][1]) r--;
+                r -= history[us][m.from()][m.to()] / 8192;
+                r = std::clamp(r, 0, newDepth - 1);
+            }
+            // Zero window first; widen only if the move looks better
+            score = -search(-alpha - 1, -alpha, newDepth - r, ply + 1, true);
+            if (score > alpha && r > 0) score = -search(-alpha - 1, -alpha, newDepth, ply + 1, true);
+            if (score > alpha && score < beta) score = -search(-beta, -alpha, newDepth, ply + 1, true);
+        }
+
+        keys.pop_back();
+        unmakeMove(m, undo);
+        if (stopped) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                best = m;
+                alpha = score;
+                updatePv(ply, m);
+                if (alpha >= beta) {
+                    if (quiet) updateQuietStats(m, quiets, quietCount, depth, ply);
+                    break;
+                }
+            }
+        }
+        if (quiet && quietCount < 64) quiets[quietCount++] = m;
+    }
+
+    if (legal == 0) return inCheck ? -kMateScore + ply : 0;
+
+    Bound bound = bestScore >= beta ? Bound::Lower : bestScore > originalAlpha ? Bound::Exact : Bound::Upper;
+    tt.store(pos.key(), best, scoreToTT(bestScore, ply), staticEval, depth, bound);
+    return bestScore;
+}
+
+int Search::Worker::qsearch(int alpha, int beta, int ply) {
+    pvLength[ply] = ply;
+    if (++nodes % kPollInterval == 0) poll();
+    if (stopped) return 0;
+
+    bool inCheck = pos.inCheck();
+    if (ply >= kMaxPly) return inCheck ? 0 : staticEvaluation();
+    int tbScore;
+    if (probeTablebase(ply, tbScore)) return tbScore;
+
+    TTEntry entry;
+    bool ttHit = tt.probe(pos.key(), entry);
+    ttProbes++;
+    ttHits += ttHit;
+    if (ttHit) {
+        int score = scoreFromTT(entry.score, ply);
+        if (entry.bound == Bound::Exact || (entry.bound == Bound::Lower && score >= beta) ||
+            (entry.bound == Bound::Upper && score <= alpha)) {
+            return score;
+        }
+    }
+
+    // Stand pat: the side to move may decline every capture
+    int bestScore = -kInfinite;
+    int standPat = 0;
+    if (!inCheck) {
+        standPat = ttHit ? entry.eval : staticEvaluation();
+        if (standPat >= beta) return standPat;
+        alpha = std::max(alpha, standPat);
+        bestScore = standPat;
+    }
+
+    MoveList list;
+    generatePseudoLegal(pos, inCheck ? GenType::All : GenType::Captures, list);
+    int scores[256];
+    scoreMoves(list, scores, ttHit ? entry.move : Move(), ply);
+
+    int legal = 0;
+    for (int i = 0; i < list.size; i++) {
+        pickMove(list, scores, i);
+        Move m = list.moves[i];
+        if (!pos.isLegal(m)) continue;
+        legal++;
+
+        if (!inCheck) {
+            if (!seeGe(pos, m, 0)) continue;
+            // Delta pruning: even winning the piece can't reach alpha
+            bool capture = isCapture(pos, m);
+            PieceType victim = m.kind() == Move::EnPassant ? Pawn : typeOf(pos.pieceOn(m.to()));
+            if (capture && m.kind() != Move::Promotion && standPat + kPieceValue[victim] + 200 <= alpha) continue;
+        }
+
+        Undo undo;
+        makeMove(m, undo);
+        int score = -qsearch(-beta, -alpha, ply + 1);
+        unmakeMove(m, undo);
+        if (stopped) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                updatePv(ply, m);
+                if (alpha >= beta) break;
+            }
+        }
+    }
+
+    if (inCheck && legal == 0) return -kMateScore + ply;
+    return bestScore;
+}
+
+void Search::Worker::iterate(const InfoCallback* onInfo) {
+    int maxDepth = limits.depth > 0 ? std::min(limits.depth, kMaxPly - 1) : kMaxPly - 1;
+    int score = 0;
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        if (id > 0) {
+            int j = (id - 1) % 20;
+            if (((depth + kSkipPhase[j]) / kSkipSize[j]) % 2) continue;
+        }
+        rootDepth = depth;
+
+        // Aspiration window around the last score, widened on failure
+        int delta = kAspirationWindow;
+        int alpha = -kInfinite, beta = kInfinite;
+        if (depth >= 5) {
+            alpha = std::max(score - delta, -kInfinite);
+            beta = std::min(score + delta, kInfinite);
+        }
+        while (true) {
+            int value = search(alpha, beta, depth, 0, false);
+            if (stopped) break;
+            if (value <= alpha) {
+                beta = (alpha + beta) / 2;
+                alpha = std::max(value - delta, -kInfinite);
+            } else if (value >= beta) {
+                beta = std::min(value + delta, kInfinite);
+            } else {
+                score = value;
+                break;
+            }
+            delta += delta / 2;
+        }
+        if (stopped) break;
+
+        completedDepth = depth;
+        bestScore = score;
+        bestMove = pv[0][0];
+        ponderMove = pvLength[0] > 1 ? pv[0][1] : Move();
+        // A mate that fits inside the depth can't get shorter
+        if (std::abs(score) >= kMateBound && kMateScore - std::abs(score) <= depth) break;
+        if (id != 0) continue;
+
+        if (onInfo && *onInfo) {
+            SearchInfo info;
+            info.depth = depth;
+            info.score = score;
+            info.nodes = owner.totalNodes();
+            info.timeMs = elapsedMs();
+            info.pv.assign(&pv[0][0], &pv[0][0] + pvLength[0]);
+            (*onInfo)(info);
+        }
+
+        // The next iteration takes longer than all previous ones together
+        if (softMs && elapsedMs() >= softMs / 2) break;
+        if (limits.nodes && owner.totalNodes() >= limits.nodes) break;
+    }
+    publishedNodes.store(nodes, std::memory_order_relaxed);
+}
+
+Search::Search(TranspositionTable& tt, int threads) : m_tt(tt) {
+    setThreads(threads);
+}
+
+Search::~Search() = default;
+
+int Search::defaultThreads() {
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    return std::max(cores - 1, 1);
+}
+
+void Search::setThreads(int threads) {
+    size_t count = static_cast<size_t>(threads > 0 ? threads : defaultThreads());
+    while (m_workers.size() > count) m_workers.pop_back();
+    while (m_workers.size() < count) {
+        m_workers.push_back(std::make_unique<Worker>(*this, static_cast<int>(m_workers.size())));
+    }
+}
+
+void Search::newGame() {
+    for (auto& worker : m_workers) worker->clear();
+}
+
+uint64_t Search::totalNodes() const {
+    uint64_t total = 0;
+    for (const auto& worker : m_workers) total += worker->publishedNodes.load(std::memory_order_relaxed);
+    return total;
+}
+
+SearchResult Search::run(const Position& root, const std::vector<uint64_t>& keys, const SearchLimits& limits,
+                         const std::atomic<bool>& stop, const InfoCallback& onInfo) {
+    SearchResult result;
+    MoveList rootMoves;
+    generateLegal(root, rootMoves);
+    if (rootMoves.size == 0) {
+        result.score = root.inCheck() ? -kMateScore : 0;
+        return result;
+    }
+
+    // Resize / clear requests made while other searches held the table
+    m_tt.applyPending();
+    auto tableGuard = m_tt.searchLock();
+    m_tt.newSearch();
+    std::shared_ptr<const Network> network = currentNetwork();
+    std::shared_ptr<const Tablebases> tables = currentTablebases();
+    for (auto& worker : m_workers) worker->prepare(root, keys, limits, stop, network, tables);
+    m_helpersStop = false;
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < m_workers.size(); i++) {
+        Worker* worker = m_workers[i].get();
+        helpers.emplace_back([worker] { worker->iterate(nullptr); });
+    }
+    Worker& main = *m_workers[0];
+    main.iterate(&onInfo);
+    m_helpersStop = true;
+    for (auto& thread : helpers) thread.join();
+
+    const Worker* best = &main;
+    for (size_t i = 1; i < m_workers.size(); i++) {
+        const Worker& helper = *m_workers[i];
+        if (helper.completedDepth > best->completedDepth && helper.bestScore >= best->bestScore) best = &helper;
+    }
+
+    result.best = best->completedDepth ? best->bestMove : rootMoves.moves[0];
+    result.ponder = best->ponderMove;
+    result.score = best->bestScore;
+    result.depth = best->completedDepth;
+    uint64_t probes = 0, hits = 0;
+    for (const auto& worker : m_workers) {
+        result.nodes += worker->nodes;
+        probes += worker->ttProbes;
+        hits += worker->ttHits;
+        result.tbHits += worker->tbHits;
+    }
+    m_tt.recordProbes(probes, hits);
+    result.timeMs = main.elapsedMs();
+    return result;
+}
+
+int matePlies(int score) {
+    if (score >= kMateBound) return kMateScore - score;
+    if (score <= -kMateBound) return -(kMateScore + score);
+    return 0;
+}
+
+} // namespace chess
+} // namespace aegis
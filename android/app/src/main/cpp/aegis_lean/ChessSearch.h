@@ -0,0 +1,117 @@
+#pragma once
+
+#include "ChessPosition.h"
+#include "ChessTT.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace aegis {
+namespace chess {
+
+constexpr int kMaxPly = 128;
+constexpr int kInfinite = 32000;
+constexpr int kMateScore = 31000;
+// Scores beyond this are forced mates (kMateScore - plies to mate)
+constexpr int kMateBound = kMateScore - kMaxPly;
+
+// Any zero field is "no limit"; with no limit at all the search runs until
+// stopped (analysis mode)
+struct SearchLimits {
+    int depth = 0;
+    uint64_t nodes = 0;
+    int moveTimeMs = 0;    // fixed time for this move, overrides the clock
+    int timeMs[2] = {0, 0}; // remaining clock per colour
+    int incMs[2] = {0, 0};
+    int movesToGo = 0;     // moves to the next time control, 0 = sudden death
+};
+
+struct SearchInfo {
+    int depth = 0;
+    int score = 0; // centipawns, or +-(kMateScore - plies) for a mate
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+    std::vector<Move> pv;
+};
+
+struct SearchResult {
+    Move best;   // Move() only when the root has no legal move
+    Move ponder; // expected reply, if the PV has one
+    int score = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+    uint64_t tbHits = 0; // nodes scored by the endgame tables
+    int64_t timeMs = 0;
+};
+
+/**
+ * Search
+ * Principal variation search with iterative deepening and aspiration
+ * windows. Nodes use the transposition table, reverse futility and
+ * null-move pruning, late move reductions and late move pruning; moves are
+ * ordered TT move, winning captures (MVV-LVA, SEE), killers, then quiet
+ * history. Leaves run a capture-only quiescence search. Positions are
+ * evaluated by the network in currentNetwork() as of run(), with
+ * accumulators updated move by move, or by the PST evaluation without one.
+ * Below the root, positions covered by currentTablebases() take their
+ * exact mate distance or draw from the tables instead of being searched.
+ *
+ * With more than one thread the search is lazy SMP: helper threads run
+ * the same iterative deepening on their own copy of the position, sharing
+ * only the lock-free transposition table. Each helper skips a different
+ * pattern of depths so the threads spread over neighbouring iterations
+ * and fill the table with results the main thread then reuses. The main
+ * thread owns the clock and the reported PV; a helper's move is taken
+ * only when it completed a deeper iteration with a score at least as good.
+ *
+ * The transposition table is passed in and may be shared with other
+ * searches (it is lock-free). Killers and history persist between run()
+ * calls so an engine playing one game reuses them; call newGame() when
+ * the position is unrelated. One run() at a time per instance.
+ */
+class Search {
+public:
+    // threads: 0 = defaultThreads()
+    explicit Search(TranspositionTable& tt, int threads = 0);
+    ~Search();
+
+    // Takes effect from the next run(); 0 = defaultThreads()
+    void setThreads(int threads);
+    int threads() const { return static_cast<int>(m_workers.size()); }
+    // Every core but the one running the UI, at least 1
+    static int defaultThreads();
+
+    // Forgets the move ordering learned from earlier searches (the table
+    // ages old entries out by itself)
+    void newGame();
+
+    using InfoCallback = std::function<void(const SearchInfo&)>;
+
+    /**
+     * Searches root until a limit is hit or stop becomes true.
+     *
+     * @param keys Keys of the game so far with root's key last, so the
+     *             search scores repetitions of earlier positions as draws
+     * @param onInfo Called after every completed main thread iteration
+     *               (on the calling thread)
+     */
+    SearchResult run(const Position& root, const std::vector<uint64_t>& keys, const SearchLimits& limits,
+                     const std::atomic<bool>& stop, const InfoCallback& onInfo = {});
+
+private:
+    struct Worker;
+
+    uint64_t totalNodes() const;
+
+    TranspositionTable& m_tt;
+    std::vector<std::unique_ptr<Worker>> m_workers; // [0] runs on the caller's thread
+    std::atomic<bool> m_helpersStop{false};
+};
+
+// Plies to mate for a mate score (negative when being mated), else 0
+int matePlies(int score);
+
+} // namespace chess
+} // namespace aegis
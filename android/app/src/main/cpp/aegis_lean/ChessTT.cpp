@@ -0,0 +1,199 @@
+#include "ChessTT.h"
+#include <algorithm>
+#include <climits>
+#include <mutex>
+#include <new>
+
+namespace aegis {
+namespace chess {
+
+namespace {
+
+// data: move 0-15, score 16-31, eval 32-47, depth 48-55, bound 56-57,
+// generation 58-63
+constexpr int kGenerationBits = 6;
+constexpr uint8_t kGenerationMask = (1 << kGenerationBits) - 1;
+
+uint64_t pack(Move move, int score, int eval, int depth, Bound bound, uint8_t generation) {
+    return static_cast<uint64_t>(move.data) | static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16 |
+           static_cast<uint64_t>(static_cast<uint16_t>(eval)) << 32 |
+           static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 48 | static_cast<uint64_t>(bound) << 56 |
+           static_cast<uint64_t>(generation & kGenerationMask) << 58;
+}
+
+TTEntry unpack(uint64_t key, uint64_t data) {
+    TTEntry entry;
+    entry.key = key;
+    entry.move = Move(static_cast<uint16_t>(data));
+    entry.score = static_cast<int16_t>(data >> 16);
+    entry.eval = static_cast<int16_t>(data >> 32);
+    entry.depth = static_cast<int8_t>(data >> 48);
+    entry.bound = static_cast<Bound>((data >> 56) & 3);
+    return entry;
+}
+
+uint8_t generationOf(uint64_t data) {
+    return static_cast<uint8_t>(data >> 58);
+}
+
+// High 64 bits of a * b: maps a key onto any bucket count
+uint64_t mulHi(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+    uint64_t aLo = a & 0xFFFFFFFF, aHi = a >> 32, bLo = b & 0xFFFFFFFF, bHi = b >> 32;
+    uint64_t mid = (aLo * bLo >> 32) + (aHi * bLo & 0xFFFFFFFF) + aLo * bHi;
+    return aHi * bHi + (aHi * bLo >> 32) + (mid >> 32);
+#endif
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t mb) {
+    resize(mb);
+}
+
+void TranspositionTable::resize(size_t mb) {
+    std::unique_lock<std::shared_mutex> lock(m_resizeMutex);
+    resizeLocked(mb);
+}
+
+void TranspositionTable::clear() {
+    std::unique_lock<std::shared_mutex> lock(m_resizeMutex);
+    clearLocked();
+}
+
+bool TranspositionTable::requestResize(size_t mb) {
+    m_pendingMb.store(std::max<size_t>(mb, 1), std::memory_order_relaxed);
+    return applyPending();
+}
+
+void TranspositionTable::requestClear() {
+    m_pendingClear.store(true, std::memory_order_relaxed);
+    applyPending();
+}
+
+bool TranspositionTable::applyPending() {
+    if (!m_pendingMb.load(std::memory_order_relaxed) && !m_pendingClear.load(std::memory_order_relaxed)) return true;
+    std::unique_lock<std::shared_mutex> lock(m_resizeMutex, std::try_to_lock);
+    if (!lock.owns_lock()) return true;
+
+    size_t mb = m_pendingMb.exchange(0, std::memory_order_relaxed);
+    bool clearPending = m_pendingClear.exchange(false, std::memory_order_relaxed);
+    if (!mb) {
+        if (clearPending) clearLocked();
+        return true;
+    }
+    try {
+        resizeLocked(mb);
+    } catch (const std::bad_alloc&) {
+        if (clearPending) clearLocked();
+        return false;
+    }
+    return true;
+}
+
+void TranspositionTable::resizeLocked(size_t mb) {
+    size_t count = std::max<size_t>((std::max<size_t>(mb, 1) << 20) / sizeof(Bucket), 1);
+    // Allocate before freeing: if it throws, the old table stays in place
+    // and probes remain valid. Briefly holds both tables.
+    auto buckets = std::make_unique<Bucket[]>(count);
+    m_buckets = std::move(buckets);
+    m_bucketCount = count;
+    m_generation = 0;
+    m_probes = 0;
+    m_hits = 0;
+}
+
+void TranspositionTable::clearLocked() {
+    for (size_t i = 0; i < m_bucketCount; i++) {
+        for (Entry& entry : m_buckets[i].entries) {
+            entry.check.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    m_generation = 0;
+}
+
+size_t TranspositionTable::index(uint64_t key) const {
+    return static_cast<size_t>(mulHi(key, m_bucketCount));
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& out) const {
+    const Bucket& bucket = m_buckets[index(key)];
+    for (const Entry& entry : bucket.entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if ((entry.check.load(std::memory_order_relaxed) ^ data) != key || data == 0) continue;
+        out = unpack(key, data);
+        return out.bound != Bound::None;
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int eval, int depth, Bound bound) {
+    Bucket& bucket = m_buckets[index(key)];
+    uint8_t generation = m_generation.load(std::memory_order_relaxed) & kGenerationMask;
+
+    Entry* target = nullptr;
+    int worst = INT_MAX;
+    for (Entry& entry : bucket.entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if (data == 0) {
+            // Empty beats any occupied entry; keep scanning for the key
+            if (worst != INT_MIN) target = &entry, worst = INT_MIN;
+            continue;
+        }
+        if ((entry.check.load(std::memory_order_relaxed) ^ data) == key) {
+            TTEntry old = unpack(key, data);
+            // Keep a deeper result from this search generation
+            if (depth < old.depth && bound != Bound::Exact && generationOf(data) == generation) return;
+            if (move.isNone()) move = old.move;
+            target = &entry;
+            break;
+        }
+        int age = (generation - generationOf(data)) & kGenerationMask;
+        int value = static_cast<int8_t>(data >> 48) - 8 * age;
+        if (value < worst) {
+            target = &entry;
+            worst = value;
+        }
+    }
+
+    uint64_t data = pack(move, score, eval, depth, bound, generation);
+    target->data.store(data, std::memory_order_relaxed);
+    target->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::recordProbes(uint64_t probes, uint64_t hits) {
+    m_probes.fetch_add(probes, std::memory_order_relaxed);
+    m_hits.fetch_add(hits, std::memory_order_relaxed);
+}
+
+TTStats TranspositionTable::stats() const {
+    std::shared_lock<std::shared_mutex> lock(m_resizeMutex);
+    TTStats stats;
+    stats.sizeMb = sizeMb();
+    stats.probes = m_probes.load(std::memory_order_relaxed);
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+
+    // Sample the first 1000 entries, like UCI hashfull
+    uint8_t generation = m_generation.load(std::memory_order_relaxed) & kGenerationMask;
+    size_t sampled = std::min<size_t>(m_bucketCount, 1000 / kBucketEntries);
+    int used = 0;
+    for (size_t i = 0; i < sampled; i++) {
+        for (const Entry& entry : m_buckets[i].entries) {
+            uint64_t data = entry.data.load(std::memory_order_relaxed);
+            used += data != 0 && generationOf(data) == generation;
+        }
+    }
+    stats.fillPermille = sampled ? static_cast<int>(used * 1000 / (sampled * kBucketEntries)) : 0;
+    return stats;
+}
+
+TranspositionTable& sharedTranspositionTable() {
+    static TranspositionTable table;
+    return table;
+}
+
+} // namespace chess
+} // namespace aegis
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "ChessTypes.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+
+namespace aegis {
+namespace chess {
+
+enum class Bound : uint8_t {
+    None = 0,
+    Upper = 1, // failed low: score <= alpha
+    Lower = 2, // failed high: score >= beta
+    Exact = 3
+};
+
+struct TTEntry {
+    uint64_t key = 0;
+    Move move;
+    int16_t score = 0;
+    int16_t eval = 0;
+    int8_t depth = 0;
+    Bound bound = Bound::None;
+};
+
+struct TTStats {
+    size_t sizeMb = 0;
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+    int fillPermille = 0; // entries written by the current search generation
+};
+
+/**
+ * TranspositionTable
+ * Search results by Zobrist key, shared by every search thread (and every
+ * search using the table) without locks. The table is an array of 64-byte
+ * buckets, one cache line each, holding four entries. An entry is packed
+ * into one 64-bit word stored next to key ^ word; a reader only accepts it
+ * when the XOR gives back its key, so an entry torn by two concurrent
+ * writers reads as a miss instead of a wrong result.
+ *
+ * A store goes to the entry already holding the position, else to an
+ * empty one, else to the one with the lowest depth minus 8 per search
+ * generation it has aged (newSearch() starts a generation). The stored
+ * move survives a shallower re-store of the same position so move
+ * ordering keeps it. Scores are stored as given (mate scores must be made
+ * ply-independent by the caller).
+ */
+class TranspositionTable {
+public:
+    explicit TranspositionTable(size_t mb = 16);
+
+    // Reallocates (and clears) the table at any size; waits for searches
+    // holding searchLock() to finish
+    void resize(size_t mb);
+    void clear();
+    size_t sizeMb() const { return m_bucketCount * sizeof(Bucket) >> 20; }
+
+    // Same without waiting, for callers that must not block (the FFI runs
+    // on the UI isolate): applied at once when no search holds the table,
+    // else by the next search that starts on an idle one. A resize
+    // supersedes a pending clear. requestResize returns false only when an
+    // immediate reallocation failed (the old table is kept).
+    bool requestResize(size_t mb);
+    void requestClear();
+    // Applies a pending request unless a search holds the table
+    bool applyPending();
+
+    // Held by a search for its whole run so resize() can't pull the table away
+    std::shared_lock<std::shared_mutex> searchLock() const { return std::shared_lock<std::shared_mutex>(m_resizeMutex); }
+    // Ages every entry by one generation
+    void newSearch() { m_generation.fetch_add(1, std::memory_order_relaxed); }
+
+    void prefetch(uint64_t key) const {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&m_buckets[index(key)]);
+#else
+        (void)key;
+#endif
+    }
+    bool probe(uint64_t key, TTEntry& out) const;
+    void store(uint64_t key, Move move, int score, int eval, int depth, Bound bound);
+
+    // Searches count their own probes and add them once per run, so the
+    // counters don't bounce a shared cache line between threads
+    void recordProbes(uint64_t probes, uint64_t hits);
+    TTStats stats() const;
+
+private:
+    static constexpr int kBucketEntries = 4;
+
+    struct Entry {
+        std::atomic<uint64_t> check{0}; // key ^ data
+        std::atomic<uint64_t> data{0};
+    };
+
+    struct alignas(64) Bucket {
+        Entry entries[kBucketEntries];
+    };
+
+    size_t index(uint64_t key) const;
+    void resizeLocked(size_t mb);
+    void clearLocked();
+
+    std::unique_ptr<Bucket[]> m_buckets;
+    size_t m_bucketCount = 0;
+    std::atomic<uint8_t> m_generation{0};
+    std::atomic<uint64_t> m_probes{0};
+    std::atomic<uint64_t> m_hits{0};
+    mutable std::shared_mutex m_resizeMutex;
+    std::atomic<size_t> m_pendingMb{0}; // 0 = no resize pending
+    std::atomic<bool> m_pendingClear{false};
+};
+
+// Process-wide table shared by every game handle's search (hints, the
+// computer opponent, analysis). Sized by AegisConfig::chessHashMb.
+TranspositionTable& sharedTranspositionTable();
+
+} // namespace chess
+} // namespace aegis
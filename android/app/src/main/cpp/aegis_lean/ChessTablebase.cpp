@@ -0,0 +1,378 @@
+#include "ChessTablebase.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace aegis {
+namespace chess {
+
+namespace {
+
+constexpr char kMagic[8] = {'A', 'E', 'G', 'I', 'S', 'T', 'B', '1'};
+constexpr size_t kNameBytes = 16;
+constexpr size_t kHeaderBytes = sizeof(kMagic) + kNameBytes + 8;
+
+constexpr char kPieceLetters[] = "PNBRQK";
+constexpr int kPieceValues[] = {1, 3, 3, 5, 9};
+
+// White king squares of pawnless tables: a1-d1-d4, index by square order
+struct Triangle {
+    int index[64];
+    int square[10];
+    Triangle() {
+        int n = 0;
+        for (int sq = 0; sq < 64; sq++) {
+            index[sq] = fileOf(sq) <= 3 && rankOf(sq) <= fileOf(sq) ? n : -1;
+            if (index[sq] >= 0) square[n++] = sq;
+        }
+    }
+};
+
+const Triangle kTriangle;
+
+// The eight board symmetries: bit 0 mirrors files, bit 1 ranks, bit 2
+// swaps files and ranks (applied last)
+int transform(int sq, int t) {
+    if (t & 1) sq ^= 7;
+    if (t & 2) sq ^= 56;
+    if (t & 4) sq = (sq >> 3) | ((sq & 7) << 3);
+    return sq;
+}
+
+std::mutex g_tablebaseMutex;
+std::shared_ptr<const Tablebases> g_tablebases;
+
+void fail(std::string* error, const std::string& reason) {
+    if (error) *error = reason;
+}
+
+// Whether a double step could still be answered en passant: a pawn on its
+// start rank next to an enemy pawn that is on, or can still reach, the
+// capturing rank. Tables don't play en passant after in-table double
+// steps, so these values may be wrong. Pawns never move back or change
+// file inside a table, so every other position only leads to positions
+// like it and its value is exact.
+bool enPassantSensitive(const Position& pos) {
+    Bitboard white = pos.pieces(White, Pawn), black = pos.pieces(Black, Pawn);
+    if (!white || !black) return false;
+    for (Bitboard w = white; w;) {
+        int ws = popLsb(w);
+        for (Bitboard b = black; b;) {
+            int bs = popLsb(b);
+            if (std::abs(fileOf(ws) - fileOf(bs)) != 1) continue;
+            if (rankOf(ws) == 1 && rankOf(bs) >= 3) return true;
+            if (rankOf(bs) == 6 && rankOf(ws) <= 4) return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+// ==================== MATERIAL ====================
+
+bool TableMaterial::parse(std::string_view name, TableMaterial& out) {
+    TableMaterial m;
+    size_t split = name.find('v');
+    if (split == std::string_view::npos) return false;
+    std::string_view sides[2] = {name.substr(0, split), name.substr(split + 1)};
+    for (int c = 0; c < 2; c++) {
+        if (sides[c].empty() || sides[c][0] != 'K') return false;
+        for (char ch : sides[c].substr(1)) {
+            const char* p = std::strchr(kPieceLetters, ch);
+            if (!ch || !p || *p == 'K') return false;
+            m.count[c][p - kPieceLetters]++;
+        }
+    }
+    if (m.pieces() > kTablebaseMaxPieces) return false;
+    out = m;
+    return true;
+}
+
+TableMaterial TableMaterial::of(const Position& pos) {
+    TableMaterial m;
+    for (int c = 0; c < 2; c++) {
+        for (int t = Pawn; t < King; t++) m.count[c][t] = popcount(pos.pieces(Color(c), PieceType(t)));
+    }
+    return m;
+}
+
+std::string TableMaterial::name() const {
+    std::string out;
+    for (int c = 0; c < 2; c++) {
+        if (c) out += 'v';
+        out += 'K';
+        for (int t = Queen; t >= Pawn; t--) out.append(count[c][t], kPieceLetters[t]);
+    }
+    return out;
+}
+
+uint64_t TableMaterial::code() const {
+    uint64_t code = 0;
+    for (int c = 0; c < 2; c++) {
+        for (int t = Pawn; t < King; t++) code = code << 4 | static_cast<uint64_t>(count[c][t]);
+    }
+    return code;
+}
+
+int TableMaterial::pieces() const {
+    int n = 2;
+    for (int c = 0; c < 2; c++) {
+        for (int t = Pawn; t < King; t++) n += count[c][t];
+    }
+    return n;
+}
+
+TableMaterial TableMaterial::flipped() const {
+    TableMaterial m;
+    for (int t = Pawn; t < King; t++) {
+        m.count[White][t] = count[Black][t];
+        m.count[Black][t] = count[White][t];
+    }
+    return m;
+}
+
+bool TableMaterial::isCanonical() const {
+    int n[2] = {}, value[2] = {};
+    for (int c = 0; c < 2; c++) {
+        for (int t = Pawn; t < King; t++) {
+            n[c] += count[c][t];
+            value[c] += count[c][t] * kPieceValues[t];
+        }
+    }
+    if (n[White] != n[Black]) return n[White] > n[Black];
+    if (value[White] != value[Black]) return value[White] > value[Black];
+    for (int t = Queen; t >= Pawn; t--) {
+        if (count[White][t] != count[Black][t]) return count[White][t] > count[Black][t];
+    }
+    return true;
+}
+
+// ==================== INDEX ====================
+
+TableIndex::TableIndex(const TableMaterial& material) {
+    m_pawns = material.pawns() > 0;
+    m_pieces[m_slots++] = makePiece(White, King);
+    m_pieces[m_slots++] = makePiece(Black, King);
+    for (int c = 0; c < 2; c++) {
+        for (int t = Queen; t >= Pawn; t--) {
+            for (int i = 0; i < material.count[c][t]; i++) m_pieces[m_slots++] = makePiece(Color(c), PieceType(t));
+        }
+    }
+
+    m_size = 2; // side to move
+    for (int i = 0; i < m_slots; i++) {
+        if (i == 0) m_range[i] = m_pawns ? 32 : 10;
+        else m_range[i] = typeOf(m_pieces[i]) == Pawn ? 48 : 64;
+        m_size *= static_cast<uint64_t>(m_range[i]);
+    }
+}
+
+void TableIndex::squaresOf(const Position& pos, bool flip, int* squares) const {
+    Bitboard remaining = 0;
+    for (int i = 0; i < m_slots; i++) {
+        if (i == 0 || m_pieces[i] != m_pieces[i - 1]) {
+            Color c = flip ? ~colorOf(m_pieces[i]) : colorOf(m_pieces[i]);
+            remaining = pos.pieces(c, typeOf(m_pieces[i]));
+        }
+        int sq = popLsb(remaining);
+        squares[i] = flip ? flipRank(sq) : sq;
+    }
+}
+
+uint64_t TableIndex::index(int* squares, Color side) const {
+    auto encode = [&](int* sq) {
+        // Equal pieces are interchangeable: keep them in square order
+        for (int i = 2; i < m_slots; i++) {
+            for (int j = i; j > 2 && m_pieces[j] == m_pieces[j - 1] && sq[j] < sq[j - 1]; j--) std::swap(sq[j], sq[j - 1]);
+        }
+        uint64_t idx = m_pawns ? static_cast<uint64_t>(rankOf(sq[0]) * 4 + fileOf(sq[0]))
+                               : static_cast<uint64_t>(kTriangle.index[sq[0]]);
+        for (int i = 1; i < m_slots; i++) {
+            int v = typeOf(m_pieces[i]) == Pawn ? sq[i] - 8 : sq[i];
+            idx = idx * static_cast<uint64_t>(m_range[i]) + static_cast<uint64_t>(v);
+        }
+        return idx * 2 + side;
+    };
+
+    if (m_pawns) {
+        if (fileOf(squares[0]) >= 4) {
+            for (int i = 0; i < m_slots; i++) squares[i] ^= 7;
+        }
+        return encode(squares);
+    }
+
+    // A king on the diagonal has two images in the triangle; the smaller
+    // index is the stored one
+    uint64_t best = ~uint64_t(0);
+    int bestSquares[kMaxSlots];
+    for (int t = 0; t < 8; t++) {
+        if (kTriangle.index[transform(squares[0], t)] < 0) continue;
+        int candidate[kMaxSlots] = {};
+        for (int i = 0; i < m_slots; i++) candidate[i] = transform(squares[i], t);
+        uint64_t idx = encode(candidate);
+        if (idx < best) {
+            best = idx;
+            std::memcpy(bestSquares, candidate, sizeof(int) * m_slots);
+        }
+    }
+    std::memcpy(squares, bestSquares, sizeof(int) * m_slots);
+    return best;
+}
+
+void TableIndex::decode(uint64_t idx, int* squares, Color& side) const {
+    side = static_cast<Color>(idx & 1);
+    idx >>= 1;
+    for (int i = m_slots - 1; i >= 1; i--) {
+        int v = static_cast<int>(idx % static_cast<uint64_t>(m_range[i]));
+        idx /= static_cast<uint64_t>(m_range[i]);
+        squares[i] = typeOf(m_pieces[i]) == Pawn ? v + 8 : v;
+    }
+    int king = static_cast<int>(idx);
+    squares[0] = m_pawns ? makeSquare(king % 4, king / 4) : kTriangle.square[king];
+}
+
+// ==================== TABLES ====================
+
+Tablebases::~Tablebases() {
+    for (const std::unique_ptr<Table>& table : m_tables) ::munmap(table->mapping, table->mappingSize);
+}
+
+std::shared_ptr<const Tablebases> Tablebases::open(const std::string& dir, std::string* error) {
+    DIR* d = ::opendir(dir.c_str());
+    if (!d) {
+        fail(error, "cannot open tablebase directory");
+        return nullptr;
+    }
+    std::vector<std::string> files;
+    while (dirent* entry = ::readdir(d)) {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".atb") == 0) files.push_back(dir + "/" + name);
+    }
+    ::closedir(d);
+    if (files.empty()) {
+        fail(error, "no .atb tables in directory");
+        return nullptr;
+    }
+
+    std::shared_ptr<Tablebases> tables = std::make_shared<Tablebases>();
+    for (const std::string& path : files) {
+        if (!tables->addFile(path, error)) return nullptr;
+    }
+    return tables;
+}
+
+bool Tablebases::addFile(const std::string& path, std::string* error) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fail(error, "cannot open " + path);
+        return false;
+    }
+    struct stat st;
+    uint8_t header[kHeaderBytes];
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kHeaderBytes) ||
+        ::pread(fd, header, kHeaderBytes, 0) != static_cast<ssize_t>(kHeaderBytes) ||
+        std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        ::close(fd);
+        fail(error, path + " is not a tablebase file");
+        return false;
+    }
+
+    const char* rawName = reinterpret_cast<const char*>(header + sizeof(kMagic));
+    TableMaterial material;
+    uint64_t entries = 0;
+    for (int i = 7; i >= 0; i--) entries = entries << 8 | header[sizeof(kMagic) + kNameBytes + i];
+    if (!TableMaterial::parse(std::string_view(rawName, strnlen(rawName, kNameBytes)), material) ||
+        !material.isCanonical() || has(material)) {
+        ::close(fd);
+        fail(error, path + " has a bad or duplicate table name");
+        return false;
+    }
+    std::unique_ptr<Table> table(new Table(material));
+    if (entries != table->index.size() || static_cast<uint64_t>(st.st_size) != kHeaderBytes + entries) {
+        ::close(fd);
+        fail(error, path + " has the wrong size for " + material.name());
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        fail(error, "mmap failed");
+        return false;
+    }
+    // Search probes land anywhere in the table
+    ::madvise(p, size, MADV_RANDOM);
+
+    table->mapping = p;
+    table->mappingSize = size;
+    table->values = static_cast<const uint8_t*>(p) + kHeaderBytes;
+    m_byCode[material.code()] = table.get();
+    m_maxPieces = std::max(m_maxPieces, material.pieces());
+    m_tables.push_back(std::move(table));
+    return true;
+}
+
+std::vector<std::string> Tablebases::names() const {
+    std::vector<std::string> out;
+    for (const std::unique_ptr<Table>& table : m_tables) out.push_back(table->material.name());
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+bool Tablebases::probe(const Position& pos, TablebaseResult& out) const {
+    if (pos.castlingRights() || pos.epSquare() != kNoSquare) return false;
+    int count = popcount(pos.pieces());
+    if (count == 2) {
+        out = TablebaseResult();
+        return true;
+    }
+    if (count > m_maxPieces || enPassantSensitive(pos)) return false;
+
+    TableMaterial material = TableMaterial::of(pos);
+    bool flip = false;
+    auto it = m_byCode.find(material.code());
+    if (it == m_byCode.end()) {
+        it = m_byCode.find(material.flipped().code());
+        if (it == m_byCode.end()) return false;
+        flip = true;
+    }
+    const Table& table = *it->second;
+    int squares[TableIndex::kMaxSlots];
+    table.index.squaresOf(pos, flip, squares);
+    Color side = flip ? ~pos.sideToMove() : pos.sideToMove();
+    TablebaseResult result = tablebaseValue(table.values[table.index.index(squares, side)]);
+    // The mate may come too late for the fifty-move rule; without distance
+    // to zeroing there is no telling, so leave it to the search
+    if (result.wdl != Wdl::Draw && pos.halfmoveClock() + result.dtm > 100) return false;
+    out = result;
+    return true;
+}
+
+TablebaseResult tablebaseValue(uint8_t value) {
+    TablebaseResult result;
+    if (value == 0) return result;
+    result.dtm = value - 1;
+    result.wdl = result.dtm % 2 ? Wdl::Win : Wdl::Loss;
+    return result;
+}
+
+std::shared_ptr<const Tablebases> currentTablebases() {
+    std::lock_guard<std::mutex> lock(g_tablebaseMutex);
+    return g_tablebases;
+}
+
+void setCurrentTablebases(std::shared_ptr<const Tablebases> tablebases) {
+    std::lock_guard<std::mutex> lock(g_tablebaseMutex);
+    g_tablebases = std::move(tablebases);
+}
+
+} // namespace chess
+} // namespace aegis
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "ChessPosition.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace aegis {
+namespace chess {
+
+constexpr int kTablebaseMaxPieces = 4; // kings included
+
+enum class Wdl : int8_t { Loss = -1, Draw = 0, Win = 1 };
+
+struct TablebaseResult {
+    Wdl wdl = Wdl::Draw; // for the side to move
+    int dtm = 0;         // plies to mate with best play, 0 for a draw
+};
+
+/**
+ * TableMaterial
+ * The non-king pieces of one table, named like "KRPvK". Tables are stored
+ * with White as the stronger side (more pieces, then more material);
+ * positions with the colours the other way round are probed mirrored.
+ */
+struct TableMaterial {
+    int count[2][6] = {}; // per colour and piece type, kings excluded
+
+    static bool parse(std::string_view name, TableMaterial& out);
+    static TableMaterial of(const Position& pos);
+
+    std::string name() const;
+    // Lookup key; equal for equal material only
+    uint64_t code() const;
+    int pieces() const; // kings included
+    int pawns() const { return count[White][Pawn] + count[Black][Pawn]; }
+    TableMaterial flipped() const;
+    // Whether this is the orientation tables are stored in
+    bool isCanonical() const;
+};
+
+/**
+ * TableIndex
+ * Maps positions of one material to dense indices. Slots are the white
+ * king, the black king, then White's pieces and Black's, each strongest
+ * type first; equal pieces are ordered by square. Symmetry shrinks the
+ * table: without pawns the board is rotated/reflected so the white king
+ * sits in the a1-d1-d4 triangle (10 squares), with pawns it is mirrored so
+ * the white king is on files a-d (32 squares). Pawns take 48 squares,
+ * other pieces 64, and the side to move is the lowest bit:
+ *
+ *   KQvKR: 10 * 64 * 64 * 64 * 2 = 5.2M entries
+ *
+ * Indices whose decoded placement is illegal or not in canonical form are
+ * never produced by index() and hold no meaningful value.
+ */
+class TableIndex {
+public:
+    static constexpr int kMaxSlots = kTablebaseMaxPieces;
+
+    explicit TableIndex(const TableMaterial& material);
+
+    uint64_t size() const { return m_size; }
+    int slots() const { return m_slots; }
+    Piece piece(int slot) const { return m_pieces[slot]; }
+
+    // Squares of pos in slot order; flip mirrors ranks and swaps colours,
+    // for positions whose material is this table's flipped()
+    void squaresOf(const Position& pos, bool flip, int* squares) const;
+    // Canonicalises squares in place and returns the index
+    uint64_t index(int* squares, Color side) const;
+    void decode(uint64_t idx, int* squares, Color& side) const;
+
+private:
+    int m_slots = 0;
+    bool m_pawns = false;
+    Piece m_pieces[kMaxSlots] = {};
+    int m_range[kMaxSlots] = {};
+    uint64_t m_size = 0;
+};
+
+/**
+ * Tablebases
+ * Distance-to-mate tables for endings with up to four pieces. Each table
+ * file (<name>.atb, written by generateTablebases) is:
+ *
+ *   char     magic[8] = "AEGISTB1"
+ *   char     name[16]               (e.g. "KQvKR", zero padded)
+ *   uint64   entries                (TableIndex size, little-endian)
+ *   uint8    value[entries]
+ *
+ * A value of 0 is a draw; v > 0 is mate in v - 1 plies, won for the side
+ * to move when that is odd and lost when even. Files are mapped read-only
+ * and probed in place; probes allocate nothing.
+ *
+ * probe() only reports exact results. Not covered are positions with
+ * castling rights or an en passant square, positions where a double step
+ * could still be taken en passant (tables don't model that, see
+ * generateTablebases), and wins or losses whose mate would come after
+ * the fifty-move rule can end the game (halfmove clock + dtm > 100).
+ */
+class Tablebases {
+public:
+    Tablebases() = default;
+    ~Tablebases();
+    Tablebases(const Tablebases&) = delete;
+    Tablebases& operator=(const Tablebases&) = delete;
+
+    // Maps every .atb file in dir; nullptr (and a reason in error) when
+    // dir can't be read or a file is malformed
+    static std::shared_ptr<const Tablebases> open(const std::string& dir, std::string* error = nullptr);
+
+    // Maps one table file; the generator adds tables as it writes them
+    bool addFile(const std::string& path, std::string* error = nullptr);
+
+    size_t tables() const { return m_tables.size(); }
+    int maxPieces() const { return m_maxPieces; }
+    std::vector<std::string> names() const;
+    bool has(const TableMaterial& material) const { return m_byCode.count(material.code()) != 0; }
+
+    // false when pos is not covered by a loaded table or the result would
+    // not be exact (see above)
+    bool probe(const Position& pos, TablebaseResult& out) const;
+
+private:
+    struct Table {
+        explicit Table(const TableMaterial& m) : material(m), index(m) {}
+        TableMaterial material;
+        TableIndex index;
+        const uint8_t* values = nullptr;
+        void* mapping = nullptr;
+        size_t mappingSize = 0;
+    };
+
+    std::vector<std::unique_ptr<Table>> m_tables;
+    std::unordered_map<uint64_t, const Table*> m_byCode;
+    int m_maxPieces = 0;
+};
+
+// Decodes a stored value
+TablebaseResult tablebaseValue(uint8_t value);
+
+// Process-wide tables used by searches and game status; nullptr = none
+std::shared_ptr<const Tablebases> currentTablebases();
+void setCurrentTablebases(std::shared_ptr<const Tablebases> tablebases);
+
+using TablebaseProgress = std::function<void(const std::string& table, int done, int total)>;
+
+/**
+ * Generates every table with up to maxPieces pieces into dir by
+ * retrograde analysis, smaller tables first since captures and
+ * promotions lead into them. Tables already in dir are loaded instead of
+ * rebuilt. Each table is solved ply by ply from the mates backwards, with
+ * positions split across threads. En passant is not played after a
+ * double step inside a table, so KPvKP positions in which it could still
+ * happen may hold wrong values; Tablebases::probe never reports those.
+ *
+ * @param threads 0 = every core
+ * @return Number of tables written, or -1 (and a reason in error)
+ */
+int generateTablebases(const std::string& dir, int maxPieces, int threads, const TablebaseProgress& onProgress = {},
+                       std::string* error = nullptr);
+
+} // namespace chess
+} // namespace aegis
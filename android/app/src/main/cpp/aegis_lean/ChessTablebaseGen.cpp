@@ -0,0 +1,379 @@
+#include "ChessTablebase.h"
+#include "ChessMoveGen.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace aegis {
+namespace chess {
+
+namespace {
+
+// Per-position state while a table is solved; 1..253 are final values
+// (mate distance + 1, as stored in the file)
+constexpr uint8_t kUnknown = 0;
+constexpr uint8_t kDrawn = 254; // stalemate, or no way on but a drawing exit
+constexpr uint8_t kInvalid = 255;
+constexpr int kMaxDistance = 252;
+
+// Exit summary: every capture/promotion loses, the longest in this many
+// plies (0 = no exits), or kNoLosingExit when one draws or wins
+constexpr uint8_t kNoLosingExit = 255;
+
+constexpr size_t kChunk = 4096;
+
+// Every table up to maxPieces, in an order where captures and promotions
+// only lead into tables already built: fewer pieces first, then fewer pawns
+std::vector<TableMaterial> tableOrder(int maxPieces) {
+    const PieceType kinds[] = {Queen, Rook, Bishop, Knight, Pawn};
+    std::vector<TableMaterial> out;
+    for (int i = 0; i < 5; i++) {
+        TableMaterial m;
+        m.count[White][kinds[i]]++;
+        out.push_back(m);
+        for (int j = i; j < 5 && maxPieces >= 4; j++) {
+            TableMaterial two = m;
+            two.count[White][kinds[j]]++;
+            out.push_back(two);
+            TableMaterial versus = m;
+            versus.count[Black][kinds[j]]++;
+            out.push_back(versus);
+        }
+    }
+    std::stable_sort(out.begin(), out.end(), [](const TableMaterial& a, const TableMaterial& b) {
+        if (a.pieces() != b.pieces()) return a.pieces() < b.pieces();
+        return a.pawns() < b.pawns();
+    });
+    return out;
+}
+
+// Runs fn(begin, end, worker) over [0, count) in chunks on threads workers
+template <typename Fn> void parallelFor(size_t count, int threads, Fn&& fn) {
+    std::atomic<size_t> next{0};
+    auto run = [&](int worker) {
+        for (;;) {
+            size_t begin = next.fetch_add(kChunk);
+            if (begin >= count) break;
+            fn(begin, std::min(count, begin + kChunk), worker);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) pool.emplace_back(run, i);
+    run(0);
+    for (std::thread& t : pool) t.join();
+}
+
+/**
+ * TableBuilder
+ * Solves one table by retrograde analysis. An initial pass over every
+ * index finds the mates and stalemates, scores captures and promotions
+ * against the smaller tables, and counts each position's distinct moves
+ * that stay in the table. Round k then takes the positions resolved at
+ * k - 1 plies and walks their moves backwards: a predecessor of a lost
+ * position is won in k, and a predecessor whose last in-table move has
+ * just turned out to lose is lost in k (or later, when a losing exit
+ * takes longer). Exits that win or lose slower than the round are parked
+ * in buckets until their round comes. Whatever is unresolved at the end
+ * is a draw.
+ */
+class TableBuilder {
+public:
+    TableBuilder(const TableMaterial& material, const Tablebases& smaller, int threads)
+        : m_index(material), m_smaller(smaller), m_threads(threads), m_state(m_index.size()),
+          m_pending(m_index.size()), m_exit(m_index.size()), m_buckets(kMaxDistance + 1), m_workers(threads) {
+        for (int i = 0; i < m_index.slots(); i++) m_pieces[i] = m_index.piece(i);
+    }
+
+    bool build(std::string* error);
+    bool write(const std::string& path, const std::string& name, std::string* error) const;
+
+private:
+    struct Worker {
+        Position pos;
+        std::vector<uint32_t> resolved;
+        std::vector<std::pair<int, uint32_t>> scheduled;
+    };
+
+    void initialise(uint32_t idx, Worker& w);
+    void retract(uint32_t child, int round, Worker& w);
+    void schedule(int distance, uint32_t idx, Worker& w);
+    bool resolve(uint32_t idx, int distance) {
+        uint8_t expected = kUnknown;
+        return m_state[idx].compare_exchange_strong(expected, static_cast<uint8_t>(distance + 1));
+    }
+    // Whether side may be to move: the other king isn't attacked
+    bool legal(const int* squares, Color side) const;
+    std::vector<uint32_t> collect();
+
+    TableIndex m_index;
+    Piece m_pieces[TableIndex::kMaxSlots] = {};
+    const Tablebases& m_smaller;
+    int m_threads;
+    std::vector<std::atomic<uint8_t>> m_state;
+    std::vector<std::atomic<uint8_t>> m_pending; // in-table moves not yet known to lose
+    std::vector<std::atomic<uint8_t>> m_exit;
+    std::vector<std::vector<uint32_t>> m_buckets;
+    std::vector<Worker> m_workers;
+    std::atomic<bool> m_missingExit{false};
+    std::atomic<bool> m_overflow{false};
+};
+
+bool TableBuilder::legal(const int* squares, Color side) const {
+    Bitboard occupied = 0;
+    for (int i = 0; i < m_index.slots(); i++) occupied |= bit(squares[i]);
+    int king = squares[side == White ? 1 : 0];
+    for (int i = 0; i < m_index.slots(); i++) {
+        if (colorOf(m_pieces[i]) != side) continue;
+        PieceType t = typeOf(m_pieces[i]);
+        Bitboard attacks = t == Pawn ? pawnAttacks(side, squares[i]) : attacksOf(t, squares[i], occupied);
+        if (attacks & bit(king)) return false;
+    }
+    return true;
+}
+
+void TableBuilder::schedule(int distance, uint32_t idx, Worker& w) {
+    if (distance > kMaxDistance) {
+        m_overflow = true;
+        return;
+    }
+    w.scheduled.emplace_back(distance, idx);
+}
+
+void TableBuilder::initialise(uint32_t idx, Worker& w) {
+    int squares[TableIndex::kMaxSlots], canonical[TableIndex::kMaxSlots];
+    Color side;
+    m_index.decode(idx, squares, side);
+    Bitboard occupied = 0;
+    for (int i = 0; i < m_index.slots(); i++) {
+        if (occupied & bit(squares[i])) {
+            m_state[idx] = kInvalid;
+            return;
+        }
+        occupied |= bit(squares[i]);
+    }
+    // Only the canonical image of each position is solved
+    std::memcpy(canonical, squares, sizeof(squares));
+    if (m_index.index(canonical, side) != idx || !w.pos.setPieces(m_pieces, squares, m_index.slots(), side)) {
+        m_state[idx] = kInvalid;
+        return;
+    }
+
+    Position& pos = w.pos;
+    MoveList moves;
+    generateLegal(pos, moves);
+    if (moves.size == 0) {
+        if (pos.inCheck()) {
+            m_state[idx] = 1;
+            w.resolved.push_back(idx);
+        } else {
+            m_state[idx] = kDrawn;
+        }
+        return;
+    }
+
+    int fastestWin = INT_MAX, slowestLoss = 0;
+    bool drawn = false;
+    uint32_t children[256];
+    int count = 0;
+    for (Move m : moves) {
+        bool exit = m.kind() == Move::Promotion || m.kind() == Move::EnPassant || pos.pieceOn(m.to()) != kNoPiece;
+        Undo undo;
+        pos.doMove(m, undo);
+        if (exit) {
+            TablebaseResult r;
+            if (!m_smaller.probe(pos, r)) m_missingExit = true;
+            else if (r.wdl == Wdl::Loss) fastestWin = std::min(fastestWin, r.dtm + 1);
+            else if (r.wdl == Wdl::Win) slowestLoss = std::max(slowestLoss, r.dtm + 1);
+            else drawn = true;
+        } else {
+            int child[TableIndex::kMaxSlots];
+            m_index.squaresOf(pos, false, child);
+            children[count++] = static_cast<uint32_t>(m_index.index(child, pos.sideToMove()));
+        }
+        pos.undoMove(m, undo);
+    }
+    // Symmetric moves can reach the same stored position
+    std::sort(children, children + count);
+    count = static_cast<int>(std::unique(children, children + count) - children);
+
+    m_pending[idx] = static_cast<uint8_t>(count);
+    m_exit[idx] = drawn || fastestWin != INT_MAX ? kNoLosingExit : static_cast<uint8_t>(std::min(slowestLoss, 254));
+    if (fastestWin != INT_MAX) schedule(fastestWin, idx, w);
+    else if (count == 0 && drawn) m_state[idx] = kDrawn;
+    else if (count == 0) schedule(slowestLoss, idx, w);
+}
+
+void TableBuilder::retract(uint32_t child, int round, Worker& w) {
+    int squares[TableIndex::kMaxSlots];
+    Color side;
+    m_index.decode(child, squares, side);
+    Color mover = ~side;
+    Bitboard occupied = 0;
+    for (int i = 0; i < m_index.slots(); i++) occupied |= bit(squares[i]);
+
+    // Positions one non-capturing, non-promoting move before this one
+    uint32_t parents[256];
+    int count = 0;
+    for (int i = 0; i < m_index.slots(); i++) {
+        if (colorOf(m_pieces[i]) != mover) continue;
+        int to = squares[i];
+        Bitboard origins;
+        if (typeOf(m_pieces[i]) == Pawn) {
+            int back = mover == White ? -8 : 8;
+            origins = 0;
+            int single = to + back;
+            if (rankOf(single) != (mover == White ? 0 : 7) && !(occupied & bit(single))) {
+                origins |= bit(single);
+                int twice = single + back;
+                if (rankOf(to) == (mover == White ? 3 : 4) && !(occupied & bit(twice))) origins |= bit(twice);
+            }
+        } else {
+            origins = attacksOf(typeOf(m_pieces[i]), to, occupied) & ~occupied;
+        }
+        while (origins) {
+            int parent[TableIndex::kMaxSlots];
+            std::memcpy(parent, squares, sizeof(squares));
+            parent[i] = popLsb(origins);
+            if (!legal(parent, mover)) continue;
+            parents[count++] = static_cast<uint32_t>(m_index.index(parent, mover));
+        }
+    }
+    std::sort(parents, parents + count);
+    count = static_cast<int>(std::unique(parents, parents + count) - parents);
+
+    bool childLost = (round - 1) % 2 == 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t parent = parents[i];
+        if (childLost) {
+            if (resolve(parent, round)) w.resolved.push_back(parent);
+            continue;
+        }
+        if (m_state[parent] != kUnknown || m_pending[parent].fetch_sub(1) != 1) continue;
+        // Every move stays lost; the slowest exit may still take longer
+        int exit = m_exit[parent];
+        if (exit == kNoLosingExit) continue;
+        if (exit <= round) {
+            if (resolve(parent, round)) w.resolved.push_back(parent);
+        } else {
+            schedule(exit, parent, w);
+        }
+    }
+}
+
+std::vector<uint32_t> TableBuilder::collect() {
+    std::vector<uint32_t> out;
+    for (Worker& w : m_workers) {
+        out.insert(out.end(), w.resolved.begin(), w.resolved.end());
+        w.resolved.clear();
+        for (const std::pair<int, uint32_t>& s : w.scheduled) m_buckets[s.first].push_back(s.second);
+        w.scheduled.clear();
+    }
+    return out;
+}
+
+bool TableBuilder::build(std::string* error) {
+    uint64_t size = m_index.size();
+    parallelFor(size, m_threads, [&](size_t begin, size_t end, int worker) {
+        for (size_t idx = begin; idx < end; idx++) initialise(static_cast<uint32_t>(idx), m_workers[worker]);
+    });
+    std::vector<uint32_t> frontier = collect();
+    if (m_missingExit) {
+        if (error) *error = "a capture or promotion leads to a table that isn't built";
+        return false;
+    }
+
+    for (int round = 1;; round++) {
+        bool waiting = false;
+        for (int d = round; d <= kMaxDistance && !waiting; d++) waiting = !m_buckets[d].empty();
+        if (frontier.empty() && !waiting) break;
+        if (round > kMaxDistance || m_overflow) {
+            if (error) *error = "mate distance exceeds the file format";
+            return false;
+        }
+
+        parallelFor(frontier.size(), m_threads, [&](size_t begin, size_t end, int worker) {
+            for (size_t i = begin; i < end; i++) retract(frontier[i], round, m_workers[worker]);
+        });
+        for (uint32_t idx : m_buckets[round]) {
+            if (resolve(idx, round)) m_workers[0].resolved.push_back(idx);
+        }
+        std::vector<uint32_t>().swap(m_buckets[round]);
+        frontier = collect();
+    }
+    return true;
+}
+
+bool TableBuilder::write(const std::string& path, const std::string& name, std::string* error) const {
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        if (error) *error = "cannot create " + tmp + ": " + std::strerror(errno);
+        return false;
+    }
+
+    std::vector<uint8_t> buffer(1 << 20);
+    uint8_t* header = buffer.data();
+    std::memset(header, 0, 32);
+    std::memcpy(header, "AEGISTB1", 8);
+    std::memcpy(header + 8, name.data(), std::min<size_t>(name.size(), 16));
+    uint64_t entries = m_index.size();
+    for (int i = 0; i < 8; i++) header[24 + i] = static_cast<uint8_t>(entries >> (8 * i));
+    size_t used = 32;
+
+    bool ok = true;
+    for (uint64_t idx = 0; idx < entries && ok; idx++) {
+        uint8_t v = m_state[idx];
+        buffer[used++] = v == kDrawn || v == kInvalid ? 0 : v;
+        if (used == buffer.size() || idx + 1 == entries) {
+            ok = ::write(fd, buffer.data(), used) == static_cast<ssize_t>(used);
+            used = 0;
+        }
+    }
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || ::rename(tmp.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        if (error) *error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int generateTablebases(const std::string& dir, int maxPieces, int threads, const TablebaseProgress& onProgress,
+                       std::string* error) {
+    if (maxPieces < 3 || maxPieces > kTablebaseMaxPieces) {
+        if (error) *error = "tables hold 3 to 4 pieces";
+        return -1;
+    }
+    if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        if (error) *error = "cannot create " + dir;
+        return -1;
+    }
+    initAttacks();
+
+    std::vector<TableMaterial> order = tableOrder(maxPieces);
+    Tablebases tables;
+    int written = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+        std::string name = order[i].name();
+        std::string path = dir + "/" + name + ".atb";
+        if (::access(path.c_str(), F_OK) != 0 || !tables.addFile(path)) {
+            TableBuilder builder(order[i], tables, threads);
+            if (!builder.build(error) || !builder.write(path, name, error) || !tables.addFile(path, error)) return -1;
+            written++;
+        }
+        if (onProgress) onProgress(name, static_cast<int>(i + 1), static_cast<int>(order.size()));
+    }
+    return written;
+}
+
+} // namespace chess
+} // namespace aegis
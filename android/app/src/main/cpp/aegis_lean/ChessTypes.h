@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+
+namespace aegis {
+namespace chess {
+
+// Squares are 0..63, a1 = 0, h1 = 7, a8 = 56, h8 = 63.
+using Bitboard = uint64_t;
+
+constexpr int kNoSquare = 64;
+
+enum Color : uint8_t { White, Black };
+
+constexpr Color operator~(Color c) { return static_cast<Color>(c ^ 1); }
+
+enum PieceType : uint8_t { Pawn, Knight, Bishop, Rook, Queen, King };
+
+// Mailbox encoding, also the aegis_game_board64 byte layout:
+// 0 = empty, 1..6 = white P N B R Q K, 7..12 = black P N B R Q K.
+using Piece = uint8_t;
+constexpr Piece kNoPiece = 0;
+
+constexpr Piece makePiece(Color c, PieceType t) { return static_cast<Piece>(1 + c * 6 + t); }
+constexpr PieceType typeOf(Piece p) { return static_cast<PieceType>((p - 1) % 6); }
+constexpr Color colorOf(Piece p) { return static_cast<Color>((p - 1) / 6); }
+
+// Castling rights bits
+enum : uint8_t {
+    WhiteOO = 1,
+    WhiteOOO = 2,
+    BlackOO = 4,
+    BlackOOO = 8,
+    AllCastling = 15
+};
+
+constexpr int fileOf(int sq) { return sq & 7; }
+constexpr int rankOf(int sq) { return sq >> 3; }
+constexpr int makeSquare(int file, int rank) { return rank * 8 + file; }
+// Same square seen from Black's side (a1 <-> a8)
+constexpr int flipRank(int sq) { return sq ^ 56; }
+
+constexpr Bitboard bit(int sq) { return Bitboard(1) << sq; }
+
+constexpr Bitboard kFileA = 0x0101010101010101ULL;
+constexpr Bitboard kFileH = kFileA << 7;
+constexpr Bitboard kRank1 = 0xFFULL;
+constexpr Bitboard kRank2 = kRank1 << 8;
+constexpr Bitboard kRank4 = kRank1 << 24;
+constexpr Bitboard kRank5 = kRank1 << 32;
+constexpr Bitboard kRank7 = kRank1 << 48;
+constexpr Bitboard kRank8 = kRank1 << 56;
+
+inline int lsb(Bitboard b) { return __builtin_ctzll(b); }
+inline int msb(Bitboard b) { return 63 - __builtin_clzll(b); }
+inline int popcount(Bitboard b) { return __builtin_popcountll(b); }
+inline int popLsb(Bitboard& b) {
+    int sq = lsb(b);
+    b &= b - 1;
+    return sq;
+}
+constexpr bool moreThanOne(Bitboard b) { return (b & (b - 1)) != 0; }
+
+template <int D> constexpr Bitboard shift(Bitboard b) {
+    if constexpr (D == 8) return b << 8;
+    if constexpr (D == -8) return b >> 8;
+    if constexpr (D == 7) return (b & ~kFileA) << 7;
+    if constexpr (D == 9) return (b & ~kFileH) << 9;
+    if constexpr (D == -7) return (b & ~kFileH) >> 7;
+    if constexpr (D == -9) return (b & ~kFileA) >> 9;
+    return 0;
+}
+
+/**
+ * Move
+ * 16 bits: from (0-5), to (6-11), promotion piece (12-13, Knight..Queen)
+ * and kind (14-15). Castling is encoded as the king's two-square step.
+ */
+struct Move {
+    enum Kind : uint16_t { Normal = 0, Promotion = 1, EnPassant = 2, Castling = 3 };
+
+    uint16_t data = 0;
+
+    constexpr Move() = default;
+    constexpr explicit Move(uint16_t raw) : data(raw) {}
+    constexpr Move(int from, int to, Kind kind = Normal, PieceType promo = Knight)
+        : data(static_cast<uint16_t>(from | (to << 6) | ((promo - Knight) << 12) | (kind << 14))) {}
+
+    constexpr int from() const { return data & 63; }
+    constexpr int to() const { return (data >> 6) & 63; }
+    constexpr Kind kind() const { return static_cast<Kind>(data >> 14); }
+    constexpr PieceType promotion() const { return static_cast<PieceType>(((data >> 12) & 3) + Knight); }
+
+    // FFI encoding: from | to << 6 | promo << 12, promo 0 = none, 1..4 = N B R Q
+    constexpr uint16_t code() const {
+        int promo = kind() == Promotion ? promotion() : 0;
+        return static_cast<uint16_t>(from() | (to() << 6) | (promo << 12));
+    }
+
+    constexpr bool isNone() const { return data == 0; }
+    constexpr bool operator==(Move o) const { return data == o.data; }
+    constexpr bool operator!=(Move o) const { return data != o.data; }
+};
+
+// Enough for any legal position (the known maximum is 218)
+struct MoveList {
+    Move moves[256];
+    int size = 0;
+
+    void push(Move m) { moves[size++] = m; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + size; }
+    Move* begin() { return moves; }
+    Move* end() { return moves + size; }
+};
+
+} // namespace chess
+} // namespace aegis
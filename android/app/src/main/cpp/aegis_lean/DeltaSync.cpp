@@ -0,0 +1,310 @@
+#include "DeltaSync.h"
+#include "compression/delta_engine.h"
+#include <algorithm>
+#include <iostream>
+
+namespace aegis {
+
+DeltaSync::DeltaSync(SyncMetrics& metrics, size_t historyDepth, size_t historyBytes)
+    : m_metrics(metrics), m_historyDepth(historyDepth == 0 ? 1 : historyDepth), m_historyLimit(historyBytes) {}
+
+uint64_t DeltaSync::recordLocal(const std::string& key, const std::vector<uint8_t>& data) {
+    auto bytes = std::make_shared<const std::vector<uint8_t>>(data);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto [hit, inserted] = m_local.try_emplace(key);
+    auto& history = hit->second;
+    if (inserted) {
+        m_lru.push_front(key);
+        history.lru = m_lru.begin();
+        history.bytes = key.size();
+        m_historyBytes += key.size();
+    } else {
+        m_lru.splice(m_lru.begin(), m_lru, history.lru);
+    }
+
+    uint64_t version = m_nextVersion++;
+    history.bytes += bytes->size();
+    m_historyBytes += bytes->size();
+    history.versions.push_back({version, std::move(bytes)});
+    while (history.versions.size() > m_historyDepth) {
+        popOldestLocked(history);
+    }
+    evictLocked(key);
+    updateGaugesLocked();
+    return version;
+}
+
+void DeltaSync::popOldestLocked(KeyHistory& history) {
+    size_t size = history.versions.front().data->size();
+    history.bytes -= size;
+    m_historyBytes -= size;
+    history.versions.pop_front();
+}
+
+void DeltaSync::evictLocked(const std::string& keep) {
+    // Least recently written keys first; keep (just written) is never
+    // evicted, but gives up its older versions if it alone is over budget
+    while (m_historyBytes > m_historyLimit && m_lru.size() > 1) {
+        std::string key = std::move(m_lru.back());
+        m_lru.pop_back();
+        auto hit = m_local.find(key);
+        m_historyBytes -= hit->second.bytes;
+        m_local.erase(hit);
+        // Acks for it only named bases that are gone now
+        for (auto& [peerId, acked] : m_acked) acked.erase(key);
+        m_metrics.deltaHistoryEvictions++;
+    }
+    auto& history = m_local.find(keep)->second;
+    while (m_historyBytes > m_historyLimit && history.versions.size() > 1) {
+        popOldestLocked(history);
+    }
+}
+
+void DeltaSync::evictReceivedLocked() {
+    // The base just applied (front) stays, even alone over budget
+    while (m_receivedBytes > m_historyLimit && m_receivedLru.size() > 1) {
+        auto peer = m_received.find(m_receivedLru.back().first);
+        eraseReceivedLocked(peer->second, peer->second.find(m_receivedLru.back().second));
+        if (peer->second.empty()) m_received.erase(peer);
+        m_metrics.deltaReceivedEvictions++;
+    }
+}
+
+void DeltaSync::eraseReceivedLocked(std::unordered_map<std::string, Received>& keys,
+                                    std::unordered_map<std::string, Received>::iterator hit) {
+    m_receivedBytes -= hit->second.bytes;
+    m_receivedLru.erase(hit->second.lru);
+    keys.erase(hit);
+}
+
+void DeltaSync::updateGaugesLocked() {
+    m_metrics.deltaHistoryKeys = m_local.size();
+    m_metrics.deltaHistoryBytes = m_historyBytes;
+    m_metrics.deltaReceivedBytes = m_receivedBytes;
+}
+
+bool DeltaSync::hasLocal(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_local.count(key) != 0;
+}
+
+std::shared_ptr<const std::vector<uint8_t>> DeltaSync::localValue(const std::string& key, uint64_t version) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto hit = m_local.find(key);
+    return hit == m_local.end() ? nullptr : findVersion(hit->second, version);
+}
+
+size_t DeltaSync::historyBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_historyBytes;
+}
+
+size_t DeltaSync::receivedBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_receivedBytes;
+}
+
+DeltaSync::Bytes DeltaSync::findVersion(const KeyHistory& history, uint64_t version) const {
+    for (auto it = history.versions.rbegin(); it != history.versions.rend(); ++it) {
+        if (it->version == version) return it->data;
+        if (it->version < version) break;
+    }
+    return nullptr;
+}
+
+std::optional<SyncFrame> DeltaSync::encodeFor(const std::string& peerId, const std::string& key) {
+    auto frames = encodeForPeers({peerId}, key);
+    if (frames.empty()) return std::nullopt;
+    return std::move(frames.front().frame);
+}
+
+std::vector<DeltaSync::PeerFrame> DeltaSync::encodeForPeers(const std::vector<std::string>& peerIds,
+                                                            const std::string& key) {
+    struct Group {
+        uint64_t baseVersion;
+        Bytes base;
+        std::vector<std::string> peers;
+    };
+    std::vector<Group> groups; // few distinct bases, linear search is fine
+    Bytes target;
+    uint64_t version = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto hit = m_local.find(key);
+        if (hit == m_local.end() || hit->second.versions.empty()) return {};
+
+        const auto& latest = hit->second.versions.back();
+        version = latest.version;
+        target = latest.data;
+
+        for (const auto& peerId : peerIds) {
+            uint64_t baseVersion = 0;
+            Bytes base;
+            auto peer = m_acked.find(peerId);
+            if (peer != m_acked.end()) {
+                auto acked = peer->second.find(key);
+                if (acked != peer->second.end()) {
+                    if (acked->second >= version) continue; // peer is up to date
+                    base = findVersion(hit->second, acked->second);
+                    if (base) baseVersion = acked->second;
+                }
+            }
+            auto group = std::find_if(groups.begin(), groups.end(),
+                                      [&](const Group& g) { return g.baseVersion == baseVersion; });
+            if (group == groups.end()) {
+                groups.push_back({baseVersion, std::move(base), {}});
+                group = groups.end() - 1;
+            }
+            group->peers.push_back(peerId);
+        }
+    }
+
+    // Encode outside the lock: delta computation is the expensive part.
+    std::vector<PeerFrame> out;
+    PeerFrame* full = nullptr;
+    out.reserve(groups.size());
+    for (auto& group : groups) {
+        if (group.base) {
+            auto delta = compression::DeltaEngine::computeDelta(*group.base, *target);
+            if (delta.size() < target->size()) {
+                m_metrics.deltaFrames++;
+                m_metrics.bytesSaved += target->size() - delta.size();
+                PeerFrame pf;
+                pf.frame = {key, version, group.baseVersion, std::move(delta)};
+                pf.peers = std::move(group.peers);
+                out.push_back(std::move(pf));
+                continue;
+            }
+            // Delta not worth it: falls back to the shared full frame
+        }
+        if (!full) {
+            m_metrics.fullFrames++;
+            PeerFrame pf;
+            pf.frame = {key, version, 0, *target};
+            out.push_back(std::move(pf));
+            full = &out.back(); // reserved above, stays valid
+        }
+        full->peers.insert(full->peers.end(), std::make_move_iterator(group.peers.begin()),
+                           std::make_move_iterator(group.peers.end()));
+    }
+    return out;
+}
+
+void DeltaSync::onAck(const std::string& peerId, const std::string& key, uint64_t version) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto hit = m_local.find(key);
+    if (hit == m_local.end()) return; // evicted: the next update goes out in full anyway
+    auto& acked = m_acked[peerId][key];
+    if (version > acked) acked = version;
+
+    // Versions older than every peer's ack can't be asked for as a base
+    // again (a peer without an ack for the key gets the full value)
+    uint64_t floor = acked;
+    for (const auto& [otherId, keys] : m_acked) {
+        auto other = keys.find(key);
+        if (other != keys.end()) floor = std::min(floor, other->second);
+    }
+    auto& history = hit->second;
+    while (history.versions.size() > 1 && history.versions.front().version < floor) {
+        popOldestLocked(history);
+    }
+    updateGaugesLocked();
+}
+
+void DeltaSync::onNack(const std::string& peerId, const std::string& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto peer = m_acked.find(peerId);
+    if (peer != m_acked.end()) peer->second.erase(key);
+    m_metrics.deltaMisses++;
+}
+
+uint64_t DeltaSync::ackedVersion(const std::string& peerId, const std::string& key) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto peer = m_acked.find(peerId);
+    if (peer == m_acked.end()) return 0;
+    auto acked = peer->second.find(key);
+    return acked == peer->second.end() ? 0 : acked->second;
+}
+
+std::vector<std::string> DeltaSync::keys() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> out;
+    out.reserve(m_local.size());
+    for (const auto& [key, history] : m_local) out.push_back(key);
+    return out;
+}
+
+std::optional<std::vector<uint8_t>> DeltaSync::decode(const std::string& peerId, const SyncFrame& frame) {
+    std::vector<uint8_t> value;
+
+    if (frame.isDelta()) {
+        Bytes base;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto peer = m_received.find(peerId);
+            if (peer != m_received.end()) {
+                auto last = peer->second.find(frame.key);
+                if (last != peer->second.end() && last->second.last.version == frame.baseVersion) {
+                    base = last->second.last.data;
+                }
+            }
+        }
+        if (!base) return std::nullopt;
+
+        try {
+            value = compression::DeltaEngine::applyDelta(*base, frame.payload);
+        } catch (const std::exception& e) {
+            std::cerr << "[DeltaSync] Failed to apply delta for " << frame.key << ": " << e.what() << std::endl;
+            return std::nullopt;
+        }
+    } else {
+        value = frame.payload;
+    }
+
+    auto data = std::make_shared<const std::vector<uint8_t>>(value);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto [hit, inserted] = m_received[peerId].try_emplace(frame.key);
+    auto& received = hit->second;
+    if (inserted) {
+        m_receivedLru.emplace_front(peerId, frame.key);
+        received.lru = m_receivedLru.begin();
+    } else if (frame.version < received.last.version) {
+        return value; // out of order: keep the newer base
+    } else {
+        m_receivedLru.splice(m_receivedLru.begin(), m_receivedLru, received.lru);
+    }
+    m_receivedBytes -= received.bytes;
+    received.bytes = frame.key.size() + data->size();
+    m_receivedBytes += received.bytes;
+    received.last = {frame.version, std::move(data)};
+    evictReceivedLocked();
+    updateGaugesLocked();
+    return value;
+}
+
+void DeltaSync::forgetPeer(const std::string& peerId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_acked.erase(peerId);
+    auto peer = m_received.find(peerId);
+    if (peer != m_received.end()) {
+        while (!peer->second.empty()) eraseReceivedLocked(peer->second, peer->second.begin());
+        m_received.erase(peer);
+    }
+    updateGaugesLocked();
+}
+
+void DeltaSync::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_local.clear();
+    m_lru.clear();
+    m_historyBytes = 0;
+    m_acked.clear();
+    m_received.clear();
+    m_receivedLru.clear();
+    m_receivedBytes = 0;
+    updateGaugesLocked(); // m_nextVersion keeps counting: peers may still hold old versions
+}
+
+} // namespace aegis
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "SyncMetrics.h"
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace aegis {
+
+// One outgoing/incoming document update.
+// baseVersion == 0 means payload is the full value, otherwise payload is a
+// delta_engine patch against the sender's baseVersion of the same key.
+struct SyncFrame {
+    std::string key;
+    uint64_t version = 0;
+    uint64_t baseVersion = 0;
+    std::vector<uint8_t> payload;
+
+    bool isDelta() const { return baseVersion != 0; }
+};
+
+/**
+ * DeltaSync
+ * Encodes document updates as deltas against the last version each peer
+ * acknowledged. Keeps a short per-key history of local versions so that a
+ * peer lagging a few versions behind still gets a delta; anything older
+ * (or never acked) falls back to the full value.
+ *
+ * The history is bounded: versions older than every peer's ack for a key
+ * are dropped as acks arrive, and past historyBytes whole keys are evicted
+ * least recently written first (their next update goes out in full).
+ * Version numbers come from one counter for all keys, so a key recorded
+ * again after eviction never reuses a version a peer has seen.
+ *
+ * The receive side mirrors this: it remembers the last version applied per
+ * (peer, key) so incoming deltas can be resolved. Those bases get their own
+ * historyBytes budget, evicting the least recently applied (peer, key)
+ * first; a delta against an evicted base is nacked and resent in full.
+ */
+class DeltaSync {
+public:
+    static constexpr size_t kDefaultHistoryBytes = 16 * 1024 * 1024;
+
+    explicit DeltaSync(SyncMetrics& metrics, size_t historyDepth = 8, size_t historyBytes = kDefaultHistoryBytes);
+
+    // One encoded frame and the peers it applies to
+    struct PeerFrame {
+        SyncFrame frame;
+        std::vector<std::string> peers;
+    };
+
+    // Sender side
+    uint64_t recordLocal(const std::string& key, const std::vector<uint8_t>& data);
+    // False once the key was evicted (or never recorded)
+    bool hasLocal(const std::string& key) const;
+    // A recorded version's value, or nullptr once it was dropped
+    std::shared_ptr<const std::vector<uint8_t>> localValue(const std::string& key, uint64_t version) const;
+    std::optional<SyncFrame> encodeFor(const std::string& peerId, const std::string& key);
+    // Broadcast: one delta per distinct acked base, shared by every peer on
+    // that base; up-to-date peers are left out.
+    std::vector<PeerFrame> encodeForPeers(const std::vector<std::string>& peerIds, const std::string& key);
+    void onAck(const std::string& peerId, const std::string& key, uint64_t version);
+    void onNack(const std::string& peerId, const std::string& key);
+    uint64_t ackedVersion(const std::string& peerId, const std::string& key) const;
+    std::vector<std::string> keys() const;
+    size_t historyBytes() const;
+    size_t receivedBytes() const;
+
+    // Receiver side: returns the full value, or nullopt if the base is unknown
+    // (caller should nack so the sender falls back to a full frame).
+    std::optional<std::vector<uint8_t>> decode(const std::string& peerId, const SyncFrame& frame);
+
+    void forgetPeer(const std::string& peerId);
+    void clear();
+
+private:
+    using Bytes = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct Version {
+        uint64_t version;
+        Bytes data;
+    };
+
+    struct KeyHistory {
+        std::deque<Version> versions; // oldest first, newest last
+        size_t bytes = 0;             // key and version payloads
+        std::list<std::string>::iterator lru;
+    };
+
+    using PeerKey = std::pair<std::string, std::string>; // peer, key
+
+    struct Received {
+        Version last;
+        size_t bytes = 0; // key and payload
+        std::list<PeerKey>::iterator lru;
+    };
+
+    Bytes findVersion(const KeyHistory& history, uint64_t version) const;
+
+    // Callers of these hold m_mutex
+    void popOldestLocked(KeyHistory& history);
+    void evictLocked(const std::string& keep);
+    void evictReceivedLocked();
+    void eraseReceivedLocked(std::unordered_map<std::string, Received>& keys,
+                             std::unordered_map<std::string, Received>::iterator hit);
+    void updateGaugesLocked();
+
+    SyncMetrics& m_metrics;
+    size_t m_historyDepth;
+    size_t m_historyLimit;
+
+    mutable std::mutex m_mutex;
+    uint64_t m_nextVersion = 1;
+    size_t m_historyBytes = 0;
+    std::list<std::string> m_lru; // most recently written first
+    std::unordered_map<std::string, KeyHistory> m_local;
+    std::unordered_map<std::string, std::unordered_map<std::string, uint64_t>> m_acked;  // peer -> key -> version
+    std::unordered_map<std::string, std::unordered_map<std::string, Received>> m_received; // peer -> key -> last applied
+    std::list<PeerKey> m_receivedLru; // most recently applied first
+    size_t m_receivedBytes = 0;
+};
+
+} // namespace aegis
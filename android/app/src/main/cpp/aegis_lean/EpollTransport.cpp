@@ -0,0 +1,495 @@
+#include "EpollTransport.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace aegis {
+
+namespace {
+
+constexpr size_t kLenBytes = 4;
+constexpr size_t kMaxIov = 64; // frames per sendmsg (two iovecs each)
+
+bool fillUnixAddr(const std::string& path, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+} // namespace
+
+EpollTransport::EpollTransport(Options options, SyncMetrics& metrics)
+    : m_options(std::move(options)), m_metrics(metrics) {}
+
+EpollTransport::~EpollTransport() {
+    stop();
+}
+
+EpollTransport::Pending EpollTransport::pending(Frame data) {
+    Pending p;
+    size_t len = data->size();
+    for (size_t i = 0; i < kLenBytes; i++) p.prefix[i] = static_cast<uint8_t>(len >> (8 * i));
+    p.data = std::move(data);
+    return p;
+}
+
+bool EpollTransport::start(Handlers handlers) {
+    if (m_loop.joinable()) return true;
+    m_handlers = std::move(handlers);
+    m_stop = false;
+
+    m_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+    m_wake = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epoll < 0 || m_wake < 0) {
+        std::cerr << "[EpollTransport] epoll/eventfd setup failed: " << std::strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = m_wake;
+    ::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wake, &ev);
+
+    if ((m_options.port != 0 && !listenTcp()) || (!m_options.unixPath.empty() && !listenUnix())) {
+        stop();
+        return false;
+    }
+
+    m_loop = std::thread(&EpollTransport::run, this);
+    return true;
+}
+
+bool EpollTransport::listenTcp() {
+    m_tcpListen = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_tcpListen < 0) return false;
+    int one = 1;
+    ::setsockopt(m_tcpListen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(m_options.port);
+    if (::inet_pton(AF_INET, m_options.bindAddress.c_str(), &addr.sin_addr) != 1 ||
+        ::bind(m_tcpListen, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(m_tcpListen, 64) != 0) {
+        std::cerr << "[EpollTransport] TCP listen on " << m_options.port << " failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(m_tcpListen, reinterpret_cast<sockaddr*>(&addr), &len);
+    m_boundPort = ntohs(addr.sin_port);
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = m_tcpListen;
+    return ::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_tcpListen, &ev) == 0;
+}
+
+bool EpollTransport::listenUnix() {
+    sockaddr_un addr;
+    if (!fillUnixAddr(m_options.unixPath, addr)) return false;
+    ::unlink(m_options.unixPath.c_str());
+
+    m_unixListen = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_unixListen < 0 ||
+        ::bind(m_unixListen, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(m_unixListen, 64) != 0) {
+        std::cerr << "[EpollTransport] Unix listen on " << m_options.unixPath << " failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = m_unixListen;
+    return ::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_unixListen, &ev) == 0;
+}
+
+void EpollTransport::stop() {
+    m_stop = true;
+    if (m_wake >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(m_wake, &one, sizeof(one));
+        (void)ignored;
+    }
+    if (m_loop.joinable()) m_loop.join();
+
+    std::vector<std::string> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& [fd, conn] : m_conns) {
+            if (!conn->peerId.empty()) dropped.push_back(conn->peerId);
+            ::close(fd);
+        }
+        m_conns.clear();
+        m_peers.clear();
+    }
+    for (const auto& peer : dropped) {
+        if (m_handlers.onPeerDisconnected) m_handlers.onPeerDisconnected(peer);
+    }
+
+    for (int* fd : {&m_tcpListen, &m_unixListen, &m_wake, &m_epoll}) {
+        if (*fd >= 0) ::close(*fd);
+        *fd = -1;
+    }
+    if (!m_options.unixPath.empty()) ::unlink(m_options.unixPath.c_str());
+}
+
+bool EpollTransport::connect(const std::string& address, int port) {
+    if (m_epoll < 0) return false;
+
+    int fd;
+    int rc;
+    if (address.rfind("unix:", 0) == 0) {
+        sockaddr_un addr;
+        if (!fillUnixAddr(address.substr(5), addr)) return false;
+        fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) return false;
+        rc = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    } else {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        if (::inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) return false;
+        fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) return false;
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        rc = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    }
+
+    if (rc != 0 && errno != EINPROGRESS && errno != EAGAIN) {
+        std::cerr << "[EpollTransport] Connect to " << address << " failed: " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    addConnection(fd, true, rc != 0);
+    return true;
+}
+
+void EpollTransport::addConnection(int fd, bool outbound, bool connecting) {
+    auto conn = std::make_unique<Connection>();
+    conn->fd = fd;
+    conn->outbound = outbound;
+    conn->connecting = connecting;
+
+    // Handshake: our clientId is the first frame
+    conn->out.push_back(pending(std::make_shared<const std::vector<uint8_t>>(
+        m_options.clientId.begin(), m_options.clientId.end())));
+    conn->wantWrite = true;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.fd = fd;
+    if (::epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        ::close(fd);
+        return;
+    }
+    m_conns[fd] = std::move(conn);
+}
+
+bool EpollTransport::enqueueLocked(const std::string& peerId, const Frame& message) {
+    auto peer = m_peers.find(peerId);
+    if (peer == m_peers.end()) return false;
+    auto& conn = *m_conns[peer->second];
+    conn.out.push_back(pending(message)); // Shares the buffer, no copy
+    conn.wantWrite = true;
+    return true;
+}
+
+void EpollTransport::wake() {
+    uint64_t one = 1;
+    ssize_t ignored = ::write(m_wake, &one, sizeof(one));
+    (void)ignored;
+}
+
+bool EpollTransport::send(const std::string& peerId, Frame message) {
+    if (!message) return false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!enqueueLocked(peerId, message)) return false;
+    }
+    wake();
+    return true;
+}
+
+size_t EpollTransport::broadcast(const std::vector<std::string>& peerIds, const Frame& message) {
+    if (!message) return 0;
+    size_t sent = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& peerId : peerIds) sent += enqueueLocked(peerId, message) ? 1 : 0;
+    }
+    if (sent) wake(); // One wakeup for the whole fan-out
+    return sent;
+}
+
+std::vector<std::string> EpollTransport::peers() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> out;
+    out.reserve(m_peers.size());
+    for (const auto& [peerId, fd] : m_peers) out.push_back(peerId);
+    return out;
+}
+
+size_t EpollTransport::peerCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_peers.size();
+}
+
+void EpollTransport::run() {
+    epoll_event events[64];
+    while (!m_stop) {
+        int n = ::epoll_wait(m_epoll, events, 64, 1000);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[EpollTransport] epoll_wait failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < n && !m_stop; i++) {
+            int fd = events[i].data.fd;
+            uint32_t ev = events[i].events;
+
+            if (fd == m_wake) {
+                uint64_t count;
+                ssize_t ignored = ::read(m_wake, &count, sizeof(count));
+                (void)ignored;
+                continue;
+            }
+            if (fd == m_tcpListen || fd == m_unixListen) {
+                accept(fd);
+                continue;
+            }
+            if (ev & (EPOLLERR | EPOLLHUP)) {
+                if (!(ev & EPOLLIN)) {
+                    closeConnection(fd);
+                    continue;
+                }
+            }
+            if (ev & EPOLLIN) onReadable(fd);
+            if (ev & EPOLLOUT) onWritable(fd);
+        }
+
+        // Frames queued by send() on other threads
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& [fd, conn] : m_conns) {
+            if (conn->wantWrite && !conn->connecting) flush(*conn);
+        }
+    }
+}
+
+void EpollTransport::accept(int listenFd) {
+    for (;;) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        if (listenFd == m_tcpListen) {
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        addConnection(fd, false, false);
+    }
+}
+
+void EpollTransport::onReadable(int fd) {
+    std::vector<std::pair<std::string, std::vector<uint8_t>>> messages;
+    std::string handshake;
+    bool closed = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_conns.find(fd);
+        if (it == m_conns.end()) return;
+        Connection& conn = *it->second;
+
+        uint8_t buf[64 * 1024];
+        for (;;) {
+            ssize_t r = ::read(fd, buf, sizeof(buf));
+            if (r > 0) {
+                conn.in.insert(conn.in.end(), buf, buf + r);
+                m_metrics.bytesReceived += static_cast<uint64_t>(r);
+                continue;
+            }
+            if (r < 0 && errno == EINTR) continue;
+            if (r == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) closed = true;
+            break;
+        }
+
+        size_t off = 0;
+        while (conn.in.size() - off >= kLenBytes) {
+            size_t len = 0;
+            for (size_t i = 0; i < kLenBytes; i++) len |= static_cast<size_t>(conn.in[off + i]) << (8 * i);
+            if (len > m_options.maxFrameBytes) {
+                std::cerr << "[EpollTransport] Oversized frame (" << len << " bytes), dropping connection" << std::endl;
+                closed = true;
+                break;
+            }
+            if (conn.in.size() - off - kLenBytes < len) break;
+
+            const uint8_t* payload = conn.in.data() + off + kLenBytes;
+            if (conn.peerId.empty() && handshake.empty()) {
+                handshake.assign(reinterpret_cast<const char*>(payload), len);
+            } else {
+                messages.emplace_back(std::string(), std::vector<uint8_t>(payload, payload + len));
+            }
+            off += kLenBytes + len;
+        }
+        conn.in.erase(conn.in.begin(), conn.in.begin() + static_cast<std::ptrdiff_t>(off));
+    }
+
+    if (!handshake.empty()) onHandshake(fd, handshake);
+
+    std::string peerId;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_conns.find(fd);
+        if (it != m_conns.end()) peerId = it->second->peerId;
+    }
+    if (!peerId.empty() && m_handlers.onMessage) {
+        for (const auto& [unused, message] : messages) {
+            m_handlers.onMessage(peerId, message.data(), message.size());
+        }
+    }
+
+    if (closed) closeConnection(fd);
+}
+
+void EpollTransport::onHandshake(int fd, std::string peerId) {
+    bool announce = false;
+    int drop = -1;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_conns.find(fd);
+        if (it == m_conns.end()) return;
+        Connection& conn = *it->second;
+
+        if (peerId.empty() || peerId == m_options.clientId) {
+            drop = fd; // Nameless peer or a connection to ourselves
+        } else {
+            auto existing = m_peers.find(peerId);
+            if (existing == m_peers.end()) {
+                conn.peerId = peerId;
+                m_peers[peerId] = fd;
+                announce = true;
+            } else {
+                // Both sides dialled each other: keep the connection opened by
+                // the smaller clientId so both ends make the same choice.
+                const std::string& keeper = std::min(m_options.clientId, peerId);
+                bool newIsKeeper = (conn.outbound ? m_options.clientId : peerId) == keeper;
+                if (newIsKeeper) {
+                    drop = existing->second;
+                    m_conns[drop]->peerId.clear();
+                    conn.peerId = peerId;
+                    existing->second = fd;
+                    announce = true; // Frames in flight on the old socket may be lost: resync
+                } else {
+                    drop = fd;
+                }
+            }
+        }
+    }
+
+    if (drop >= 0) closeConnection(drop);
+    if (announce && m_handlers.onPeerConnected) m_handlers.onPeerConnected(peerId);
+}
+
+void EpollTransport::onWritable(int fd) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_conns.find(fd);
+    if (it == m_conns.end()) return;
+    Connection& conn = *it->second;
+
+    if (conn.connecting) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err != 0) {
+            std::cerr << "[EpollTransport] Connect failed: " << std::strerror(err) << std::endl;
+            epoll_event ev{};
+            ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, &ev);
+            ::close(fd);
+            m_conns.erase(it);
+            return;
+        }
+        conn.connecting = false;
+    }
+    flush(conn);
+}
+
+void EpollTransport::flush(Connection& conn) {
+    while (!conn.out.empty()) {
+        // Gather up to kMaxIov queued frames: [prefix][payload] pairs
+        iovec iov[2 * kMaxIov];
+        int n = 0;
+        size_t skip = conn.outOffset;
+        for (auto it = conn.out.begin(); it != conn.out.end() && n < static_cast<int>(2 * kMaxIov); ++it) {
+            const uint8_t* parts[2] = {it->prefix.data(), it->data->data()};
+            size_t lens[2] = {it->prefix.size(), it->data->size()};
+            for (int p = 0; p < 2; p++) {
+                if (skip >= lens[p]) { skip -= lens[p]; continue; }
+                iov[n].iov_base = const_cast<uint8_t*>(parts[p] + skip);
+                iov[n].iov_len = lens[p] - skip;
+                skip = 0;
+                n++;
+            }
+        }
+
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(n);
+        ssize_t w = ::sendmsg(conn.fd, &msg, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            break; // EAGAIN: wait for EPOLLOUT. Hard errors surface as EPOLLERR.
+        }
+        m_metrics.bytesSent += static_cast<uint64_t>(w);
+
+        // Retire fully written frames; the last reference frees the buffer
+        size_t written = conn.outOffset + static_cast<size_t>(w);
+        while (!conn.out.empty() && written >= conn.out.front().size()) {
+            written -= conn.out.front().size();
+            conn.out.pop_front();
+        }
+        conn.outOffset = written;
+    }
+    conn.wantWrite = !conn.out.empty();
+    updateInterest(conn);
+}
+
+void EpollTransport::updateInterest(Connection& conn) {
+    epoll_event ev{};
+    ev.events = EPOLLIN | (conn.wantWrite || conn.connecting ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    ev.data.fd = conn.fd;
+    ::epoll_ctl(m_epoll, EPOLL_CTL_MOD, conn.fd, &ev);
+}
+
+void EpollTransport::closeConnection(int fd) {
+    std::string peerId;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_conns.find(fd);
+        if (it == m_conns.end()) return;
+        peerId = it->second->peerId;
+        if (!peerId.empty()) {
+            auto peer = m_peers.find(peerId);
+            if (peer != m_peers.end() && peer->second == fd) m_peers.erase(peer);
+        }
+        epoll_event ev{};
+        ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, &ev);
+        ::close(fd);
+        m_conns.erase(it);
+    }
+    if (!peerId.empty() && m_handlers.onPeerDisconnected) m_handlers.onPeerDisconnected(peerId);
+}
+
+} // namespace aegis
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "SyncMetrics.h"
+#include "Transport.h"
+#include <array>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace aegis {
+
+/**
+ * EpollTransport
+ * Single-threaded epoll event loop over non-blocking TCP or Unix domain
+ * sockets. Plain length-prefixed frames ([u32 len][payload]), no TLS; the
+ * first frame in each direction is the sender's clientId.
+ *
+ * send() may be called from any thread: it queues the frame and wakes the
+ * loop through an eventfd, which performs all socket I/O. Queued frames are
+ * shared buffers plus a per-connection length prefix, written out with
+ * scatter-gather sendmsg.
+ */
+class EpollTransport : public Transport {
+public:
+    struct Options {
+        std::string clientId;
+        std::string bindAddress = "0.0.0.0";
+        uint16_t port = 0;          // 0 = no TCP listener
+        std::string unixPath;       // empty = no Unix socket listener
+        size_t maxFrameBytes = 64 * 1024 * 1024;
+    };
+
+    EpollTransport(Options options, SyncMetrics& metrics);
+    ~EpollTransport() override;
+
+    bool start(Handlers handlers) override;
+    void stop() override;
+    bool connect(const std::string& address, int port) override;
+    using Transport::send;
+    bool send(const std::string& peerId, Frame message) override;
+    size_t broadcast(const std::vector<std::string>& peerIds, const Frame& message) override;
+    std::vector<std::string> peers() const override;
+    size_t peerCount() const override;
+    const std::string& localId() const override { return m_options.clientId; }
+
+    uint16_t boundPort() const { return m_boundPort; }
+
+private:
+    struct Pending {
+        std::array<uint8_t, 4> prefix; // u32 LE payload length
+        Frame data;
+        size_t size() const { return prefix.size() + data->size(); }
+    };
+
+    struct Connection {
+        int fd = -1;
+        bool outbound = false;
+        bool connecting = false;
+        bool wantWrite = false;
+        std::string peerId;      // set once the handshake frame arrived
+        std::vector<uint8_t> in;
+        std::deque<Pending> out;
+        size_t outOffset = 0;    // bytes of out.front() already written
+    };
+
+    void run();
+    bool listenTcp();
+    bool listenUnix();
+    void accept(int listenFd);
+    void addConnection(int fd, bool outbound, bool connecting);
+    void onReadable(int fd);
+    void onWritable(int fd);
+    void flush(Connection& conn);
+    void updateInterest(Connection& conn);
+    void closeConnection(int fd);
+    void onHandshake(int fd, std::string peerId);
+    bool enqueueLocked(const std::string& peerId, const Frame& message);
+    void wake();
+    static Pending pending(Frame data);
+
+    Options m_options;
+    SyncMetrics& m_metrics;
+    Handlers m_handlers;
+
+    int m_epoll = -1;
+    int m_wake = -1;
+    int m_tcpListen = -1;
+    int m_unixListen = -1;
+    uint16_t m_boundPort = 0;
+
+    mutable std::mutex m_mutex;
+    std::map<int, std::unique_ptr<Connection>> m_conns; // by fd
+    std::map<std::string, int> m_peers;                 // peerId -> fd
+
+    std::atomic<bool> m_stop{false};
+    std::thread m_loop;
+};
+
+} // namespace aegis
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace aegis {
+
+/**
+ * HybridClock
+ * 64-bit hybrid logical clock: [48-bit physical ms][16-bit logical].
+ * Stamps are strictly increasing per node, and a stamp taken after
+ * observing a remote one is larger than it, while staying within clock
+ * skew of wall time. Ordering two versions is one integer compare.
+ */
+class HybridClock {
+public:
+    static constexpr int kLogicalBits = 16;
+    static constexpr int64_t kMaxDriftMs = 60 * 1000; // reject remote stamps further ahead
+
+    static uint64_t pack(int64_t ms, uint32_t logical) {
+        return (static_cast<uint64_t>(ms) << kLogicalBits) | (logical & ((1u << kLogicalBits) - 1));
+    }
+    static int64_t physicalMs(uint64_t hlc) { return static_cast<int64_t>(hlc >> kLogicalBits); }
+
+    // Metadata written before HLCs carried plain epoch milliseconds (< 2^47);
+    // packed stamps are always larger.
+    static uint64_t normalize(int64_t timestamp) {
+        if (timestamp <= 0) return 0;
+        return timestamp < (int64_t(1) << 47) ? pack(timestamp, 0) : static_cast<uint64_t>(timestamp);
+    }
+
+    // Local event (write or send)
+    uint64_t now() {
+        uint64_t last = m_last.load(std::memory_order_relaxed);
+        for (;;) {
+            uint64_t next = std::max(last + 1, pack(wallMs(), 0));
+            if (m_last.compare_exchange_weak(last, next, std::memory_order_relaxed)) return next;
+        }
+    }
+
+    // Receive: merge a remote stamp so later local stamps order after it.
+    // Returns false (clock untouched) if it runs too far ahead of wall time.
+    bool observe(uint64_t remote) {
+        int64_t wall = wallMs();
+        if (physicalMs(remote) > wall + kMaxDriftMs) return false;
+        uint64_t last = m_last.load(std::memory_order_relaxed);
+        while (last < remote) {
+            if (m_last.compare_exchange_weak(last, remote, std::memory_order_relaxed)) break;
+        }
+        return true;
+    }
+
+    uint64_t last() const { return m_last.load(std::memory_order_relaxed); }
+
+private:
+    static int64_t wallMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::atomic<uint64_t> m_last{0};
+};
+
+// Compact causality metadata kept per key: HLC plus an index into the local
+// client registry (MerkleIndex::clientIndex).
+struct VersionStamp {
+    uint64_t hlc = 0;
+    uint32_t client = 0;
+};
+
+} // namespace aegis
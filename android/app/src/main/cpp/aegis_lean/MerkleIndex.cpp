@@ -0,0 +1,442 @@
+#include "MerkleIndex.h"
+#include "sqlite3.h"
+#include <iostream>
+
+namespace aegis {
+
+namespace {
+
+#define MERKLE_ITEMS_COLUMNS \
+    "  key TEXT PRIMARY KEY,"        \
+    "  leaf INTEGER NOT NULL,"       \
+    "  hash INTEGER NOT NULL,"       \
+    "  hlc INTEGER NOT NULL,"        \
+    "  client INTEGER NOT NULL"
+
+const char* kSchema =
+    "CREATE TABLE IF NOT EXISTS merkle_clients ("
+    "  idx INTEGER PRIMARY KEY,"
+    "  client_id TEXT NOT NULL UNIQUE"
+    ");"
+    "CREATE TABLE IF NOT EXISTS merkle_items (" MERKLE_ITEMS_COLUMNS ") WITHOUT ROWID;"
+    "CREATE INDEX IF NOT EXISTS merkle_items_leaf ON merkle_items (leaf);"
+    "CREATE INDEX IF NOT EXISTS merkle_items_writer ON merkle_items (client, hlc);";
+
+// Pre-HLC layout stored (ts ms, client TEXT) per key: intern the clients,
+// lift millisecond timestamps into HLC space and swap the table in place.
+const char* kMigrateFromTs =
+    "BEGIN IMMEDIATE;"
+    "INSERT OR IGNORE INTO merkle_clients (client_id) SELECT DISTINCT client FROM merkle_items;"
+    "CREATE TABLE merkle_items_v2 (" MERKLE_ITEMS_COLUMNS ") WITHOUT ROWID;"
+    "INSERT INTO merkle_items_v2 (key, leaf, hash, hlc, client)"
+    "  SELECT m.key, m.leaf, m.hash,"
+    "         CASE WHEN m.ts > 0 AND m.ts < 140737488355328 THEN m.ts << 16 ELSE m.ts END,"
+    "         c.idx"
+    "  FROM merkle_items m JOIN merkle_clients c ON c.client_id = m.client;"
+    "DROP TABLE merkle_items;"
+    "ALTER TABLE merkle_items_v2 RENAME TO merkle_items;"
+    "COMMIT;";
+
+#undef MERKLE_ITEMS_COLUMNS
+
+bool prepare(sqlite3* db, const char* sql, sqlite3_stmt** stmt) {
+    if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "[MerkleIndex] Prepare failed: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+uint64_t fnv1a(const uint8_t* data, size_t len, uint64_t h = 0xcbf29ce484222325ULL) {
+    for (size_t i = 0; i < len; i++) {
+        h ^= data[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// splitmix64 finaliser: spreads FNV output over all 64 bits
+uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+uint64_t keyHash(std::string_view key) {
+    return mix(fnv1a(reinterpret_cast<const uint8_t*>(key.data()), key.size()));
+}
+
+} // namespace
+
+MerkleIndex::~MerkleIndex() {
+    close();
+}
+
+size_t MerkleIndex::levelOffset(uint32_t level) {
+    size_t offset = 0;
+    size_t width = 1;
+    for (uint32_t l = 0; l < level; l++) {
+        offset += width;
+        width *= kFanout;
+    }
+    return offset;
+}
+
+uint32_t MerkleIndex::leafOf(std::string_view key) {
+    return static_cast<uint32_t>(keyHash(key) >> (64 - 12)) % kLeaves;
+}
+
+uint64_t MerkleIndex::itemHash(const std::string& key, const uint8_t* data, size_t len) {
+    uint64_t h = keyHash(key);
+    h = mix(fnv1a(data, len, h ^ 0x9e3779b97f4a7c15ULL));
+    return h ? h : 1; // 0 is reserved for "absent"
+}
+
+bool MerkleIndex::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_db) return true;
+
+    if (sqlite3_open(path.c_str(), &m_db) != SQLITE_OK) {
+        std::cerr << "[MerkleIndex] Open failed: " << sqlite3_errmsg(m_db) << std::endl;
+        sqlite3_close(m_db);
+        m_db = nullptr;
+        return false;
+    }
+
+    // Shares the sidecar file with AppendLog (separate connection)
+    sqlite3_busy_timeout(m_db, 5000);
+    sqlite3_exec(m_db, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr);
+    if (sqlite3_exec(m_db, kSchema, nullptr, nullptr, nullptr) != SQLITE_OK || !migrateLocked() ||
+        !prepare(m_db, "SELECT hash, hlc, client FROM merkle_items WHERE key = ?", &m_lookup) ||
+        !prepare(m_db,
+                 "INSERT INTO merkle_items (key, leaf, hash, hlc, client) VALUES (?, ?, ?, ?, ?) "
+                 "ON CONFLICT (key) DO UPDATE SET hash = excluded.hash, hlc = excluded.hlc, client = excluded.client",
+                 &m_upsert) ||
+        !prepare(m_db, "DELETE FROM merkle_items WHERE key = ?", &m_delete) ||
+        !prepare(m_db, "SELECT key, hash, hlc, client FROM merkle_items WHERE leaf = ?", &m_leaf) ||
+        !prepare(m_db,
+                 "SELECT key, hash, hlc FROM merkle_items WHERE client = ? AND hlc > ? AND hlc <= ? "
+                 "ORDER BY hlc LIMIT ?",
+                 &m_writtenBy) ||
+        !prepare(m_db, "INSERT INTO merkle_clients (client_id) VALUES (?)", &m_addClient) ||
+        !loadClientsLocked()) {
+        std::cerr << "[MerkleIndex] Schema setup failed: " << sqlite3_errmsg(m_db) << std::endl;
+        sqlite3_close_v2(m_db);
+        m_db = nullptr;
+        return false;
+    }
+
+    rebuildLocked();
+    return true;
+}
+
+void MerkleIndex::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto* stmt : {m_lookup, m_upsert, m_delete, m_leaf, m_writtenBy, m_addClient}) {
+        sqlite3_finalize(stmt);
+    }
+    m_lookup = m_upsert = m_delete = m_leaf = m_writtenBy = m_addClient = nullptr;
+    if (m_db) {
+        sqlite3_close_v2(m_db);
+        m_db = nullptr;
+    }
+    m_nodes.clear();
+    m_clientNames.clear();
+    m_clients.clear();
+}
+
+void MerkleIndex::rebuildLocked() {
+    // Leaves from the table, parents by folding children
+    m_nodes.assign(levelOffset(kDepth + 1), Digest{});
+    sqlite3_stmt* scan = nullptr;
+    if (sqlite3_prepare_v2(m_db, "SELECT leaf, hash FROM merkle_items", -1, &scan, nullptr) == SQLITE_OK) {
+        Digest* leaves = &m_nodes[levelOffset(kDepth)];
+        while (sqlite3_step(scan) == SQLITE_ROW) {
+            auto leaf = static_cast<uint32_t>(sqlite3_column_int64(scan, 0)) % kLeaves;
+            leaves[leaf].hash ^= static_cast<uint64_t>(sqlite3_column_int64(scan, 1));
+            leaves[leaf].count++;
+        }
+    }
+    sqlite3_finalize(scan);
+    for (uint32_t level = kDepth; level > 0; level--) {
+        size_t width = levelOffset(level + 1) - levelOffset(level);
+        Digest* child = &m_nodes[levelOffset(level)];
+        Digest* parent = &m_nodes[levelOffset(level - 1)];
+        for (size_t i = 0; i < width; i++) {
+            parent[i / kFanout].hash ^= child[i].hash;
+            parent[i / kFanout].count += child[i].count;
+        }
+    }
+}
+
+bool MerkleIndex::migrateLocked() {
+    // CREATE IF NOT EXISTS above leaves an old table alone; detect it by column
+    sqlite3_stmt* probe = nullptr;
+    bool legacy = sqlite3_prepare_v2(m_db, "SELECT ts FROM merkle_items LIMIT 0", -1, &probe, nullptr) == SQLITE_OK;
+    sqlite3_finalize(probe);
+    if (!legacy) return true;
+
+    if (sqlite3_exec(m_db, kMigrateFromTs, nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "[MerkleIndex] Migration failed: " << sqlite3_errmsg(m_db) << std::endl;
+        sqlite3_exec(m_db, "ROLLBACK", nullptr, nullptr, nullptr);
+        return false;
+    }
+    // The leaf index went with the old table
+    sqlite3_exec(m_db, kSchema, nullptr, nullptr, nullptr);
+    std::cout << "[MerkleIndex] Migrated items to HLC stamps" << std::endl;
+    return true;
+}
+
+bool MerkleIndex::loadClientsLocked() {
+    m_clientNames.assign(1, std::string());
+    m_clients.clear();
+    sqlite3_stmt* scan = nullptr;
+    if (sqlite3_prepare_v2(m_db, "SELECT idx, client_id FROM merkle_clients", -1, &scan, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    while (sqlite3_step(scan) == SQLITE_ROW) {
+        auto idx = static_cast<uint32_t>(sqlite3_column_int64(scan, 0));
+        auto* name = reinterpret_cast<const char*>(sqlite3_column_text(scan, 1));
+        if (!idx || !name) continue;
+        if (idx >= m_clientNames.size()) m_clientNames.resize(idx + 1);
+        m_clientNames[idx] = name;
+        m_clients[name] = idx;
+    }
+    sqlite3_finalize(scan);
+    return true;
+}
+
+uint32_t MerkleIndex::clientIndexLocked(const std::string& clientId) {
+    auto it = m_clients.find(clientId);
+    if (it != m_clients.end()) return it->second;
+    if (!m_db) return 0;
+
+    sqlite3_bind_text(m_addClient, 1, clientId.data(), static_cast<int>(clientId.size()), SQLITE_STATIC);
+    int rc = sqlite3_step(m_addClient);
+    sqlite3_reset(m_addClient);
+    sqlite3_clear_bindings(m_addClient);
+    if (rc != SQLITE_DONE) {
+        std::cerr << "[MerkleIndex] Client registration failed: " << sqlite3_errmsg(m_db) << std::endl;
+        return 0;
+    }
+    auto idx = static_cast<uint32_t>(sqlite3_last_insert_rowid(m_db));
+    if (idx >= m_clientNames.size()) m_clientNames.resize(idx + 1);
+    m_clientNames[idx] = clientId;
+    m_clients.emplace(clientId, idx);
+    return idx;
+}
+
+uint32_t MerkleIndex::clientIndex(const std::string& clientId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return clientIndexLocked(clientId);
+}
+
+std::string MerkleIndex::clientName(uint32_t index) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return index < m_clientNames.size() ? m_clientNames[index] : std::string();
+}
+
+bool MerkleIndex::tieBreakLocked(const VersionStamp& a, const VersionStamp& b) const {
+    // Same HLC from two writers: order by id, which every replica agrees on
+    auto name = [this](uint32_t idx) -> const std::string& {
+        static const std::string empty;
+        return idx < m_clientNames.size() ? m_clientNames[idx] : empty;
+    };
+    return name(a.client) > name(b.client);
+}
+
+bool MerkleIndex::tieBreak(const VersionStamp& a, const VersionStamp& b) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return tieBreakLocked(a, b);
+}
+
+std::optional<VersionStamp> MerkleIndex::stampLocked(std::string_view key, uint64_t* hash) {
+    std::optional<VersionStamp> out;
+    sqlite3_bind_text(m_lookup, 1, key.data(), static_cast<int>(key.size()), SQLITE_STATIC);
+    if (sqlite3_step(m_lookup) == SQLITE_ROW) {
+        if (hash) *hash = static_cast<uint64_t>(sqlite3_column_int64(m_lookup, 0));
+        out = VersionStamp{static_cast<uint64_t>(sqlite3_column_int64(m_lookup, 1)),
+                           static_cast<uint32_t>(sqlite3_column_int64(m_lookup, 2))};
+    }
+    sqlite3_reset(m_lookup);
+    sqlite3_clear_bindings(m_lookup);
+    return out;
+}
+
+std::optional<VersionStamp> MerkleIndex::stamp(const std::string& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_db) return std::nullopt;
+    return stampLocked(key);
+}
+
+std::vector<std::optional<VersionStamp>> MerkleIndex::stamps(const std::vector<std::string_view>& keys,
+                                                             std::vector<uint64_t>* hashes) {
+    std::vector<std::optional<VersionStamp>> out(keys.size());
+    if (hashes) hashes->assign(keys.size(), 0);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_db) return out;
+    // One snapshot instead of a read transaction per lookup
+    bool txn = keys.size() > 1 && sqlite3_exec(m_db, "BEGIN", nullptr, nullptr, nullptr) == SQLITE_OK;
+    for (size_t i = 0; i < keys.size(); i++) {
+        out[i] = stampLocked(keys[i], hashes ? &(*hashes)[i] : nullptr);
+    }
+    if (txn) sqlite3_exec(m_db, "COMMIT", nullptr, nullptr, nullptr);
+    return out;
+}
+
+bool MerkleIndex::admit(const std::string& key, const VersionStamp& incoming) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_db) return true;
+    auto current = stampLocked(key);
+    if (!current) return true;
+    if (incoming.hlc != current->hlc) return incoming.hlc > current->hlc;
+    return incoming.client != current->client && tieBreakLocked(incoming, *current);
+}
+
+void MerkleIndex::applyDelta(uint32_t leaf, uint64_t hashDelta, int countDelta) {
+    // XOR is its own inverse: the same delta updates every ancestor
+    uint32_t index = leaf;
+    for (uint32_t level = kDepth + 1; level-- > 0;) {
+        auto& node = m_nodes[levelOffset(level) + index];
+        node.hash ^= hashDelta;
+        node.count = static_cast<uint32_t>(static_cast<int64_t>(node.count) + countDelta);
+        index /= kFanout;
+    }
+}
+
+bool MerkleIndex::updateLocked(std::string_view key, uint64_t hash, const VersionStamp& stamp) {
+    uint64_t oldHash = 0;
+    auto current = stampLocked(key, &oldHash);
+    if (current && oldHash == hash && current->hlc == stamp.hlc && current->client == stamp.client) {
+        return true;
+    }
+
+    uint32_t leaf = leafOf(key);
+    sqlite3_bind_text(m_upsert, 1, key.data(), static_cast<int>(key.size()), SQLITE_STATIC);
+    sqlite3_bind_int64(m_upsert, 2, leaf);
+    sqlite3_bind_int64(m_upsert, 3, static_cast<sqlite3_int64>(hash));
+    sqlite3_bind_int64(m_upsert, 4, static_cast<sqlite3_int64>(stamp.hlc));
+    sqlite3_bind_int64(m_upsert, 5, stamp.client);
+    int rc = sqlite3_step(m_upsert);
+    sqlite3_reset(m_upsert);
+    sqlite3_clear_bindings(m_upsert);
+    if (rc != SQLITE_DONE) {
+        std::cerr << "[MerkleIndex] Update failed: " << sqlite3_errmsg(m_db) << std::endl;
+        return false;
+    }
+
+    applyDelta(leaf, oldHash ^ hash, oldHash ? 0 : 1);
+    return true;
+}
+
+void MerkleIndex::update(const std::string& key, const std::vector<uint8_t>& data, const VersionStamp& stamp) {
+    uint64_t hash = itemHash(key, data.data(), data.size());
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_db) return;
+    updateLocked(key, hash, stamp);
+}
+
+void MerkleIndex::updateBatch(const std::vector<Update>& updates) {
+    if (updates.empty()) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_db) return;
+    if (sqlite3_exec(m_db, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "[MerkleIndex] Batch begin failed: " << sqlite3_errmsg(m_db) << std::endl;
+        return;
+    }
+    // Tree deltas are applied per row as it lands; a failed row is skipped
+    // (its summary stays at the old value) rather than failing the batch
+    for (const auto& update : updates) {
+        updateLocked(update.key, update.hash, update.stamp);
+    }
+    if (sqlite3_exec(m_db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "[MerkleIndex] Batch commit failed: " << sqlite3_errmsg(m_db) << std::endl;
+        sqlite3_exec(m_db, "ROLLBACK", nullptr, nullptr, nullptr);
+        rebuildLocked(); // drop the deltas of the rolled-back rows
+    }
+}
+
+void MerkleIndex::remove(const std::string& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_db) return;
+
+    uint64_t oldHash = 0;
+    stampLocked(key, &oldHash);
+    if (!oldHash) return;
+
+    sqlite3_bind_text(m_delete, 1, key.data(), static_cast<int>(key.size()), SQLITE_STATIC);
+    int rc = sqlite3_step(m_delete);
+    sqlite3_reset(m_delete);
+    sqlite3_clear_bindings(m_delete);
+    if (rc == SQLITE_DONE) applyDelta(leafOf(key), oldHash, -1);
+}
+
+MerkleIndex::Digest MerkleIndex::root() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nodes.empty() ? Digest{} : m_nodes[0];
+}
+
+std::array<MerkleIndex::Digest, MerkleIndex::kFanout> MerkleIndex::children(uint32_t level, uint32_t index) const {
+    std::array<Digest, kFanout> out{};
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_nodes.empty() || level >= kDepth) return out;
+    size_t width = levelOffset(level + 1) - levelOffset(level);
+    if (index >= width) return out;
+    const Digest* first = &m_nodes[levelOffset(level + 1) + static_cast<size_t>(index) * kFanout];
+    for (uint32_t i = 0; i < kFanout; i++) out[i] = first[i];
+    return out;
+}
+
+std::vector<MerkleIndex::Item> MerkleIndex::leafItems(uint32_t leaf) {
+    std::vector<Item> out;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_db || leaf >= kLeaves) return out;
+    sqlite3_bind_int64(m_leaf, 1, leaf);
+    while (sqlite3_step(m_leaf) == SQLITE_ROW) {
+        Item item;
+        auto* key = reinterpret_cast<const char*>(sqlite3_column_text(m_leaf, 0));
+        auto client = static_cast<uint32_t>(sqlite3_column_int64(m_leaf, 3));
+        if (key) item.key = key;
+        item.hash = static_cast<uint64_t>(sqlite3_column_int64(m_leaf, 1));
+        item.meta.timestamp = sqlite3_column_int64(m_leaf, 2);
+        if (client < m_clientNames.size()) item.meta.clientId = m_clientNames[client];
+        out.push_back(std::move(item));
+    }
+    sqlite3_reset(m_leaf);
+    sqlite3_clear_bindings(m_leaf);
+    return out;
+}
+
+std::vector<MerkleIndex::Item> MerkleIndex::writtenBy(uint32_t client, uint64_t afterHlc, uint64_t toHlc,
+                                                      size_t limit) {
+    std::vector<Item> out;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_db || limit == 0) return out;
+    sqlite3_bind_int64(m_writtenBy, 1, client);
+    sqlite3_bind_int64(m_writtenBy, 2, static_cast<int64_t>(afterHlc));
+    sqlite3_bind_int64(m_writtenBy, 3, static_cast<int64_t>(toHlc));
+    sqlite3_bind_int64(m_writtenBy, 4, static_cast<int64_t>(limit));
+    const std::string& clientId = client < m_clientNames.size() ? m_clientNames[client] : std::string();
+    while (sqlite3_step(m_writtenBy) == SQLITE_ROW) {
+        Item item;
+        auto* key = reinterpret_cast<const char*>(sqlite3_column_text(m_writtenBy, 0));
+        if (key) item.key = key;
+        item.hash = static_cast<uint64_t>(sqlite3_column_int64(m_writtenBy, 1));
+        item.meta.timestamp = sqlite3_column_int64(m_writtenBy, 2);
+        item.meta.clientId = clientId;
+        out.push_back(std::move(item));
+    }
+    sqlite3_reset(m_writtenBy);
+    sqlite3_clear_bindings(m_writtenBy);
+    return out;
+}
+
+size_t MerkleIndex::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nodes.empty() ? 0 : m_nodes[0].count;
+}
+
+} // namespace aegis
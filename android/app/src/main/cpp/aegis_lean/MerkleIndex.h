@@ -0,0 +1,134 @@
+#pragma once
+
+#include "HybridClock.h"
+#include "storage/storage_manager.h"
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace aegis {
+
+/**
+ * MerkleIndex
+ * Range-hash summary of the document keyspace for anti-entropy. Keys map to
+ * one of kLeaves leaves by hash; every node holds the XOR of the item hashes
+ * below it (item hash = H(key, value)) plus an item count, so a write only
+ * touches the kDepth + 1 nodes on its path.
+ *
+ * Two replicas compare root children, descend only into differing ranges
+ * and exchange (key, hash) lists for differing leaves. Work is proportional
+ * to the difference, not the keyspace.
+ *
+ * Per-key hashes and the VersionStamp of the summarised version are
+ * persisted in a merkle_items table; the tree is rebuilt from it on open.
+ * Client ids are interned in a clients table so a stamp is two integers,
+ * and admitting a remote version is one HLC compare (ties fall back to the
+ * client id string). Tables from before HLC stamps are migrated on open.
+ */
+class MerkleIndex {
+public:
+    static constexpr uint32_t kFanout = 16;
+    static constexpr uint32_t kDepth = 3;   // levels below the root
+    static constexpr uint32_t kLeaves = 4096; // kFanout ^ kDepth
+
+    struct Digest {
+        uint64_t hash = 0;
+        uint32_t count = 0;
+        bool operator==(const Digest& o) const { return hash == o.hash && count == o.count; }
+        bool operator!=(const Digest& o) const { return !(*this == o); }
+    };
+
+    struct Update {
+        std::string_view key;
+        uint64_t hash = 0; // itemHash of the new value
+        VersionStamp stamp;
+    };
+
+    struct Item {
+        std::string key;
+        uint64_t hash = 0;
+        storage::SyncMetadata meta; // timestamp carries the HLC
+    };
+
+    MerkleIndex() = default;
+    ~MerkleIndex();
+    MerkleIndex(const MerkleIndex&) = delete;
+    MerkleIndex& operator=(const MerkleIndex&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    // Records the current value of key (local write or accepted remote update).
+    void update(const std::string& key, const std::vector<uint8_t>& data, const VersionStamp& stamp);
+    // Records several values in one transaction.
+    void updateBatch(const std::vector<Update>& updates);
+    void remove(const std::string& key);
+
+    // Stable local index for clientId (0 = unknown); persisted on first use.
+    uint32_t clientIndex(const std::string& clientId);
+    std::string clientName(uint32_t index) const;
+
+    std::optional<VersionStamp> stamp(const std::string& key);
+    // Stamps of many keys (nullopt where absent) in one read transaction;
+    // hashes, if given, gets their item hashes alongside.
+    std::vector<std::optional<VersionStamp>> stamps(const std::vector<std::string_view>& keys,
+                                                    std::vector<uint64_t>* hashes = nullptr);
+    // True if incoming orders after the recorded version of key (or there is none).
+    bool admit(const std::string& key, const VersionStamp& incoming);
+    // Last-writer-wins order: HLC, then client id
+    bool newer(const VersionStamp& a, const VersionStamp& b) const {
+        if (a.hlc != b.hlc) return a.hlc > b.hlc;
+        return a.client != b.client && tieBreak(a, b);
+    }
+
+    Digest root() const;
+    // Children of node `index` at `level` (level < kDepth).
+    std::array<Digest, kFanout> children(uint32_t level, uint32_t index) const;
+    std::vector<Item> leafItems(uint32_t leaf);
+    // One page of the keys whose recorded version client wrote with an HLC
+    // in (afterHlc, toHlc], oldest first; pass the last hlc as afterHlc
+    // for the next page.
+    std::vector<Item> writtenBy(uint32_t client, uint64_t afterHlc, uint64_t toHlc, size_t limit);
+    size_t size() const;
+
+    static uint32_t leafOf(std::string_view key);
+    static uint64_t itemHash(const std::string& key, const uint8_t* data, size_t len);
+
+private:
+    bool migrateLocked();
+    void rebuildLocked();
+    bool loadClientsLocked();
+    uint32_t clientIndexLocked(const std::string& clientId);
+    std::optional<VersionStamp> stampLocked(std::string_view key, uint64_t* hash = nullptr);
+    bool tieBreak(const VersionStamp& a, const VersionStamp& b) const;
+    bool tieBreakLocked(const VersionStamp& a, const VersionStamp& b) const;
+    bool updateLocked(std::string_view key, uint64_t hash, const VersionStamp& stamp);
+    void applyDelta(uint32_t leaf, uint64_t hashDelta, int countDelta);
+    static size_t levelOffset(uint32_t level);
+
+    mutable std::mutex m_mutex;
+    sqlite3* m_db = nullptr;
+    sqlite3_stmt* m_lookup = nullptr;
+    sqlite3_stmt* m_upsert = nullptr;
+    sqlite3_stmt* m_delete = nullptr;
+    sqlite3_stmt* m_leaf = nullptr;
+    sqlite3_stmt* m_writtenBy = nullptr;
+    sqlite3_stmt* m_addClient = nullptr;
+
+    // Client registry: index -> id (slot 0 unused) and id -> index
+    std::vector<std::string> m_clientNames;
+    std::unordered_map<std::string, uint32_t> m_clients;
+
+    // All levels, root first: level L holds kFanout^L nodes
+    std::vector<Digest> m_nodes;
+};
+
+} // namespace aegis
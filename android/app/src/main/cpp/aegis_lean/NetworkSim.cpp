@@ -0,0 +1,344 @@
+#include "NetworkSim.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace aegis {
+
+SimNetwork::SimNetwork(NetworkSimConfig config)
+    : m_config(config), m_rngState(config.seed ^ 0x9e3779b97f4a7c15ULL) {}
+
+SimNetwork::~SimNetwork() {
+    stopRealtime();
+}
+
+SimNetwork& SimNetwork::shared(const NetworkSimConfig& config) {
+    static SimNetwork network(config);
+    static std::once_flag started;
+    std::call_once(started, [] {
+        network.startRealtime();
+        std::cout << "[NetworkSim] Shared simulated network started (seed " << network.m_config.seed << ")"
+                  << std::endl;
+    });
+    return network;
+}
+
+int64_t SimNetwork::nowUs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nowUs;
+}
+
+void SimNetwork::setLinkProfile(const std::string& from, const std::string& to, const LinkProfile& profile) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_profiles[Pair(from, to)] = profile;
+}
+
+const LinkProfile& SimNetwork::profileLocked(const std::string& from, const std::string& to) const {
+    auto it = m_profiles.find(Pair(from, to));
+    return it != m_profiles.end() ? it->second : m_config.link;
+}
+
+double SimNetwork::uniformLocked() {
+    // splitmix64: same sequence on every platform, unlike <random> distributions
+    uint64_t z = (m_rngState += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return static_cast<double>(z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+int64_t SimNetwork::sampleLatencyUsLocked(const LinkProfile& profile) {
+    double ms = profile.latencyMs;
+    switch (profile.latencyModel) {
+    case LatencyModel::Fixed:
+        break;
+    case LatencyModel::Uniform:
+        ms += (2.0 * uniformLocked() - 1.0) * profile.jitterMs;
+        break;
+    case LatencyModel::Normal: {
+        // Box-Muller
+        double u1 = 1.0 - uniformLocked(); // (0, 1]
+        double u2 = uniformLocked();
+        ms += std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2) * profile.jitterMs;
+        break;
+    }
+    case LatencyModel::Pareto: {
+        double u = 1.0 - uniformLocked();
+        ms += profile.jitterMs * std::min(1.0 / std::sqrt(u) - 1.0, 1000.0);
+        break;
+    }
+    }
+    return static_cast<int64_t>(std::max(ms, 0.0) * 1000.0);
+}
+
+void SimNetwork::pushLocked(int64_t timeUs, std::function<void()> fn) {
+    m_events.push(Event{std::max(timeUs, m_nowUs), m_seq++, std::move(fn)});
+}
+
+void SimNetwork::schedule(int64_t delayUs, std::function<void()> fn) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pushLocked(m_nowUs + delayUs, std::move(fn));
+}
+
+bool SimNetwork::crossesPartitionLocked(const std::string& a, const std::string& b) const {
+    if (m_partition.empty()) return false;
+    return m_partition.count(a) != m_partition.count(b);
+}
+
+void SimNetwork::notifyLocked(const std::string& nodeId, const std::string& peerId, bool connected, uint64_t epoch) {
+    pushLocked(m_nowUs, [this, nodeId, peerId, connected, epoch] {
+        std::function<void(const std::string&)> handler;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto node = m_nodes.find(nodeId);
+            if (node == m_nodes.end()) return;
+            if (connected) {
+                // Superseded before it was reported: the disconnect follows anyway
+                auto it = m_connected.find(pairOf(nodeId, peerId));
+                if (it == m_connected.end() || it->second != epoch) return;
+            }
+            handler = connected ? node->second.onPeerConnected : node->second.onPeerDisconnected;
+        }
+        if (handler) handler(peerId);
+    });
+}
+
+void SimNetwork::establishLocked(const Pair& pair, const std::string& from) {
+    uint64_t epoch = ++m_epoch;
+    m_connected[pair] = epoch;
+    m_links[Pair(pair.first, pair.second)] = Link{m_nowUs, m_nowUs};
+    m_links[Pair(pair.second, pair.first)] = Link{m_nowUs, m_nowUs};
+    m_stats.connects++;
+    // Acceptor learns first, as with a handshake
+    const std::string& to = pair.first == from ? pair.second : pair.first;
+    notifyLocked(to, from, true, epoch);
+    notifyLocked(from, to, true, epoch);
+}
+
+void SimNetwork::dropLocked(const Pair& pair) {
+    auto it = m_connected.find(pair);
+    if (it == m_connected.end()) return;
+    m_connected.erase(it);
+    m_stats.disconnects++;
+    notifyLocked(pair.first, pair.second, false, 0);
+    notifyLocked(pair.second, pair.first, false, 0);
+}
+
+bool SimNetwork::attach(const std::string& nodeId, Transport::Handlers handlers) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (nodeId.empty() || m_nodes.count(nodeId)) return false;
+    m_nodes[nodeId] = std::move(handlers);
+    return true;
+}
+
+void SimNetwork::detach(const std::string& nodeId) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_nodes.erase(nodeId)) return;
+        for (auto it = m_connected.begin(); it != m_connected.end();) {
+            if (it->first.first == nodeId || it->first.second == nodeId) {
+                const std::string& peer = it->first.first == nodeId ? it->first.second : it->first.first;
+                notifyLocked(peer, nodeId, false, 0);
+                m_stats.disconnects++;
+                it = m_connected.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    // No handler of this node runs once we return
+    std::lock_guard<std::recursive_mutex> wait(m_dispatch);
+}
+
+bool SimNetwork::connect(const std::string& from, const std::string& to) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (from == to || !m_nodes.count(from) || !m_nodes.count(to) || crossesPartitionLocked(from, to)) return false;
+    Pair pair = pairOf(from, to);
+    if (m_connected.count(pair) || !m_pending.insert(pair).second) return true;
+
+    // Handshake takes one sampled one-way delay
+    int64_t delay = sampleLatencyUsLocked(profileLocked(from, to));
+    pushLocked(m_nowUs + delay, [this, pair, from] {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.erase(pair);
+        if (!m_nodes.count(pair.first) || !m_nodes.count(pair.second) ||
+            crossesPartitionLocked(pair.first, pair.second) || m_connected.count(pair)) {
+            return;
+        }
+        establishLocked(pair, from);
+    });
+    return true;
+}
+
+bool SimNetwork::send(const std::string& from, const std::string& to, const Transport::Frame& message) {
+    if (!message) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Pair pair = pairOf(from, to);
+    auto conn = m_connected.find(pair);
+    if (conn == m_connected.end()) return false;
+    uint64_t epoch = conn->second;
+
+    size_t bytes = message->size();
+    m_stats.messagesSent++;
+    m_stats.bytesSent += bytes;
+
+    const LinkProfile& profile = profileLocked(from, to);
+    Link& link = m_links[Pair(from, to)];
+    int64_t txUs = profile.bandwidthKbps > 0
+        ? static_cast<int64_t>(static_cast<double>(bytes) * 8.0 * 1000.0 / profile.bandwidthKbps)
+        : 0;
+    int64_t departUs = std::max(m_nowUs, link.busyUntilUs) + txUs;
+    link.busyUntilUs = departUs;
+
+    bool lost = profile.lossRate > 0 && uniformLocked() < profile.lossRate;
+    if (lost && !profile.reliable) {
+        m_stats.messagesLost++;
+        return true; // the sender cannot tell
+    }
+
+    int64_t latencyUs = sampleLatencyUsLocked(profile);
+    int64_t arrivalUs = departUs + latencyUs;
+    if (lost) {
+        // One retransmission timeout (floor 200 ms, as TCP's minimum RTO)
+        m_stats.retransmits++;
+        arrivalUs += std::max<int64_t>(200 * 1000, 2 * latencyUs);
+    }
+    bool reorder = !profile.reliable && profile.reorderRate > 0 && uniformLocked() < profile.reorderRate;
+    if (!reorder) arrivalUs = std::max(arrivalUs, link.lastArrivalUs);
+    link.lastArrivalUs = std::max(link.lastArrivalUs, arrivalUs);
+
+    pushLocked(arrivalUs, [this, from, to, pair, epoch, message] {
+        std::function<void(const std::string&, const uint8_t*, size_t)> handler;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto conn = m_connected.find(pair);
+            auto node = m_nodes.find(to);
+            if (conn == m_connected.end() || conn->second != epoch || node == m_nodes.end()) {
+                m_stats.messagesCut++;
+                return;
+            }
+            m_stats.messagesDelivered++;
+            m_stats.bytesDelivered += message->size();
+            handler = node->second.onMessage;
+        }
+        if (handler) handler(from, message->data(), message->size());
+    });
+    return true;
+}
+
+std::vector<std::string> SimNetwork::peersOf(const std::string& nodeId) const {
+    std::vector<std::string> out;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& [pair, epoch] : m_connected) {
+        if (pair.first == nodeId) out.push_back(pair.second);
+        else if (pair.second == nodeId) out.push_back(pair.first);
+    }
+    return out;
+}
+
+size_t SimNetwork::peerCountOf(const std::string& nodeId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = 0;
+    for (const auto& [pair, epoch] : m_connected) {
+        count += pair.first == nodeId || pair.second == nodeId;
+    }
+    return count;
+}
+
+void SimNetwork::partition(const std::vector<std::string>& side) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_partition = std::set<std::string>(side.begin(), side.end());
+    std::vector<Pair> cut;
+    for (const auto& [pair, epoch] : m_connected) {
+        if (crossesPartitionLocked(pair.first, pair.second)) cut.push_back(pair);
+    }
+    for (const auto& pair : cut) {
+        m_severed.insert(pair);
+        dropLocked(pair);
+    }
+}
+
+void SimNetwork::heal() {
+    std::set<Pair> severed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_partition.clear();
+        severed.swap(m_severed);
+    }
+    for (const auto& pair : severed) {
+        connect(pair.first, pair.second);
+    }
+}
+
+bool SimNetwork::step(int64_t limitUs) {
+    std::lock_guard<std::recursive_mutex> dispatch(m_dispatch);
+    std::function<void()> fn;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_events.empty() || m_events.top().timeUs > limitUs) return false;
+        // top() is const; the event is popped right after
+        fn = std::move(const_cast<Event&>(m_events.top()).fn);
+        m_nowUs = m_events.top().timeUs;
+        m_events.pop();
+    }
+    fn();
+    return true;
+}
+
+size_t SimNetwork::runUntil(int64_t timeUs) {
+    size_t count = 0;
+    while (step(timeUs)) count++;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_nowUs = std::max(m_nowUs, timeUs);
+    return count;
+}
+
+size_t SimNetwork::runUntilIdle(int64_t limitUs) {
+    size_t count = 0;
+    while (step(limitUs)) count++;
+    return count;
+}
+
+bool SimNetwork::idle() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_events.empty();
+}
+
+void SimNetwork::startRealtime() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_realtime) return;
+    m_realtime = true;
+    m_pump = std::thread(&SimNetwork::realtimeLoop, this);
+}
+
+void SimNetwork::stopRealtime() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_realtime) return;
+        m_realtime = false;
+    }
+    m_cv.notify_all();
+    if (m_pump.joinable()) m_pump.join();
+}
+
+void SimNetwork::realtimeLoop() {
+    auto wallStart = std::chrono::steady_clock::now();
+    int64_t virtualStart = nowUs();
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait_for(lock, std::chrono::milliseconds(1), [this] { return !m_realtime; });
+            if (!m_realtime) break;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - wallStart);
+        runUntil(virtualStart + elapsed.count());
+    }
+}
+
+SimNetwork::Stats SimNetwork::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+} // namespace aegis
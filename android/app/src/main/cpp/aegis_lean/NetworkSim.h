@@ -0,0 +1,168 @@
+#pragma once
+
+#include "Transport.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace aegis {
+
+// One-way delay model for a simulated link.
+enum class LatencyModel {
+    Fixed,   // latencyMs
+    Uniform, // latencyMs +/- jitterMs
+    Normal,  // mean latencyMs, stddev jitterMs, clamped at 0
+    Pareto   // latencyMs floor plus a heavy tail with scale jitterMs (alpha 2)
+};
+
+struct LinkProfile {
+    LatencyModel latencyModel = LatencyModel::Normal;
+    double latencyMs = 20.0;
+    double jitterMs = 5.0;
+    double lossRate = 0.0;      // per-message loss probability
+    double reorderRate = 0.0;   // probability a message may overtake earlier ones (datagram links)
+    double bandwidthKbps = 0.0; // per direction, 0 = unlimited
+    // Stream semantics like the socket transport: a loss costs a
+    // retransmission timeout and blocks the messages behind it, order is
+    // kept. false: lost messages are gone and reordering applies.
+    bool reliable = true;
+};
+
+struct NetworkSimConfig {
+    bool enabled = false; // Aegis::startNetwork uses SimNetwork::shared() instead of sockets
+    uint64_t seed = 1;
+    LinkProfile link;     // default for every link (SimNetwork::setLinkProfile overrides)
+};
+
+/**
+ * SimNetwork
+ * In-process link layer for SimTransport endpoints, driven by virtual time
+ * and a seeded RNG: the same seed and the same sequence of calls produce
+ * the same deliveries, drops and timings on any machine.
+ *
+ * Each directed link applies its LinkProfile: serialisation delay under the
+ * bandwidth cap, sampled latency, and loss, either as retransmission delay
+ * (reliable links, the default) or as drops and reordering (datagram links). Connections carry an epoch, so messages in
+ * flight when a link drops (stop, partition) are discarded like on TCP.
+ *
+ * Normally driven by the caller (runUntil / runUntilIdle) from one thread,
+ * which makes every handler run on that thread. startRealtime() instead
+ * advances virtual time with the wall clock on a background thread.
+ */
+class SimNetwork {
+public:
+    struct Stats {
+        uint64_t messagesSent = 0;
+        uint64_t messagesDelivered = 0;
+        uint64_t messagesLost = 0;   // dropped by lossRate (datagram links)
+        uint64_t retransmits = 0;    // delayed by lossRate (reliable links)
+        uint64_t messagesCut = 0;    // link went down while in flight
+        uint64_t bytesSent = 0;
+        uint64_t bytesDelivered = 0;
+        uint64_t connects = 0;
+        uint64_t disconnects = 0;
+    };
+
+    explicit SimNetwork(NetworkSimConfig config = NetworkSimConfig());
+    ~SimNetwork();
+    SimNetwork(const SimNetwork&) = delete;
+    SimNetwork& operator=(const SimNetwork&) = delete;
+
+    // Process-wide network used by Aegis when NetworkSimConfig::enabled is
+    // set; created (and started in realtime mode) on first use.
+    static SimNetwork& shared(const NetworkSimConfig& config);
+
+    int64_t nowUs() const;
+    void setLinkProfile(const std::string& from, const std::string& to, const LinkProfile& profile);
+
+    // Cuts every connection between `side` and the rest; heal() restores them.
+    void partition(const std::vector<std::string>& side);
+    void heal();
+
+    // Runs fn at nowUs() + delayUs on the driving thread (scenario scripting).
+    void schedule(int64_t delayUs, std::function<void()> fn);
+    // Processes events up to timeUs, then sets the clock to it. Returns the count.
+    size_t runUntil(int64_t timeUs);
+    // Runs until no event is pending or the clock reaches limitUs.
+    size_t runUntilIdle(int64_t limitUs);
+    bool idle() const;
+
+    void startRealtime();
+    void stopRealtime();
+
+    Stats stats() const;
+
+    // SimTransport endpoints
+    bool attach(const std::string& nodeId, Transport::Handlers handlers);
+    void detach(const std::string& nodeId);
+    bool connect(const std::string& from, const std::string& to);
+    bool send(const std::string& from, const std::string& to, const Transport::Frame& message);
+    std::vector<std::string> peersOf(const std::string& nodeId) const;
+    size_t peerCountOf(const std::string& nodeId) const;
+
+private:
+    using Pair = std::pair<std::string, std::string>; // (min, max) node ids
+
+    struct Event {
+        int64_t timeUs;
+        uint64_t seq; // FIFO among equal times
+        std::function<void()> fn;
+        bool operator>(const Event& o) const { return timeUs != o.timeUs ? timeUs > o.timeUs : seq > o.seq; }
+    };
+
+    struct Link { // one direction
+        int64_t busyUntilUs = 0;
+        int64_t lastArrivalUs = 0;
+    };
+
+    static Pair pairOf(const std::string& a, const std::string& b) {
+        return a < b ? Pair(a, b) : Pair(b, a);
+    }
+
+    // Callers hold m_mutex
+    void pushLocked(int64_t timeUs, std::function<void()> fn);
+    const LinkProfile& profileLocked(const std::string& from, const std::string& to) const;
+    int64_t sampleLatencyUsLocked(const LinkProfile& profile);
+    double uniformLocked(); // [0, 1)
+    bool crossesPartitionLocked(const std::string& a, const std::string& b) const;
+    void establishLocked(const Pair& pair, const std::string& from);
+    void dropLocked(const Pair& pair);
+    void notifyLocked(const std::string& nodeId, const std::string& peerId, bool connected, uint64_t epoch);
+
+    bool step(int64_t limitUs);
+    void realtimeLoop();
+
+    NetworkSimConfig m_config;
+    uint64_t m_rngState;
+
+    mutable std::mutex m_mutex;
+    // Held while an event runs, so detach() can wait out a handler in flight;
+    // recursive because handlers may detach on the driving thread
+    std::recursive_mutex m_dispatch;
+    int64_t m_nowUs = 0;
+    uint64_t m_seq = 0;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> m_events;
+    std::map<std::string, Transport::Handlers> m_nodes;
+    std::map<Pair, uint64_t> m_connected;   // pair -> connection epoch
+    std::set<Pair> m_pending;               // connect in progress
+    std::map<Pair, Link> m_links;           // keyed (from, to), directed
+    std::map<Pair, LinkProfile> m_profiles; // keyed (from, to), directed
+    std::set<std::string> m_partition;      // one side of the current cut
+    std::set<Pair> m_severed;               // connections to restore on heal()
+    uint64_t m_epoch = 0;
+    Stats m_stats;
+
+    std::condition_variable m_cv;
+    bool m_realtime = false;
+    std::thread m_pump;
+};
+
+} // namespace aegis
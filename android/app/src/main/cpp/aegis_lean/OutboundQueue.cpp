@@ -0,0 +1,374 @@
+#include "OutboundQueue.h"
+#include <algorithm>
+#include <iostream>
+
+namespace aegis {
+
+namespace {
+
+// Bytes credited per round-robin visit. Move is strict priority and unused.
+constexpr std::array<size_t, kSyncLaneCount> kQuantum = {
+    0,          // Move
+    32 * 1024,  // Clock
+    16 * 1024,  // Presence
+    8 * 1024,   // Document
+    4 * 1024,   // Bulk
+};
+
+thread_local int t_laneOverride = -1;
+
+size_t laneIndex(SyncLane lane) { return static_cast<size_t>(lane); }
+
+// Spill record: [u8 lane][u32 keyLen][key][i64 timestamp][u32 clientLen][clientId][data]
+void putU32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+}
+
+std::vector<uint8_t> encodeSpill(const OutboundItem& item) {
+    const auto& m = item.mutation;
+    std::vector<uint8_t> out;
+    out.reserve(1 + 4 + m.key.size() + 8 + 4 + m.meta.clientId.size() + m.data.size());
+    out.push_back(static_cast<uint8_t>(item.lane));
+    putU32(out, static_cast<uint32_t>(m.key.size()));
+    out.insert(out.end(), m.key.begin(), m.key.end());
+    for (int i = 0; i < 8; i++) out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(m.meta.timestamp) >> (8 * i)));
+    putU32(out, static_cast<uint32_t>(m.meta.clientId.size()));
+    out.insert(out.end(), m.meta.clientId.begin(), m.meta.clientId.end());
+    out.insert(out.end(), m.data.begin(), m.data.end());
+    return out;
+}
+
+bool decodeSpill(const uint8_t* p, size_t len, OutboundItem& item) {
+    const uint8_t* end = p + len;
+    auto u32 = [&](uint32_t& v) {
+        if (end - p < 4) return false;
+        v = 0;
+        for (int i = 3; i >= 0; i--) v = (v << 8) | p[i];
+        p += 4;
+        return true;
+    };
+    if (end - p < 1 || *p >= kSyncLaneCount) return false;
+    item.lane = static_cast<SyncLane>(*p++);
+
+    uint32_t n;
+    if (!u32(n) || static_cast<size_t>(end - p) < n) return false;
+    item.mutation.key.assign(reinterpret_cast<const char*>(p), n);
+    p += n;
+
+    if (end - p < 8) return false;
+    uint64_t ts = 0;
+    for (int i = 7; i >= 0; i--) ts = (ts << 8) | p[i];
+    item.mutation.meta.timestamp = static_cast<int64_t>(ts);
+    p += 8;
+
+    if (!u32(n) || static_cast<size_t>(end - p) < n) return false;
+    item.mutation.meta.clientId.assign(reinterpret_cast<const char*>(p), n);
+    p += n;
+
+    item.mutation.data.assign(p, end);
+    item.bytes = item.mutation.key.size() + item.mutation.data.size();
+    return true;
+}
+
+} // namespace
+
+OutboundQueue::ScopedLane::ScopedLane(SyncLane lane) : m_previous(t_laneOverride) {
+    t_laneOverride = static_cast<int>(lane);
+}
+
+OutboundQueue::ScopedLane::~ScopedLane() {
+    t_laneOverride = m_previous;
+}
+
+OutboundQueue::OutboundQueue(SyncMetrics& metrics) : m_metrics(metrics) {
+    setLaneForPrefix("match_", SyncLane::Move);
+    setLaneForPrefix("clock_", SyncLane::Clock);
+    setLaneForPrefix("presence_", SyncLane::Presence);
+    setLaneForPrefix("typing_", SyncLane::Presence);
+    setLaneForPrefix("attachment_", SyncLane::Bulk);
+}
+
+void OutboundQueue::setLimits(const Limits& limits) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_limits = limits;
+    }
+    m_capacity.notify_all();
+}
+
+void OutboundQueue::setSpillLog(SegmentLog* log) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_spillLog = log;
+    m_spill = Spill();
+    m_unlogged = Spill();
+    if (log) {
+        m_spill.count = log->pendingCount();
+        m_spill.bytes = log->pendingBytes();
+    }
+    updateGauges();
+}
+
+bool OutboundQueue::hasSpillLog() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_spillLog != nullptr;
+}
+
+void OutboundQueue::setLaneForPrefix(const std::string& prefix, SyncLane lane) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find_if(m_rules.begin(), m_rules.end(), [&](const auto& r) { return r.first == prefix; });
+    if (it != m_rules.end()) {
+        it->second = lane;
+        return;
+    }
+    m_rules.emplace_back(prefix, lane);
+    std::stable_sort(m_rules.begin(), m_rules.end(),
+                     [](const auto& a, const auto& b) { return a.first.size() > b.first.size(); });
+}
+
+SyncLane OutboundQueue::classify(const std::string& key, size_t bytes) const {
+    if (t_laneOverride >= 0) return static_cast<SyncLane>(t_laneOverride);
+    if (bytes >= kBulkThresholdBytes) return SyncLane::Bulk;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& [prefix, lane] : m_rules) {
+        if (key.compare(0, prefix.size(), prefix) == 0) return lane;
+    }
+    return SyncLane::Document;
+}
+
+void OutboundQueue::push(const storage::Mutation& mutation) {
+    OutboundItem item;
+    item.bytes = mutation.key.size() + mutation.data.size();
+    item.lane = classify(mutation.key, item.bytes);
+    item.enqueuedAt = std::chrono::steady_clock::now();
+    item.mutation = mutation;
+
+    auto& stats = m_metrics.lanes[laneIndex(item.lane)];
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats.enqueued++;
+
+    bool overHighWater = m_spill.count > 0 ||
+                         m_size + 1 > m_limits.highWaterCount ||
+                         m_bytes + item.bytes > m_limits.highWaterBytes;
+    if (overHighWater && item.lane != SyncLane::Move) {
+        // Already durable in MutationQueue; keep only the accounting (or
+        // append to the spill log). Once spilling starts everything but
+        // moves spills until the worker catches up, so the replay sees
+        // mutations in their original order.
+        bool logged = false;
+        if (m_spillLog) {
+            auto record = encodeSpill(item);
+            logged = m_spillLog->append(record.data(), record.size()) != 0;
+            if (!logged) std::cerr << "[OutboundQueue] Spill append failed for " << item.mutation.key << std::endl;
+        }
+        if (!logged) {
+            // Still in MutationQueue: counted for a full replay
+            auto hlc = static_cast<uint64_t>(item.mutation.meta.timestamp);
+            m_unlogged.firstHlc = m_unlogged.count == 0 ? hlc : std::min(m_unlogged.firstHlc, hlc);
+            m_unlogged.lastHlc = std::max(m_unlogged.lastHlc, hlc);
+            m_unlogged.count++;
+            m_unlogged.bytes += item.bytes;
+        }
+        m_spill.count++;
+        m_spill.bytes += item.bytes;
+        m_metrics.spilledMutations++;
+        updateGauges();
+        return;
+    }
+
+    m_bytes += item.bytes;
+    m_lanes[laneIndex(item.lane)].push_back(std::move(item));
+    m_size++;
+    stats.depth++;
+    updateGauges();
+}
+
+bool OutboundQueue::admit(size_t bytes, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto hasRoom = [&] {
+        return m_size + m_spill.count + 1 <= m_limits.hardLimitCount &&
+               m_bytes + m_spill.bytes + bytes <= m_limits.hardLimitBytes;
+    };
+    if (hasRoom()) return true;
+
+    m_metrics.backpressureWaits++;
+    if (timeout.count() > 0 && m_capacity.wait_for(lock, timeout, hasRoom)) return true;
+
+    m_metrics.rejectedWrites++;
+    return false;
+}
+
+OutboundQueue::Spill OutboundQueue::spilled() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_spill;
+}
+
+OutboundQueue::Spill OutboundQueue::unlogged() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_unlogged;
+}
+
+void OutboundQueue::releaseUnlogged(const Spill& covered) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_unlogged.count -= std::min(covered.count, m_unlogged.count);
+        m_unlogged.bytes -= std::min(covered.bytes, m_unlogged.bytes);
+        if (m_unlogged.count == 0) m_unlogged = Spill();
+    }
+    releaseSpilled(covered);
+}
+
+void OutboundQueue::releaseSpilled(const Spill& covered) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_spill.count -= std::min(covered.count, m_spill.count);
+        m_spill.bytes -= std::min(covered.bytes, m_spill.bytes);
+        if (m_spill.count == 0) m_spill.bytes = 0; // Log-derived byte counts are estimates
+        updateGauges();
+    }
+    m_capacity.notify_all();
+}
+
+OutboundQueue::SpillBatch OutboundQueue::popSpilled(size_t maxItems, size_t maxBytes) {
+    SpillBatch batch;
+    SegmentLog* log;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        log = m_spillLog;
+    }
+    if (!log) return batch;
+
+    log->replay(log->lowWater(), maxItems, [&](uint64_t seq, const uint8_t* data, size_t len) {
+        OutboundItem item;
+        if (!decodeSpill(data, len, item)) {
+            std::cerr << "[OutboundQueue] Skipping undecodable spill record " << seq << std::endl;
+        } else {
+            if (!batch.items.empty() && batch.bytes + item.bytes > maxBytes) return false;
+            item.enqueuedAt = std::chrono::steady_clock::now();
+            batch.bytes += item.bytes;
+            batch.items.push_back(std::move(item));
+        }
+        batch.lastSeq = seq;
+        batch.records++;
+        return true;
+    });
+    return batch;
+}
+
+void OutboundQueue::ackSpilled(const SpillBatch& batch) {
+    SegmentLog* log;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        log = m_spillLog;
+    }
+    if (!log || batch.lastSeq == 0) return;
+    log->ack(batch.lastSeq);
+    releaseSpilled({batch.records, batch.bytes});
+}
+
+void OutboundQueue::updateGauges() {
+    m_metrics.residentMutations = m_size;
+    m_metrics.residentBytes = m_bytes;
+    m_metrics.spilledPending = m_spill.count;
+    m_metrics.spilledPendingBytes = m_spill.bytes;
+}
+
+void OutboundQueue::take(size_t lane, std::vector<OutboundItem>& batch, size_t& bytes) {
+    auto& q = m_lanes[lane];
+    bytes += q.front().bytes;
+    m_bytes -= q.front().bytes;
+    batch.push_back(std::move(q.front()));
+    q.pop_front();
+    m_size--;
+    m_metrics.lanes[lane].depth--;
+}
+
+std::vector<OutboundItem> OutboundQueue::popBatch(size_t maxItems, size_t maxBytes) {
+    std::vector<OutboundItem> batch;
+    size_t bytes = 0;
+    auto fits = [&](const OutboundItem& item) { return batch.empty() || bytes + item.bytes <= maxBytes; };
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // 1. Moves: strict priority
+    auto& moves = m_lanes[laneIndex(SyncLane::Move)];
+    while (!moves.empty() && batch.size() < maxItems && fits(moves.front())) {
+        take(laneIndex(SyncLane::Move), batch, bytes);
+    }
+
+    // 2. Deficit round robin over the weighted lanes
+    while (batch.size() < maxItems && m_size > moves.size()) {
+        size_t lane = m_cursor;
+        auto& q = m_lanes[lane];
+
+        if (q.empty()) {
+            m_deficit[lane] = 0;
+        } else {
+            if (!m_inService) {
+                m_deficit[lane] += kQuantum[lane];
+                m_inService = true;
+            }
+            bool full = false;
+            while (!q.empty() && q.front().bytes <= m_deficit[lane]) {
+                if (batch.size() >= maxItems || !fits(q.front())) {
+                    full = true;
+                    break;
+                }
+                m_deficit[lane] -= q.front().bytes;
+                take(lane, batch, bytes);
+            }
+            if (full) break; // Resume this lane, with its remaining deficit, next batch
+            if (q.empty()) m_deficit[lane] = 0;
+        }
+
+        m_inService = false;
+        m_cursor = m_cursor + 1 < kSyncLaneCount ? m_cursor + 1 : 1;
+    }
+
+    updateGauges();
+    lock.unlock();
+    if (!batch.empty()) m_capacity.notify_all();
+    return batch;
+}
+
+void OutboundQueue::requeueFront(std::vector<OutboundItem>&& batch) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+        size_t lane = laneIndex(it->lane);
+        m_bytes += it->bytes;
+        m_lanes[lane].push_front(std::move(*it));
+        m_size++;
+        m_metrics.lanes[lane].depth++;
+    }
+    updateGauges();
+}
+
+size_t OutboundQueue::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
+
+size_t OutboundQueue::depth(SyncLane lane) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lanes[laneIndex(lane)].size();
+}
+
+void OutboundQueue::clear() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t lane = 0; lane < kSyncLaneCount; lane++) {
+            m_lanes[lane].clear();
+            m_metrics.lanes[lane].depth = 0;
+            m_deficit[lane] = 0;
+        }
+        m_size = 0;
+        m_bytes = 0;
+        m_spill = Spill();
+        m_unlogged = Spill();
+        m_inService = false;
+        updateGauges();
+    }
+    m_capacity.notify_all();
+}
+
+} // namespace aegis
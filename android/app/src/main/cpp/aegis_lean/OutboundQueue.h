@@ -0,0 +1,150 @@
+#pragma once
+
+#include "SegmentLog.h"
+#include "SyncLane.h"
+#include "SyncMetrics.h"
+#include "storage/storage_manager.h"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace aegis {
+
+struct OutboundItem {
+    storage::Mutation mutation;
+    SyncLane lane = SyncLane::Document;
+    size_t bytes = 0;
+    std::chrono::steady_clock::time_point enqueuedAt;
+};
+
+/**
+ * OutboundQueue
+ * In-memory hand-off between writers (mutation-added hook, any thread) and
+ * the sync worker. MutationQueue stays the durable record; this only holds
+ * what still has to be pushed into SyncManager.
+ *
+ * Mutations are split into SyncLanes by key prefix (longest match wins) or
+ * by an explicit per-call ScopedLane. popBatch() serves the Move lane with
+ * strict priority and the remaining lanes by deficit round robin, so a
+ * queued attachment only ever delays a move by one batch.
+ *
+ * Memory is bounded. Past the high-water marks, new mutations are not
+ * copied into memory at all ("spilled"): they are already durable in
+ * MutationQueue, so the worker later streams them from storage with a full
+ * replay. With a SegmentLog attached, spilled mutations are appended to it
+ * instead and the worker streams them back with popSpilled(); one whose
+ * append fails is left to a full replay like the rest. Moves never spill.
+ * Past the hard limits, admit() makes writers wait (up to a timeout) and
+ * then reject the write.
+ */
+class OutboundQueue {
+public:
+    // Overrides prefix classification for mutations enqueued on this thread
+    // while in scope (e.g. aegis_flutter_put_with_lane, attachments).
+    class ScopedLane {
+    public:
+        explicit ScopedLane(SyncLane lane);
+        ~ScopedLane();
+        ScopedLane(const ScopedLane&) = delete;
+        ScopedLane& operator=(const ScopedLane&) = delete;
+    private:
+        int m_previous;
+    };
+
+    struct Limits {
+        size_t highWaterCount = 4096;
+        size_t highWaterBytes = 8 * 1024 * 1024;
+        size_t hardLimitCount = 1000000;          // counts spilled mutations too
+        size_t hardLimitBytes = 512 * 1024 * 1024;
+    };
+
+    struct Spill {
+        size_t count = 0;
+        size_t bytes = 0;
+        // unlogged() only: HLC stamps (meta.timestamp) spanning those
+        // writes, so the replay can find their keys again. Only widens
+        // until they drain.
+        uint64_t firstHlc = 0;
+        uint64_t lastHlc = 0;
+    };
+
+    struct SpillBatch {
+        std::vector<OutboundItem> items;
+        uint64_t lastSeq = 0;
+        size_t records = 0; // includes undecodable records that were skipped
+        size_t bytes = 0;
+    };
+
+    explicit OutboundQueue(SyncMetrics& metrics);
+
+    void setLimits(const Limits& limits);
+
+    // Optional spill backend. Picks up records left unacknowledged by a
+    // previous run. Pass nullptr to detach.
+    void setSpillLog(SegmentLog* log);
+    bool hasSpillLog() const;
+
+    void setLaneForPrefix(const std::string& prefix, SyncLane lane);
+    SyncLane classify(const std::string& key, size_t bytes) const;
+
+    void push(const storage::Mutation& mutation);
+
+    // Backpressure for writers, checked before a write reaches the DB.
+    // Returns false if the backlog stays over the hard limit for timeout.
+    bool admit(size_t bytes, std::chrono::milliseconds timeout);
+
+    // All spilled mutations, with a spill log or without
+    Spill spilled() const;
+    // Spilled mutations with no spill log record (all of them without a
+    // log) are only counted; the worker snapshots the counters, replays
+    // from storage and then releases what it covered.
+    Spill unlogged() const;
+    void releaseUnlogged(const Spill& covered);
+
+    // SegmentLog spill only: next spilled records in append order, and the
+    // acknowledgement once they were delivered. Consumer thread only.
+    SpillBatch popSpilled(size_t maxItems, size_t maxBytes);
+    void ackSpilled(const SpillBatch& batch);
+
+    // Removes up to maxItems / maxBytes (at least one item if any are queued).
+    std::vector<OutboundItem> popBatch(size_t maxItems, size_t maxBytes);
+
+    // Puts a batch back at the head of its lanes, e.g. after a failed send.
+    void requeueFront(std::vector<OutboundItem>&& batch);
+
+    size_t size() const; // resident only
+    size_t depth(SyncLane lane) const;
+    void clear();
+
+    // Large values are demoted to Bulk regardless of prefix.
+    static constexpr size_t kBulkThresholdBytes = 256 * 1024;
+
+private:
+    void take(size_t lane, std::vector<OutboundItem>& batch, size_t& bytes);
+    void releaseSpilled(const Spill& covered);
+    void updateGauges();
+
+    SyncMetrics& m_metrics;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::pair<std::string, SyncLane>> m_rules; // sorted longest prefix first
+    std::array<std::deque<OutboundItem>, kSyncLaneCount> m_lanes;
+    size_t m_size = 0;
+    size_t m_bytes = 0;
+    Limits m_limits;
+    Spill m_spill;
+    Spill m_unlogged; // part of m_spill
+    SegmentLog* m_spillLog = nullptr;
+    std::condition_variable m_capacity;
+
+    // Deficit round robin state for the weighted lanes
+    std::array<size_t, kSyncLaneCount> m_deficit{};
+    size_t m_cursor = 1;
+    bool m_inService = false;
+};
+
+} // namespace aegis
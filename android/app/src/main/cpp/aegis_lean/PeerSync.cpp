@@ -0,0 +1,535 @@
+#include "PeerSync.h"
+#include <iostream>
+#include <array>
+#include <map>
+
+namespace aegis {
+
+namespace {
+
+constexpr size_t kLogPage = 256;
+constexpr size_t kBatchKeys = 64;            // documents per Mutations frame
+constexpr size_t kBatchBytes = 256 * 1024;   // payload budget per Mutations frame
+constexpr size_t kVarint = 10;
+
+} // namespace
+
+PeerSync::PeerSync(std::shared_ptr<Transport> transport, DeltaSync& delta, AppendLog& log, SyncMetrics& metrics, ApplyFn apply)
+    : m_transport(std::move(transport)), m_delta(delta), m_log(log), m_metrics(metrics), m_apply(std::move(apply)) {}
+
+Transport::Handlers PeerSync::handlers() {
+    Transport::Handlers h;
+    h.onPeerConnected = [this](const std::string& peerId) { onPeerConnected(peerId); };
+    h.onPeerDisconnected = [this](const std::string& peerId) { onPeerDisconnected(peerId); };
+    h.onMessage = [this](const std::string& peerId, const uint8_t* data, size_t len) { onMessage(peerId, data, len); };
+    return h;
+}
+
+std::shared_ptr<PeerSync::Peer> PeerSync::findPeer(const std::string& peerId) {
+    std::lock_guard<std::mutex> lock(m_peersMutex);
+    auto it = m_peers.find(peerId);
+    return it == m_peers.end() ? nullptr : it->second;
+}
+
+template <typename Fn>
+Transport::Frame PeerSync::buildFrame(wire::FrameType type, size_t bound, Fn&& body) {
+    std::vector<uint8_t> buf(2 + bound);
+    wire::WireWriter w(buf.data(), buf.size());
+    wire::writeFrameHeader(w, type);
+    body(w);
+    if (!w.ok()) {
+        std::cerr << "[PeerSync] Frame type " << static_cast<int>(type) << " exceeded its size bound" << std::endl;
+        return nullptr;
+    }
+    buf.resize(w.size());
+    return std::make_shared<const std::vector<uint8_t>>(std::move(buf));
+}
+
+void PeerSync::publish(const std::vector<OutboundItem>& batch) {
+    std::vector<std::string> keys;
+    std::unordered_map<std::string, size_t> last; // key -> its newest item in batch
+    for (size_t i = 0; i < batch.size(); i++) {
+        const auto& key = batch[i].mutation.key;
+        auto [it, inserted] = last.try_emplace(key, i);
+        if (inserted) keys.push_back(key);
+        else it->second = i;
+    }
+    // DeltaSync evicts keys over its byte budget; encode those from the batch
+    for (const auto& key : keys) {
+        if (!m_delta.hasLocal(key)) m_delta.recordLocal(key, batch[last[key]].mutation.data);
+    }
+    auto peerIds = m_transport->peers();
+    if (peerIds.empty()) return;
+
+    std::lock_guard<std::mutex> lock(m_txMutex);
+
+    // DeltaSync always encodes the latest version, so one record per key and
+    // one encoding per distinct acked base
+    std::vector<DeltaSync::PeerFrame> frames;
+    std::unordered_map<std::string, std::vector<uint32_t>> needs; // peer -> indices into frames
+    for (const auto& key : keys) {
+        for (auto& pf : m_delta.encodeForPeers(peerIds, key)) {
+            auto index = static_cast<uint32_t>(frames.size());
+            for (const auto& peerId : pf.peers) needs[peerId].push_back(index);
+            frames.push_back(std::move(pf));
+        }
+    }
+
+    // Peers needing the same frames share one encoded buffer
+    std::map<std::vector<uint32_t>, std::vector<std::string>> groups;
+    for (auto& [peerId, indices] : needs) groups[std::move(indices)].push_back(peerId);
+
+    std::vector<const SyncFrame*> group;
+    for (const auto& [indices, members] : groups) {
+        group.clear();
+        for (auto index : indices) group.push_back(&frames[index].frame);
+        auto metas = stampFrames(group);
+        sendMutations(members, group, metas);
+    }
+}
+
+void PeerSync::publishLog(const std::string& logId, const LogEntry& entry) {
+    auto peerIds = m_transport->peers();
+    if (peerIds.empty()) return;
+    auto frame = buildFrame(wire::FrameType::LogEntries, 3 * kVarint + logId.size() + entry.data.size(),
+                            [&](wire::WireWriter& w) {
+                                w.str(logId);
+                                w.varint(1);
+                                w.varint(entry.seq);
+                                w.blob(entry.data.data(), entry.data.size());
+                            });
+    if (frame) m_transport->broadcast(peerIds, frame);
+}
+
+void PeerSync::sendUpdates(const std::string& peerId, const std::vector<std::string>& keys) {
+    std::vector<SyncFrame> frames;
+    frames.reserve(keys.size());
+    for (const auto& key : keys) {
+        if (auto frame = m_delta.encodeFor(peerId, key)) frames.push_back(std::move(*frame));
+    }
+    std::vector<const SyncFrame*> ptrs;
+    ptrs.reserve(frames.size());
+    for (const auto& frame : frames) ptrs.push_back(&frame);
+    auto metas = stampFrames(ptrs);
+    sendMutations({peerId}, ptrs, metas);
+}
+
+std::vector<storage::SyncMetadata> PeerSync::stampFrames(std::vector<const SyncFrame*>& frames) {
+    // Each key goes out with the stamp the index recorded for it, as
+    // anti-entropy sends it. That stamp only belongs to the value DeltaSync
+    // encoded if the recorded hash is that value's: otherwise a remote
+    // update replaced it (its writer propagates that one), or a newer local
+    // write is still on its way to publish().
+    std::vector<storage::SyncMetadata> metas;
+    if (!m_merkle) {
+        metas.resize(frames.size());
+        return metas;
+    }
+    std::vector<std::string_view> keys;
+    keys.reserve(frames.size());
+    for (const auto* frame : frames) keys.push_back(frame->key);
+    std::vector<uint64_t> hashes;
+    auto stamps = m_merkle->stamps(keys, &hashes);
+
+    size_t kept = 0;
+    metas.reserve(frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        const SyncFrame& frame = *frames[i];
+        if (!stamps[i]) continue;
+        auto value = m_delta.localValue(frame.key, frame.version);
+        if (!value || MerkleIndex::itemHash(frame.key, value->data(), value->size()) != hashes[i]) continue;
+        storage::SyncMetadata meta;
+        meta.timestamp = static_cast<int64_t>(stamps[i]->hlc);
+        meta.clientId = m_merkle->clientName(stamps[i]->client);
+        metas.push_back(std::move(meta));
+        frames[kept++] = frames[i];
+    }
+    frames.resize(kept);
+    return metas;
+}
+
+void PeerSync::sendMutations(const std::vector<std::string>& peerIds, const std::vector<const SyncFrame*>& frames,
+                             const std::vector<storage::SyncMetadata>& metas) {
+    std::vector<wire::WireMutation> items;
+    size_t payloadBytes = 0;
+    for (size_t i = 0; i < frames.size(); i++) {
+        const auto& frame = *frames[i];
+        wire::WireMutation m;
+        m.key = frame.key;
+        m.clientId = metas[i].clientId;
+        m.version = frame.version;
+        m.baseVersion = frame.baseVersion;
+        m.timestamp = metas[i].timestamp;
+        m.payload = frame.payload.data();
+        m.payloadLen = frame.payload.size();
+        payloadBytes += m.payloadLen;
+        items.push_back(m);
+        if (items.size() >= kBatchKeys || payloadBytes >= kBatchBytes) {
+            flushMutations(peerIds, items, payloadBytes);
+            payloadBytes = 0;
+        }
+    }
+    flushMutations(peerIds, items, payloadBytes);
+}
+
+void PeerSync::flushMutations(const std::vector<std::string>& peerIds, std::vector<wire::WireMutation>& items,
+                              size_t payloadBytes) {
+    if (items.empty() || peerIds.empty()) return;
+
+    std::vector<uint8_t> buf(wire::WireEncoder::maxEncodedSize(items.data(), items.size()));
+    size_t n = 0;
+    if (peerIds.size() == 1) {
+        // Single recipient: stream-coded against its session (interned ids)
+        if (auto peer = findPeer(peerIds.front())) {
+            n = wire::WireEncoder(peer->tx).encodeMutations(items.data(), items.size(), buf.data(), buf.size());
+        }
+    } else {
+        n = wire::WireEncoder::encodeStandalone(items.data(), items.size(), buf.data(), buf.size());
+    }
+
+    if (n == 0) {
+        std::cerr << "[PeerSync] Dropped " << items.size() << " mutations for " << peerIds.size() << " peer(s)" << std::endl;
+    } else {
+        buf.resize(n);
+        m_metrics.wireFrames++;
+        m_metrics.wireMutations += items.size();
+        m_metrics.wireOverheadBytes += n - payloadBytes;
+        auto frame = std::make_shared<const std::vector<uint8_t>>(std::move(buf));
+        if (peerIds.size() == 1) {
+            m_transport->send(peerIds.front(), frame);
+        } else {
+            m_transport->broadcast(peerIds, frame);
+        }
+    }
+    items.clear();
+}
+
+void PeerSync::sendLogRange(const std::string& peerId, const std::string& logId, uint64_t fromSeq) {
+    for (uint64_t next = fromSeq;;) {
+        auto page = m_log.read(logId, next, kLogPage);
+        if (page.empty()) break;
+
+        size_t bound = 2 * kVarint + logId.size();
+        for (const auto& e : page) bound += 2 * kVarint + e.data.size();
+        auto frame = buildFrame(wire::FrameType::LogEntries, bound, [&](wire::WireWriter& w) {
+            w.str(logId);
+            w.varint(page.size());
+            uint64_t prev = 0;
+            for (const auto& e : page) {
+                w.varint(e.seq - prev); // Sequences ascend: small deltas
+                prev = e.seq;
+                w.blob(e.data.data(), e.data.size());
+            }
+        });
+        if (frame) m_transport->send(peerId, frame);
+
+        if (page.size() < kLogPage) break;
+        next = page.back().seq + 1;
+    }
+}
+
+void PeerSync::onPeerConnected(const std::string& peerId) {
+    std::cout << "[PeerSync] Peer connected: " << peerId << std::endl;
+    {
+        // Fresh wire sessions; also covers the transport switching sockets
+        std::lock_guard<std::mutex> lock(m_peersMutex);
+        m_peers[peerId] = std::make_shared<Peer>();
+    }
+
+    auto heads = m_log.heads();
+    size_t bound = kVarint;
+    for (const auto& [logId, head] : heads) bound += 2 * kVarint + logId.size();
+    auto frame = buildFrame(wire::FrameType::LogHeads, bound, [&](wire::WireWriter& w) {
+        w.varint(heads.size());
+        for (const auto& [logId, head] : heads) {
+            w.str(logId);
+            w.varint(head);
+        }
+    });
+    if (frame) m_transport->send(peerId, frame);
+
+    // Bring the peer up to date on every document we have written
+    {
+        std::lock_guard<std::mutex> lock(m_txMutex);
+        sendUpdates(peerId, m_delta.keys());
+    }
+
+    // One side drives the summary comparison; it covers both directions
+    if (m_merkle && m_transport->localId() < peerId) startAntiEntropy(peerId);
+}
+
+void PeerSync::onPeerDisconnected(const std::string& peerId) {
+    std::cout << "[PeerSync] Peer disconnected: " << peerId << std::endl;
+    {
+        std::lock_guard<std::mutex> lock(m_peersMutex);
+        m_peers.erase(peerId);
+    }
+    // Acked bases may be stale after a reconnect; start over with full frames
+    m_delta.forgetPeer(peerId);
+}
+
+void PeerSync::onMutations(const std::string& peerId, wire::WireReader& r) {
+    auto peer = findPeer(peerId);
+    if (!peer) return;
+
+    wire::WireDecoder decoder(peer->rx);
+    auto status = decoder.decodeMutations(r, peer->rxItems);
+    if (status != wire::WireStatus::Ok) {
+        m_metrics.wireDecodeErrors++;
+        if (!peer->resyncRequested) {
+            std::cerr << "[PeerSync] Mutations from " << peerId << ": " << wire::wireStatusName(status)
+                      << ", requesting resync" << std::endl;
+            peer->resyncRequested = true;
+            if (auto frame = buildFrame(wire::FrameType::Resync, 0, [](wire::WireWriter&) {})) {
+                m_transport->send(peerId, frame);
+            }
+        }
+        return;
+    }
+    peer->resyncRequested = false;
+
+    std::vector<std::pair<std::string, uint64_t>> acks;
+    std::vector<std::string> nacks;
+    size_t ackBytes = kVarint;
+    size_t nackBytes = kVarint;
+    for (const auto& m : peer->rxItems) {
+        SyncFrame frame;
+        frame.key.assign(m.key);
+        frame.version = m.version;
+        frame.baseVersion = m.baseVersion;
+        frame.payload.assign(m.payload, m.payload + m.payloadLen);
+
+        auto value = m_delta.decode(peerId, frame);
+        if (!value) {
+            nackBytes += kVarint + frame.key.size();
+            nacks.push_back(std::move(frame.key));
+            continue;
+        }
+        storage::SyncMetadata meta;
+        meta.timestamp = m.timestamp;
+        meta.clientId.assign(m.clientId);
+        m_apply(frame.key, *value, meta);
+        ackBytes += 2 * kVarint + frame.key.size();
+        acks.emplace_back(std::move(frame.key), frame.version);
+    }
+    peer->rxItems.clear();
+
+    if (!acks.empty()) {
+        auto frame = buildFrame(wire::FrameType::Ack, ackBytes, [&](wire::WireWriter& w) {
+            w.varint(acks.size());
+            for (const auto& [key, version] : acks) {
+                w.str(key);
+                w.varint(version);
+            }
+        });
+        if (frame) m_transport->send(peerId, frame);
+    }
+    if (!nacks.empty()) {
+        auto frame = buildFrame(wire::FrameType::Nack, nackBytes, [&](wire::WireWriter& w) {
+            w.varint(nacks.size());
+            for (const auto& key : nacks) w.str(key);
+        });
+        if (frame) m_transport->send(peerId, frame);
+    }
+}
+
+void PeerSync::setAntiEntropy(MerkleIndex* index, GetFn get) {
+    m_merkle = index;
+    m_get = std::move(get);
+}
+
+void PeerSync::startAntiEntropy(const std::string& peerId) {
+    if (!m_merkle) return;
+    sendDigest(peerId, 0, 0);
+}
+
+void PeerSync::sendDigest(const std::string& peerId, uint32_t level, uint32_t index) {
+    auto children = m_merkle->children(level, index);
+    m_metrics.antiEntropyDigests++;
+    auto frame = buildFrame(wire::FrameType::Digest, (2 + 2 * MerkleIndex::kFanout) * kVarint,
+                            [&](wire::WireWriter& w) {
+                                w.varint(level);
+                                w.varint(index);
+                                for (const auto& child : children) {
+                                    w.varint(child.count);
+                                    w.fixed64(child.hash);
+                                }
+                            });
+    if (frame) m_transport->send(peerId, frame);
+}
+
+void PeerSync::onDigest(const std::string& peerId, wire::WireReader& r) {
+    if (!m_merkle) return;
+    uint64_t level = r.varint();
+    uint64_t index = r.varint();
+    std::array<MerkleIndex::Digest, MerkleIndex::kFanout> theirs;
+    for (auto& d : theirs) {
+        d.count = static_cast<uint32_t>(r.varint());
+        d.hash = r.fixed64();
+    }
+    if (!r.ok() || level >= MerkleIndex::kDepth || index >= MerkleIndex::kLeaves) return;
+
+    // Descend only where the ranges differ; at the bottom swap key lists
+    auto mine = m_merkle->children(static_cast<uint32_t>(level), static_cast<uint32_t>(index));
+    for (uint32_t i = 0; i < MerkleIndex::kFanout; i++) {
+        if (mine[i] == theirs[i]) continue;
+        uint32_t child = static_cast<uint32_t>(index) * MerkleIndex::kFanout + i;
+        if (level + 1 == MerkleIndex::kDepth) {
+            sendLeafItems(peerId, child, m_merkle->leafItems(child), true);
+        } else {
+            sendDigest(peerId, static_cast<uint32_t>(level + 1), child);
+        }
+    }
+}
+
+void PeerSync::sendLeafItems(const std::string& peerId, uint32_t leaf, const std::vector<MerkleIndex::Item>& items,
+                             bool reply) {
+    size_t bound = 3 * kVarint;
+    for (const auto& item : items) bound += kVarint + 8 + item.key.size();
+    m_metrics.antiEntropyLeaves++;
+    auto frame = buildFrame(wire::FrameType::LeafItems, bound, [&](wire::WireWriter& w) {
+        w.varint(leaf);
+        w.u8(reply ? 1 : 0);
+        w.varint(items.size());
+        for (const auto& item : items) {
+            w.str(item.key);
+            w.fixed64(item.hash);
+        }
+    });
+    if (frame) m_transport->send(peerId, frame);
+}
+
+void PeerSync::onLeafItems(const std::string& peerId, wire::WireReader& r) {
+    if (!m_merkle) return;
+    uint64_t leaf = r.varint();
+    bool reply = r.u8() != 0;
+    std::unordered_map<std::string_view, uint64_t> theirs;
+    uint64_t n = r.count(9);
+    for (uint64_t i = 0; i < n && r.ok(); i++) {
+        auto key = r.str(wire::kMaxKeyBytes);
+        uint64_t hash = r.fixed64();
+        if (r.ok()) theirs[key] = hash;
+    }
+    if (!r.ok() || leaf >= MerkleIndex::kLeaves) return;
+
+    auto mine = m_merkle->leafItems(static_cast<uint32_t>(leaf));
+    if (reply) sendLeafItems(peerId, static_cast<uint32_t>(leaf), mine, false);
+
+    // Push our value wherever theirs is missing or different; if both sides
+    // changed a key, both push and the LWW apply settles it
+    std::vector<SyncFrame> frames;
+    std::vector<storage::SyncMetadata> metas;
+    for (auto& item : mine) {
+        auto it = theirs.find(item.key);
+        if (it != theirs.end() && it->second == item.hash) continue;
+        auto value = m_get ? m_get(item.key) : std::nullopt;
+        if (!value) continue;
+        SyncFrame frame;
+        frame.key = item.key;
+        frame.payload = std::move(*value); // version 0: outside DeltaSync history
+        frames.push_back(std::move(frame));
+        metas.push_back(std::move(item.meta));
+    }
+    if (frames.empty()) return;
+
+    m_metrics.antiEntropyKeys += frames.size();
+    std::vector<const SyncFrame*> ptrs;
+    for (const auto& frame : frames) ptrs.push_back(&frame);
+    std::lock_guard<std::mutex> lock(m_txMutex);
+    sendMutations({peerId}, ptrs, metas);
+}
+
+void PeerSync::onMessage(const std::string& peerId, const uint8_t* data, size_t len) {
+    wire::WireReader r(data, len);
+    wire::FrameType type;
+    auto status = wire::readFrameHeader(r, type);
+    if (status != wire::WireStatus::Ok) {
+        m_metrics.wireDecodeErrors++;
+        std::cerr << "[PeerSync] Bad frame from " << peerId << ": " << wire::wireStatusName(status) << std::endl;
+        return;
+    }
+
+    switch (type) {
+        case wire::FrameType::Mutations:
+            onMutations(peerId, r);
+            return;
+        case wire::FrameType::Ack: {
+            uint64_t n = r.count(2);
+            for (uint64_t i = 0; i < n && r.ok(); i++) {
+                auto key = r.str(wire::kMaxKeyBytes);
+                uint64_t version = r.varint();
+                if (r.ok()) m_delta.onAck(peerId, std::string(key), version);
+            }
+            break;
+        }
+        case wire::FrameType::Nack: {
+            std::vector<std::string> keys;
+            uint64_t n = r.count(1);
+            for (uint64_t i = 0; i < n && r.ok(); i++) {
+                auto key = r.str(wire::kMaxKeyBytes);
+                if (!r.ok()) break;
+                keys.emplace_back(key);
+                m_delta.onNack(peerId, keys.back());
+            }
+            std::lock_guard<std::mutex> lock(m_txMutex);
+            sendUpdates(peerId, keys); // Now full frames
+            break;
+        }
+        case wire::FrameType::LogHeads: {
+            std::unordered_map<std::string, uint64_t> theirs;
+            uint64_t n = r.count(2);
+            for (uint64_t i = 0; i < n && r.ok(); i++) {
+                auto logId = r.str();
+                uint64_t head = r.varint();
+                if (r.ok()) theirs[std::string(logId)] = head;
+            }
+            if (!r.ok()) break;
+            for (const auto& [logId, head] : m_log.heads()) {
+                auto it = theirs.find(logId);
+                uint64_t theirHead = it == theirs.end() ? 0 : it->second;
+                if (theirHead < head) sendLogRange(peerId, logId, theirHead + 1);
+            }
+            break;
+        }
+        case wire::FrameType::LogEntries: {
+            auto logId = r.str();
+            uint64_t n = r.count(2);
+            std::vector<LogEntry> entries;
+            entries.reserve(static_cast<size_t>(n));
+            uint64_t seq = 0;
+            for (uint64_t i = 0; i < n && r.ok(); i++) {
+                seq += r.varint();
+                auto data = r.blob();
+                if (!r.ok()) break;
+                LogEntry e;
+                e.seq = seq;
+                e.data.assign(data.begin(), data.end());
+                entries.push_back(std::move(e));
+            }
+            if (r.ok()) m_log.applyRemote(std::string(logId), entries);
+            break;
+        }
+        case wire::FrameType::Digest:
+            onDigest(peerId, r);
+            break;
+        case wire::FrameType::LeafItems:
+            onLeafItems(peerId, r);
+            break;
+        case wire::FrameType::Resync: {
+            // Our stream state is unusable on their end: restart it and
+            // resend every document in full
+            std::lock_guard<std::mutex> lock(m_txMutex);
+            if (auto peer = findPeer(peerId)) peer->tx.reset();
+            m_delta.forgetPeer(peerId);
+            sendUpdates(peerId, m_delta.keys());
+            break;
+        }
+    }
+
+    if (!r.ok() || r.remaining() != 0) {
+        m_metrics.wireDecodeErrors++;
+        std::cerr << "[PeerSync] Bad frame type " << static_cast<int>(type) << " from " << peerId << std::endl;
+    }
+}
+
+} // namespace aegis
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "AppendLog.h"
+#include "DeltaSync.h"
+#include "MerkleIndex.h"
+#include "OutboundQueue.h"
+#include "SyncMetrics.h"
+#include "Transport.h"
+#include "WireFormat.h"
+#include "storage/storage_manager.h"
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace aegis {
+
+/**
+ * PeerSync
+ * Sync protocol between engines over a Transport: document updates as
+ * DeltaSync frames with per-peer acks/nacks, and AppendLog entries by
+ * sequence range (peers swap log heads on connect and push what the other
+ * is missing).
+ *
+ * Messages use the binary wire format (WireFormat.h); each peer gets its
+ * own pair of WireSessions for the stream-coded Mutations frames.
+ * Broadcasts are encoded once per group of peers needing identical frames
+ * (usually all of them) and fanned out as one shared buffer.
+ *
+ * With a MerkleIndex attached, peers run anti-entropy on connect: they swap
+ * summary digests, descend into differing ranges only and push the values
+ * of keys whose leaf entries differ.
+ */
+class PeerSync {
+public:
+    using ApplyFn = std::function<void(const std::string& key, const std::vector<uint8_t>& data,
+                                       const storage::SyncMetadata& meta)>;
+    using GetFn = std::function<std::optional<std::vector<uint8_t>>(const std::string& key)>;
+
+    PeerSync(std::shared_ptr<Transport> transport, DeltaSync& delta, AppendLog& log, SyncMetrics& metrics, ApplyFn apply);
+
+    Transport::Handlers handlers();
+    Transport& transport() { return *m_transport; }
+
+    // Enables anti-entropy; set before the transport starts. get reads the
+    // current local value of a key. Mutations sent to peers carry the HLC
+    // stamp index records for their key.
+    void setAntiEntropy(MerkleIndex* index, GetFn get);
+    // Starts a summary comparison with peerId (also done on connect).
+    void startAntiEntropy(const std::string& peerId);
+
+    // Sync worker: push a delivered batch to every connected peer.
+    void publish(const std::vector<OutboundItem>& batch);
+    // Local AppendLog append.
+    void publishLog(const std::string& logId, const LogEntry& entry);
+
+private:
+    struct Peer {
+        wire::WireSession tx;    // guarded by m_txMutex
+        wire::WireSession rx;    // transport thread only
+        std::vector<wire::WireMutation> rxItems;
+        bool resyncRequested = false;
+    };
+
+    void onPeerConnected(const std::string& peerId);
+    void onPeerDisconnected(const std::string& peerId);
+    void onMessage(const std::string& peerId, const uint8_t* data, size_t len);
+
+    std::shared_ptr<Peer> findPeer(const std::string& peerId);
+
+    // Callers of these hold m_txMutex
+    void sendUpdates(const std::string& peerId, const std::vector<std::string>& keys);
+    void sendMutations(const std::vector<std::string>& peerIds, const std::vector<const SyncFrame*>& frames,
+                       const std::vector<storage::SyncMetadata>& metas);
+    void flushMutations(const std::vector<std::string>& peerIds, std::vector<wire::WireMutation>& items,
+                        size_t payloadBytes);
+
+    void sendLogRange(const std::string& peerId, const std::string& logId, uint64_t fromSeq);
+    template <typename Fn>
+    Transport::Frame buildFrame(wire::FrameType type, size_t bound, Fn&& body);
+
+    // Metadata for each frame from the MerkleIndex; drops frames whose
+    // value is no longer the recorded one for their key.
+    std::vector<storage::SyncMetadata> stampFrames(std::vector<const SyncFrame*>& frames);
+
+    void onMutations(const std::string& peerId, wire::WireReader& r);
+
+    // Anti-entropy
+    void sendDigest(const std::string& peerId, uint32_t level, uint32_t index);
+    void sendLeafItems(const std::string& peerId, uint32_t leaf, const std::vector<MerkleIndex::Item>& items, bool reply);
+    void onDigest(const std::string& peerId, wire::WireReader& r);
+    void onLeafItems(const std::string& peerId, wire::WireReader& r);
+
+    std::shared_ptr<Transport> m_transport;
+    DeltaSync& m_delta;
+    AppendLog& m_log;
+    SyncMetrics& m_metrics;
+    ApplyFn m_apply;
+    MerkleIndex* m_merkle = nullptr;
+    GetFn m_get;
+
+    // Mutations frames are encoded and queued under this lock so versions of
+    // a key reach each peer in order
+    std::mutex m_txMutex;
+
+    std::mutex m_peersMutex;
+    std::unordered_map<std::string, std::shared_ptr<Peer>> m_peers;
+};
+
+} // namespace aegis
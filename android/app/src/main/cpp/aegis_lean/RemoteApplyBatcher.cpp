@@ -0,0 +1,206 @@
+#include "RemoteApplyBatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string_view>
+#include <unordered_map>
+
+namespace aegis {
+
+RemoteApplyBatcher::RemoteApplyBatcher(MerkleIndex& index, HybridClock& clock, SyncMetrics& metrics, ApplyFn apply,
+                                       NotifyFn notify)
+    : m_index(index), m_clock(clock), m_metrics(metrics), m_apply(std::move(apply)), m_notify(std::move(notify)) {}
+
+RemoteApplyBatcher::~RemoteApplyBatcher() {
+    stop();
+}
+
+void RemoteApplyBatcher::setLimits(const Limits& limits) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_limits = limits;
+    }
+    m_spaceCv.notify_all();
+}
+
+void RemoteApplyBatcher::start() {
+    if (m_running.exchange(true)) return;
+    m_stop = false;
+    m_worker = std::thread(&RemoteApplyBatcher::run, this);
+}
+
+void RemoteApplyBatcher::stop() {
+    if (!m_running) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    m_spaceCv.notify_all();
+    if (m_worker.joinable()) m_worker.join();
+    m_running = false;
+    m_doneCv.notify_all();
+}
+
+void RemoteApplyBatcher::stage(const std::string& key, const std::vector<uint8_t>& data,
+                               const storage::SyncMetadata& meta) {
+    size_t bytes = key.size() + data.size();
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto hasRoom = [&] {
+            return m_staged.empty() || (m_staged.size() < m_limits.maxStagedCount &&
+                                        m_stagedBytes + bytes <= m_limits.maxStagedBytes);
+        };
+        if (!hasRoom() && m_running && !m_stop && std::this_thread::get_id() != m_worker.get_id()) {
+            m_metrics.remoteStageWaits++;
+            m_cv.notify_one();
+            m_spaceCv.wait(lock, [&] { return hasRoom() || m_stop || !m_running; });
+        }
+        m_staged.push_back(Staged{key, data, meta, VersionStamp{}});
+        m_stagedBytes += bytes;
+        m_stagedSeq++;
+    }
+    m_cv.notify_one();
+}
+
+void RemoteApplyBatcher::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_running) {
+        // No worker: apply on the caller's thread
+        std::vector<Staged> batch;
+        batch.swap(m_staged);
+        m_stagedBytes = 0;
+        uint64_t seq = m_stagedSeq;
+        lock.unlock();
+        applyBatch(batch);
+        lock.lock();
+        m_appliedSeq = std::max(m_appliedSeq, seq);
+        return;
+    }
+    uint64_t target = m_stagedSeq;
+    m_doneCv.wait(lock, [this, target] { return m_appliedSeq >= target || !m_running; });
+}
+
+void RemoteApplyBatcher::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_cv.wait(lock, [this] { return m_stop || !m_staged.empty(); });
+        if (m_staged.empty()) break; // stopping, nothing left to drain
+
+        // Everything that piled up while the previous batch ran
+        std::vector<Staged> batch;
+        batch.swap(m_staged);
+        m_stagedBytes = 0;
+        uint64_t seq = m_stagedSeq;
+        m_spaceCv.notify_all();
+
+        lock.unlock();
+        applyBatch(batch);
+        lock.lock();
+
+        m_appliedSeq = seq;
+        m_doneCv.notify_all();
+    }
+}
+
+void RemoteApplyBatcher::applyBatch(std::vector<Staged>& batch) {
+    if (batch.empty()) return;
+    auto started = std::chrono::steady_clock::now();
+
+    // 1. Stamp and coalesce: newest version per key wins within the batch
+    std::unordered_map<std::string, uint32_t> clients;
+    std::unordered_map<std::string_view, size_t> latest;
+    latest.reserve(batch.size());
+    std::vector<size_t> order; // first-seen order of distinct keys
+    uint64_t rejected = 0;
+    for (size_t i = 0; i < batch.size(); i++) {
+        auto& item = batch[i];
+        uint64_t hlc = HybridClock::normalize(item.meta.timestamp);
+        if (!m_clock.observe(hlc)) {
+            rejected++;
+            std::cerr << "[RemoteApply] Dropped update for " << item.key << ": clock of " << item.meta.clientId
+                      << " too far ahead" << std::endl;
+            continue;
+        }
+        auto client = clients.find(item.meta.clientId);
+        if (client == clients.end()) {
+            client = clients.emplace(item.meta.clientId, m_index.clientIndex(item.meta.clientId)).first;
+        }
+        item.stamp = VersionStamp{hlc, client->second};
+
+        auto [it, inserted] = latest.emplace(item.key, i);
+        if (inserted) {
+            order.push_back(i);
+        } else if (!m_index.newer(batch[it->second].stamp, item.stamp)) {
+            // Same or newer stamp later in the stream replaces the earlier one
+            it->second = i;
+        }
+    }
+    m_metrics.remoteClockRejects += rejected;
+
+    std::vector<size_t> winners;
+    winners.reserve(order.size());
+    std::vector<std::string_view> keys;
+    keys.reserve(order.size());
+    for (size_t first : order) {
+        size_t i = latest[batch[first].key];
+        winners.push_back(i);
+        keys.push_back(batch[i].key);
+    }
+    m_metrics.remoteCoalesced += batch.size() - rejected - winners.size();
+
+    // 2. Conflict check against stored versions: one integer compare per key
+    auto stored = m_index.stamps(keys);
+    size_t n = winners.size();
+    std::vector<uint64_t> incoming(n), current(n);
+    for (size_t k = 0; k < n; k++) {
+        incoming[k] = batch[winners[k]].stamp.hlc;
+        current[k] = stored[k] ? stored[k]->hlc : 0;
+    }
+    std::vector<uint8_t> wins(n);
+    for (size_t k = 0; k < n; k++) {
+        wins[k] = incoming[k] > current[k];
+    }
+    for (size_t k = 0; k < n; k++) {
+        // Equal HLCs (or a zero stamp on a new key) settle on the client id
+        if (incoming[k] == current[k]) {
+            wins[k] = !stored[k] || m_index.newer(batch[winners[k]].stamp, *stored[k]);
+        }
+    }
+
+    // 3. Write winners, record them in one index transaction, notify per key
+    std::vector<MerkleIndex::Update> updates;
+    std::vector<size_t> applied;
+    updates.reserve(n);
+    applied.reserve(n);
+    uint64_t stale = 0;
+    for (size_t k = 0; k < n; k++) {
+        auto& item = batch[winners[k]];
+        if (!wins[k]) {
+            stale++;
+            continue;
+        }
+        // The store keeps millisecond timestamps
+        storage::SyncMetadata storeMeta = item.meta;
+        storeMeta.timestamp = HybridClock::physicalMs(item.stamp.hlc);
+        if (!m_apply(item.key, item.data, storeMeta)) continue;
+        updates.push_back(MerkleIndex::Update{item.key, MerkleIndex::itemHash(item.key, item.data.data(), item.data.size()),
+                                              item.stamp});
+        applied.push_back(winners[k]);
+    }
+    m_index.updateBatch(updates);
+
+    m_metrics.remoteStale += stale;
+    m_metrics.remoteApplied += applied.size();
+    m_metrics.remoteBatches++;
+    m_metrics.lastRemoteBatchUs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count());
+
+    if (m_notify) {
+        for (size_t i : applied) {
+            m_notify(batch[i].key, batch[i].data);
+        }
+    }
+}
+
+} // namespace aegis
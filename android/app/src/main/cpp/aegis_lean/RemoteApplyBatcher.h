@@ -0,0 +1,95 @@
+#pragma once
+
+#include "HybridClock.h"
+#include "MerkleIndex.h"
+#include "SyncMetrics.h"
+#include "storage/storage_manager.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aegis {
+
+/**
+ * RemoteApplyBatcher
+ * Apply pipeline for incoming remote updates. Transports stage updates and
+ * return immediately; a worker takes everything staged so far as one batch:
+ *
+ *   1. coalesce per key, keeping the newest stamp (HLC, then client id)
+ *   2. fetch the stored stamps of all batch keys in one read transaction and
+ *      compare the packed HLCs in one pass
+ *   3. hand the winners to the store, record them in the MerkleIndex in one
+ *      transaction and emit one change notification per key
+ *
+ * A reconnect burst with many versions of the same keys therefore costs one
+ * store write and one callback per key instead of one per version.
+ *
+ * Staging is bounded: past the Limits, stage() blocks the transport thread
+ * until the worker takes the staged batch, so a peer faster than the store
+ * is slowed down instead of growing the queue.
+ */
+class RemoteApplyBatcher {
+public:
+    // Writes a winning update (LocalDB::applyRemoteUpdate); false if refused.
+    using ApplyFn = std::function<bool(const std::string& key, const std::vector<uint8_t>& data,
+                                       const storage::SyncMetadata& meta)>;
+    using NotifyFn = std::function<void(const std::string& key, const std::vector<uint8_t>& data)>;
+
+    struct Limits {
+        size_t maxStagedCount = 65536;
+        size_t maxStagedBytes = 32 * 1024 * 1024; // keys and values
+    };
+
+    RemoteApplyBatcher(MerkleIndex& index, HybridClock& clock, SyncMetrics& metrics, ApplyFn apply, NotifyFn notify);
+    ~RemoteApplyBatcher();
+
+    void setLimits(const Limits& limits);
+
+    void start();
+    // Applies whatever is still staged, then joins the worker.
+    void stop();
+
+    // Any thread. meta.timestamp is an HLC stamp (plain ms is normalised).
+    // Waits while the staged updates are over the limits (never without a
+    // running worker, or on the worker itself).
+    void stage(const std::string& key, const std::vector<uint8_t>& data, const storage::SyncMetadata& meta);
+    // Blocks until everything staged before the call has been applied.
+    void flush();
+
+private:
+    struct Staged {
+        std::string key;
+        std::vector<uint8_t> data;
+        storage::SyncMetadata meta;
+        VersionStamp stamp;
+    };
+
+    void run();
+    void applyBatch(std::vector<Staged>& batch);
+
+    MerkleIndex& m_index;
+    HybridClock& m_clock;
+    SyncMetrics& m_metrics;
+    ApplyFn m_apply;
+    NotifyFn m_notify;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_doneCv;
+    std::condition_variable m_spaceCv;
+    Limits m_limits;
+    std::vector<Staged> m_staged;
+    size_t m_stagedBytes = 0;
+    uint64_t m_stagedSeq = 0;  // updates staged so far
+    uint64_t m_appliedSeq = 0; // updates fully processed so far
+    bool m_stop = false;
+    std::atomic<bool> m_running{false};
+    std::thread m_worker;
+};
+
+} // namespace aegis
@@ -0,0 +1,335 @@
+#include "SegmentLog.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace aegis {
+
+namespace {
+
+// On-disk record: [u32 len][u32 crc][u64 seq][len bytes], little-endian.
+// crc covers seq and payload.
+constexpr size_t kHeaderBytes = 16;
+
+const std::array<uint32_t, 256>& crcTable() {
+    static const auto table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t len) {
+    const auto& table = crcTable();
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t recordCrc(uint64_t seq, const uint8_t* data, size_t len) {
+    uint8_t seqBytes[8];
+    for (int i = 0; i < 8; i++) seqBytes[i] = static_cast<uint8_t>(seq >> (8 * i));
+    return crc32Update(crc32Update(0, seqBytes, 8), data, len);
+}
+
+void put32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = static_cast<uint8_t>(v >> (8 * i)); }
+void put64(uint8_t* p, uint64_t v) { for (int i = 0; i < 8; i++) p[i] = static_cast<uint8_t>(v >> (8 * i)); }
+uint32_t get32(const uint8_t* p) { uint32_t v = 0; for (int i = 3; i >= 0; i--) v = (v << 8) | p[i]; return v; }
+uint64_t get64(const uint8_t* p) { uint64_t v = 0; for (int i = 7; i >= 0; i--) v = (v << 8) | p[i]; return v; }
+
+// Read-only mapping of a whole segment.
+struct Mapping {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    Mapping(const std::string& path, size_t length) {
+        if (length == 0) return;
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+        void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return;
+        ::madvise(p, length, MADV_SEQUENTIAL);
+        data = static_cast<const uint8_t*>(p);
+        size = length;
+    }
+    ~Mapping() {
+        if (data) ::munmap(const_cast<uint8_t*>(data), size);
+    }
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+};
+
+// Walks valid records in [data, data+size): consecutive sequence numbers
+// from baseSeq, so what a recycled segment held before ends the walk like a
+// torn record does. Returns the offset just past the last valid record.
+template <typename Fn>
+size_t scanRecords(const uint8_t* data, size_t size, uint64_t baseSeq, Fn&& fn) {
+    size_t off = 0;
+    while (off + kHeaderBytes <= size) {
+        uint32_t len = get32(data + off);
+        uint32_t crc = get32(data + off + 4);
+        uint64_t seq = get64(data + off + 8);
+        if (seq != baseSeq++ || len > size - off - kHeaderBytes) break;
+        const uint8_t* payload = data + off + kHeaderBytes;
+        if (recordCrc(seq, payload, len) != crc) break;
+        if (!fn(seq, payload, static_cast<size_t>(len))) return off + kHeaderBytes + len;
+        off += kHeaderBytes + len;
+    }
+    return off;
+}
+
+} // namespace
+
+SegmentLog::~SegmentLog() {
+    close();
+}
+
+std::string SegmentLog::segmentPath(uint64_t baseSeq) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%020llu.seg", static_cast<unsigned long long>(baseSeq));
+    return m_dir + "/" + name;
+}
+
+bool SegmentLog::open(const std::string& dir) {
+    return open(dir, Options());
+}
+
+bool SegmentLog::open(const std::string& dir, Options options) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_tailFd >= 0) return true;
+
+    m_options = options;
+    m_dir = dir;
+    if (::mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+        std::cerr << "[SegmentLog] Cannot create " << dir << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Low-water mark: [u64 seq][u32 crc]
+    m_ackFd = ::open((dir + "/ack").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (m_ackFd < 0) return false;
+    uint8_t ackBuf[12];
+    if (::pread(m_ackFd, ackBuf, sizeof(ackBuf), 0) == static_cast<ssize_t>(sizeof(ackBuf)) &&
+        crc32Update(0, ackBuf, 8) == get32(ackBuf + 8)) {
+        m_lowWater = get64(ackBuf);
+    }
+
+    m_segments.clear();
+    if (DIR* d = ::opendir(dir.c_str())) {
+        while (dirent* entry = ::readdir(d)) {
+            std::string name = entry->d_name;
+            if (name.size() != 24 || name.compare(20, 4, ".seg") != 0) continue;
+            uint64_t base = std::strtoull(name.substr(0, 20).c_str(), nullptr, 10);
+            struct stat st {};
+            std::string path = dir + "/" + name;
+            if (::stat(path.c_str(), &st) != 0) continue;
+            m_segments.push_back({base, path, static_cast<size_t>(st.st_size)});
+        }
+        ::closedir(d);
+    }
+    struct stat spare {};
+    if (::stat((dir + "/spare").c_str(), &spare) == 0) m_spare = dir + "/spare";
+
+    std::sort(m_segments.begin(), m_segments.end(),
+              [](const Segment& a, const Segment& b) { return a.baseSeq < b.baseSeq; });
+
+    m_nextSeq = std::max<uint64_t>(m_lowWater + 1, m_segments.empty() ? 1 : m_segments.front().baseSeq);
+    if (!recoverTail()) return false;
+    return true;
+}
+
+bool SegmentLog::recoverTail() {
+    if (m_segments.empty()) return openTail(m_nextSeq);
+
+    Segment& tail = m_segments.back();
+    uint64_t last = tail.baseSeq - 1;
+    size_t valid;
+    {
+        Mapping map(tail.path, tail.size);
+        valid = scanRecords(map.data, map.data ? map.size : 0, tail.baseSeq, [&](uint64_t seq, const uint8_t*, size_t) {
+            last = seq;
+            return true;
+        });
+    }
+    // Past the last valid record: a torn append, or space a recycled
+    // segment still has allocated. Appends overwrite it from there.
+    tail.size = valid;
+    m_nextSeq = std::max(m_nextSeq, last + 1);
+
+    m_tailFd = ::open(tail.path.c_str(), O_WRONLY | O_CLOEXEC);
+    return m_tailFd >= 0;
+}
+
+bool SegmentLog::openTail(uint64_t baseSeq) {
+    std::string path = segmentPath(baseSeq);
+    if (!m_spare.empty()) {
+        // Reuse a recycled segment: its blocks stay allocated and appends
+        // overwrite its old records in place (size is the write offset)
+        if (::rename(m_spare.c_str(), path.c_str()) != 0) ::unlink(m_spare.c_str());
+        m_spare.clear();
+    }
+    m_tailFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0600);
+    if (m_tailFd < 0) {
+        std::cerr << "[SegmentLog] Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    m_segments.push_back({baseSeq, path, 0});
+    return true;
+}
+
+bool SegmentLog::rotate() {
+    // Drop what a recycled segment held past the new records, then seal:
+    // sealed segments are never rescanned
+    if (::ftruncate(m_tailFd, static_cast<off_t>(m_segments.back().size)) != 0) {
+        std::cerr << "[SegmentLog] Sealing truncate failed: " << std::strerror(errno) << std::endl;
+    }
+    ::fdatasync(m_tailFd);
+    ::close(m_tailFd);
+    m_tailFd = -1;
+    return openTail(m_nextSeq);
+}
+
+void SegmentLog::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_tailFd >= 0) {
+        ::fdatasync(m_tailFd);
+        ::close(m_tailFd);
+        m_tailFd = -1;
+    }
+    if (m_ackFd >= 0) {
+        ::close(m_ackFd);
+        m_ackFd = -1;
+    }
+    m_segments.clear();
+}
+
+uint64_t SegmentLog::append(const uint8_t* data, size_t len) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_tailFd < 0 || len > UINT32_MAX) return 0;
+
+    if (m_segments.back().size > 0 && m_segments.back().size + kHeaderBytes + len > m_options.segmentBytes) {
+        if (!rotate()) return 0;
+    }
+
+    uint64_t seq = m_nextSeq;
+    uint8_t header[kHeaderBytes];
+    put32(header, static_cast<uint32_t>(len));
+    put32(header + 4, recordCrc(seq, data, len));
+    put64(header + 8, seq);
+
+    iovec iov[2] = {{header, kHeaderBytes}, {const_cast<uint8_t*>(data), len}};
+    ssize_t n = ::pwritev(m_tailFd, iov, 2, static_cast<off_t>(m_segments.back().size));
+    if (n != static_cast<ssize_t>(kHeaderBytes + len)) {
+        // The write offset stays put: the next append overwrites the
+        // partial record, and a scan stops at it until then
+        std::cerr << "[SegmentLog] Append failed: " << std::strerror(errno) << std::endl;
+        return 0;
+    }
+    if (m_options.syncEveryAppend) ::fdatasync(m_tailFd);
+
+    m_segments.back().size += kHeaderBytes + len;
+    m_nextSeq++;
+    return seq;
+}
+
+size_t SegmentLog::replay(uint64_t afterSeq, size_t maxRecords, const RecordFn& fn) {
+    std::vector<Segment> segments;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        segments = m_segments; // size snapshot: bytes appended later are not visited
+    }
+
+    size_t visited = 0;
+    for (size_t i = 0; i < segments.size() && visited < maxRecords; i++) {
+        // Skip segments that end at or before afterSeq
+        if (i + 1 < segments.size() && segments[i + 1].baseSeq <= afterSeq + 1) continue;
+
+        Mapping map(segments[i].path, segments[i].size);
+        if (!map.data) continue;
+        bool stopped = false;
+        scanRecords(map.data, map.size, segments[i].baseSeq, [&](uint64_t seq, const uint8_t* data, size_t len) {
+            if (seq <= afterSeq) return true;
+            visited++;
+            if (!fn(seq, data, len) || visited >= maxRecords) {
+                stopped = true;
+                return false;
+            }
+            return true;
+        });
+        if (stopped) break;
+    }
+    return visited;
+}
+
+void SegmentLog::ack(uint64_t seq) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (seq <= m_lowWater || m_ackFd < 0) return;
+    m_lowWater = std::min(seq, m_nextSeq - 1);
+    persistLowWater();
+
+    // Recycle segments whose every record is acknowledged (never the tail)
+    while (m_segments.size() > 1 && m_segments[1].baseSeq <= m_lowWater + 1) {
+        const std::string path = m_segments.front().path;
+        m_segments.erase(m_segments.begin());
+        if (m_spare.empty()) {
+            m_spare = m_dir + "/spare";
+            if (::rename(path.c_str(), m_spare.c_str()) != 0) {
+                ::unlink(path.c_str());
+                m_spare.clear();
+            }
+        } else {
+            ::unlink(path.c_str());
+        }
+    }
+}
+
+void SegmentLog::persistLowWater() {
+    uint8_t buf[12];
+    put64(buf, m_lowWater);
+    put32(buf + 8, crc32Update(0, buf, 8));
+    if (::pwrite(m_ackFd, buf, sizeof(buf), 0) != static_cast<ssize_t>(sizeof(buf))) {
+        std::cerr << "[SegmentLog] Persisting low-water mark failed: " << std::strerror(errno) << std::endl;
+    }
+}
+
+uint64_t SegmentLog::lowWater() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lowWater;
+}
+
+uint64_t SegmentLog::lastSeq() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nextSeq - 1;
+}
+
+size_t SegmentLog::pendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<size_t>(m_nextSeq - 1 - std::min(m_lowWater, m_nextSeq - 1));
+}
+
+size_t SegmentLog::pendingBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t bytes = 0;
+    for (size_t i = 0; i < m_segments.size(); i++) {
+        bool fullyAcked = i + 1 < m_segments.size() && m_segments[i + 1].baseSeq <= m_lowWater + 1;
+        if (!fullyAcked) bytes += m_segments[i].size;
+    }
+    return bytes;
+}
+
+} // namespace aegis
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace aegis {
+
+/**
+ * SegmentLog
+ * Append-only record log split into fixed-size segment files
+ * (<dir>/<firstSeq>.seg). Every record carries its sequence number and a
+ * CRC32; appends are sequential writes to the tail segment.
+ *
+ * Consumers acknowledge with a low-water mark (everything <= seq is done).
+ * Segments that fall entirely below it are recycled as the next tail
+ * segment, or deleted. A recycled tail keeps its allocated length and is
+ * overwritten from the start; the segment's size is the write offset.
+ * Replay mmaps whole segments and hands out pointers into the mapping, so
+ * it does not copy.
+ *
+ * Records in a segment carry consecutive sequence numbers from its base,
+ * which tells them apart from what a recycled file held before. Only the
+ * tail segment can be torn by a crash; open() scans just that one and
+ * appends from its first bad record on. Older segments were truncated to
+ * their records and fsynced when they were sealed.
+ *
+ * Threading: append() may run concurrently with replay()/ack(), but replay
+ * and ack must come from one consumer thread.
+ */
+class SegmentLog {
+public:
+    struct Options {
+        size_t segmentBytes = 4 * 1024 * 1024;
+        bool syncEveryAppend = false; // fdatasync after each record
+    };
+
+    // Return false to stop the replay early.
+    using RecordFn = std::function<bool(uint64_t seq, const uint8_t* data, size_t len)>;
+
+    SegmentLog() = default;
+    ~SegmentLog();
+    SegmentLog(const SegmentLog&) = delete;
+    SegmentLog& operator=(const SegmentLog&) = delete;
+
+    bool open(const std::string& dir);
+    bool open(const std::string& dir, Options options);
+    void close();
+
+    // Returns the record's sequence number, or 0 on failure.
+    uint64_t append(const uint8_t* data, size_t len);
+
+    // Visits records with seq > afterSeq in order, at most maxRecords of them.
+    size_t replay(uint64_t afterSeq, size_t maxRecords, const RecordFn& fn);
+
+    void ack(uint64_t seq);
+
+    uint64_t lowWater() const;
+    uint64_t lastSeq() const;
+    size_t pendingCount() const;
+    size_t pendingBytes() const; // upper bound: sizes of segments holding unacked records
+
+private:
+    struct Segment {
+        uint64_t baseSeq;
+        std::string path;
+        size_t size; // bytes of valid records (the tail's write offset)
+    };
+
+    bool recoverTail();
+    bool openTail(uint64_t baseSeq);
+    bool rotate();
+    void persistLowWater();
+    std::string segmentPath(uint64_t baseSeq) const;
+
+    Options m_options;
+    std::string m_dir;
+
+    mutable std::mutex m_mutex;
+    std::vector<Segment> m_segments; // sorted by baseSeq, last is the tail
+    int m_tailFd = -1;
+    int m_ackFd = -1;
+    uint64_t m_nextSeq = 1;
+    uint64_t m_lowWater = 0;
+    std::string m_spare; // recycled segment waiting to become the next tail
+};
+
+} // namespace aegis
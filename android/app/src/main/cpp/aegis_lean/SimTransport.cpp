@@ -0,0 +1,56 @@
+#include "SimTransport.h"
+#include <iostream>
+
+namespace aegis {
+
+SimTransport::SimTransport(SimNetwork& network, std::string clientId, SyncMetrics& metrics)
+    : m_network(network), m_clientId(std::move(clientId)), m_metrics(metrics) {}
+
+SimTransport::~SimTransport() {
+    stop();
+}
+
+bool SimTransport::start(Handlers handlers) {
+    if (m_started) return true;
+    auto onMessage = std::move(handlers.onMessage);
+    handlers.onMessage = [this, onMessage](const std::string& peerId, const uint8_t* data, size_t len) {
+        m_metrics.bytesReceived += len;
+        if (onMessage) onMessage(peerId, data, len);
+    };
+    if (!m_network.attach(m_clientId, std::move(handlers))) {
+        std::cerr << "[SimTransport] Node id already in use: " << m_clientId << std::endl;
+        return false;
+    }
+    m_started = true;
+    return true;
+}
+
+void SimTransport::stop() {
+    if (!m_started.exchange(false)) return;
+    m_network.detach(m_clientId);
+}
+
+bool SimTransport::connect(const std::string& address, int /*port*/) {
+    if (!m_started) return false;
+    const std::string prefix = "sim:";
+    std::string peerId = address.compare(0, prefix.size(), prefix) == 0 ? address.substr(prefix.size()) : address;
+    return m_network.connect(m_clientId, peerId);
+}
+
+bool SimTransport::send(const std::string& peerId, Frame message) {
+    if (!m_started || !message) return false;
+    size_t len = message->size();
+    if (!m_network.send(m_clientId, peerId, message)) return false;
+    m_metrics.bytesSent += len;
+    return true;
+}
+
+std::vector<std::string> SimTransport::peers() const {
+    return m_network.peersOf(m_clientId);
+}
+
+size_t SimTransport::peerCount() const {
+    return m_network.peerCountOf(m_clientId);
+}
+
+} // namespace aegis
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "NetworkSim.h"
+#include "SyncMetrics.h"
+#include "Transport.h"
+#include <atomic>
+#include <string>
+
+namespace aegis {
+
+/**
+ * SimTransport
+ * Transport endpoint on a SimNetwork. Peers are addressed by clientId
+ * ("sim:<clientId>" or the bare id); the port is ignored. Handlers run on
+ * whichever thread drives the network.
+ */
+class SimTransport : public Transport {
+public:
+    SimTransport(SimNetwork& network, std::string clientId, SyncMetrics& metrics);
+    ~SimTransport() override;
+
+    bool start(Handlers handlers) override;
+    void stop() override;
+    bool connect(const std::string& address, int port) override;
+    using Transport::send;
+    bool send(const std::string& peerId, Frame message) override;
+    std::vector<std::string> peers() const override;
+    size_t peerCount() const override;
+    const std::string& localId() const override { return m_clientId; }
+
+    SimNetwork& network() { return m_network; }
+
+private:
+    SimNetwork& m_network;
+    std::string m_clientId;
+    SyncMetrics& m_metrics;
+    std::atomic<bool> m_started{false};
+};
+
+} // namespace aegis
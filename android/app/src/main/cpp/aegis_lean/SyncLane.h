@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace aegis {
+
+// Priority classes for outgoing mutations. Move is drained with strict
+// priority; the others share the remaining bandwidth by weight.
+enum class SyncLane : uint8_t {
+    Move = 0,     // match moves: must go out immediately
+    Clock = 1,    // clock / turn state
+    Presence = 2, // presence, typing
+    Document = 3, // everything without a more specific rule
+    Bulk = 4,     // attachments and other large blobs
+};
+
+constexpr size_t kSyncLaneCount = 5;
+
+inline const char* syncLaneName(SyncLane lane) {
+    switch (lane) {
+        case SyncLane::Move: return "move";
+        case SyncLane::Clock: return "clock";
+        case SyncLane::Presence: return "presence";
+        case SyncLane::Document: return "document";
+        case SyncLane::Bulk: return "bulk";
+    }
+    return "unknown";
+}
+
+} // namespace aegis
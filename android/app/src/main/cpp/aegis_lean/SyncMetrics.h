@@ -0,0 +1,131 @@
+#pragma once
+
+#include "SyncLane.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace aegis {
+
+// Process-wide sync counters. Written from the sync path, read by the
+// observability FFI (aegis_flutter_get_bandwidth_stats).
+struct SyncLaneMetrics {
+    std::atomic<uint64_t> depth{0};        // gauge: mutations queued in this lane
+    std::atomic<uint64_t> enqueued{0};
+    std::atomic<uint64_t> sent{0};
+    std::atomic<uint64_t> latencySumUs{0}; // enqueue -> handed to SyncManager
+    std::atomic<uint64_t> latencyMaxUs{0};
+
+    void reset() {
+        depth = 0;
+        enqueued = 0;
+        sent = 0;
+        latencySumUs = 0;
+        latencyMaxUs = 0;
+    }
+};
+
+struct SyncMetrics {
+    std::atomic<uint64_t> bytesSent{0};
+    std::atomic<uint64_t> bytesReceived{0};
+
+    // Delta encoding (DeltaSync)
+    std::atomic<uint64_t> deltaFrames{0};
+    std::atomic<uint64_t> fullFrames{0};
+    std::atomic<uint64_t> bytesSaved{0};   // full size - encoded size, summed over delta frames
+    std::atomic<uint64_t> deltaMisses{0};  // peer could not resolve the base, resent in full
+    std::atomic<uint64_t> deltaHistoryKeys{0};      // gauge: keys with local versions kept as bases
+    std::atomic<uint64_t> deltaHistoryBytes{0};     // gauge
+    std::atomic<uint64_t> deltaHistoryEvictions{0}; // keys dropped over the byte budget
+    std::atomic<uint64_t> deltaReceivedBytes{0};     // gauge: peers' values kept as bases for their deltas
+    std::atomic<uint64_t> deltaReceivedEvictions{0}; // (peer, key) bases dropped over the byte budget
+
+    // Peer wire format (PeerSync)
+    std::atomic<uint64_t> wireFrames{0};        // Mutations frames sent
+    std::atomic<uint64_t> wireMutations{0};     // mutations carried by them
+    std::atomic<uint64_t> wireOverheadBytes{0}; // frame bytes minus payload bytes
+    std::atomic<uint64_t> wireDecodeErrors{0};
+
+    // Anti-entropy (PeerSync + MerkleIndex)
+    std::atomic<uint64_t> antiEntropyDigests{0}; // summary nodes sent
+    std::atomic<uint64_t> antiEntropyLeaves{0};  // leaf key lists sent
+    std::atomic<uint64_t> antiEntropyKeys{0};    // values pushed to repair a difference
+
+    // Remote apply (RemoteApplyBatcher)
+    std::atomic<uint64_t> remoteApplied{0};
+    std::atomic<uint64_t> remoteStale{0};        // older than the stored version, dropped
+    std::atomic<uint64_t> remoteCoalesced{0};    // superseded by a newer version in the same batch
+    std::atomic<uint64_t> remoteClockRejects{0}; // HLC too far ahead of local wall time
+    std::atomic<uint64_t> remoteBatches{0};
+    std::atomic<uint64_t> remoteStageWaits{0};   // stage() calls that waited for the worker
+    std::atomic<uint64_t> lastRemoteBatchUs{0};
+
+    // Append logs (AppendLog)
+    std::atomic<uint64_t> logConflicts{0}; // same-seq entries from two writers, settled by applyRemote
+
+    // Sync worker (SyncScheduler)
+    std::atomic<uint64_t> syncPasses{0};
+    std::atomic<uint64_t> syncBatches{0};
+    std::atomic<uint64_t> syncFailures{0};
+    std::atomic<uint64_t> mutationsSynced{0};
+    std::atomic<uint64_t> syncPending{0};     // gauge: mutations waiting for the worker
+    std::atomic<uint64_t> syncBackoffMs{0};   // gauge: current retry backoff, 0 when healthy
+    std::atomic<uint64_t> lastSyncPassUs{0};
+
+    std::array<SyncLaneMetrics, kSyncLaneCount> lanes;
+
+    // Memory bounds (OutboundQueue)
+    std::atomic<uint64_t> residentMutations{0};   // gauge
+    std::atomic<uint64_t> residentBytes{0};       // gauge
+    std::atomic<uint64_t> spilledPending{0};      // gauge: left in storage, awaiting replay
+    std::atomic<uint64_t> spilledPendingBytes{0}; // gauge
+    std::atomic<uint64_t> spilledMutations{0};
+    std::atomic<uint64_t> backpressureWaits{0};
+    std::atomic<uint64_t> rejectedWrites{0};
+
+    void reset() {
+        bytesSent = 0;
+        bytesReceived = 0;
+        deltaFrames = 0;
+        fullFrames = 0;
+        bytesSaved = 0;
+        deltaMisses = 0;
+        deltaHistoryKeys = 0;
+        deltaHistoryBytes = 0;
+        deltaHistoryEvictions = 0;
+        deltaReceivedBytes = 0;
+        deltaReceivedEvictions = 0;
+        wireFrames = 0;
+        wireMutations = 0;
+        wireOverheadBytes = 0;
+        wireDecodeErrors = 0;
+        antiEntropyDigests = 0;
+        antiEntropyLeaves = 0;
+        antiEntropyKeys = 0;
+        remoteApplied = 0;
+        remoteStale = 0;
+        remoteCoalesced = 0;
+        remoteClockRejects = 0;
+        remoteBatches = 0;
+        remoteStageWaits = 0;
+        lastRemoteBatchUs = 0;
+        logConflicts = 0;
+        syncPasses = 0;
+        syncBatches = 0;
+        syncFailures = 0;
+        mutationsSynced = 0;
+        syncPending = 0;
+        syncBackoffMs = 0;
+        lastSyncPassUs = 0;
+        for (auto& lane : lanes) lane.reset();
+        residentMutations = 0;
+        residentBytes = 0;
+        spilledPending = 0;
+        spilledPendingBytes = 0;
+        spilledMutations = 0;
+        backpressureWaits = 0;
+        rejectedWrites = 0;
+    }
+};
+
+} // namespace aegis
@@ -0,0 +1,174 @@
+#include "SyncScheduler.h"
+#include <iostream>
+
+namespace aegis {
+
+SyncScheduler::SyncScheduler(OutboundQueue& queue, SyncMetrics& metrics, BatchSink sink, ReplayFn replay)
+    : SyncScheduler(queue, metrics, std::move(sink), std::move(replay), Options()) {}
+
+SyncScheduler::SyncScheduler(OutboundQueue& queue, SyncMetrics& metrics, BatchSink sink, ReplayFn replay, Options options)
+    : m_queue(queue), m_metrics(metrics), m_sink(std::move(sink)), m_replay(std::move(replay)), m_options(options) {
+    if (m_options.batchSize == 0) m_options.batchSize = 1;
+}
+
+SyncScheduler::~SyncScheduler() {
+    stop();
+}
+
+void SyncScheduler::start() {
+    if (m_running.exchange(true)) return;
+    m_stop = false;
+    m_worker = std::thread(&SyncScheduler::run, this);
+}
+
+void SyncScheduler::stop() {
+    if (!m_running) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    if (m_worker.joinable()) m_worker.join();
+    m_running = false;
+}
+
+void SyncScheduler::nudge() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wakeup = true;
+    }
+    m_cv.notify_one();
+}
+
+void SyncScheduler::requestReplay() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_replayRequested = true;
+        m_wakeup = true;
+        m_backoff = std::chrono::milliseconds(0); // Explicit request skips the backoff wait
+    }
+    m_cv.notify_one();
+}
+
+void SyncScheduler::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        if (m_backoff.count() > 0) {
+            // Retry after the backoff expires, or earlier on an explicit
+            // replay request or a nudge with moves queued: moves never wait
+            // out a backoff meant for bulk traffic
+            m_cv.wait_for(lock, m_backoff, [this] {
+                return m_stop || m_replayRequested || (m_wakeup && m_queue.depth(SyncLane::Move) > 0);
+            });
+        } else {
+            m_cv.wait(lock, [this] { return m_stop || m_wakeup; });
+        }
+        if (m_stop) break;
+        m_wakeup = false;
+
+        lock.unlock();
+        bool ok = runPass();
+        lock.lock();
+
+        if (ok) {
+            m_backoff = std::chrono::milliseconds(0);
+        } else {
+            m_metrics.syncFailures++;
+            m_backoff = m_backoff.count() == 0
+                ? m_options.minBackoff
+                : std::min(m_backoff * 2, m_options.maxBackoff);
+        }
+        m_metrics.syncBackoffMs = static_cast<uint64_t>(m_backoff.count());
+    }
+}
+
+bool SyncScheduler::runPass() {
+    auto start = std::chrono::steady_clock::now();
+    m_metrics.syncPasses++;
+
+    bool replay = m_retryReplay;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        replay = replay || m_replayRequested;
+        m_replayRequested = false;
+    }
+
+    // Drain in bounded batches; stop() takes effect between batches.
+    bool ok = true;
+    while (ok && !m_stop) {
+        auto batch = m_queue.popBatch(m_options.batchSize, m_options.batchBytes);
+        if (batch.empty()) break;
+
+        try {
+            ok = m_sink(batch);
+        } catch (const std::exception& e) {
+            std::cerr << "[SyncScheduler] Batch failed: " << e.what() << std::endl;
+            ok = false;
+        }
+
+        if (ok) {
+            recordDelivered(batch);
+        } else {
+            m_queue.requeueFront(std::move(batch));
+        }
+    }
+
+    // Spilled mutations were never copied into memory. With a spill log,
+    // stream them back from its segments in append order; those without a
+    // record are left to a full replay from MutationQueue storage.
+    bool spillLog = m_queue.hasSpillLog();
+    while (spillLog && ok && !m_stop) {
+        auto spilled = m_queue.popSpilled(m_options.batchSize, m_options.batchBytes);
+        if (spilled.records == 0) break;
+
+        try {
+            ok = spilled.items.empty() || m_sink(spilled.items);
+        } catch (const std::exception& e) {
+            std::cerr << "[SyncScheduler] Spill batch failed: " << e.what() << std::endl;
+            ok = false;
+        }
+        if (ok) {
+            recordDelivered(spilled.items);
+            m_queue.ackSpilled(spilled);
+        }
+    }
+
+    auto unlogged = m_queue.unlogged();
+    if (replay || unlogged.count > 0) {
+        if (ok && !m_stop && m_replay) {
+            try {
+                ok = m_replay(unlogged);
+            } catch (const std::exception& e) {
+                std::cerr << "[SyncScheduler] Replay failed: " << e.what() << std::endl;
+                ok = false;
+            }
+            m_retryReplay = !ok;
+            if (ok) m_queue.releaseUnlogged(unlogged);
+        } else {
+            m_retryReplay = replay; // Not reached this pass; keep the request
+        }
+    }
+
+    auto spill = m_queue.spilled();
+    m_metrics.syncPending = m_queue.size() + spill.count;
+    m_metrics.lastSyncPassUs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    return ok;
+}
+
+void SyncScheduler::recordDelivered(const std::vector<OutboundItem>& batch) {
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& item : batch) {
+        auto& lane = m_metrics.lanes[static_cast<size_t>(item.lane)];
+        auto us = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - item.enqueuedAt).count());
+        lane.sent++;
+        lane.latencySumUs += us;
+        uint64_t prev = lane.latencyMaxUs.load();
+        while (us > prev && !lane.latencyMaxUs.compare_exchange_weak(prev, us)) {}
+    }
+    m_metrics.syncBatches++;
+    m_metrics.mutationsSynced += batch.size();
+}
+
+} // namespace aegis
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "OutboundQueue.h"
+#include "SyncMetrics.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace aegis {
+
+/**
+ * SyncScheduler
+ * Dedicated sync worker. Writers and aegis_flutter_trigger_sync only nudge
+ * it; the worker drains the OutboundQueue in bounded batches (lane order is
+ * decided by the queue, so moves re-take the lead every batch) and runs full
+ * replays off the caller's thread. Failed passes retry with exponential
+ * backoff, cut short by a nudge while moves are queued. stop() is honoured
+ * between batches.
+ */
+class SyncScheduler {
+public:
+    // Returns false if the batch could not be delivered (it is requeued).
+    using BatchSink = std::function<bool(const std::vector<OutboundItem>& batch)>;
+    // Full replay of everything pending (SyncManager::replayMutations).
+    // spilled is what it covers of the mutations that skipped the sink
+    // (OutboundQueue::unlogged(); spill log records go through the sink).
+    using ReplayFn = std::function<bool(const OutboundQueue::Spill& spilled)>;
+
+    struct Options {
+        size_t batchSize = 64;
+        size_t batchBytes = 256 * 1024;
+        std::chrono::milliseconds minBackoff{100};
+        std::chrono::milliseconds maxBackoff{30000};
+    };
+
+    SyncScheduler(OutboundQueue& queue, SyncMetrics& metrics, BatchSink sink, ReplayFn replay);
+    SyncScheduler(OutboundQueue& queue, SyncMetrics& metrics, BatchSink sink, ReplayFn replay, Options options);
+    ~SyncScheduler();
+
+    void start();
+    void stop();
+
+    // Non-blocking: wake the worker to drain new mutations (during a
+    // backoff only when moves are queued).
+    void nudge();
+    // Non-blocking: schedule a full replay on the worker.
+    void requestReplay();
+
+    bool isRunning() const { return m_running; }
+
+private:
+    void run();
+    bool runPass();
+    void recordDelivered(const std::vector<OutboundItem>& batch);
+
+    OutboundQueue& m_queue;
+    SyncMetrics& m_metrics;
+    BatchSink m_sink;
+    ReplayFn m_replay;
+    Options m_options;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_wakeup = false;
+    bool m_replayRequested = false;
+    std::atomic<bool> m_stop{false};
+    std::atomic<bool> m_running{false};
+    std::chrono::milliseconds m_backoff{0};
+    bool m_retryReplay = false; // worker thread only
+    std::thread m_worker;
+};
+
+} // namespace aegis
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aegis {
+
+/**
+ * Transport
+ * Message-oriented link between engines. Peers are identified by their
+ * clientId, exchanged in a handshake, so callers never deal with sockets.
+ * Handlers run on the transport's own thread.
+ *
+ * Outgoing messages are immutable refcounted buffers: a broadcast queues the
+ * same buffer on every connection and it is freed after the last write.
+ */
+class Transport {
+public:
+    using Frame = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct Handlers {
+        std::function<void(const std::string& peerId)> onPeerConnected;
+        std::function<void(const std::string& peerId)> onPeerDisconnected;
+        std::function<void(const std::string& peerId, const uint8_t* data, size_t len)> onMessage;
+    };
+
+    virtual ~Transport() = default;
+
+    virtual bool start(Handlers handlers) = 0;
+    virtual void stop() = 0;
+
+    // address is an IPv4 host, or "unix:<path>" for a Unix domain socket.
+    virtual bool connect(const std::string& address, int port) = 0;
+
+    virtual bool send(const std::string& peerId, Frame message) = 0;
+    bool send(const std::string& peerId, std::vector<uint8_t> message) {
+        return send(peerId, std::make_shared<const std::vector<uint8_t>>(std::move(message)));
+    }
+    // Queues one buffer for many peers. Returns how many accepted it.
+    virtual size_t broadcast(const std::vector<std::string>& peerIds, const Frame& message) {
+        size_t sent = 0;
+        for (const auto& peerId : peerIds) sent += send(peerId, message) ? 1 : 0;
+        return sent;
+    }
+
+    virtual std::vector<std::string> peers() const = 0;
+    virtual const std::string& localId() const = 0;
+    virtual size_t peerCount() const = 0;
+};
+
+} // namespace aegis
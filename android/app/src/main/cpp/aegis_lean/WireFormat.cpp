@@ -0,0 +1,308 @@
+#include "WireFormat.h"
+#include <cstring>
+
+namespace aegis::wire {
+
+namespace {
+
+constexpr uint8_t kFlagDeleted = 0x01;
+constexpr uint8_t kFlagDelta = 0x02;
+constexpr uint8_t kFlagClientLiteral = 0x04;
+constexpr uint8_t kKnownFlags = kFlagDeleted | kFlagDelta | kFlagClientLiteral;
+
+constexpr uint8_t kFrameReset = 0x01;
+constexpr uint8_t kFrameStandalone = 0x02;
+
+constexpr size_t kMaxVarint = 10;
+
+// Smallest possible mutation record: flags, empty key, client index,
+// version, timestamp delta, empty payload
+constexpr size_t kMinMutationBytes = 6;
+
+} // namespace
+
+const char* wireStatusName(WireStatus status) {
+    switch (status) {
+        case WireStatus::Ok: return "ok";
+        case WireStatus::Truncated: return "truncated";
+        case WireStatus::BadVersion: return "bad_version";
+        case WireStatus::Malformed: return "malformed";
+        case WireStatus::Desync: return "desync";
+    }
+    return "unknown";
+}
+
+// --- WireWriter ---
+
+void WireWriter::u8(uint8_t v) {
+    if (!m_ok || m_pos == m_end) { m_ok = false; return; }
+    *m_pos++ = v;
+}
+
+void WireWriter::varint(uint64_t v) {
+    if (!m_ok) return;
+    if (static_cast<size_t>(m_end - m_pos) < varintSize(v)) { m_ok = false; return; }
+    while (v >= 0x80) {
+        *m_pos++ = static_cast<uint8_t>(v) | 0x80;
+        v >>= 7;
+    }
+    *m_pos++ = static_cast<uint8_t>(v);
+}
+
+void WireWriter::fixed64(uint64_t v) {
+    uint8_t b[8];
+    for (int i = 0; i < 8; i++) b[i] = static_cast<uint8_t>(v >> (8 * i));
+    bytes(b, sizeof(b));
+}
+
+void WireWriter::bytes(const void* data, size_t len) {
+    if (!m_ok) return;
+    if (static_cast<size_t>(m_end - m_pos) < len) { m_ok = false; return; }
+    if (len) std::memcpy(m_pos, data, len);
+    m_pos += len;
+}
+
+// --- WireReader ---
+
+uint8_t WireReader::u8() {
+    if (!ok()) return 0;
+    if (m_pos == m_end) { fail(WireStatus::Truncated); return 0; }
+    return *m_pos++;
+}
+
+uint64_t WireReader::varint() {
+    if (!ok()) return 0;
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (m_pos == m_end) { fail(WireStatus::Truncated); return 0; }
+        uint8_t b = *m_pos++;
+        // Tenth byte may only carry the top bit
+        if (shift == 63 && b > 1) { fail(WireStatus::Malformed); return 0; }
+        v |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    fail(WireStatus::Malformed);
+    return 0;
+}
+
+uint64_t WireReader::fixed64() {
+    if (!ok()) return 0;
+    if (remaining() < 8) { fail(WireStatus::Truncated); return 0; }
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= static_cast<uint64_t>(m_pos[i]) << (8 * i);
+    m_pos += 8;
+    return v;
+}
+
+std::string_view WireReader::blob(size_t maxLen) {
+    uint64_t len = varint();
+    if (!ok()) return {};
+    if (len > maxLen) { fail(WireStatus::Malformed); return {}; }
+    if (len > remaining()) { fail(WireStatus::Truncated); return {}; }
+    std::string_view view(reinterpret_cast<const char*>(m_pos), static_cast<size_t>(len));
+    m_pos += len;
+    return view;
+}
+
+uint64_t WireReader::count(size_t minBytes) {
+    uint64_t n = varint();
+    if (!ok()) return 0;
+    if (n > kMaxBatchCount || n > remaining() / (minBytes ? minBytes : 1)) {
+        fail(WireStatus::Malformed);
+        return 0;
+    }
+    return n;
+}
+
+// --- Frame header ---
+
+void writeFrameHeader(WireWriter& w, FrameType type) {
+    w.u8(kWireVersion);
+    w.u8(static_cast<uint8_t>(type));
+}
+
+WireStatus readFrameHeader(WireReader& r, FrameType& type) {
+    uint8_t version = r.u8();
+    uint8_t t = r.u8();
+    if (!r.ok()) return r.status();
+    if (version != kWireVersion) return WireStatus::BadVersion;
+    if (t < static_cast<uint8_t>(FrameType::Mutations) || t > static_cast<uint8_t>(FrameType::LeafItems)) {
+        return WireStatus::Malformed;
+    }
+    type = static_cast<FrameType>(t);
+    return WireStatus::Ok;
+}
+
+// --- WireSession ---
+
+void WireSession::reset() {
+    m_index.clear();
+    m_clients.clear();
+    lastTimestamp = 0;
+    m_resetPending = true;
+}
+
+int64_t WireSession::find(std::string_view clientId) const {
+    auto it = m_index.find(clientId);
+    return it == m_index.end() ? -1 : static_cast<int64_t>(it->second);
+}
+
+std::string_view WireSession::intern(std::string_view clientId) {
+    if (m_clients.size() >= kMaxInternedClients) return clientId;
+    m_clients.emplace_back(clientId);
+    std::string_view stored = m_clients.back();
+    m_index.emplace(stored, static_cast<uint32_t>(m_clients.size() - 1));
+    return stored;
+}
+
+void WireSession::truncate(size_t size) {
+    while (m_clients.size() > size) {
+        m_index.erase(m_clients.back());
+        m_clients.pop_back();
+    }
+}
+
+// --- WireEncoder ---
+
+size_t WireEncoder::maxEncodedSize(const WireMutation* items, size_t count) {
+    size_t total = 3 + kMaxVarint;
+    for (size_t i = 0; i < count; i++) {
+        const auto& m = items[i];
+        total += 1 + 6 * kMaxVarint + m.key.size() + m.clientId.size() + m.payloadLen;
+    }
+    return total;
+}
+
+size_t WireEncoder::encodeMutations(const WireMutation* items, size_t count, uint8_t* out, size_t cap) {
+    size_t n = encode(items, count, out, cap, m_session.m_resetPending ? kFrameReset : 0);
+    if (n) m_session.m_resetPending = false;
+    return n;
+}
+
+size_t WireEncoder::encodeStandalone(const WireMutation* items, size_t count, uint8_t* out, size_t cap) {
+    WireSession scratch; // frame-local table, timestamps from 0
+    return WireEncoder(scratch).encode(items, count, out, cap, kFrameStandalone);
+}
+
+size_t WireEncoder::encode(const WireMutation* items, size_t count, uint8_t* out, size_t cap, uint8_t frameFlags) {
+    if (count > kMaxBatchCount) return 0;
+
+    // Roll back interning / timestamp state if the frame does not fit
+    size_t tableSize = m_session.size();
+    int64_t lastTs = m_session.lastTimestamp;
+
+    WireWriter w(out, cap);
+    writeFrameHeader(w, FrameType::Mutations);
+    w.u8(frameFlags);
+    w.varint(count);
+
+    for (size_t i = 0; i < count && w.ok(); i++) {
+        const auto& m = items[i];
+        if (m.key.size() > kMaxKeyBytes || m.clientId.size() > kMaxClientIdBytes) {
+            w.fail();
+            break;
+        }
+
+        int64_t clientIndex = m_session.find(m.clientId);
+        uint8_t flags = 0;
+        if (m.deleted) flags |= kFlagDeleted;
+        if (m.baseVersion != 0) flags |= kFlagDelta;
+        if (clientIndex < 0) flags |= kFlagClientLiteral;
+
+        w.u8(flags);
+        w.str(m.key);
+        if (clientIndex < 0) {
+            w.str(m.clientId);
+            m_session.intern(m.clientId);
+        } else {
+            w.varint(static_cast<uint64_t>(clientIndex));
+        }
+        w.varint(m.version);
+        if (flags & kFlagDelta) w.varint(m.baseVersion);
+        w.zigzag(static_cast<int64_t>(static_cast<uint64_t>(m.timestamp) - static_cast<uint64_t>(m_session.lastTimestamp)));
+        m_session.lastTimestamp = m.timestamp;
+        w.blob(m.payload, m.payloadLen);
+    }
+
+    if (!w.ok()) {
+        m_session.truncate(tableSize);
+        m_session.lastTimestamp = lastTs;
+        return 0;
+    }
+    return w.size();
+}
+
+// --- WireDecoder ---
+
+WireStatus WireDecoder::decodeMutations(WireReader& r, std::vector<WireMutation>& out) {
+    out.clear();
+    uint8_t frameFlags = r.u8();
+    if (!r.ok()) return r.status();
+    if (frameFlags & ~(kFrameReset | kFrameStandalone)) {
+        m_session.m_resetPending = true;
+        return WireStatus::Malformed;
+    }
+    bool standalone = (frameFlags & kFrameStandalone) != 0;
+    if (standalone) {
+        if (frameFlags & kFrameReset) return WireStatus::Malformed;
+        m_frameClients.clear();
+    } else if (frameFlags & kFrameReset) {
+        m_session.reset();
+        m_session.m_resetPending = false;
+    } else if (m_session.m_resetPending) {
+        return WireStatus::Desync;
+    }
+
+    uint64_t count = r.count(kMinMutationBytes);
+    int64_t lastTs = standalone ? 0 : m_session.lastTimestamp;
+
+    for (uint64_t i = 0; i < count && r.ok(); i++) {
+        WireMutation m;
+        uint8_t flags = r.u8();
+        if (flags & ~kKnownFlags) { r.fail(WireStatus::Malformed); break; }
+
+        m.deleted = (flags & kFlagDeleted) != 0;
+        m.key = r.str(kMaxKeyBytes);
+        if (flags & kFlagClientLiteral) {
+            auto literal = r.str(kMaxClientIdBytes);
+            if (!r.ok()) break;
+            if (!standalone) {
+                m.clientId = m_session.intern(literal);
+            } else {
+                if (m_frameClients.size() < kMaxInternedClients) m_frameClients.push_back(literal);
+                m.clientId = literal;
+            }
+        } else {
+            uint64_t index = r.varint();
+            if (!r.ok()) break;
+            size_t tableSize = standalone ? m_frameClients.size() : m_session.size();
+            if (index >= tableSize) { r.fail(WireStatus::Malformed); break; }
+            m.clientId = standalone ? m_frameClients[index] : m_session.at(index);
+        }
+        m.version = r.varint();
+        if (flags & kFlagDelta) {
+            m.baseVersion = r.varint();
+            if (r.ok() && m.baseVersion == 0) { r.fail(WireStatus::Malformed); break; }
+        }
+        int64_t tsDelta = r.zigzag();
+        m.timestamp = static_cast<int64_t>(static_cast<uint64_t>(lastTs) + static_cast<uint64_t>(tsDelta));
+        auto payload = r.blob();
+        if (!r.ok()) break;
+
+        lastTs = m.timestamp;
+        m.payload = reinterpret_cast<const uint8_t*>(payload.data());
+        m.payloadLen = payload.size();
+        out.push_back(m);
+    }
+
+    if (r.ok() && r.remaining() != 0) r.fail(WireStatus::Malformed);
+    if (!r.ok()) {
+        out.clear();
+        if (!standalone) m_session.m_resetPending = true; // Out of step with the sender now
+        return r.status();
+    }
+    if (!standalone) m_session.lastTimestamp = lastTs;
+    return WireStatus::Ok;
+}
+
+} // namespace aegis::wire
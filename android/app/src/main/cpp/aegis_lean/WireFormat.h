@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace aegis::wire {
+
+/**
+ * Binary peer wire format (v1)
+ *
+ * Every frame starts with [u8 version][u8 type]; the rest is type specific.
+ * Integers are LEB128 varints, signed values are zigzag coded, strings and
+ * blobs are [varint len][bytes].
+ *
+ * Mutation batches are stream coded: client ids are interned per
+ * connection (first use carries the string, later uses a table index) and
+ * timestamps are deltas against the previous mutation on the same stream.
+ * Encoder and decoder therefore keep a WireSession each, fed frames in
+ * send order. The first Mutations frame after an encoder reset carries the
+ * Reset flag; a decoder that has not seen one (fresh, or after an error)
+ * reports Desync and the receiver asks the sender to start over (Resync).
+ *
+ * Standalone Mutations frames (broadcast) intern and delta-code within the
+ * frame only and leave both sessions alone, so one encoding can go to any
+ * number of peers.
+ *
+ * Mutations frame: [u8 frameFlags][varint count][record...]
+ * Mutation record:
+ *   [u8 flags][key][client: index | literal][varint version]
+ *   [varint baseVersion if Delta][zigzag tsDelta][payload]
+ */
+constexpr uint8_t kWireVersion = 1;
+
+enum class FrameType : uint8_t {
+    Mutations = 1,
+    Ack = 2,
+    Nack = 3,
+    LogHeads = 4,
+    LogEntries = 5,
+    Resync = 6,
+    Digest = 7,     // anti-entropy: child digests of one summary node
+    LeafItems = 8,  // anti-entropy: (key, hash) list of one summary leaf
+};
+
+enum class WireStatus {
+    Ok,
+    Truncated,      // ran off the end of the input / output buffer
+    BadVersion,
+    Malformed,      // out of range index, length or flag
+    Desync,         // stream state unknown: waiting for a Reset frame
+};
+
+const char* wireStatusName(WireStatus status);
+
+// Caps enforced on decode (and respected by the encoder)
+constexpr size_t kMaxInternedClients = 4096;
+constexpr size_t kMaxClientIdBytes = 256;
+constexpr size_t kMaxKeyBytes = 64 * 1024;
+constexpr size_t kMaxBatchCount = 1 << 20;
+
+// Bounds-checked writer over a caller-provided buffer. Once a write does
+// not fit, ok() stays false and nothing further is written.
+class WireWriter {
+public:
+    WireWriter(uint8_t* out, size_t cap) : m_begin(out), m_pos(out), m_end(out + cap) {}
+
+    void u8(uint8_t v);
+    void varint(uint64_t v);
+    void zigzag(int64_t v) { varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); }
+    void fixed64(uint64_t v);   // little-endian, for hashes
+    void bytes(const void* data, size_t len);
+    void blob(const void* data, size_t len) { varint(len); bytes(data, len); }
+    void str(std::string_view s) { blob(s.data(), s.size()); }
+    void fail() { m_ok = false; }
+
+    bool ok() const { return m_ok; }
+    size_t size() const { return static_cast<size_t>(m_pos - m_begin); }
+
+private:
+    uint8_t* m_begin;
+    uint8_t* m_pos;
+    uint8_t* m_end;
+    bool m_ok = true;
+};
+
+// Bounds-checked reader. Views returned by blob()/str() point into the input.
+class WireReader {
+public:
+    WireReader(const uint8_t* data, size_t len) : m_pos(data), m_end(data + len) {}
+
+    uint8_t u8();
+    uint64_t varint();
+    int64_t zigzag() { uint64_t v = varint(); return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+    uint64_t fixed64();
+    std::string_view blob(size_t maxLen = SIZE_MAX);
+    std::string_view str(size_t maxLen = SIZE_MAX) { return blob(maxLen); }
+
+    // Count prefix sanity: every element needs at least minBytes of input
+    uint64_t count(size_t minBytes = 1);
+
+    bool ok() const { return m_status == WireStatus::Ok; }
+    WireStatus status() const { return m_status; }
+    void fail(WireStatus status) { if (m_status == WireStatus::Ok) m_status = status; }
+    size_t remaining() const { return static_cast<size_t>(m_end - m_pos); }
+
+private:
+    const uint8_t* m_pos;
+    const uint8_t* m_end;
+    WireStatus m_status = WireStatus::Ok;
+};
+
+// Maximum bytes a varint of v takes
+inline size_t varintSize(uint64_t v) {
+    size_t n = 1;
+    while (v >= 0x80) { v >>= 7; n++; }
+    return n;
+}
+
+// Writes the frame header; readFrameHeader checks the version.
+void writeFrameHeader(WireWriter& w, FrameType type);
+WireStatus readFrameHeader(WireReader& r, FrameType& type);
+
+struct WireMutation {
+    std::string_view key;
+    std::string_view clientId;
+    uint64_t version = 0;
+    uint64_t baseVersion = 0;   // 0: payload is the full value
+    int64_t timestamp = 0;      // HLC stamp (HybridClock)
+    bool deleted = false;
+    const uint8_t* payload = nullptr;
+    size_t payloadLen = 0;
+};
+
+// Per-connection stream state (one per direction).
+class WireSession {
+public:
+    WireSession() = default;
+    WireSession(const WireSession&) = delete; // m_index views into m_clients
+    WireSession& operator=(const WireSession&) = delete;
+
+    // Encoder: next frame carries Reset. Decoder: discard state and wait
+    // for a Reset frame.
+    void reset();
+
+    // Encoder side: index of an interned id, or -1 (caller sends the literal)
+    int64_t find(std::string_view clientId) const;
+    // Both sides: interns if there is room (the rule is the same on both
+    // ends so the tables stay in step). Returns the stored id.
+    std::string_view intern(std::string_view clientId);
+    std::string_view at(uint64_t index) const { return m_clients[index]; }
+    size_t size() const { return m_clients.size(); }
+
+    int64_t lastTimestamp = 0;
+
+private:
+    friend class WireEncoder;
+    friend class WireDecoder;
+    void truncate(size_t size);
+
+    bool m_resetPending = true; // encoder: announce Reset; decoder: not yet in step
+
+    std::deque<std::string> m_clients;  // deque: views stay valid as it grows
+    std::unordered_map<std::string_view, uint32_t> m_index;
+};
+
+class WireEncoder {
+public:
+    explicit WireEncoder(WireSession& session) : m_session(session) {}
+
+    // Upper bound for encodeMutations() output
+    static size_t maxEncodedSize(const WireMutation* items, size_t count);
+
+    // Writes one Mutations frame into out. Returns the bytes written, or 0 if
+    // cap is too small (session state is left untouched in that case).
+    size_t encodeMutations(const WireMutation* items, size_t count, uint8_t* out, size_t cap);
+
+    // Same, as a standalone frame that any peer can decode.
+    static size_t encodeStandalone(const WireMutation* items, size_t count, uint8_t* out, size_t cap);
+
+private:
+    size_t encode(const WireMutation* items, size_t count, uint8_t* out, size_t cap, uint8_t frameFlags);
+
+    WireSession& m_session;
+};
+
+class WireDecoder {
+public:
+    explicit WireDecoder(WireSession& session) : m_session(session) {}
+
+    // Decodes the body of a Mutations frame (after readFrameHeader). out is
+    // cleared and refilled; its views point into the input buffer and the
+    // session's client table. On error the session may be out of step with
+    // the sender and the connection should be dropped.
+    WireStatus decodeMutations(WireReader& r, std::vector<WireMutation>& out);
+
+private:
+    WireSession& m_session;
+    std::vector<std::string_view> m_frameClients; // standalone frames: views into the input
+};
+
+} // namespace aegis::wire
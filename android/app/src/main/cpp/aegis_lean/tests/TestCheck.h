@@ -0,0 +1,31 @@
+#pragma once
+
+// Assertion helpers for the host tests. Unlike assert() they stay active in
+// release builds; the first failure prints its location and exits non-zero,
+// which is all CTest looks at.
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace aegis::test {
+
+[[noreturn]] inline void fail(const char* file, int line, const char* what) {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+    std::exit(1);
+}
+
+template <typename A, typename B>
+void checkEq(const A& a, const B& b, const char* file, int line, const char* what) {
+    if (a == b) return;
+    std::fprintf(stderr, "%s:%d: check failed: %s (%lld vs %lld)\n", file, line, what, static_cast<long long>(a),
+                 static_cast<long long>(b));
+    std::exit(1);
+}
+
+} // namespace aegis::test
+
+#define CHECK(cond) \
+    do { if (!(cond)) ::aegis::test::fail(__FILE__, __LINE__, #cond); } while (0)
+
+// Integer (or enum) equality; prints both values on failure
+#define CHECK_EQ(a, b) ::aegis::test::checkEq((a), (b), __FILE__, __LINE__, #a " == " #b)
@@ -0,0 +1,146 @@
+// AppendLog: local appends, merging a peer's range, subscriptions, same-seq
+// conflicts between two writers and the packed exchange format.
+
+#include "AppendLog.h"
+#include "TestCheck.h"
+#include <string>
+#include <vector>
+
+using namespace aegis;
+
+namespace {
+
+std::vector<uint8_t> bytes(const std::string& s) { return std::vector<uint8_t>(s.begin(), s.end()); }
+
+void testAppendAndMerge() {
+    AppendLog a, b;
+    CHECK(a.open(":memory:"));
+    CHECK(b.open(":memory:"));
+
+    CHECK_EQ(a.append("match_1", bytes("e4")), 1u);
+    CHECK_EQ(a.append("match_1", bytes("e5")), 2u);
+    CHECK_EQ(a.append("match_2", bytes("d4")), 1u);
+    CHECK_EQ(a.head("match_1"), 2u);
+    CHECK_EQ(a.head("missing"), 0u);
+    auto heads = a.heads();
+    CHECK_EQ(heads.size(), 2u);
+    CHECK_EQ(heads["match_2"], 1u);
+
+    std::vector<uint64_t> localSeqs;
+    a.setOnLocalAppend([&](const std::string&, const LogEntry& e) { localSeqs.push_back(e.seq); });
+    a.append("match_1", bytes("Nf3"));
+    CHECK(localSeqs == std::vector<uint64_t>{3});
+
+    // b subscribes before anything arrives, then merges a's range
+    std::vector<uint64_t> seen;
+    uint64_t sub = b.subscribe("match_1", 0, [&](const std::string&, const LogEntry& e) { seen.push_back(e.seq); });
+    CHECK(sub != 0);
+    auto range = a.read("match_1", 1, 100);
+    CHECK_EQ(range.size(), 3u);
+    CHECK_EQ(b.applyRemote("match_1", range), 3u);
+    CHECK(seen == (std::vector<uint64_t>{1, 2, 3}));
+    CHECK_EQ(b.head("match_1"), 3u);
+
+    // Merging the same range again adds and reports nothing
+    CHECK_EQ(b.applyRemote("match_1", range), 0u);
+    CHECK_EQ(seen.size(), 3u);
+
+    // Local appends continue after the merged head
+    CHECK_EQ(b.append("match_1", bytes("Nc6")), 4u);
+    CHECK_EQ(seen.size(), 4u);
+    b.unsubscribe(sub);
+    b.append("match_1", bytes("Bb5"));
+    CHECK_EQ(seen.size(), 4u);
+
+    // A late subscriber gets the backlog from its starting point
+    std::vector<std::string> backlog;
+    b.subscribe("match_1", 4, [&](const std::string&, const LogEntry& e) {
+        backlog.emplace_back(e.data.begin(), e.data.end());
+    });
+    CHECK(backlog == (std::vector<std::string>{"Nc6", "Bb5"}));
+}
+
+// Two writers append the same seq before seeing each other's entry: both
+// keep the bytewise smaller payload, and neither side drops data silently
+void testSameSeqConflict() {
+    AppendLog a, b;
+    CHECK(a.open(":memory:"));
+    CHECK(b.open(":memory:"));
+
+    struct Conflict {
+        uint64_t seq;
+        std::string kept, dropped;
+    };
+    std::vector<Conflict> conflictsA, conflictsB;
+    auto record = [](std::vector<Conflict>& out) {
+        return [&out](const std::string&, const LogEntry& kept, const LogEntry& dropped) {
+            out.push_back({kept.seq, std::string(kept.data.begin(), kept.data.end()),
+                           std::string(dropped.data.begin(), dropped.data.end())});
+        };
+    };
+    a.setOnConflict(record(conflictsA));
+    b.setOnConflict(record(conflictsB));
+
+    std::vector<std::pair<uint64_t, std::string>> deliveredB;
+    b.subscribe("match_1", 0, [&](const std::string&, const LogEntry& e) {
+        deliveredB.emplace_back(e.seq, std::string(e.data.begin(), e.data.end()));
+    });
+
+    CHECK_EQ(a.append("match_1", bytes("e4")), 1u);
+    CHECK_EQ(b.append("match_1", bytes("g3")), 1u);
+    CHECK_EQ(a.append("match_1", bytes("e5")), 2u);
+
+    // b receives a's range: seq 1 collides ("e4" < "g3" replaces b's entry),
+    // seq 2 is new
+    CHECK_EQ(b.applyRemote("match_1", a.read("match_1", 1, 100)), 1u);
+    CHECK_EQ(conflictsB.size(), 1u);
+    CHECK_EQ(conflictsB[0].seq, 1u);
+    CHECK(conflictsB[0].kept == "e4" && conflictsB[0].dropped == "g3");
+    // The subscriber sees seq 1 again with the entry that replaced its own
+    CHECK(deliveredB == (std::vector<std::pair<uint64_t, std::string>>{{1, "g3"}, {1, "e4"}, {2, "e5"}}));
+
+    // a receives b's (now identical) range plus b's original entry: the
+    // original loses, is reported, and leaves a's log unchanged
+    CHECK_EQ(a.applyRemote("match_1", {{1, bytes("g3")}}), 0u);
+    CHECK_EQ(conflictsA.size(), 1u);
+    CHECK(conflictsA[0].kept == "e4" && conflictsA[0].dropped == "g3");
+    CHECK_EQ(a.applyRemote("match_1", b.read("match_1", 1, 100)), 0u);
+    CHECK_EQ(conflictsA.size(), 1u);
+
+    auto logA = a.read("match_1", 1, 100);
+    auto logB = b.read("match_1", 1, 100);
+    CHECK_EQ(logA.size(), 2u);
+    CHECK_EQ(logB.size(), 2u);
+    for (size_t i = 0; i < logA.size(); i++) CHECK(logA[i].data == logB[i].data);
+    CHECK(logA[0].data == bytes("e4"));
+}
+
+void testPack() {
+    std::vector<LogEntry> entries = {{1, bytes("e4")}, {2, {}}, {1ull << 40, bytes("long payload")}};
+    auto packed = AppendLog::pack(entries);
+    CHECK_EQ(packed.size(), 3 * 12 + 2 + 12u);
+
+    std::vector<LogEntry> out;
+    CHECK(AppendLog::unpack(packed.data(), packed.size(), out));
+    CHECK_EQ(out.size(), 3u);
+    for (size_t i = 0; i < out.size(); i++) {
+        CHECK_EQ(out[i].seq, entries[i].seq);
+        CHECK(out[i].data == entries[i].data);
+    }
+
+    // Truncated input is rejected
+    for (size_t len = 1; len < packed.size(); len++) {
+        if (len == 14 || len == 26) continue; // entry boundaries
+        std::vector<LogEntry> partial;
+        CHECK(!AppendLog::unpack(packed.data(), len, partial));
+    }
+}
+
+} // namespace
+
+int main() {
+    testAppendAndMerge();
+    testSameSeqConflict();
+    testPack();
+    return 0;
+}
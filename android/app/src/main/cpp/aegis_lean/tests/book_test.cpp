@@ -0,0 +1,173 @@
+// Opening book: the compiled-in Random64 table against the Polyglot
+// reference keys, then a small book written in the .bin format with
+// entries under the published keys of the start position and 1.e4 (and
+// the en passant position after 1.e4 d5 2.e5 f5), probed through
+// OpeningBook. Also covers the castling and promotion move encodings,
+// colliding entries and weighted picks.
+
+#include "ChessBook.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace aegis::chess;
+
+namespace {
+
+constexpr uint64_t kStartKey = 0x463b96181691fc9cULL;
+constexpr uint64_t kE4Key = 0x823c9b50fd114196ULL;
+constexpr uint64_t kE4D5E5F5Key = 0x22a48b5a8e47ff78ULL;
+
+const char* const kStart = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+const char* const kE4 = "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1";
+const char* const kE4D5E5F5 = "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3";
+const char* const kCastling = "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1";
+const char* const kPromotion = "8/P7/8/8/8/8/8/k1K5 w - - 0 1";
+
+struct Entry {
+    uint64_t key;
+    uint16_t move;
+    uint16_t weight;
+};
+
+int square(const char* s) {
+    return (s[0] - 'a') + 8 * (s[1] - '1');
+}
+
+// Polyglot move: to, from and promotion (1 = knight .. 4 = queen) fields
+uint16_t bookMove(const char* uci, int promotion = 0) {
+    return static_cast<uint16_t>(square(uci + 2) | square(uci) << 6 | promotion << 12);
+}
+
+void writeBook(const std::filesystem::path& path, std::vector<Entry> entries) {
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+    std::ofstream out(path, std::ios::binary);
+    for (const Entry& e : entries) {
+        uint8_t bytes[16] = {};
+        for (int i = 0; i < 8; i++) bytes[i] = static_cast<uint8_t>(e.key >> (56 - 8 * i));
+        bytes[8] = static_cast<uint8_t>(e.move >> 8);
+        bytes[9] = static_cast<uint8_t>(e.move);
+        bytes[10] = static_cast<uint8_t>(e.weight >> 8);
+        bytes[11] = static_cast<uint8_t>(e.weight);
+        out.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    }
+    CHECK(out.good());
+}
+
+Position position(const char* fen) {
+    Position pos;
+    CHECK(pos.setFen(fen));
+    return pos;
+}
+
+std::string uciAt(const BookMove* moves, int i) {
+    return Position::toUci(moves[i].move);
+}
+
+void testKeys() {
+    CHECK(PolyglotKeys::verify());
+    CHECK(PolyglotKeys::key(position(kStart)) == kStartKey);
+    CHECK(PolyglotKeys::key(position(kE4)) == kE4Key);
+    CHECK(PolyglotKeys::key(position(kE4D5E5F5)) == kE4D5E5F5Key);
+    // The en passant file only counts when a pawn can take there
+    CHECK(PolyglotKeys::key(position(kE4)) ==
+          PolyglotKeys::key(position("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1")));
+}
+
+void testProbe(const std::filesystem::path& dir) {
+    uint64_t castlingKey = PolyglotKeys::key(position(kCastling));
+    uint64_t promotionKey = PolyglotKeys::key(position(kPromotion));
+    std::vector<Entry> entries = {
+        {kStartKey, bookMove("d2d4"), 80},
+        {kStartKey, bookMove("e2e4"), 100},
+        {kStartKey, bookMove("c2c4"), 10},
+        {kStartKey, bookMove("g1f3"), 20},
+        {kStartKey, bookMove("e2e5"), 500}, // a colliding position's move
+        {kE4Key, bookMove("e7e5"), 40},
+        {kE4Key, bookMove("c7c5"), 60},
+        {kE4Key, bookMove("a7a6"), 0},
+        {kE4D5E5F5Key, bookMove("e5f6"), 3},
+        {castlingKey, bookMove("e1h1"), 10},
+        {castlingKey, bookMove("e1a1"), 5},
+        {promotionKey, bookMove("a7a8", 4), 7},
+        {promotionKey, bookMove("a7a8", 1), 3},
+    };
+    // Unrelated positions around them
+    for (uint64_t i = 1; i <= 500; i++) entries.push_back({i * 0x9e3779b97f4a7c15ULL, bookMove("b1c3"), 1});
+    std::filesystem::path path = dir / "small.bin";
+    writeBook(path, entries);
+
+    std::string error;
+    std::shared_ptr<const OpeningBook> book = OpeningBook::open(path.string(), &error);
+    CHECK(book);
+    CHECK_EQ(book->entries(), entries.size());
+
+    BookMove moves[OpeningBook::kMaxMoves];
+    int count = book->probe(position(kStart), moves, OpeningBook::kMaxMoves);
+    CHECK_EQ(count, 4);
+    CHECK(uciAt(moves, 0) == "e2e4" && moves[0].weight == 100);
+    CHECK(uciAt(moves, 1) == "d2d4" && moves[1].weight == 80);
+    CHECK(uciAt(moves, 2) == "g1f3" && moves[2].weight == 20);
+    CHECK(uciAt(moves, 3) == "c2c4" && moves[3].weight == 10);
+    CHECK_EQ(book->probe(position(kStart), moves, 2), 2);
+
+    count = book->probe(position(kE4), moves, OpeningBook::kMaxMoves);
+    CHECK_EQ(count, 3);
+    CHECK(uciAt(moves, 0) == "c7c5" && uciAt(moves, 1) == "e7e5" && uciAt(moves, 2) == "a7a6");
+
+    count = book->probe(position(kE4D5E5F5), moves, OpeningBook::kMaxMoves);
+    CHECK_EQ(count, 1);
+    CHECK(uciAt(moves, 0) == "e5f6");
+
+    // Castling is stored as the king taking its rook
+    count = book->probe(position(kCastling), moves, OpeningBook::kMaxMoves);
+    CHECK_EQ(count, 2);
+    CHECK(moves[0].move.kind() == Move::Castling && uciAt(moves, 0) == "e1g1");
+    CHECK(moves[1].move.kind() == Move::Castling && uciAt(moves, 1) == "e1c1");
+
+    count = book->probe(position(kPromotion), moves, OpeningBook::kMaxMoves);
+    CHECK_EQ(count, 2);
+    CHECK(uciAt(moves, 0) == "a7a8q" && uciAt(moves, 1) == "a7a8n");
+
+    CHECK_EQ(book->probe(position("4k3/8/8/8/8/8/8/4K3 w - - 0 1"), moves, OpeningBook::kMaxMoves), 0);
+    CHECK(book->pick(position("4k3/8/8/8/8/8/8/4K3 w - - 0 1"), 0).isNone());
+
+    // Picks follow the weights: [0, 100) e2e4, [100, 180) d2d4, ...
+    CHECK(Position::toUci(book->pick(position(kStart), 99)) == "e2e4");
+    CHECK(Position::toUci(book->pick(position(kStart), 100)) == "d2d4");
+    CHECK(Position::toUci(book->pick(position(kStart), 209)) == "c2c4");
+    CHECK(Position::toUci(book->pick(position(kStart), 210)) == "e2e4");
+    // Weight 0 is listed but never picked
+    for (uint64_t r = 0; r < 100; r++) CHECK(Position::toUci(book->pick(position(kE4), r)) != "a7a6");
+}
+
+void testMalformed(const std::filesystem::path& dir) {
+    std::filesystem::path path = dir / "truncated.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write("0123456789", 10);
+    }
+    std::string error;
+    CHECK(!OpeningBook::open(path.string(), &error));
+    CHECK(!error.empty());
+    CHECK(!OpeningBook::open((dir / "missing.bin").string(), &error));
+}
+
+} // namespace
+
+int main() {
+    auto dir = std::filesystem::temp_directory_path() / "aegis_book_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    testKeys();
+    testProbe(dir);
+    testMalformed(dir);
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,194 @@
+// DeltaSync: full and delta frames against acked bases, pruning the local
+// history as peers acknowledge it, and the byte budgets over keys (LRU
+// eviction, fresh versions after it, gauges) on both the sending and the
+// receiving side.
+
+#include "DeltaSync.h"
+#include "TestCheck.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace aegis;
+
+namespace {
+
+std::vector<uint8_t> document(size_t size, char edit) {
+    std::vector<uint8_t> data(size, 'x');
+    data.back() = static_cast<uint8_t>(edit);
+    return data;
+}
+
+std::string keyOf(int i) {
+    char key[8];
+    std::snprintf(key, sizeof(key), "k%03d", i);
+    return key;
+}
+
+// Sends the current version of key from sender to receiver and acks it
+void deliver(DeltaSync& sender, DeltaSync& receiver, const std::string& from, const std::string& to,
+             const std::string& key) {
+    auto frame = sender.encodeFor(to, key);
+    CHECK(frame.has_value());
+    CHECK(receiver.decode(from, *frame).has_value());
+    sender.onAck(to, key, frame->version);
+}
+
+void testEncodeAgainstAckedBase() {
+    SyncMetrics metrics;
+    DeltaSync alice(metrics), bob(metrics);
+    alice.recordLocal("doc", document(1000, 'a'));
+    auto first = alice.encodeFor("bob", "doc");
+    CHECK(first && !first->isDelta());
+    auto value = bob.decode("alice", *first);
+    CHECK(value && *value == document(1000, 'a'));
+    alice.onAck("bob", "doc", first->version);
+    CHECK(!alice.encodeFor("bob", "doc")); // up to date
+
+    alice.recordLocal("doc", document(1000, 'b'));
+    auto second = alice.encodeFor("bob", "doc");
+    CHECK(second && second->isDelta());
+    CHECK_EQ(second->baseVersion, first->version);
+    CHECK(second->payload.size() < 1000u);
+    value = bob.decode("alice", *second);
+    CHECK(value && *value == document(1000, 'b'));
+
+    // A nack drops the acked base: next frame is full
+    alice.onNack("bob", "doc");
+    auto third = alice.encodeFor("bob", "doc");
+    CHECK(third && !third->isDelta());
+}
+
+void testHistoryPrunedOnAck() {
+    SyncMetrics metrics;
+    DeltaSync alice(metrics), bob(metrics), carol(metrics);
+    const size_t version = 100 + 3; // value and key bytes
+
+    alice.recordLocal("doc", document(100, '1'));
+    deliver(alice, bob, "alice", "bob", "doc");
+    deliver(alice, carol, "alice", "carol", "doc");
+    alice.recordLocal("doc", document(100, '2'));
+    deliver(alice, bob, "alice", "bob", "doc");
+    alice.recordLocal("doc", document(100, '3'));
+    CHECK_EQ(alice.historyBytes(), 3 + 3 * 100u);
+
+    // carol's ack still names version 1, bob's version 2
+    deliver(alice, bob, "alice", "bob", "doc");
+    CHECK_EQ(alice.historyBytes(), 3 + 3 * 100u);
+    // Once carol acks the latest, only versions some peer may use remain
+    deliver(alice, carol, "alice", "carol", "doc");
+    CHECK_EQ(alice.historyBytes(), version);
+    CHECK_EQ(metrics.deltaHistoryBytes.load(), version);
+    CHECK_EQ(metrics.deltaHistoryKeys.load(), 1u);
+
+    // The latest is kept as the next base
+    alice.recordLocal("doc", document(100, '4'));
+    auto frame = alice.encodeFor("bob", "doc");
+    CHECK(frame && frame->isDelta());
+}
+
+void testByteBudget() {
+    SyncMetrics metrics;
+    const size_t keyBytes = 4 + 100; // "k000" + value
+    DeltaSync alice(metrics, 8, 10 * keyBytes), bob(metrics);
+
+    alice.recordLocal("k000", document(100, 'a'));
+    deliver(alice, bob, "alice", "bob", "k000");
+    uint64_t evictedVersion = alice.ackedVersion("bob", "k000");
+    CHECK(evictedVersion != 0);
+
+    for (int i = 1; i < 50; i++) alice.recordLocal(keyOf(i), document(100, 'a'));
+    CHECK(alice.historyBytes() <= 10 * keyBytes);
+    CHECK_EQ(metrics.deltaHistoryKeys.load(), 10u);
+    CHECK_EQ(metrics.deltaHistoryEvictions.load(), 40u);
+    CHECK(!alice.hasLocal("k000"));
+    CHECK(!alice.hasLocal("k039"));
+    CHECK(alice.hasLocal("k040") && alice.hasLocal("k049"));
+    CHECK_EQ(alice.keys().size(), 10u);
+
+    // Evicted keys lose their acks, and late acks for them are ignored
+    CHECK_EQ(alice.ackedVersion("bob", "k000"), 0u);
+    alice.onAck("bob", "k000", evictedVersion);
+    CHECK_EQ(alice.ackedVersion("bob", "k000"), 0u);
+
+    // Recorded again: a version bob has never seen, sent in full
+    uint64_t again = alice.recordLocal("k000", document(100, 'b'));
+    CHECK(again > evictedVersion);
+    auto frame = alice.encodeFor("bob", "k000");
+    CHECK(frame && !frame->isDelta());
+    auto value = bob.decode("alice", *frame);
+    CHECK(value && *value == document(100, 'b'));
+    CHECK(!alice.hasLocal("k040")); // least recently written goes next
+
+    // A single value over the budget keeps only its latest version
+    DeltaSync small(metrics, 8, 50);
+    small.recordLocal("big", document(100, '1'));
+    small.recordLocal("big", document(100, '2'));
+    CHECK_EQ(small.historyBytes(), 3 + 100u);
+    CHECK(small.hasLocal("big"));
+}
+
+void testReceivedBudget() {
+    SyncMetrics metrics, senders;
+    const size_t keyBytes = 4 + 100;
+    DeltaSync alice(senders), carol(senders), bob(metrics, 8, 10 * keyBytes);
+
+    // Bases from two peers share bob's budget, least recently applied first
+    for (int i = 0; i < 8; i++) {
+        alice.recordLocal(keyOf(i), document(100, 'a'));
+        deliver(alice, bob, "alice", "bob", keyOf(i));
+    }
+    for (int i = 0; i < 8; i++) {
+        carol.recordLocal(keyOf(i), document(100, 'c'));
+        deliver(carol, bob, "carol", "bob", keyOf(i));
+    }
+    CHECK(bob.receivedBytes() <= 10 * keyBytes);
+    CHECK_EQ(metrics.deltaReceivedBytes.load(), bob.receivedBytes());
+    CHECK_EQ(metrics.deltaReceivedEvictions.load(), 6u);
+
+    // alice's k006 and k007 survived; a delta on k000 finds no base and
+    // alice falls back to the full value after the nack
+    alice.recordLocal(keyOf(7), document(100, 'b'));
+    auto kept = alice.encodeFor("bob", keyOf(7));
+    CHECK(kept && kept->isDelta());
+    CHECK(bob.decode("alice", *kept).has_value());
+
+    alice.recordLocal(keyOf(0), document(100, 'b'));
+    auto lost = alice.encodeFor("bob", keyOf(0));
+    CHECK(lost && lost->isDelta());
+    CHECK(!bob.decode("alice", *lost));
+    alice.onNack("bob", keyOf(0));
+    auto full = alice.encodeFor("bob", keyOf(0));
+    CHECK(full && !full->isDelta());
+    auto value = bob.decode("alice", *full);
+    CHECK(value && *value == document(100, 'b'));
+
+    // A late frame doesn't replace a newer base
+    alice.onAck("bob", keyOf(0), full->version);
+    alice.recordLocal(keyOf(0), document(100, 'c'));
+    auto next = alice.encodeFor("bob", keyOf(0));
+    alice.recordLocal(keyOf(0), document(100, 'd'));
+    deliver(alice, bob, "alice", "bob", keyOf(0));
+    CHECK(next && !bob.decode("alice", *next)); // its base moved on
+    CHECK(bob.decode("alice", *full).has_value());
+    alice.recordLocal(keyOf(0), document(100, 'e'));
+    auto latest = alice.encodeFor("bob", keyOf(0));
+    CHECK(latest && latest->isDelta());
+    value = bob.decode("alice", *latest);
+    CHECK(value && *value == document(100, 'e'));
+
+    bob.forgetPeer("carol");
+    bob.forgetPeer("alice");
+    CHECK_EQ(bob.receivedBytes(), 0u);
+    CHECK_EQ(metrics.deltaReceivedBytes.load(), 0u);
+}
+
+} // namespace
+
+int main() {
+    testEncodeAgainstAckedBase();
+    testHistoryPrunedOnAck();
+    testByteBudget();
+    testReceivedBudget();
+    return 0;
+}
@@ -0,0 +1,86 @@
+// HybridClock: monotonic stamps, merging remote stamps, drift rejection.
+
+#include "HybridClock.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace aegis;
+
+namespace {
+
+int64_t wallMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void testPacking() {
+    uint64_t hlc = HybridClock::pack(1700000000000, 5);
+    CHECK_EQ(HybridClock::physicalMs(hlc), 1700000000000);
+    CHECK_EQ(hlc & 0xffff, 5u);
+    // Logical counters wrap inside their 16 bits
+    CHECK_EQ(HybridClock::pack(1, 0x10001) & 0xffff, 1u);
+
+    // Legacy epoch-ms timestamps order below packed stamps of the same time
+    CHECK_EQ(HybridClock::normalize(0), 0u);
+    CHECK_EQ(HybridClock::normalize(-5), 0u);
+    CHECK(HybridClock::normalize(1700000000000) == HybridClock::pack(1700000000000, 0));
+    CHECK(HybridClock::normalize(static_cast<int64_t>(hlc)) == hlc);
+}
+
+void testMonotonic() {
+    HybridClock clock;
+    uint64_t last = 0;
+    for (int i = 0; i < 100000; i++) {
+        uint64_t now = clock.now();
+        CHECK(now > last);
+        last = now;
+    }
+    CHECK(HybridClock::physicalMs(last) <= wallMs() + 1000);
+
+    // Concurrent stamps are unique
+    HybridClock shared;
+    std::vector<std::vector<uint64_t>> stamps(4);
+    std::vector<std::thread> threads;
+    for (auto& s : stamps) {
+        threads.emplace_back([&shared, &s] {
+            for (int i = 0; i < 20000; i++) s.push_back(shared.now());
+        });
+    }
+    for (auto& t : threads) t.join();
+    std::vector<uint64_t> all;
+    for (auto& s : stamps) all.insert(all.end(), s.begin(), s.end());
+    std::sort(all.begin(), all.end());
+    CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+}
+
+void testObserve() {
+    HybridClock clock;
+    uint64_t local = clock.now();
+
+    // A remote stamp a few seconds ahead pulls later local stamps past it
+    uint64_t remote = HybridClock::pack(wallMs() + 5000, 3);
+    CHECK(clock.observe(remote));
+    CHECK(clock.now() > remote);
+
+    // Older remote stamps leave the clock alone
+    uint64_t before = clock.last();
+    CHECK(clock.observe(local));
+    CHECK_EQ(clock.last(), before);
+
+    // Stamps too far ahead are rejected without moving the clock
+    uint64_t far = HybridClock::pack(wallMs() + 2 * HybridClock::kMaxDriftMs, 0);
+    CHECK(!clock.observe(far));
+    CHECK_EQ(clock.last(), before);
+}
+
+} // namespace
+
+int main() {
+    testPacking();
+    testMonotonic();
+    testObserve();
+    return 0;
+}
@@ -0,0 +1,152 @@
+// MerkleIndex: two replicas find exactly their differing keys by descending
+// only into differing ranges, last-writer-wins admission, and paging a
+// client's writes by HLC range.
+
+#include "MerkleIndex.h"
+#include "TestCheck.h"
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace aegis;
+
+namespace {
+
+std::vector<uint8_t> value(const std::string& s) { return std::vector<uint8_t>(s.begin(), s.end()); }
+
+// Anti-entropy descent: returns the keys whose hashes differ (or exist on
+// one side only) and counts the leaves visited
+std::set<std::string> diff(MerkleIndex& a, MerkleIndex& b, size_t& leavesVisited) {
+    std::set<std::string> keys;
+    leavesVisited = 0;
+    if (a.root() == b.root()) return keys;
+
+    std::vector<uint32_t> nodes = {0};
+    for (uint32_t level = 0; level < MerkleIndex::kDepth; level++) {
+        std::vector<uint32_t> next;
+        for (uint32_t node : nodes) {
+            auto ca = a.children(level, node);
+            auto cb = b.children(level, node);
+            for (uint32_t i = 0; i < MerkleIndex::kFanout; i++) {
+                if (ca[i] != cb[i]) next.push_back(node * MerkleIndex::kFanout + i);
+            }
+        }
+        nodes = std::move(next);
+    }
+    for (uint32_t leaf : nodes) {
+        leavesVisited++;
+        std::map<std::string, uint64_t> left;
+        for (const auto& item : a.leafItems(leaf)) left[item.key] = item.hash;
+        for (const auto& item : b.leafItems(leaf)) {
+            auto it = left.find(item.key);
+            if (it == left.end() || it->second != item.hash) keys.insert(item.key);
+            if (it != left.end()) left.erase(it);
+        }
+        for (const auto& [key, hash] : left) keys.insert(key);
+    }
+    return keys;
+}
+
+void testDiff() {
+    MerkleIndex a, b;
+    CHECK(a.open(":memory:"));
+    CHECK(b.open(":memory:"));
+    uint32_t clientA = a.clientIndex("node-a");
+    uint32_t clientB = b.clientIndex("node-a");
+
+    for (int i = 0; i < 2000; i++) {
+        std::string key = "doc_" + std::to_string(i);
+        a.update(key, value(key + "_v"), {static_cast<uint64_t>(i + 1), clientA});
+        b.update(key, value(key + "_v"), {static_cast<uint64_t>(i + 1), clientB});
+    }
+    CHECK(a.root() == b.root());
+    CHECK_EQ(a.size(), 2000u);
+
+    size_t leaves = 0;
+    CHECK(diff(a, b, leaves).empty());
+    CHECK_EQ(leaves, 0u);
+
+    // Changed value, key missing on b, key only on b
+    b.update("doc_7", value("changed"), {5000, clientB});
+    b.remove("doc_99");
+    b.update("extra", value("x"), {5001, clientB});
+    CHECK(a.root() != b.root());
+    CHECK_EQ(b.size(), 2000u);
+
+    auto keys = diff(a, b, leaves);
+    CHECK(keys == (std::set<std::string>{"doc_7", "doc_99", "extra"}));
+    CHECK(leaves <= 3);
+
+    // Repairing the differences converges the summaries
+    a.update("doc_7", value("changed"), {5000, clientA});
+    a.remove("doc_99");
+    a.update("extra", value("x"), {5001, clientA});
+    CHECK(a.root() == b.root());
+
+    // A rewrite with the same value leaves the summary unchanged
+    auto root = a.root();
+    a.update("doc_1", value("doc_1_v"), {9000, clientA});
+    CHECK(a.root() == root);
+}
+
+void testAdmit() {
+    MerkleIndex index;
+    CHECK(index.open(":memory:"));
+    uint32_t alice = index.clientIndex("alice");
+    uint32_t bob = index.clientIndex("bob");
+    CHECK(alice != 0 && bob != 0 && alice != bob);
+    CHECK(index.clientName(bob) == "bob");
+    CHECK_EQ(index.clientIndex("alice"), alice);
+
+    CHECK(index.admit("k", {10, alice})); // absent
+    index.update("k", value("a"), {10, alice});
+    CHECK(!index.admit("k", {9, bob}));
+    CHECK(index.admit("k", {11, bob}));
+    // Equal HLCs fall back to the client id, the same way on every replica
+    CHECK(!index.admit("k", {10, alice}));
+    CHECK_EQ(index.admit("k", {10, bob}), index.newer({10, bob}, {10, alice}));
+    CHECK(index.newer({10, bob}, {10, alice}) != index.newer({10, alice}, {10, bob}));
+
+    auto stamp = index.stamp("k");
+    CHECK(stamp && stamp->hlc == 10 && stamp->client == alice);
+    CHECK(!index.stamp("missing"));
+}
+
+void testWrittenBy() {
+    MerkleIndex index;
+    CHECK(index.open(":memory:"));
+    uint32_t alice = index.clientIndex("alice");
+    uint32_t bob = index.clientIndex("bob");
+    for (uint64_t hlc = 1; hlc <= 10; hlc++) {
+        char key[8];
+        std::snprintf(key, sizeof(key), "k%d", static_cast<int>(hlc));
+        index.update(key, value("a"), {hlc, alice});
+    }
+    index.update("k4", value("b"), {11, bob}); // replaced by bob
+    index.update("k5", value("c"), {12, alice}); // rewritten past the range
+
+    std::vector<std::string> keys;
+    uint64_t after = 2;
+    for (;;) {
+        auto page = index.writtenBy(alice, after, 8, 2);
+        for (const auto& item : page) {
+            CHECK(item.meta.clientId == "alice");
+            keys.push_back(item.key);
+        }
+        if (page.size() < 2) break;
+        after = static_cast<uint64_t>(page.back().meta.timestamp);
+    }
+    CHECK((keys == std::vector<std::string>{"k3", "k6", "k7", "k8"}));
+    CHECK(index.writtenBy(bob, 0, 10, 10).empty());
+}
+
+} // namespace
+
+int main() {
+    testDiff();
+    testAdmit();
+    testWrittenBy();
+    return 0;
+}
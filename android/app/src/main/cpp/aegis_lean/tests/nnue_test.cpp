@@ -0,0 +1,171 @@
+// NNUE: incrementally updated accumulators evaluate exactly like a refresh
+// and like a plain reference computation, over castling, en passant and
+// promotions (with and without capture) for both sides, null moves, random
+// games and unwinding. Runs once per SIMD kernel this build and CPU have
+// (avx2 on x86-64, neon on arm64, scalar everywhere).
+
+#include "ChessMoveGen.h"
+#include "ChessNnue.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace aegis::chess;
+
+namespace {
+
+constexpr int kHidden = 64;
+
+template <typename T>
+void append(std::vector<uint8_t>& out, T value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+// Weights wide enough that accumulators leave [0, 127] both ways, so the
+// clamp in every kernel is exercised
+std::shared_ptr<const Network> randomNetwork() {
+    std::mt19937 rng(2024);
+    std::uniform_int_distribution<int> feature(-40, 40);
+    std::uniform_int_distribution<int> output(-127, 127);
+    std::vector<uint8_t> bytes;
+    bytes.insert(bytes.end(), "AEGISNN1", "AEGISNN1" + 8);
+    append<uint32_t>(bytes, kHidden);
+    append<int32_t>(bytes, 600);
+    for (int i = 0; i < kHidden; i++) append<int16_t>(bytes, static_cast<int16_t>(feature(rng) + 40));
+    for (int i = 0; i < Network::kInputs * kHidden; i++) append<int16_t>(bytes, static_cast<int16_t>(feature(rng)));
+    for (int i = 0; i < 2 * kHidden; i++) append<int8_t>(bytes, static_cast<int8_t>(output(rng)));
+    append<int32_t>(bytes, 1234);
+    std::string error;
+    auto network = Network::fromBytes(std::move(bytes), &error);
+    CHECK(network);
+    return network;
+}
+
+// The evaluation spelled out from the format description in ChessNnue.h
+int reference(const Network& net, const Position& pos) {
+    std::vector<int> acc[2];
+    for (Color perspective : {White, Black}) {
+        acc[perspective].assign(net.featureBias(), net.featureBias() + kHidden);
+        for (int sq = 0; sq < 64; sq++) {
+            Piece piece = pos.pieceOn(sq);
+            if (piece == kNoPiece) continue;
+            int relative = perspective == Black ? sq ^ 56 : sq;
+            int feature = (colorOf(piece) == perspective ? 0 : 384) + typeOf(piece) * 64 + relative;
+            for (int i = 0; i < kHidden; i++) acc[perspective][i] += net.featureWeights(feature)[i];
+        }
+    }
+    Color us = pos.sideToMove();
+    int64_t dot = 0;
+    for (int i = 0; i < kHidden; i++) {
+        dot += std::clamp(acc[us][i], 0, 127) * net.outputWeights()[i];
+        dot += std::clamp(acc[~us][i], 0, 127) * net.outputWeights()[kHidden + i];
+    }
+    return static_cast<int>((dot + net.outputBias()) * net.scale() / (127 * 64));
+}
+
+struct Checker {
+    std::shared_ptr<const Network> network;
+    NnueAccumulators incremental{network, 64};
+    NnueAccumulators fresh{network, 0};
+
+    void expectMatch(const Position& pos) {
+        fresh.refresh(pos);
+        int expected = reference(*network, pos);
+        CHECK_EQ(fresh.evaluate(pos.sideToMove()), expected);
+        CHECK_EQ(incremental.evaluate(pos.sideToMove()), expected);
+    }
+
+    // Plays the UCI moves from fen, checking after each one and again
+    // after unwinding to the start
+    void line(const char* fen, const std::vector<const char*>& moves) {
+        Position pos;
+        CHECK(pos.setFen(fen));
+        incremental.refresh(pos);
+        expectMatch(pos);
+        std::vector<Move> played;
+        std::vector<Undo> undo(moves.size());
+        for (size_t i = 0; i < moves.size(); i++) {
+            Move m = pos.parseUci(moves[i]);
+            CHECK(!m.isNone());
+            incremental.push(pos, m);
+            pos.doMove(m, undo[i]);
+            played.push_back(m);
+            expectMatch(pos);
+        }
+        while (!played.empty()) {
+            pos.undoMove(played.back(), undo[played.size() - 1]);
+            played.pop_back();
+            incremental.pop();
+        }
+        expectMatch(pos);
+    }
+};
+
+void testSpecialMoves(Checker& checker) {
+    // Castling on both wings for both sides
+    checker.line("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", {"e1g1", "e8c8"});
+    checker.line("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", {"e1c1", "e8g8"});
+    // En passant for White, then for Black
+    checker.line("rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", {"e5f6"});
+    checker.line("4k3/8/8/8/3Pp3/8/8/4K3 b - d3 0 1", {"e4d3"});
+    // Promotions: capturing to a queen, pushing to a knight, capturing to a
+    // rook for Black
+    checker.line("1r6/P3k3/8/8/8/8/7p/4K1N1 w - - 0 1", {"a7b8q", "h2g1r"});
+    checker.line("4k3/P7/8/8/8/8/7p/4K3 w - - 0 1", {"a7a8n", "h2h1q"});
+}
+
+void testRandomGames(Checker& checker) {
+    std::mt19937 rng(99);
+    for (int game = 0; game < 20; game++) {
+        Position pos;
+        CHECK(pos.setFen("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"));
+        checker.incremental.refresh(pos);
+        Undo undo[64];
+        Move played[64];
+        int ply = 0;
+        for (; ply < 64; ply++) {
+            MoveList list;
+            generateLegal(pos, list);
+            if (list.size == 0) break;
+            if (!pos.inCheck() && rng() % 16 == 0) {
+                checker.incremental.pushNull();
+                pos.doNullMove(undo[ply]);
+                played[ply] = Move();
+            } else {
+                Move m = list.moves[rng() % list.size];
+                checker.incremental.push(pos, m);
+                pos.doMove(m, undo[ply]);
+                played[ply] = m;
+            }
+            checker.expectMatch(pos);
+        }
+        while (ply-- > 0) {
+            if (played[ply].isNone()) pos.undoNullMove(undo[ply]);
+            else pos.undoMove(played[ply], undo[ply]);
+            checker.incremental.pop();
+        }
+        checker.expectMatch(pos);
+    }
+}
+
+} // namespace
+
+int main() {
+    auto network = randomNetwork();
+    auto kernels = nnueKernelNames();
+    CHECK(kernels.front() == nnueKernelName());
+    CHECK(kernels.back() == "scalar");
+    CHECK(!setNnueKernel("missing"));
+
+    for (const auto& kernel : kernels) {
+        CHECK(setNnueKernel(kernel));
+        CHECK(kernel == nnueKernelName());
+        Checker checker{network};
+        testSpecialMoves(checker);
+        testRandomGames(checker);
+    }
+    return 0;
+}
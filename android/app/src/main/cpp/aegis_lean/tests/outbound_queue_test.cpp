@@ -0,0 +1,263 @@
+// OutboundQueue: lane classification, move priority, round robin, spilling
+// (counted and through a SegmentLog, including failed appends), requeueing
+// and SegmentLog segment recycling.
+
+#include "OutboundQueue.h"
+#include "TestCheck.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace aegis;
+
+namespace {
+
+storage::Mutation mutation(const std::string& key, size_t bytes = 8) {
+    storage::Mutation m;
+    m.key = key;
+    m.data.assign(bytes, 'x');
+    m.meta.clientId = "test";
+    m.meta.timestamp = 42;
+    return m;
+}
+
+void testClassify() {
+    SyncMetrics metrics;
+    OutboundQueue queue(metrics);
+    CHECK(queue.classify("match_1", 10) == SyncLane::Move);
+    CHECK(queue.classify("clock_1", 10) == SyncLane::Clock);
+    CHECK(queue.classify("typing_1", 10) == SyncLane::Presence);
+    CHECK(queue.classify("note_1", 10) == SyncLane::Document);
+    CHECK(queue.classify("note_1", OutboundQueue::kBulkThresholdBytes) == SyncLane::Bulk);
+
+    // Longest prefix wins
+    queue.setLaneForPrefix("match_chat_", SyncLane::Document);
+    CHECK(queue.classify("match_chat_1", 10) == SyncLane::Document);
+    CHECK(queue.classify("match_2", 10) == SyncLane::Move);
+
+    {
+        OutboundQueue::ScopedLane scoped(SyncLane::Bulk);
+        CHECK(queue.classify("match_1", 10) == SyncLane::Bulk);
+    }
+    CHECK(queue.classify("match_1", 10) == SyncLane::Move);
+}
+
+void testPriority() {
+    SyncMetrics metrics;
+    OutboundQueue queue(metrics);
+    for (int i = 0; i < 20; i++) queue.push(mutation("doc_" + std::to_string(i)));
+    queue.push(mutation("match_1"));
+    queue.push(mutation("presence_1"));
+    CHECK_EQ(queue.size(), 22u);
+    CHECK_EQ(queue.depth(SyncLane::Document), 20u);
+    CHECK_EQ(metrics.lanes[static_cast<size_t>(SyncLane::Move)].depth.load(), 1u);
+
+    // The move goes first even though it was queued last
+    auto batch = queue.popBatch(4, SIZE_MAX);
+    CHECK_EQ(batch.size(), 4u);
+    CHECK(batch[0].mutation.key == "match_1");
+
+    // Remaining lanes drain completely, in per-lane FIFO order
+    size_t popped = batch.size();
+    int nextDoc = 0;
+    bool presence = false;
+    for (const auto& item : batch) {
+        if (item.lane == SyncLane::Document) CHECK(item.mutation.key == "doc_" + std::to_string(nextDoc++));
+        presence |= item.lane == SyncLane::Presence;
+    }
+    while (!(batch = queue.popBatch(3, SIZE_MAX)).empty()) {
+        popped += batch.size();
+        for (const auto& item : batch) {
+            if (item.lane == SyncLane::Document) CHECK(item.mutation.key == "doc_" + std::to_string(nextDoc++));
+            presence |= item.lane == SyncLane::Presence;
+        }
+    }
+    CHECK_EQ(popped, 22u);
+    CHECK_EQ(nextDoc, 20);
+    CHECK(presence);
+    CHECK_EQ(metrics.residentMutations.load(), 0u);
+
+    // A failed send puts the batch back in front
+    queue.push(mutation("doc_a"));
+    queue.push(mutation("doc_b"));
+    batch = queue.popBatch(1, SIZE_MAX);
+    CHECK(batch[0].mutation.key == "doc_a");
+    queue.requeueFront(std::move(batch));
+    batch = queue.popBatch(2, SIZE_MAX);
+    CHECK_EQ(batch.size(), 2u);
+    CHECK(batch[0].mutation.key == "doc_a");
+}
+
+void testCountedSpill() {
+    SyncMetrics metrics;
+    OutboundQueue queue(metrics);
+    OutboundQueue::Limits limits;
+    limits.highWaterCount = 4;
+    queue.setLimits(limits);
+
+    for (int i = 0; i < 10; i++) queue.push(mutation("doc_" + std::to_string(i)));
+    queue.push(mutation("match_1"));
+    // Moves never spill; everything past the high-water mark does
+    CHECK_EQ(queue.size(), 5u);
+    CHECK_EQ(queue.spilled().count, 6u);
+    CHECK_EQ(metrics.spilledPending.load(), 6u);
+
+    // Once spilling started, later mutations spill too (order is kept by
+    // the replay), even with room in memory again
+    queue.popBatch(100, SIZE_MAX);
+    queue.push(mutation("doc_late"));
+    CHECK_EQ(queue.size(), 0u);
+    CHECK_EQ(queue.spilled().count, 7u);
+
+    CHECK_EQ(queue.unlogged().count, 7u);
+    queue.releaseUnlogged(queue.unlogged());
+    CHECK_EQ(queue.spilled().count, 0u);
+    queue.push(mutation("doc_resident"));
+    CHECK_EQ(queue.size(), 1u);
+}
+
+void testLogSpill() {
+    auto dir = std::filesystem::temp_directory_path() / "aegis_outbound_queue_test";
+    std::filesystem::remove_all(dir);
+
+    SyncMetrics metrics;
+    OutboundQueue queue(metrics);
+    OutboundQueue::Limits limits;
+    limits.highWaterCount = 2;
+    queue.setLimits(limits);
+    {
+        SegmentLog log;
+        CHECK(log.open(dir.string()));
+        queue.setSpillLog(&log);
+        for (int i = 0; i < 8; i++) queue.push(mutation("doc_" + std::to_string(i), 16 + i));
+        CHECK_EQ(queue.size(), 2u);
+        CHECK_EQ(queue.spilled().count, 6u);
+
+        // Streams back in append order with the record contents intact
+        auto batch = queue.popSpilled(4, SIZE_MAX);
+        CHECK_EQ(batch.items.size(), 4u);
+        CHECK(batch.items[0].mutation.key == "doc_2");
+        CHECK_EQ(batch.items[0].mutation.data.size(), 18u);
+        CHECK(batch.items[0].mutation.meta.clientId == "test");
+        CHECK_EQ(batch.items[0].mutation.meta.timestamp, 42);
+        queue.ackSpilled(batch);
+        CHECK_EQ(queue.spilled().count, 2u);
+        queue.setSpillLog(nullptr);
+    }
+
+    // Unacknowledged records survive a restart
+    SegmentLog log;
+    CHECK(log.open(dir.string()));
+    OutboundQueue restarted(metrics);
+    restarted.setSpillLog(&log);
+    CHECK_EQ(restarted.spilled().count, 2u);
+    auto batch = restarted.popSpilled(10, SIZE_MAX);
+    CHECK_EQ(batch.items.size(), 2u);
+    CHECK(batch.items[0].mutation.key == "doc_6");
+    restarted.ackSpilled(batch);
+    CHECK_EQ(restarted.spilled().count, 0u);
+    restarted.setSpillLog(nullptr);
+    log.close();
+    std::filesystem::remove_all(dir);
+}
+
+// A failed append leaves the mutation to a full replay instead of losing it
+void testFailedSpillAppend() {
+    auto dir = std::filesystem::temp_directory_path() / "aegis_outbound_queue_failed";
+    std::filesystem::remove_all(dir);
+
+    SyncMetrics metrics;
+    OutboundQueue queue(metrics);
+    OutboundQueue::Limits limits;
+    limits.highWaterCount = 1;
+    queue.setLimits(limits);
+    SegmentLog log;
+    CHECK(log.open(dir.string()));
+    queue.setSpillLog(&log);
+
+    queue.push(mutation("doc_0"));
+    queue.push(mutation("doc_1")); // logged
+    log.close();
+    storage::Mutation late = mutation("doc_2");
+    late.meta.timestamp = 77;
+    queue.push(late); // append fails
+    CHECK_EQ(queue.spilled().count, 2u);
+    auto unlogged = queue.unlogged();
+    CHECK_EQ(unlogged.count, 1u);
+    CHECK_EQ(unlogged.firstHlc, 77u);
+    CHECK_EQ(unlogged.lastHlc, 77u);
+
+    queue.releaseUnlogged(unlogged);
+    CHECK_EQ(queue.unlogged().count, 0u);
+    CHECK_EQ(queue.spilled().count, 1u);
+    queue.setSpillLog(nullptr);
+    std::filesystem::remove_all(dir);
+}
+
+std::vector<uint64_t> replayAll(SegmentLog& log, std::vector<std::string>* payloads = nullptr) {
+    std::vector<uint64_t> seqs;
+    log.replay(log.lowWater(), SIZE_MAX, [&](uint64_t seq, const uint8_t* data, size_t len) {
+        seqs.push_back(seq);
+        if (payloads) payloads->emplace_back(reinterpret_cast<const char*>(data), len);
+        return true;
+    });
+    return seqs;
+}
+
+// An acknowledged segment is reused as the next tail without giving up its
+// blocks, and its old records never come back
+void testRecycledSegment() {
+    auto dir = std::filesystem::temp_directory_path() / "aegis_segment_recycle";
+    std::filesystem::remove_all(dir);
+    SegmentLog::Options options;
+    options.segmentBytes = 256; // 16-byte header + 48-byte payload: 4 records per segment
+    const std::string old(48, 'o');
+    const std::string fresh(48, 'n');
+    auto append = [](SegmentLog& log, const std::string& payload) {
+        return log.append(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+    };
+    {
+        SegmentLog log;
+        CHECK(log.open(dir.string(), options));
+        for (int i = 0; i < 5; i++) CHECK(append(log, old) != 0); // seqs 1-4 sealed, 5 in the tail
+        log.ack(4);
+        CHECK(std::filesystem::file_size(dir / "spare") == 256u);
+
+        for (int i = 0; i < 4; i++) CHECK(append(log, fresh) != 0); // 9 rotates onto the spare
+        CHECK(!std::filesystem::exists(dir / "spare"));
+        CHECK_EQ(log.lastSeq(), 9u);
+        CHECK(replayAll(log) == (std::vector<uint64_t>{5, 6, 7, 8, 9}));
+    }
+
+    // The reused tail still has its allocated length; a reopen finds only
+    // the new record in it and appends right after
+    std::filesystem::path tail;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.path().filename().string().find("00000000000000000009") == 0) tail = entry.path();
+    }
+    CHECK(!tail.empty());
+    CHECK(std::filesystem::file_size(tail) == 256u);
+
+    SegmentLog log;
+    CHECK(log.open(dir.string(), options));
+    CHECK_EQ(log.lastSeq(), 9u);
+    CHECK_EQ(append(log, fresh), 10u);
+    std::vector<std::string> payloads;
+    CHECK(replayAll(log, &payloads) == (std::vector<uint64_t>{5, 6, 7, 8, 9, 10}));
+    CHECK(payloads[0] == old);
+    for (size_t i = 1; i < payloads.size(); i++) CHECK(payloads[i] == fresh);
+    log.close();
+    std::filesystem::remove_all(dir);
+}
+
+} // namespace
+
+int main() {
+    testClassify();
+    testPriority();
+    testCountedSpill();
+    testLogSpill();
+    testFailedSpillAppend();
+    testRecycledSegment();
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Perft: move generator against published node counts, kept shallow
+// enough for every CTest run. tools/perft.cpp --suite runs the deep set.
+
+#include "ChessPerft.h"
+#include "TestCheck.h"
+#include <cstdio>
+
+using namespace aegis::chess;
+
+namespace {
+
+struct Reference {
+    const char* fen;
+    int depth;
+    uint64_t nodes;
+};
+
+const Reference kSuite[] = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4, 197281},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3, 97862},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62379},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 3, 89890},
+    // En passant, castling and promotion edge cases
+    {"5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072},
+    {"3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711},
+    {"4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342},
+    {"8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683},
+    {"K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217},
+    {"8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527},
+};
+
+} // namespace
+
+int main() {
+    for (const auto& ref : kSuite) {
+        Position pos;
+        CHECK(pos.setFen(ref.fen));
+        uint64_t nodes = perft(pos, ref.depth);
+        if (nodes != ref.nodes) std::fprintf(stderr, "%s d%d\n", ref.fen, ref.depth);
+        CHECK_EQ(nodes, ref.nodes);
+        // make/unmake leaves the position as it was
+        CHECK(pos.fen() == ref.fen);
+    }
+
+    // The parallel and cached forms agree with the serial count
+    Position kiwipete;
+    CHECK(kiwipete.setFen(kSuite[1].fen));
+    PerftOptions options;
+    options.threads = 3;
+    options.hashMb = 1;
+    CHECK_EQ(perftParallel(kiwipete, 4, options), 4085603u);
+
+    uint64_t total = 0;
+    auto entries = perftDivide(kiwipete, 3, options);
+    CHECK_EQ(entries.size(), 48u);
+    for (const auto& entry : entries) total += entry.nodes;
+    CHECK_EQ(total, kSuite[1].nodes);
+    return 0;
+}
@@ -0,0 +1,181 @@
+// RemoteApplyBatcher: coalescing versions of a key within a batch, stale
+// updates against the stored stamp, the client id tie-break on equal HLCs,
+// and stage() backpressure while the worker is busy.
+
+#include "RemoteApplyBatcher.h"
+#include "TestCheck.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace aegis;
+
+namespace {
+
+std::vector<uint8_t> value(const std::string& s) { return std::vector<uint8_t>(s.begin(), s.end()); }
+
+std::string keyOf(const char* prefix, int i) {
+    char key[16];
+    std::snprintf(key, sizeof(key), "%s%d", prefix, i);
+    return key;
+}
+
+storage::SyncMetadata meta(uint64_t hlc, const std::string& client) {
+    storage::SyncMetadata m;
+    m.timestamp = static_cast<int64_t>(hlc);
+    m.clientId = client;
+    return m;
+}
+
+// A store that records what the batcher wrote and notified
+struct Store {
+    std::map<std::string, std::string> values;
+    std::vector<std::string> writes;
+    std::vector<std::string> notified;
+
+    RemoteApplyBatcher::ApplyFn apply() {
+        return [this](const std::string& key, const std::vector<uint8_t>& data, const storage::SyncMetadata&) {
+            values[key].assign(data.begin(), data.end());
+            writes.push_back(key);
+            return true;
+        };
+    }
+    RemoteApplyBatcher::NotifyFn notify() {
+        return [this](const std::string& key, const std::vector<uint8_t>&) { notified.push_back(key); };
+    }
+};
+
+void testCoalesce() {
+    MerkleIndex index;
+    CHECK(index.open(":memory:"));
+    HybridClock clock;
+    SyncMetrics metrics;
+    Store store;
+    RemoteApplyBatcher batcher(index, clock, metrics, store.apply(), store.notify());
+    uint64_t base = clock.now();
+
+    // Versions of one key arrive out of order; only the newest is written
+    batcher.stage("doc", value("v1"), meta(base + 1, "alice"));
+    batcher.stage("doc", value("v3"), meta(base + 3, "alice"));
+    batcher.stage("doc", value("v2"), meta(base + 2, "alice"));
+    batcher.stage("other", value("x"), meta(base + 1, "bob"));
+    batcher.flush();
+
+    CHECK((store.writes == std::vector<std::string>{"doc", "other"}));
+    CHECK((store.notified == std::vector<std::string>{"doc", "other"}));
+    CHECK(store.values["doc"] == "v3");
+    CHECK_EQ(metrics.remoteCoalesced.load(), 2u);
+    CHECK_EQ(metrics.remoteApplied.load(), 2u);
+    CHECK_EQ(metrics.remoteBatches.load(), 1u);
+    auto stamp = index.stamp("doc");
+    CHECK(stamp && stamp->hlc == base + 3 && stamp->client == index.clientIndex("alice"));
+}
+
+void testStaleAndTieBreak() {
+    MerkleIndex index;
+    CHECK(index.open(":memory:"));
+    HybridClock clock;
+    SyncMetrics metrics;
+    Store store;
+    RemoteApplyBatcher batcher(index, clock, metrics, store.apply(), store.notify());
+    uint64_t base = clock.now();
+    uint32_t alice = index.clientIndex("alice");
+    uint32_t bob = index.clientIndex("bob");
+    index.update("stale", value("stored"), {base + 10, alice});
+    index.update("tied", value("stored"), {base + 10, alice});
+
+    // Older than the stored version: dropped
+    batcher.stage("stale", value("old"), meta(base + 9, "bob"));
+    // Same HLC from another client: the client id order decides, the same
+    // way on every replica
+    batcher.stage("tied", value("bob"), meta(base + 10, "bob"));
+    // Same HLC from the writer of the stored version: nothing new
+    batcher.stage("stale", value("again"), meta(base + 10, "alice"));
+    batcher.flush();
+
+    bool bobWins = index.newer({base + 10, bob}, {base + 10, alice});
+    CHECK(!store.values.count("stale"));
+    CHECK_EQ(store.values.count("tied"), bobWins ? 1u : 0u);
+    CHECK_EQ(metrics.remoteStale.load(), bobWins ? 1u : 2u);
+    CHECK_EQ(metrics.remoteCoalesced.load(), 1u);
+    CHECK(index.stamp("tied")->client == (bobWins ? bob : alice));
+
+    // Within a batch, equal stamps from two clients settle the same way,
+    // whichever arrives first
+    for (int order = 0; order < 2; order++) {
+        std::string key = keyOf("both_", order);
+        std::string first = order ? "bob" : "alice";
+        std::string second = order ? "alice" : "bob";
+        batcher.stage(key, value(first), meta(base + 20, first));
+        batcher.stage(key, value(second), meta(base + 20, second));
+        batcher.flush();
+        CHECK(store.values[key] == (bobWins ? "bob" : "alice"));
+    }
+}
+
+void testBackpressure() {
+    MerkleIndex index;
+    CHECK(index.open(":memory:"));
+    HybridClock clock;
+    SyncMetrics metrics;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool release = false;
+    std::atomic<int> applied{0};
+    RemoteApplyBatcher batcher(
+        index, clock, metrics,
+        [&](const std::string&, const std::vector<uint8_t>&, const storage::SyncMetadata&) {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return release; });
+            applied++;
+            return true;
+        },
+        nullptr);
+    RemoteApplyBatcher::Limits limits;
+    limits.maxStagedCount = 2;
+    batcher.setLimits(limits);
+    batcher.start();
+    uint64_t base = clock.now();
+
+    // The worker takes the first batch and blocks in the store; two more
+    // updates fit, the next one waits for the worker
+    std::atomic<int> staged{0};
+    std::thread transport([&] {
+        for (int i = 0; i < 6; i++) {
+            batcher.stage(keyOf("k", i), value("v"), meta(base + i, "peer"));
+            staged++;
+        }
+    });
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (metrics.remoteStageWaits.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    CHECK(metrics.remoteStageWaits.load() > 0);
+    CHECK(staged.load() < 6);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    cv.notify_all();
+    transport.join();
+    batcher.flush();
+    CHECK_EQ(applied.load(), 6);
+    CHECK_EQ(metrics.remoteApplied.load(), 6u);
+    batcher.stop();
+}
+
+} // namespace
+
+int main() {
+    testCoalesce();
+    testStaleAndTieBreak();
+    testBackpressure();
+    return 0;
+}
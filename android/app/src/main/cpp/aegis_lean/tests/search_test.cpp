@@ -0,0 +1,114 @@
+// Search: forced mates found at their exact distance for the winning and
+// the losing side, and the aegis_chess_go callback reporting them, including
+// callbacks that start another search, stop or free their own handle.
+
+#include "AegisChess.h"
+#include "ChessSearch.h"
+#include "ChessTT.h"
+#include "TestCheck.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace aegis::chess;
+
+namespace {
+
+struct MateCase {
+    const char* fen;
+    int plies; // matePlies of the expected score
+};
+
+const MateCase kMates[] = {
+    {"6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", 1},          // back rank
+    {"7k/8/8/8/8/8/R7/1R4K1 w - - 0 1", 3},            // rook ladder
+    {"7k/R7/1R6/8/8/8/8/6K1 b - - 0 1", -2},           // mated after Kg8
+    {"r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4", 1}, // scholar's mate
+    {"6rk/6pp/8/6N1/8/8/8/6K1 w - - 0 1", 1},          // smothered mate
+};
+
+void testMateDistances() {
+    TranspositionTable tt(8);
+    Search search(tt, 1);
+    for (const auto& mate : kMates) {
+        Position root;
+        CHECK(root.setFen(mate.fen));
+        SearchLimits limits;
+        limits.depth = 8;
+        std::atomic<bool> stop{false};
+        SearchResult result = search.run(root, {root.key()}, limits, stop);
+        CHECK_EQ(matePlies(result.score), mate.plies);
+        CHECK(!result.best.isNone());
+    }
+}
+
+// The C API callback has no user pointer, so it reports through globals
+std::mutex g_mutex;
+std::condition_variable g_cv;
+std::vector<int32_t> g_mates;
+aegis_game_t* g_game = nullptr;
+enum class OnBest { Record, Stop, Free, GoAgain } g_action = OnBest::Record;
+
+const aegis_search_limits_t kDepth8 = {8, 0, 0, 0, 0, 0, 0, 0};
+
+void onBestMove(int64_t, uint16_t best, uint16_t, int32_t, int32_t mateIn, int32_t, int64_t, int64_t) {
+    CHECK(best != 0);
+    OnBest action;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        action = g_action;
+        g_action = OnBest::Record;
+    }
+    // Calls back into the handle from the search thread
+    if (action == OnBest::Stop) aegis_chess_stop(g_game);
+    if (action == OnBest::Free) {
+        aegis_game_free(g_game);
+        g_game = nullptr;
+    }
+    if (action == OnBest::GoAgain) CHECK(aegis_chess_go(g_game, &kDepth8, onBestMove) > 0);
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_mates.push_back(mateIn);
+    g_cv.notify_all();
+}
+
+void waitForResults(size_t count) {
+    std::unique_lock<std::mutex> lock(g_mutex);
+    CHECK(g_cv.wait_for(lock, std::chrono::seconds(30), [&] { return g_mates.size() >= count; }));
+}
+
+void testGoCallback() {
+    g_game = aegis_game_new("7k/8/8/8/8/8/R7/1R4K1 w - - 0 1");
+    CHECK(g_game);
+    aegis_chess_set_threads(g_game, 1);
+
+    CHECK(aegis_chess_go(g_game, &kDepth8, onBestMove) > 0);
+    waitForResults(1);
+    CHECK_EQ(g_mates[0], 2);
+
+    g_action = OnBest::GoAgain;
+    CHECK(aegis_chess_go(g_game, &kDepth8, onBestMove) > 0);
+    waitForResults(3);
+    CHECK_EQ(g_mates[2], 2);
+
+    g_action = OnBest::Stop;
+    CHECK(aegis_chess_go(g_game, &kDepth8, onBestMove) > 0);
+    waitForResults(4);
+
+    g_action = OnBest::Free;
+    CHECK(aegis_chess_go(g_game, &kDepth8, onBestMove) > 0);
+    waitForResults(5);
+    CHECK(!g_game);
+    // The detached search thread only has to return; give it the moment
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+
+} // namespace
+
+int main() {
+    testMateDistances();
+    testGoCallback();
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Spilled mutations reach peers: two engines on simulated links, the writer
+// with high-water marks low enough that every document spills to
+// MutationQueue storage. The sync worker's replay must publish them; the
+// reader only counts what arrives through the data-change callback.
+
+#include "Aegis.h"
+#include "TestCheck.h"
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+using namespace aegis;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kDocuments = 300;
+
+bool waitFor(const std::function<bool()>& done, std::chrono::milliseconds limit) {
+    auto deadline = Clock::now() + limit;
+    while (!done()) {
+        if (Clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+AegisConfig engineConfig(const std::filesystem::path& dir, const std::string& clientId) {
+    AegisConfig config;
+    config.clientId = clientId;
+    config.dbPath = (dir / (clientId + ".db")).string();
+    config.netSim.enabled = true;
+    return config;
+}
+
+} // namespace
+
+int main() {
+    auto dir = std::filesystem::temp_directory_path() / "aegis_spill_replay_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    {
+        AegisConfig writerConfig = engineConfig(dir, "writer");
+        writerConfig.outboundLimits.highWaterCount = 1;
+        writerConfig.outboundLimits.highWaterBytes = 1;
+        Aegis writer, reader;
+        CHECK(writer.init(writerConfig));
+        CHECK(reader.init(engineConfig(dir, "reader")));
+
+        std::mutex mutex;
+        std::set<std::string> arrived;
+        reader.setOnDataChange([&](const std::string& key, const std::vector<uint8_t>&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            arrived.insert(key);
+        });
+
+        writer.startNetwork();
+        reader.startNetwork();
+        writer.connectToPeer("sim:reader", 0);
+        // Let the connect-time anti-entropy round (driven by the lower id,
+        // the reader, over empty stores) finish first
+        SimNetwork& network = SimNetwork::shared(writerConfig.netSim);
+        CHECK(waitFor([&] {
+            return writer.getConnectedPeersCount() == 1 && reader.getConnectedPeersCount() == 1 &&
+                   reader.metrics().antiEntropyDigests > 0 && network.idle();
+        }, std::chrono::seconds(10)));
+
+        // Not the match_ prefix: moves never spill
+        for (int i = 0; i < kDocuments; i++) {
+            std::string value = "value " + std::to_string(i);
+            writer.db().put("doc:" + std::to_string(i), std::vector<uint8_t>(value.begin(), value.end()));
+        }
+        CHECK_EQ(writer.metrics().spilledMutations.load(), static_cast<uint64_t>(kDocuments));
+
+        // No triggerSync(): its anti-entropy round would repair the gap
+        // (checked below: nothing was sent as a repair)
+        bool complete = waitFor([&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            return arrived.size() == static_cast<size_t>(kDocuments);
+        }, std::chrono::seconds(30));
+        CHECK(complete);
+        for (int i = 0; i < kDocuments; i++) {
+            auto value = reader.db().get("doc:" + std::to_string(i));
+            CHECK(value && std::string(value->begin(), value->end()) == "value " + std::to_string(i));
+        }
+        CHECK_EQ(writer.metrics().spilledPending.load(), 0u);
+        CHECK_EQ(writer.getPendingMutationsCount(), 0);
+        CHECK_EQ(writer.metrics().antiEntropyKeys.load(), 0u);
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,80 @@
+// SyncScheduler: a failing sink puts the worker into a long backoff; a
+// nudge for a document waits it out, a nudge with a move queued does not.
+
+#include "SyncScheduler.h"
+#include "TestCheck.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+using namespace aegis;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+storage::Mutation mutation(const std::string& key) {
+    storage::Mutation m;
+    m.key = key;
+    m.data.assign(8, 'x');
+    m.meta.clientId = "test";
+    return m;
+}
+
+bool waitFor(const std::function<bool()>& done, std::chrono::milliseconds limit) {
+    auto deadline = Clock::now() + limit;
+    while (!done()) {
+        if (Clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return true;
+}
+
+void testMoveCutsBackoff() {
+    SyncMetrics metrics;
+    OutboundQueue queue(metrics);
+    std::atomic<bool> failing{true};
+    std::atomic<int> movesSent{0};
+    SyncScheduler::Options options;
+    options.minBackoff = std::chrono::milliseconds(20000);
+    options.maxBackoff = std::chrono::milliseconds(20000);
+    SyncScheduler scheduler(
+        queue, metrics,
+        [&](const std::vector<OutboundItem>& batch) {
+            if (failing) return false;
+            for (const auto& item : batch) movesSent += item.lane == SyncLane::Move;
+            return true;
+        },
+        [](const OutboundQueue::Spill&) { return true; }, options);
+    scheduler.start();
+
+    queue.push(mutation("note_1"));
+    scheduler.nudge();
+    CHECK(waitFor([&] { return metrics.syncFailures.load() == 1; }, std::chrono::seconds(5)));
+    CHECK_EQ(metrics.syncBackoffMs.load(), 20000u);
+    failing = false;
+
+    // Documents wait for the backoff to expire
+    uint64_t passes = metrics.syncPasses.load();
+    queue.push(mutation("note_2"));
+    scheduler.nudge();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK_EQ(metrics.syncPasses.load(), passes);
+
+    // A move is sent at once, along with what was held back
+    queue.push(mutation("match_1"));
+    scheduler.nudge();
+    CHECK(waitFor([&] { return movesSent.load() == 1; }, std::chrono::seconds(5)));
+    CHECK(waitFor([&] { return queue.size() == 0; }, std::chrono::seconds(5)));
+    CHECK_EQ(metrics.syncBackoffMs.load(), 0u);
+    scheduler.stop();
+}
+
+} // namespace
+
+int main() {
+    testMoveCutsBackoff();
+    return 0;
+}
@@ -0,0 +1,241 @@
+// Endgame tables: the 3-piece tables are generated into a temporary
+// directory and cross-checked on sampled KQvK, KRvK and KPvK positions
+// against brute force: a full-width mate search for short mates, and the
+// best move's probed successor for every sample. Also covers the cases
+// probe() must decline (fifty-move rule, en passant) and game status.
+
+#include "ChessGame.h"
+#include "ChessMoveGen.h"
+#include "ChessTablebase.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+using namespace aegis::chess;
+
+namespace {
+
+constexpr int kMate = 1000;
+constexpr int kSearchPlies = 5;
+
+// Negamax without tables: kMate - plies for a forced mate within depth,
+// the negation when mated, 0 for draws and anything past the horizon
+int mateSearch(Position& pos, int depth, int ply, int alpha, int beta) {
+    MoveList moves;
+    generateLegal(pos, moves);
+    if (moves.size == 0) return pos.inCheck() ? -(kMate - ply) : 0;
+    if (depth == 0 || popcount(pos.pieces()) == 2) return 0;
+    for (Move m : moves) {
+        Undo undo;
+        pos.doMove(m, undo);
+        int score = -mateSearch(pos, depth - 1, ply + 1, -beta, -alpha);
+        pos.undoMove(m, undo);
+        if (score >= beta) return score;
+        if (score > alpha) alpha = score;
+    }
+    return alpha;
+}
+
+// Result for the side to move from the probed result of every move
+TablebaseResult fromSuccessors(Position& pos, const Tablebases& tables) {
+    MoveList moves;
+    generateLegal(pos, moves);
+    TablebaseResult best;
+    if (moves.size == 0) {
+        if (pos.inCheck()) best.wdl = Wdl::Loss;
+        return best;
+    }
+    int fastestWin = INT_MAX, slowestLoss = -1;
+    bool draw = false;
+    for (Move m : moves) {
+        Undo undo;
+        pos.doMove(m, undo);
+        TablebaseResult child;
+        CHECK(tables.probe(pos, child));
+        pos.undoMove(m, undo);
+        if (child.wdl == Wdl::Loss) fastestWin = std::min(fastestWin, child.dtm + 1);
+        else if (child.wdl == Wdl::Win) slowestLoss = std::max(slowestLoss, child.dtm + 1);
+        else draw = true;
+    }
+    if (fastestWin != INT_MAX) best = {Wdl::Win, fastestWin};
+    else if (!draw) best = {Wdl::Loss, slowestLoss};
+    return best;
+}
+
+void crossCheck(const Tablebases& tables, PieceType strong, std::mt19937& rng) {
+    const Piece pieces[] = {makePiece(White, King), makePiece(Black, King), makePiece(White, strong)};
+    int checked = 0, searched = 0, wins = 0, losses = 0;
+    while (checked < 3000) {
+        int squares[3];
+        for (int& sq : squares) sq = static_cast<int>(rng() % 64);
+        Color side = rng() % 2 ? White : Black;
+        Position pos;
+        if (!pos.setPieces(pieces, squares, 3, side)) continue;
+        checked++;
+
+        TablebaseResult r;
+        CHECK(tables.probe(pos, r));
+        TablebaseResult expected = fromSuccessors(pos, tables);
+        if (r.wdl != expected.wdl || r.dtm != expected.dtm) std::fprintf(stderr, "%s\n", pos.fen().c_str());
+        CHECK(r.wdl == expected.wdl);
+        CHECK_EQ(r.dtm, expected.dtm);
+        wins += r.wdl == Wdl::Win;
+        losses += r.wdl == Wdl::Loss;
+
+        // The search is exponential: only a share of the samples, but
+        // every one with a mate inside its horizon
+        if (r.dtm > kSearchPlies && checked % 16) continue;
+        searched++;
+        int score = mateSearch(pos, kSearchPlies, 0, -kMate - 1, kMate + 1);
+        int dtm = score ? kMate - std::abs(score) : 0;
+        if (r.wdl == Wdl::Draw || r.dtm > kSearchPlies) {
+            CHECK_EQ(score, 0);
+        } else {
+            CHECK_EQ(dtm, r.dtm);
+            CHECK((score > 0) == (r.wdl == Wdl::Win));
+        }
+    }
+    // The samples cover both outcomes, and pawn endings draws too
+    CHECK(wins > 0 && losses > 0 && searched > 100);
+}
+
+std::string withHalfmove(const std::string& fen, int halfmove) {
+    // "... - - 0 1" -> "... - - <halfmove> 60"
+    size_t end = fen.rfind(' ');
+    size_t start = fen.rfind(' ', end - 1);
+    return fen.substr(0, start + 1) + std::to_string(halfmove) + " 60";
+}
+
+void testFiftyMoves(const Tablebases& tables) {
+    const std::string fen = "8/8/8/4k3/8/8/8/KQ6 w - - 0 1";
+    Position pos;
+    CHECK(pos.setFen(fen));
+    TablebaseResult r;
+    CHECK(tables.probe(pos, r));
+    CHECK(r.wdl == Wdl::Win);
+    CHECK(r.dtm > 1);
+
+    // Reported while the mate lands by the 100th ply, withheld after
+    CHECK(pos.setFen(withHalfmove(fen, 100 - r.dtm)));
+    CHECK(tables.probe(pos, r));
+    int dtm = r.dtm;
+    CHECK(pos.setFen(withHalfmove(fen, 101 - dtm)));
+    CHECK(!tables.probe(pos, r));
+
+    // Draws don't depend on the clock
+    CHECK(pos.setFen("8/8/8/8/8/3k4/8/3K4 w - - 99 80"));
+    CHECK(tables.probe(pos, r) && r.wdl == Wdl::Draw);
+}
+
+void testGameStatus(std::shared_ptr<const Tablebases> tables) {
+    setCurrentTablebases(tables);
+    Game game;
+    // Black is in check in a table position: status stays Check, the
+    // verdict comes separately
+    CHECK(game.setFen("4k3/8/8/8/8/8/8/K3Q3 b - - 0 1"));
+    CHECK(game.status() == GameStatus::Check);
+    TablebaseResult r;
+    CHECK(game.tablebaseResult(r));
+    CHECK(r.wdl == Wdl::Loss);
+
+    // Otherwise status adjudicates
+    CHECK(game.setFen("8/8/8/4k3/8/8/8/KQ6 w - - 0 1"));
+    CHECK(game.status() == GameStatus::TablebaseWin);
+    CHECK(game.tablebaseResult(r) && r.wdl == Wdl::Win);
+    CHECK(game.setFen("8/8/8/4k3/8/8/8/KQ6 b - - 0 1"));
+    CHECK(game.status() == GameStatus::TablebaseLoss);
+    CHECK(game.setFen("8/8/8/8/8/3k4/3P4/3K4 w - - 0 1"));
+    CHECK(game.status() == GameStatus::TablebaseDraw);
+    // A verdict the fifty-move rule could overturn is not reported
+    CHECK(game.setFen("8/8/8/4k3/8/8/8/KQ6 w - - 99 80"));
+    CHECK(game.status() == GameStatus::Ongoing);
+
+    // No verdict once the game is over
+    CHECK(game.setFen("7k/6Q1/6K1/8/8/8/8/8 b - - 0 1"));
+    CHECK(game.status() == GameStatus::Checkmate);
+    CHECK(!game.tablebaseResult(r));
+
+    // Closing the tables takes effect on a position already asked about
+    CHECK(game.setFen("8/8/8/4k3/8/8/8/KQ6 w - - 0 1"));
+    CHECK(game.status() == GameStatus::TablebaseWin);
+    setCurrentTablebases(nullptr);
+    CHECK(game.status() == GameStatus::Ongoing);
+    CHECK(!game.tablebaseResult(r));
+}
+
+// A KPvKP file whose every entry reads "won in 1": probe() must decline
+// the positions in which a double step could be taken en passant
+void testEnPassant(const std::filesystem::path& dir) {
+    TableMaterial material;
+    CHECK(TableMaterial::parse("KPvKP", material));
+    TableIndex index(material);
+    std::filesystem::path path = dir / "KPvKP.atb";
+    {
+        std::ofstream out(path, std::ios::binary);
+        char header[32] = "AEGISTB1KPvKP"; // magic, zero padded name
+        uint64_t entries = index.size();
+        for (int i = 0; i < 8; i++) header[24 + i] = static_cast<char>(entries >> (8 * i));
+        out.write(header, sizeof(header));
+        std::string values(entries, '\2');
+        out.write(values.data(), static_cast<std::streamsize>(values.size()));
+        CHECK(out.good());
+    }
+    Tablebases tables;
+    std::string error;
+    CHECK(tables.addFile(path.string(), &error));
+
+    const char* const covered[] = {
+        "k7/8/8/8/3p4/4P3/8/7K w - - 0 1", // white pawn past its start rank
+        "k7/3p4/4P3/8/8/8/8/7K b - - 0 1", // white pawn already past d5
+        "k7/8/8/8/7p/8/P7/7K w - - 0 1",   // files not adjacent
+    };
+    const char* const declined[] = {
+        "k7/8/8/8/3p4/8/4P3/7K w - - 0 1", // e2-e4 dxe3
+        "k7/8/3p4/8/8/8/4P3/7K b - - 0 1", // the d pawn can still get to d4
+        "k7/3p4/8/8/4P3/8/8/7K b - - 0 1", // d7-d5 exd6
+    };
+    Position pos;
+    TablebaseResult r;
+    for (const char* fen : covered) {
+        CHECK(pos.setFen(fen));
+        CHECK(tables.probe(pos, r) && r.wdl == Wdl::Win);
+    }
+    for (const char* fen : declined) {
+        CHECK(pos.setFen(fen));
+        CHECK(!tables.probe(pos, r));
+    }
+}
+
+} // namespace
+
+int main() {
+    auto dir = std::filesystem::temp_directory_path() / "aegis_tablebase_test";
+    std::filesystem::remove_all(dir);
+    std::string error;
+    int written = generateTablebases(dir.string(), 3, 0, {}, &error);
+    if (written < 0) std::fprintf(stderr, "%s\n", error.c_str());
+    CHECK_EQ(written, 5);
+    std::shared_ptr<const Tablebases> tables = Tablebases::open(dir.string(), &error);
+    CHECK(tables);
+    CHECK_EQ(tables->tables(), 5u);
+
+    std::mt19937 rng(2024);
+    crossCheck(*tables, Queen, rng);
+    crossCheck(*tables, Rook, rng);
+    crossCheck(*tables, Pawn, rng);
+    testFiftyMoves(*tables);
+    testGameStatus(tables);
+
+    auto pawnDir = dir / "kpvkp";
+    std::filesystem::create_directories(pawnDir);
+    testEnPassant(pawnDir);
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
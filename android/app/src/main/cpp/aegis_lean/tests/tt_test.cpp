@@ -0,0 +1,171 @@
+// TranspositionTable: packing round trip, depth-preferred overwrites within
+// a search, move retention, bucket replacement, clear and resize (direct
+// and deferred while a search holds the table).
+
+#include "ChessTT.h"
+#include "TestCheck.h"
+
+using namespace aegis::chess;
+
+namespace {
+
+void testRoundTrip() {
+    TranspositionTable tt(1);
+    CHECK_EQ(tt.sizeMb(), 1u);
+    TTEntry e;
+    CHECK(!tt.probe(0x1234, e));
+
+    Move move(12, 28);
+    tt.store(0x1234, move, -30950, 17, 9, Bound::Lower);
+    CHECK(tt.probe(0x1234, e));
+    CHECK(e.move == move);
+    CHECK_EQ(e.score, -30950);
+    CHECK_EQ(e.eval, 17);
+    CHECK_EQ(e.depth, 9);
+    CHECK(e.bound == Bound::Lower);
+
+    // Promotions keep their piece
+    Move promo(52, 60, Move::Promotion, Queen);
+    tt.store(0x5678, promo, 0, 0, -1, Bound::Exact);
+    CHECK(tt.probe(0x5678, e));
+    CHECK(e.move == promo);
+    CHECK_EQ(e.depth, -1);
+}
+
+void testReplacement() {
+    TranspositionTable tt(1);
+    TTEntry e;
+    Move best(6, 21);
+
+    tt.store(42, best, 100, 0, 10, Bound::Lower);
+    // A shallower non-exact result of the same search doesn't overwrite
+    tt.store(42, Move(1, 18), 50, 0, 4, Bound::Upper);
+    CHECK(tt.probe(42, e));
+    CHECK_EQ(e.depth, 10);
+    CHECK(e.move == best);
+
+    // An exact one does, and without a move of its own it keeps the old one
+    tt.store(42, Move(), 70, 0, 4, Bound::Exact);
+    CHECK(tt.probe(42, e));
+    CHECK_EQ(e.depth, 4);
+    CHECK_EQ(e.score, 70);
+    CHECK(e.move == best);
+
+    // In a later search any result replaces it
+    tt.store(43, best, 100, 0, 12, Bound::Lower);
+    tt.newSearch();
+    tt.store(43, Move(), 10, 0, 2, Bound::Upper);
+    CHECK(tt.probe(43, e));
+    CHECK_EQ(e.depth, 2);
+    CHECK(e.move == best);
+}
+
+void testBucketFill() {
+    TranspositionTable tt(1);
+    TTEntry e;
+    // Keys differing only in their low bits share a bucket
+    const uint64_t base = 0x8000000000000000ull;
+    const int depths[] = {10, 3, 8, 6};
+    for (int i = 0; i < 4; i++) tt.store(base + 1 + i, Move(1, 2), i, 0, depths[i], Bound::Exact);
+    // Every store takes an empty entry while there is one
+    for (int i = 0; i < 4; i++) {
+        CHECK(tt.probe(base + 1 + i, e));
+        CHECK_EQ(e.depth, depths[i]);
+    }
+
+    // A full bucket gives up its shallowest entry
+    tt.store(base + 5, Move(1, 2), 0, 0, 5, Bound::Exact);
+    CHECK(tt.probe(base + 5, e));
+    CHECK(!tt.probe(base + 2, e));
+    CHECK(tt.probe(base + 1, e) && tt.probe(base + 3, e) && tt.probe(base + 4, e));
+
+    // Age counts against depth: after two searches, the shallowest aged
+    // entry goes first, then aged ones lose to a fresh shallow one
+    tt.newSearch();
+    tt.newSearch();
+    tt.store(base + 6, Move(1, 2), 0, 0, 1, Bound::Exact);
+    CHECK(!tt.probe(base + 5, e));
+    tt.store(base + 7, Move(1, 2), 0, 0, 1, Bound::Exact);
+    CHECK(!tt.probe(base + 4, e));
+    CHECK(tt.probe(base + 6, e) && tt.probe(base + 7, e));
+    CHECK(tt.probe(base + 1, e) && tt.probe(base + 3, e));
+
+    // After clear() the bucket fills from empty again
+    tt.clear();
+    for (int i = 0; i < 4; i++) tt.store(base + 10 + i, Move(1, 2), 0, 0, 20 - i, Bound::Lower);
+    for (int i = 0; i < 4; i++) CHECK(tt.probe(base + 10 + i, e));
+}
+
+void testClearAndResize() {
+    TranspositionTable tt(1);
+    for (uint64_t key = 1; key <= 1000; key++) tt.store(key * 0x9e3779b97f4a7c15ull, Move(1, 2), 0, 0, 5, Bound::Exact);
+    CHECK(tt.stats().fillPermille > 0);
+
+    tt.clear();
+    TTEntry e;
+    CHECK(!tt.probe(0x9e3779b97f4a7c15ull, e));
+    CHECK_EQ(tt.stats().fillPermille, 0);
+
+    tt.store(77, Move(1, 2), 0, 0, 5, Bound::Exact);
+    tt.resize(2);
+    CHECK_EQ(tt.sizeMb(), 2u);
+    CHECK(!tt.probe(77, e));
+
+    tt.recordProbes(10, 4);
+    TTStats stats = tt.stats();
+    CHECK_EQ(stats.probes, 10u);
+    CHECK_EQ(stats.hits, 4u);
+}
+
+void testDeferred() {
+    TranspositionTable tt(1);
+    TTEntry e;
+    tt.store(77, Move(1, 2), 0, 0, 5, Bound::Exact);
+
+    // Idle table: applied at once
+    CHECK(tt.requestResize(2));
+    CHECK_EQ(tt.sizeMb(), 2u);
+    CHECK(!tt.probe(77, e));
+
+    // A running search holds the table: requests return without waiting
+    // and take effect when the next search applies them
+    tt.store(77, Move(1, 2), 0, 0, 5, Bound::Exact);
+    {
+        auto guard = tt.searchLock();
+        tt.requestClear();
+        CHECK(tt.probe(77, e));
+        CHECK(tt.requestResize(3));
+        CHECK_EQ(tt.sizeMb(), 2u);
+        CHECK(tt.applyPending());
+        CHECK_EQ(tt.sizeMb(), 2u);
+    }
+    CHECK(tt.applyPending());
+    CHECK_EQ(tt.sizeMb(), 3u);
+    CHECK(!tt.probe(77, e));
+
+    tt.store(78, Move(1, 2), 0, 0, 5, Bound::Exact);
+    {
+        auto guard = tt.searchLock();
+        tt.requestClear();
+    }
+    CHECK(tt.probe(78, e));
+    tt.applyPending();
+    CHECK(!tt.probe(78, e));
+
+    // A reallocation that fails keeps the old table and its entries
+    tt.store(79, Move(1, 2), 0, 0, 5, Bound::Exact);
+    CHECK(!tt.requestResize(size_t(1) << 40));
+    CHECK_EQ(tt.sizeMb(), 3u);
+    CHECK(tt.probe(79, e));
+}
+
+} // namespace
+
+int main() {
+    testRoundTrip();
+    testReplacement();
+    testBucketFill();
+    testClearAndResize();
+    testDeferred();
+    return 0;
+}
@@ -0,0 +1,161 @@
+// Wire format: primitive coding, stream sessions and decode errors.
+
+#include "TestCheck.h"
+#include "WireFormat.h"
+#include <string>
+#include <vector>
+
+using namespace aegis::wire;
+
+namespace {
+
+WireMutation mutation(const std::string& key, const std::string& client, const std::string& payload, int64_t ts) {
+    WireMutation m;
+    m.key = key;
+    m.clientId = client;
+    m.version = 7;
+    m.timestamp = ts;
+    m.payload = reinterpret_cast<const uint8_t*>(payload.data());
+    m.payloadLen = payload.size();
+    return m;
+}
+
+bool same(const WireMutation& a, const WireMutation& b) {
+    return a.key == b.key && a.clientId == b.clientId && a.version == b.version &&
+           a.baseVersion == b.baseVersion && a.timestamp == b.timestamp && a.deleted == b.deleted &&
+           std::string_view(reinterpret_cast<const char*>(a.payload), a.payloadLen) ==
+               std::string_view(reinterpret_cast<const char*>(b.payload), b.payloadLen);
+}
+
+std::vector<uint8_t> encode(WireEncoder& encoder, const std::vector<WireMutation>& items) {
+    std::vector<uint8_t> buf(WireEncoder::maxEncodedSize(items.data(), items.size()));
+    size_t n = encoder.encodeMutations(items.data(), items.size(), buf.data(), buf.size());
+    CHECK(n > 0);
+    buf.resize(n);
+    return buf;
+}
+
+WireStatus decode(WireDecoder& decoder, const std::vector<uint8_t>& frame, std::vector<WireMutation>& out) {
+    WireReader r(frame.data(), frame.size());
+    FrameType type;
+    WireStatus status = readFrameHeader(r, type);
+    if (status != WireStatus::Ok) return status;
+    CHECK(type == FrameType::Mutations);
+    return decoder.decodeMutations(r, out);
+}
+
+void testPrimitives() {
+    const uint64_t values[] = {0, 1, 127, 128, 300, 1ull << 35, UINT64_MAX};
+    const int64_t signedValues[] = {0, -1, 1, -64, 64, INT64_MIN, INT64_MAX};
+    uint8_t buf[256];
+    WireWriter w(buf, sizeof(buf));
+    for (uint64_t v : values) w.varint(v);
+    for (int64_t v : signedValues) w.zigzag(v);
+    w.fixed64(0x0123456789abcdefull);
+    w.str("hello");
+    CHECK(w.ok());
+
+    size_t expected = 8 + 5 + 1;
+    for (uint64_t v : values) expected += varintSize(v);
+    for (int64_t v : signedValues) expected += varintSize((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+    CHECK_EQ(w.size(), expected);
+
+    WireReader r(buf, w.size());
+    for (uint64_t v : values) CHECK(r.varint() == v);
+    for (int64_t v : signedValues) CHECK(r.zigzag() == v);
+    CHECK(r.fixed64() == 0x0123456789abcdefull);
+    CHECK(r.str() == "hello");
+    CHECK(r.ok());
+    CHECK_EQ(r.remaining(), 0u);
+
+    // Reading past the end latches Truncated
+    r.u8();
+    CHECK(r.status() == WireStatus::Truncated);
+
+    // A write that doesn't fit fails without writing past the cap
+    uint8_t small[4];
+    WireWriter ws(small, sizeof(small));
+    ws.str("too long");
+    CHECK(!ws.ok());
+    CHECK(ws.size() <= sizeof(small));
+}
+
+void testStream() {
+    WireSession tx, rx;
+    WireEncoder encoder(tx);
+    WireDecoder decoder(rx);
+
+    const std::string keys[] = {"doc_a", "doc_b", "match_1"};
+    const std::string alice = "alice", bob = "bob";
+    const std::string payload = "payload", empty;
+
+    std::vector<WireMutation> first = {mutation(keys[0], alice, payload, 1000), mutation(keys[1], bob, payload, 900)};
+    first[1].deleted = true;
+    first[1].payloadLen = 0;
+    std::vector<WireMutation> second = {mutation(keys[2], alice, empty, 1001)};
+    second[0].baseVersion = 6;
+
+    auto frame1 = encode(encoder, first);
+    auto frame2 = encode(encoder, second);
+    // Both clients are interned; the second frame refers to alice by index
+    CHECK_EQ(tx.size(), 2u);
+
+    std::vector<WireMutation> out;
+    CHECK(decode(decoder, frame1, out) == WireStatus::Ok);
+    CHECK_EQ(out.size(), first.size());
+    for (size_t i = 0; i < out.size(); i++) CHECK(same(out[i], first[i]));
+    CHECK(decode(decoder, frame2, out) == WireStatus::Ok);
+    CHECK_EQ(out.size(), 1u);
+    CHECK(same(out[0], second[0]));
+    CHECK_EQ(rx.size(), 2u);
+
+    // A decoder that joins mid-stream has no Reset frame to start from
+    WireSession late;
+    WireDecoder lateDecoder(late);
+    CHECK(decode(lateDecoder, frame2, out) == WireStatus::Desync);
+
+    // After an encoder reset the next frame resynchronises it
+    tx.reset();
+    auto frame3 = encode(encoder, second);
+    CHECK(decode(lateDecoder, frame3, out) == WireStatus::Ok);
+    CHECK(same(out[0], second[0]));
+}
+
+void testStandalone() {
+    const std::string key = "doc", client = "carol", payload = "x";
+    std::vector<WireMutation> items = {mutation(key, client, payload, 5), mutation(key, client, payload, 6)};
+    std::vector<uint8_t> buf(WireEncoder::maxEncodedSize(items.data(), items.size()));
+    size_t n = WireEncoder::encodeStandalone(items.data(), items.size(), buf.data(), buf.size());
+    CHECK(n > 0);
+    buf.resize(n);
+
+    // Any fresh decoder takes it, and its session stays untouched
+    WireSession rx;
+    WireDecoder decoder(rx);
+    std::vector<WireMutation> out;
+    CHECK(decode(decoder, buf, out) == WireStatus::Ok);
+    CHECK_EQ(out.size(), 2u);
+    CHECK(same(out[1], items[1]));
+    CHECK_EQ(rx.size(), 0u);
+
+    // Every truncation is rejected, never read past
+    for (size_t len = 0; len < buf.size(); len++) {
+        std::vector<uint8_t> cut(buf.begin(), buf.begin() + len);
+        WireSession s;
+        WireDecoder d(s);
+        CHECK(decode(d, cut, out) != WireStatus::Ok);
+    }
+
+    // Unknown version
+    buf[0] = kWireVersion + 1;
+    CHECK(decode(decoder, buf, out) == WireStatus::BadVersion);
+}
+
+} // namespace
+
+int main() {
+    testPrimitives();
+    testStream();
+    testStandalone();
+    return 0;
+}
@@ -0,0 +1,143 @@
+// Remote-apply throughput benchmark.
+//
+// Built by AEGIS_BUILD_TOOLS: `aegis_bench_remote_apply [keys] [updates] [dir]`.
+//
+// Drives the lean side of remote apply over a keyspace with a mix of newer
+// and stale remote versions, twice: one update at a time (HLC observe, stamp
+// admission, index update each in its own transaction) and as a reconnect
+// burst through RemoteApplyBatcher. Then times the conflict compare alone:
+// packed VersionStamps against the old (timestamp, clientId string) metadata.
+// The core LocalDB write is a no-op here.
+
+#include "HybridClock.h"
+#include "MerkleIndex.h"
+#include "RemoteApplyBatcher.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace aegis;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct LegacyMeta {
+    int64_t timestamp;
+    std::string clientId;
+};
+
+bool legacyNewer(const LegacyMeta& a, const LegacyMeta& b) {
+    if (a.timestamp != b.timestamp) return a.timestamp > b.timestamp;
+    return a.clientId > b.clientId;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t keys = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    size_t updates = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+    std::string dir = argc > 3 ? argv[3] : "/tmp";
+    if (!keys || !updates) {
+        std::fprintf(stderr, "usage: %s [keys] [updates] [dir]\n", argv[0]);
+        return 2;
+    }
+
+    std::string path = dir + "/aegis_bench_remote_apply." + std::to_string(getpid()) + ".db";
+    MerkleIndex index;
+    if (!index.open(path)) return 1;
+
+    HybridClock clock;
+    std::mt19937_64 rng(42);
+    std::vector<std::string> clients = {"bench-local", "peer-a", "peer-b", "peer-c"};
+    std::vector<uint8_t> value(96);
+    for (auto& b : value) b = static_cast<uint8_t>(rng());
+
+    // Seed the keyspace with local versions
+    uint32_t local = index.clientIndex(clients[0]);
+    auto start = Clock::now();
+    for (size_t i = 0; i < keys; i++) {
+        value[0] = static_cast<uint8_t>(i);
+        index.update("doc:" + std::to_string(i), value, VersionStamp{clock.now(), local});
+    }
+    std::printf("seed     %8zu keys     %8.3f s\n", keys, secondsSince(start));
+
+    // Remote burst: every other update is older than what is stored
+    size_t applied = 0, stale = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < updates; i++) {
+        std::string key = "doc:" + std::to_string(rng() % keys);
+        const std::string& client = clients[1 + rng() % 3];
+        uint64_t hlc = (i & 1) ? clock.last() + 1 + (rng() & 0xff) : HybridClock::pack(1, 0);
+        if (!clock.observe(hlc)) continue;
+        VersionStamp stamp{hlc, index.clientIndex(client)};
+        if (!index.admit(key, stamp)) {
+            stale++;
+            continue;
+        }
+        value[1] = static_cast<uint8_t>(i);
+        index.update(key, value, stamp);
+        applied++;
+    }
+    double elapsed = secondsSince(start);
+    std::printf("single   %8zu updates  %8.3f s  %10.0f updates/s  (%zu applied, %zu stale)\n", updates, elapsed,
+                updates / elapsed, applied, stale);
+
+    // Same mix as one burst through the batcher
+    SyncMetrics metrics;
+    size_t notified = 0;
+    RemoteApplyBatcher batcher(
+        index, clock, metrics, [](const std::string&, const std::vector<uint8_t>&, const storage::SyncMetadata&) { return true; },
+        [&notified](const std::string&, const std::vector<uint8_t>&) { notified++; });
+    std::vector<std::pair<std::string, storage::SyncMetadata>> burst(updates);
+    for (size_t i = 0; i < updates; i++) {
+        burst[i].first = "doc:" + std::to_string(rng() % keys);
+        burst[i].second.clientId = clients[1 + rng() % 3];
+        uint64_t hlc = (i & 1) ? clock.last() + 1 + i : HybridClock::pack(1, 0);
+        burst[i].second.timestamp = static_cast<int64_t>(hlc);
+    }
+    start = Clock::now();
+    for (const auto& [key, meta] : burst) batcher.stage(key, value, meta);
+    batcher.flush();
+    elapsed = secondsSince(start);
+    std::printf("batched  %8zu updates  %8.3f s  %10.0f updates/s  (%lu applied, %lu stale, %lu coalesced, %zu notified)\n",
+                updates, elapsed, updates / elapsed, (unsigned long)metrics.remoteApplied.load(),
+                (unsigned long)metrics.remoteStale.load(), (unsigned long)metrics.remoteCoalesced.load(), notified);
+
+    // Conflict compare alone
+    std::vector<VersionStamp> stamps(keys * 2);
+    std::vector<LegacyMeta> metas(keys * 2);
+    for (size_t i = 0; i < stamps.size(); i++) {
+        uint32_t c = 1 + static_cast<uint32_t>(rng() % 3);
+        uint64_t hlc = clock.now();
+        stamps[i] = VersionStamp{hlc, index.clientIndex(clients[c])};
+        metas[i] = LegacyMeta{static_cast<int64_t>(HybridClock::physicalMs(hlc)), clients[c]};
+    }
+    const int rounds = 200;
+    size_t wins = 0;
+    start = Clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < keys; i++) wins += index.newer(stamps[i * 2], stamps[i * 2 + 1]);
+    }
+    double stampTime = secondsSince(start);
+    start = Clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < keys; i++) wins += legacyNewer(metas[i * 2], metas[i * 2 + 1]);
+    }
+    double legacyTime = secondsSince(start);
+    double compares = static_cast<double>(rounds) * keys;
+    std::printf("compare  stamp %6.1f ns  legacy %6.1f ns  (%zu)\n", stampTime * 1e9 / compares,
+                legacyTime * 1e9 / compares, wins);
+
+    index.close();
+    for (const char* suffix : {"", "-wal", "-shm"}) unlink((path + suffix).c_str());
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Opening book probe: lists the book moves of positions and times probes.
+//
+// Built by AEGIS_BUILD_TOOLS:
+//   `aegis_book_probe book.bin [fen ...]`
+//
+// Any standard Polyglot book. Without FENs the start position and a few
+// common openings are probed. Each position is then probed repeatedly to
+// report the cost of one lookup (hashing, binary search and legality
+// matching) once the book pages are resident.
+
+#include "ChessBook.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using namespace aegis::chess;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kTimedProbes = 100000;
+
+const char* const kDefaultPositions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1",
+    "rnbqkbnr/pppppppp/8/8/3P4/8/PPP1PPPP/RNBQKBNR b KQkq d3 0 1",
+    "rnbqkbnr/pp1ppppp/8/2p5/4P3/8/PPPP1PPP/RNBQKBNR w KQkq c6 0 2",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+};
+
+int usage(const char* argv0) {
+    std::fprintf(stderr, "usage: %s book.bin [fen ...]\n", argv0);
+    return 2;
+}
+
+// Prints the book moves of fen and the time of one probe; false on a bad FEN
+bool probe(const OpeningBook& book, const char* fen) {
+    Position pos;
+    if (!pos.setFen(fen)) {
+        std::fprintf(stderr, "bad fen: %s\n", fen);
+        return false;
+    }
+    BookMove moves[OpeningBook::kMaxMoves];
+    int count = book.probe(pos, moves, OpeningBook::kMaxMoves);
+    uint32_t total = 0;
+    for (int i = 0; i < count; i++) total += moves[i].weight;
+
+    auto start = Clock::now();
+    int found = 0;
+    for (int i = 0; i < kTimedProbes; i++) found += book.probe(pos, moves, OpeningBook::kMaxMoves);
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / kTimedProbes;
+
+    std::printf("%s  key %016llx  %d moves  %.0f ns/probe\n", fen,
+                static_cast<unsigned long long>(PolyglotKeys::key(pos)), found / kTimedProbes, ns);
+    for (int i = 0; i < count; i++) {
+        std::printf("  %-6s %5u  %5.1f%%\n", Position::toUci(moves[i].move).c_str(), moves[i].weight,
+                    total ? 100.0 * moves[i].weight / total : 0.0);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) return usage(argv[0]);
+    const char* bookPath = argv[1];
+
+    std::string error;
+    std::shared_ptr<const OpeningBook> book = OpeningBook::open(bookPath, &error);
+    if (!book) {
+        std::fprintf(stderr, "book not opened: %s\n", error.c_str());
+        return 1;
+    }
+    std::printf("%s: %zu entries\n", bookPath, book->entries());
+
+    if (argc == 2) {
+        for (const char* fen : kDefaultPositions) {
+            if (!probe(*book, fen)) return 1;
+        }
+    }
+    for (int i = 2; i < argc; i++) {
+        if (!probe(*book, argv[i])) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,205 @@
+// In-process cluster benchmark: N full Aegis engines in one process.
+//
+// Built by AEGIS_BUILD_TOOLS:
+//   `aegis_cluster_bench [nodes] [games] [moves] [intervalMs] [sim] [dir]`
+//
+// Every engine gets its own database, client id and Unix socket (or, with
+// `sim`, an endpoint on the shared simulated network); engines connect as a
+// full mesh. Each game document "match:<n>" is played by two engines in
+// turn: every round, each game gets one more move written through
+// db().put() by the engine whose turn it is. Payloads carry the write time,
+// so the data-change callbacks on the other engines measure propagation.
+//
+// Reports p50/p99/max move propagation latency, time from the last write
+// until every MerkleIndex root matches, process CPU time and bytes sent.
+
+#include "Aegis.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace aegis;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Game document: [u64 written ns][u8 origin node][u16 moves...]
+constexpr size_t kHeader = 9;
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+double cpuSeconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+struct LatencyLog {
+    std::mutex mutex;
+    std::vector<uint32_t> us;
+};
+
+bool waitFor(const std::function<bool()>& done, std::chrono::milliseconds limit) {
+    auto deadline = Clock::now() + limit;
+    while (!done()) {
+        if (Clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t nodes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+    size_t games = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+    size_t moves = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 40;
+    int intervalMs = argc > 4 ? std::atoi(argv[4]) : 50;
+    bool sim = argc > 5 && std::strcmp(argv[5], "sim") == 0;
+    std::string dir = argc > 6 ? argv[6] : "/tmp";
+    if (nodes < 2 || nodes > 255 || !games || !moves) {
+        std::fprintf(stderr, "usage: %s [nodes 2..255] [games] [moves] [intervalMs] [sim|sock] [dir]\n", argv[0]);
+        return 2;
+    }
+
+    // 1. Engines
+    std::string prefix = dir + "/aegis_cluster_" + std::to_string(getpid()) + "_";
+    std::vector<std::unique_ptr<Aegis>> engines;
+    std::vector<std::string> addresses;
+    LatencyLog latencies;
+    for (size_t i = 0; i < nodes; i++) {
+        AegisConfig config;
+        config.clientId = "node" + std::to_string(i);
+        config.dbPath = prefix + config.clientId + ".db";
+        config.port = 0;
+        if (sim) {
+            config.netSim.enabled = true;
+            config.netSim.link.latencyModel = LatencyModel::Normal;
+            config.netSim.link.latencyMs = 15;
+            config.netSim.link.jitterMs = 5;
+            addresses.push_back("sim:" + config.clientId);
+        } else {
+            config.unixSocketPath = prefix + config.clientId + ".sock";
+            addresses.push_back("unix:" + config.unixSocketPath);
+        }
+
+        auto engine = std::make_unique<Aegis>();
+        if (!engine->init(config)) {
+            std::fprintf(stderr, "cluster_bench: init failed for %s\n", config.clientId.c_str());
+            return 1;
+        }
+        auto self = static_cast<uint8_t>(i);
+        engine->setOnDataChange([self, &latencies](const std::string& key, const std::vector<uint8_t>& data) {
+            if (key.compare(0, 6, "match:") != 0 || data.size() < kHeader || data[8] == self) return;
+            int64_t written = 0;
+            std::memcpy(&written, data.data(), sizeof(written));
+            auto us = static_cast<uint32_t>(std::max<int64_t>(0, (nowNs() - written) / 1000));
+            std::lock_guard<std::mutex> lock(latencies.mutex);
+            latencies.us.push_back(us);
+        });
+        engine->startNetwork();
+        engines.push_back(std::move(engine));
+    }
+
+    // 2. Full mesh
+    for (size_t i = 0; i < nodes; i++) {
+        for (size_t j = i + 1; j < nodes; j++) engines[i]->connectToPeer(addresses[j], 0);
+    }
+    bool meshed = waitFor([&] {
+        for (auto& engine : engines) {
+            if (engine->getConnectedPeersCount() < static_cast<int>(nodes - 1)) return false;
+        }
+        return true;
+    }, std::chrono::seconds(10));
+    if (!meshed) {
+        std::fprintf(stderr, "cluster_bench: mesh did not form\n");
+        return 1;
+    }
+
+    // 3. Workload: one move per game per round, alternating between its two players
+    std::mt19937 rng(1234);
+    std::vector<std::vector<uint16_t>> lines(games);
+    double cpuStart = cpuSeconds();
+    auto started = Clock::now();
+    for (size_t round = 0; round < moves; round++) {
+        auto roundStart = Clock::now();
+        for (size_t g = 0; g < games; g++) {
+            size_t player = (g + round % 2) % nodes;
+            uint16_t move = static_cast<uint16_t>((rng() % 64) | ((rng() % 64) << 6));
+            lines[g].push_back(move);
+
+            std::vector<uint8_t> doc(kHeader + lines[g].size() * 2);
+            int64_t written = nowNs();
+            std::memcpy(doc.data(), &written, sizeof(written));
+            doc[8] = static_cast<uint8_t>(player);
+            std::memcpy(doc.data() + kHeader, lines[g].data(), lines[g].size() * 2);
+            engines[player]->db().put("match:" + std::to_string(g), doc);
+        }
+        std::this_thread::sleep_until(roundStart + std::chrono::milliseconds(intervalMs));
+    }
+    auto lastWrite = Clock::now();
+
+    // 4. Convergence: every replica summarises the same document set
+    bool converged = waitFor([&] {
+        auto root = engines[0]->merkleIndex().root();
+        if (root.count < games) return false;
+        for (auto& engine : engines) {
+            if (engine->merkleIndex().root() != root) return false;
+        }
+        return true;
+    }, std::chrono::seconds(60));
+    auto convergedAt = Clock::now();
+    double cpu = cpuSeconds() - cpuStart;
+
+    // 5. Report
+    std::vector<uint32_t> us;
+    {
+        std::lock_guard<std::mutex> lock(latencies.mutex);
+        us = latencies.us;
+    }
+    std::sort(us.begin(), us.end());
+    auto pct = [&us](double p) { return us.empty() ? 0.0 : us[std::min(us.size() - 1, size_t(p * us.size()))] / 1000.0; };
+    uint64_t bytes = 0, frames = 0;
+    for (auto& engine : engines) {
+        bytes += engine->metrics().bytesSent;
+        frames += engine->metrics().wireFrames;
+    }
+    double wall = std::chrono::duration<double>(convergedAt - started).count();
+    size_t written = games * moves;
+
+    std::printf("%zu engines (%s), %zu games x %zu moves, %d ms rounds\n", nodes, sim ? "simulated links" : "unix sockets",
+                games, moves, intervalMs);
+    std::printf("moves written      %zu (%.0f/s)\n", written,
+                written / std::chrono::duration<double>(lastWrite - started).count());
+    std::printf("updates observed   %zu\n", us.size());
+    std::printf("propagation        p50 %.2f ms  p99 %.2f ms  max %.2f ms\n", pct(0.50), pct(0.99),
+                us.empty() ? 0.0 : us.back() / 1000.0);
+    std::printf("convergence        %s, %.1f ms after the last write\n", converged ? "yes" : "NO",
+                std::chrono::duration<double, std::milli>(convergedAt - lastWrite).count());
+    std::printf("cpu                %.2f s over %.2f s wall (%.0f%%)\n", cpu, wall, 100.0 * cpu / wall);
+    std::printf("wire               %lu bytes sent, %lu mutation frames, %.1f bytes/move/peer\n", (unsigned long)bytes,
+                (unsigned long)frames, static_cast<double>(bytes) / written / (nodes - 1));
+
+    engines.clear();
+    for (size_t i = 0; i < nodes; i++) {
+        std::string base = prefix + "node" + std::to_string(i);
+        for (const char* suffix : {".db", ".db-wal", ".db-shm", ".db.log", ".db.log-wal", ".db.log-shm", ".sock"}) {
+            unlink((base + suffix).c_str());
+        }
+    }
+    return converged ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+// Evaluation benchmark: PST vs NNUE, full refresh vs incremental updates.
+//
+// Built by AEGIS_BUILD_TOOLS:
+//   `aegis_eval_bench [-n network]`             time a network file
+//   `aegis_eval_bench [-N hidden] [-o out]`     time a random network (and save it)
+//
+// Each timed step is make move, evaluate, unmake over every legal move of
+// a set of positions, so the numbers compare what the search pays per
+// node. Before timing, random games check that the incrementally updated
+// accumulators evaluate exactly like a refresh from scratch; the exit
+// status is 1 on any mismatch. A random network says nothing about
+// playing strength, only about speed and the update logic.
+
+#include "ChessEval.h"
+#include "ChessMoveGen.h"
+#include "ChessNnue.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+using namespace aegis::chess;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const kPositions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+};
+
+int usage(const char* argv0) {
+    std::fprintf(stderr, "usage: %s [-n network] [-N hidden] [-o out] [-i iterations]\n", argv0);
+    return 2;
+}
+
+template <typename T>
+void append(std::vector<uint8_t>& out, T value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+std::vector<uint8_t> randomNetworkBytes(int hidden) {
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> feature(-24, 24);
+    std::uniform_int_distribution<int> output(-64, 64);
+    std::vector<uint8_t> bytes;
+    bytes.insert(bytes.end(), "AEGISNN1", "AEGISNN1" + 8);
+    append<uint32_t>(bytes, static_cast<uint32_t>(hidden));
+    append<int32_t>(bytes, 400);
+    for (int i = 0; i < hidden; i++) append<int16_t>(bytes, static_cast<int16_t>(feature(rng) + 32));
+    for (int i = 0; i < Network::kInputs * hidden; i++) append<int16_t>(bytes, static_cast<int16_t>(feature(rng)));
+    for (int i = 0; i < 2 * hidden; i++) append<int8_t>(bytes, static_cast<int8_t>(output(rng)));
+    append<int32_t>(bytes, 0);
+    return bytes;
+}
+
+// Random games from every position, comparing incremental and refreshed
+// evaluations after each move (including null moves)
+int checkIncremental(const std::shared_ptr<const Network>& network) {
+    std::mt19937 rng(7);
+    NnueAccumulators incremental(network, 64);
+    NnueAccumulators fresh(network, 0);
+    int mismatches = 0, checked = 0;
+    for (const char* fen : kPositions) {
+        for (int game = 0; game < 50; game++) {
+            Position pos;
+            pos.setFen(fen);
+            incremental.refresh(pos);
+            Undo undo[64];
+            Move played[64];
+            int ply = 0;
+            for (; ply < 64; ply++) {
+                MoveList list;
+                generateLegal(pos, list);
+                bool null = !pos.inCheck() && rng() % 16 == 0;
+                if (list.size == 0) break;
+                if (null) {
+                    incremental.pushNull();
+                    pos.doNullMove(undo[ply]);
+                    played[ply] = Move();
+                } else {
+                    Move m = list.moves[rng() % list.size];
+                    incremental.push(pos, m);
+                    pos.doMove(m, undo[ply]);
+                    played[ply] = m;
+                }
+                fresh.refresh(pos);
+                checked++;
+                if (incremental.evaluate(pos.sideToMove()) != fresh.evaluate(pos.sideToMove())) {
+                    if (mismatches++ < 5) std::fprintf(stderr, "mismatch after %d plies at %s\n", ply + 1, pos.fen().c_str());
+                }
+            }
+            // Unwinding must land on the refreshed root again
+            while (ply-- > 0) {
+                if (played[ply].isNone()) pos.undoNullMove(undo[ply]);
+                else pos.undoMove(played[ply], undo[ply]);
+                incremental.pop();
+            }
+            fresh.refresh(pos);
+            if (incremental.evaluate(pos.sideToMove()) != fresh.evaluate(pos.sideToMove())) mismatches++;
+        }
+    }
+    std::printf("incremental vs refresh: %d positions, %d mismatches\n", checked, mismatches);
+    return mismatches;
+}
+
+struct Timing {
+    uint64_t evals = 0;
+    double seconds = 0;
+    int64_t checksum = 0;
+};
+
+template <typename Step>
+Timing timeSteps(int iterations, Step&& step) {
+    Timing timing;
+    auto start = Clock::now();
+    for (int it = 0; it < iterations; it++) {
+        for (const char* fen : kPositions) {
+            Position pos;
+            pos.setFen(fen);
+            MoveList list;
+            generateLegal(pos, list);
+            timing.checksum += step(pos, list);
+            timing.evals += list.size;
+        }
+    }
+    timing.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return timing;
+}
+
+void report(const char* name, const Timing& timing, double baseline) {
+    double rate = timing.evals / timing.seconds;
+    std::printf("%-22s %10.2f Mevals/s  %6.1f ns/eval  %5.2fx  (checksum %lld)\n", name, rate / 1e6,
+                1e9 / rate, baseline > 0 ? rate / baseline : 1.0, static_cast<long long>(timing.checksum));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* networkPath = nullptr;
+    const char* outPath = nullptr;
+    int hidden = 256;
+    int iterations = 20000;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-n") && i + 1 < argc) networkPath = argv[++i];
+        else if (!std::strcmp(argv[i], "-N") && i + 1 < argc) hidden = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-o") && i + 1 < argc) outPath = argv[++i];
+        else if (!std::strcmp(argv[i], "-i") && i + 1 < argc) iterations = std::atoi(argv[++i]);
+        else return usage(argv[0]);
+    }
+
+    std::shared_ptr<const Network> network;
+    std::string error;
+    if (networkPath) {
+        network = Network::load(networkPath, &error);
+    } else {
+        std::vector<uint8_t> bytes = randomNetworkBytes(hidden);
+        if (outPath) {
+            std::ofstream out(outPath, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!out) {
+                std::fprintf(stderr, "cannot write %s\n", outPath);
+                return 1;
+            }
+        }
+        network = Network::fromBytes(std::move(bytes), &error);
+    }
+    if (!network) {
+        std::fprintf(stderr, "network not loaded: %s\n", error.c_str());
+        return 1;
+    }
+    std::printf("network: %s, hidden %d, kernel %s\n", networkPath ? networkPath : "random", network->hidden(),
+                nnueKernelName());
+
+    if (checkIncremental(network) != 0) return 1;
+
+    Timing pst = timeSteps(iterations, [](Position& pos, const MoveList& list) {
+        int64_t sum = 0;
+        for (int i = 0; i < list.size; i++) {
+            Undo undo;
+            pos.doMove(list.moves[i], undo);
+            sum += evaluate(pos);
+            pos.undoMove(list.moves[i], undo);
+        }
+        return sum;
+    });
+
+    NnueAccumulators accumulators(network, 8);
+    Timing refresh = timeSteps(iterations / 10, [&](Position& pos, const MoveList& list) {
+        int64_t sum = 0;
+        for (int i = 0; i < list.size; i++) {
+            Undo undo;
+            pos.doMove(list.moves[i], undo);
+            accumulators.refresh(pos);
+            sum += accumulators.evaluate(pos.sideToMove());
+            pos.undoMove(list.moves[i], undo);
+        }
+        return sum;
+    });
+
+    Timing incremental = timeSteps(iterations, [&](Position& pos, const MoveList& list) {
+        accumulators.refresh(pos);
+        int64_t sum = 0;
+        for (int i = 0; i < list.size; i++) {
+            Undo undo;
+            accumulators.push(pos, list.moves[i]);
+            pos.doMove(list.moves[i], undo);
+            sum += accumulators.evaluate(pos.sideToMove());
+            pos.undoMove(list.moves[i], undo);
+            accumulators.pop();
+        }
+        return sum;
+    });
+
+    double base = pst.evals / pst.seconds;
+    report("pst", pst, base);
+    report("nnue full refresh", refresh, base);
+    report("nnue incremental", incremental, base);
+    return 0;
+}
@@ -0,0 +1,179 @@
+// Fuzz harness for the peer wire format (WireFormat.h).
+//
+// libFuzzer:  clang++ -fsanitize=fuzzer,address -I.. fuzz_wire.cpp ../WireFormat.cpp
+// Standalone: built by AEGIS_BUILD_TOOLS; runs seeded random round trips and
+//             mutated-frame decoding, e.g. `aegis_fuzz_wire 200000`.
+//
+// Invariants checked:
+//  - decoding arbitrary bytes never reads out of bounds and never crashes
+//  - anything that decodes re-encodes and decodes to the same mutations
+//  - encode -> decode round trips across a multi-frame stream are exact
+
+#include "WireFormat.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace aegis::wire;
+
+namespace {
+
+[[noreturn]] void fail(const char* what) {
+    std::fprintf(stderr, "fuzz_wire: %s\n", what);
+    std::abort();
+}
+
+bool sameMutation(const WireMutation& a, const WireMutation& b) {
+    return a.key == b.key && a.clientId == b.clientId && a.version == b.version &&
+           a.baseVersion == b.baseVersion && a.timestamp == b.timestamp && a.deleted == b.deleted &&
+           std::string_view(reinterpret_cast<const char*>(a.payload), a.payloadLen) ==
+               std::string_view(reinterpret_cast<const char*>(b.payload), b.payloadLen);
+}
+
+// Re-encode whatever decoded and check it survives a second trip
+void checkRoundTrip(const std::vector<WireMutation>& items) {
+    WireSession tx, rx;
+    WireEncoder encoder(tx);
+    std::vector<uint8_t> buf(WireEncoder::maxEncodedSize(items.data(), items.size()));
+    size_t n = encoder.encodeMutations(items.data(), items.size(), buf.data(), buf.size());
+    if (n == 0) fail("re-encode of decoded frame failed");
+
+    WireReader r(buf.data(), n);
+    FrameType type;
+    if (readFrameHeader(r, type) != WireStatus::Ok || type != FrameType::Mutations) fail("bad re-encoded header");
+    std::vector<WireMutation> again;
+    WireDecoder decoder(rx);
+    if (decoder.decodeMutations(r, again) != WireStatus::Ok) fail("re-encoded frame does not decode");
+    if (again.size() != items.size()) fail("round trip count mismatch");
+    for (size_t i = 0; i < items.size(); i++) {
+        if (!sameMutation(items[i], again[i])) fail("round trip mismatch");
+    }
+}
+
+// First byte splits the input into two frames decoded on one session, so
+// interning and timestamp state carried between frames gets exercised.
+void decodeStream(const uint8_t* data, size_t size) {
+    if (size == 0) return;
+    size_t split = size > 1 ? 1 + data[0] % size : 1;
+    WireSession rx;
+    WireDecoder decoder(rx);
+    std::vector<WireMutation> out;
+    const uint8_t* frames[2] = {data + 1, data + split};
+    size_t lens[2] = {split - 1, size - split};
+    for (int f = 0; f < 2; f++) {
+        WireReader r(frames[f], lens[f]);
+        FrameType type;
+        if (readFrameHeader(r, type) != WireStatus::Ok || type != FrameType::Mutations) continue;
+        if (decoder.decodeMutations(r, out) == WireStatus::Ok) checkRoundTrip(out);
+    }
+}
+
+std::string randomString(std::mt19937_64& rng, size_t maxLen) {
+    std::string s(rng() % (maxLen + 1), '\0');
+    for (auto& c : s) c = static_cast<char>(rng());
+    return s;
+}
+
+// Structured stream: random batches through one encoder/decoder pair
+void roundTripStream(std::mt19937_64& rng, std::vector<std::vector<uint8_t>>& corpus) {
+    WireSession tx, rx;
+    WireEncoder encoder(tx);
+    WireDecoder decoder(rx);
+
+    std::vector<std::string> clients;
+    for (int i = 0; i < 1 + static_cast<int>(rng() % 6); i++) clients.push_back(randomString(rng, 24));
+
+    int64_t ts = static_cast<int64_t>(rng() % 2000000000000LL);
+    for (int frame = 0; frame < 4; frame++) {
+        size_t count = rng() % 12;
+        std::vector<std::string> keys(count), payloads(count);
+        std::vector<WireMutation> items(count);
+        for (size_t i = 0; i < count; i++) {
+            keys[i] = randomString(rng, 40);
+            payloads[i] = randomString(rng, 64);
+            auto& m = items[i];
+            m.key = keys[i];
+            m.clientId = clients[rng() % clients.size()];
+            m.version = rng() >> (rng() % 64);
+            m.baseVersion = rng() % 3 ? 0 : 1 + (rng() >> (rng() % 63 + 1));
+            ts += static_cast<int64_t>(rng() % 100000) - 20000;
+            m.timestamp = rng() % 50 ? ts : static_cast<int64_t>(rng());
+            m.deleted = rng() % 10 == 0;
+            m.payload = reinterpret_cast<const uint8_t*>(payloads[i].data());
+            m.payloadLen = payloads[i].size();
+        }
+
+        std::vector<uint8_t> buf(WireEncoder::maxEncodedSize(items.data(), items.size()));
+        size_t n = 0;
+        if (rng() % 4 == 0) {
+            // Broadcast frame: must decode without disturbing the stream
+            n = WireEncoder::encodeStandalone(items.data(), items.size(), buf.data(), buf.size());
+            if (n == 0) fail("standalone encode failed");
+        } else if (count && rng() % 8 == 0) {
+            // Short buffer: either fits or fails cleanly, leaving the session
+            // usable for the retry
+            size_t shortCap = rng() % buf.size();
+            n = encoder.encodeMutations(items.data(), items.size(), buf.data(), shortCap);
+            if (n > shortCap) fail("wrote past the cap");
+        }
+        if (n == 0) n = encoder.encodeMutations(items.data(), items.size(), buf.data(), buf.size());
+        if (n == 0) fail("encode failed");
+        buf.resize(n);
+
+        WireReader r(buf.data(), buf.size());
+        FrameType type;
+        if (readFrameHeader(r, type) != WireStatus::Ok) fail("header");
+        std::vector<WireMutation> out;
+        if (decoder.decodeMutations(r, out) != WireStatus::Ok) fail("decode of encoded frame failed");
+        if (out.size() != items.size()) fail("count mismatch");
+        for (size_t i = 0; i < count; i++) {
+            if (!sameMutation(items[i], out[i])) fail("stream round trip mismatch");
+        }
+        if (corpus.size() < 256) corpus.push_back(buf);
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    decodeStream(data, size);
+    return 0;
+}
+
+#ifndef AEGIS_LIBFUZZER
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? std::atol(argv[1]) : 100000;
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0xae915;
+    std::mt19937_64 rng(seed);
+    std::vector<std::vector<uint8_t>> corpus;
+
+    for (long i = 0; i < iterations; i++) {
+        if (i % 4 == 0 || corpus.empty()) {
+            roundTripStream(rng, corpus);
+            continue;
+        }
+        // Mutate a valid frame: bit flips, truncation, splices. Byte 0 picks
+        // where decodeStream splits; sizing the buffer up front keeps the
+        // copy bound visible to GCC's -Warray-bounds
+        const auto& base = corpus[rng() % corpus.size()];
+        std::vector<uint8_t> input(base.size() + 1);
+        input[0] = static_cast<uint8_t>(rng());
+        std::copy(base.begin(), base.end(), input.begin() + 1);
+        for (int k = 0, edits = 1 + static_cast<int>(rng() % 4); k < edits && input.size() > 1; k++) {
+            size_t pos = 1 + rng() % (input.size() - 1);
+            switch (rng() % 4) {
+                case 0: input[pos] ^= static_cast<uint8_t>(1u << (rng() % 8)); break;
+                case 1: input.resize(pos); break;
+                case 2: input[pos] = static_cast<uint8_t>(rng()); break;
+                case 3: input.insert(input.begin() + static_cast<std::ptrdiff_t>(pos), static_cast<uint8_t>(rng())); break;
+            }
+        }
+        decodeStream(input.data(), input.size());
+    }
+    std::printf("fuzz_wire: %ld iterations OK (seed %llu)\n", iterations, static_cast<unsigned long long>(seed));
+    return 0;
+}
+#endif
@@ -0,0 +1,151 @@
+// Perft: move generator correctness oracle and nodes-per-second benchmark.
+//
+// Built by AEGIS_BUILD_TOOLS:
+//   `aegis_perft [-t threads] [-H hashMb] [-d] depth [fen]`   count (or divide) one position
+//   `aegis_perft [-t threads] [-H hashMb] --suite [extraDepth]` check the reference set
+//
+// The suite runs positions with published node counts (start position,
+// Kiwipete, the chessprogramming.org test positions and the en passant,
+// castling and promotion edge cases) and exits non-zero on any mismatch,
+// so it can gate CI. extraDepth adds plies to every entry for a longer
+// benchmark run.
+
+#include "ChessPerft.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace aegis::chess;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Reference {
+    const char* fen;
+    int depth;
+    uint64_t nodes[8]; // nodes[d - 1] for depth d; 0 = unknown
+};
+
+const Reference kSuite[] = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5,
+     {20, 400, 8902, 197281, 4865609, 119060324, 3195901860ULL, 0}},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4,
+     {48, 2039, 97862, 4085603, 193690690, 8031647685ULL, 0, 0}},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, {14, 191, 2812, 43238, 674624, 11030083, 178633661, 0}},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5,
+     {6, 264, 9467, 422333, 15833292, 706045033, 0, 0}},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, {44, 1486, 62379, 2103487, 89941194, 0, 0, 0}},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4,
+     {46, 2079, 89890, 3894594, 164075551, 0, 0, 0}},
+    // Edge cases: illegal en passant, en passant giving check, castling
+    // into check, promotion out of and into check, stalemate traps
+    {"3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, {0, 0, 0, 0, 0, 1134888, 0, 0}},
+    {"8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, {0, 0, 0, 0, 0, 1015133, 0, 0}},
+    {"8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, {0, 0, 0, 0, 0, 1440467, 0, 0}},
+    {"5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, {0, 0, 0, 0, 0, 661072, 0, 0}},
+    {"3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, {0, 0, 0, 0, 0, 803711, 0, 0}},
+    {"r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, {0, 0, 0, 1274206, 0, 0, 0, 0}},
+    {"r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, {0, 0, 0, 1720476, 0, 0, 0, 0}},
+    {"2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, {0, 0, 0, 0, 0, 3821001, 0, 0}},
+    {"8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, {0, 0, 0, 0, 1004658, 0, 0, 0}},
+    {"4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, {0, 0, 0, 0, 0, 217342, 0, 0}},
+    {"8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, {0, 0, 0, 0, 0, 92683, 0, 0}},
+    {"K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, {0, 0, 0, 0, 0, 2217, 0, 0}},
+    {"8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, {0, 0, 0, 0, 0, 0, 567584, 0}},
+    {"8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, {0, 0, 0, 23527, 0, 0, 0, 0}},
+};
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int usage(const char* argv0) {
+    std::fprintf(stderr, "usage: %s [-t threads] [-H hashMb] [-d] depth [fen]\n", argv0);
+    std::fprintf(stderr, "       %s [-t threads] [-H hashMb] --suite [extraDepth]\n", argv0);
+    return 2;
+}
+
+int runSuite(const PerftOptions& options, int extra) {
+    int failures = 0;
+    uint64_t totalNodes = 0;
+    double totalTime = 0;
+    for (const auto& ref : kSuite) {
+        // Deepest known count at or below depth + extra
+        int depth = std::min(ref.depth + extra, 8);
+        while (depth > 0 && ref.nodes[depth - 1] == 0) depth--;
+        if (depth == 0) continue;
+
+        Position pos;
+        if (!pos.setFen(ref.fen)) {
+            std::printf("FAIL  bad fen  %s\n", ref.fen);
+            failures++;
+            continue;
+        }
+        auto start = Clock::now();
+        uint64_t nodes = perftParallel(pos, depth, options);
+        double elapsed = secondsSince(start);
+        totalNodes += nodes;
+        totalTime += elapsed;
+
+        bool ok = nodes == ref.nodes[depth - 1];
+        failures += !ok;
+        std::printf("%s  d%d %12llu", ok ? "ok  " : "FAIL", depth, static_cast<unsigned long long>(nodes));
+        if (!ok) std::printf(" (expected %llu)", static_cast<unsigned long long>(ref.nodes[depth - 1]));
+        std::printf("  %7.3f s  %s\n", elapsed, ref.fen);
+    }
+    std::printf("%s: %llu nodes in %.3f s, %.1f Mnps\n", failures ? "FAILED" : "passed",
+                static_cast<unsigned long long>(totalNodes), totalTime, totalNodes / totalTime / 1e6);
+    return failures ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    PerftOptions options;
+    options.threads = 0;
+    bool divide = false, suite = false;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-t") && i + 1 < argc) options.threads = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-H") && i + 1 < argc) options.hashMb = std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "-d")) divide = true;
+        else if (!std::strcmp(argv[i], "--suite")) suite = true;
+        else args.push_back(argv[i]);
+    }
+
+    if (suite) return runSuite(options, args.empty() ? 0 : std::atoi(args[0].c_str()));
+    if (args.empty()) return usage(argv[0]);
+
+    int depth = std::atoi(args[0].c_str());
+    std::string fen = Position::kStartFen;
+    if (args.size() > 1) {
+        fen.clear();
+        for (size_t i = 1; i < args.size(); i++) fen += (i > 1 ? " " : "") + args[i];
+    }
+    Position pos;
+    if (depth < 1 || !pos.setFen(fen)) return usage(argv[0]);
+
+    auto start = Clock::now();
+    uint64_t total = 0;
+    if (divide) {
+        auto entries = perftDivide(pos, depth, options);
+        std::sort(entries.begin(), entries.end(),
+                  [](const DivideEntry& a, const DivideEntry& b) { return Position::toUci(a.move) < Position::toUci(b.move); });
+        for (const auto& entry : entries) {
+            std::printf("%s: %llu\n", Position::toUci(entry.move).c_str(), static_cast<unsigned long long>(entry.nodes));
+            total += entry.nodes;
+        }
+        std::printf("\n");
+    } else {
+        total = perftParallel(pos, depth, options);
+    }
+    double elapsed = secondsSince(start);
+    std::printf("nodes %llu  time %.3f s  %.1f Mnps\n", static_cast<unsigned long long>(total), elapsed,
+                total / elapsed / 1e6);
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Search benchmark: fixed positions searched to a fixed depth.
+//
+// Built by AEGIS_BUILD_TOOLS:
+//   `aegis_search_bench [-t threads] [-d depth] [-H hashMb]`       fixed depth
+//   `aegis_search_bench [-t maxThreads] [-H hashMb] --scaling [ms]` lazy SMP scaling
+//   `-n network` evaluates with an NNUE network file instead of the PST
+//
+// Every position starts from a cleared search, so with one thread the
+// total node count is deterministic for a given build and acts as a
+// signature: a change that should not alter the search (a speedup) must
+// keep it, while NPS shows the speed. Positions cover the opening, sharp
+// middlegames and endgames.
+//
+// --scaling gives every position a fixed time (default 1000 ms) with 1, 2,
+// 4 ... maxThreads threads (default 8) and reports the average depth
+// reached and the NPS per thread count.
+
+#include "ChessNnue.h"
+#include "ChessSearch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace aegis::chess;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const kPositions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "2rq1rk1/pp1bppbp/2np1np1/8/3NP3/1BN1BP2/PPPQ2PP/2KR3R b - - 0 11",
+    "r1bq1rk1/pp2nppp/2n1p3/3pP3/1b1P4/2NB1N2/PP3PPP/R1BQK2R w KQ - 0 9",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    "8/5pk1/6p1/7p/3R3P/6P1/5PK1/1r6 b - - 0 40",
+    "4r1k1/1p3ppp/p1p5/3b4/3P4/2PB1q2/PP3P1P/R2Q1RK1 w - - 0 20",
+};
+
+int usage(const char* argv0) {
+    std::fprintf(stderr, "usage: %s [-t threads] [-d depth] [-H hashMb] [-n network]\n", argv0);
+    std::fprintf(stderr, "       %s [-t maxThreads] [-H hashMb] [-n network] --scaling [ms]\n", argv0);
+    return 2;
+}
+
+int runScaling(size_t hashMb, int maxThreads, int moveTimeMs) {
+    SearchLimits limits;
+    limits.moveTimeMs = moveTimeMs;
+    std::atomic<bool> stop{false};
+    double baseNps = 0;
+    std::printf("threads  avg depth  total nodes       knps  speedup\n");
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        TranspositionTable tt(hashMb);
+        Search search(tt, threads);
+        uint64_t nodes = 0;
+        double seconds = 0;
+        int depthSum = 0;
+        for (const char* fen : kPositions) {
+            Position pos;
+            pos.setFen(fen);
+            tt.clear();
+            search.newGame();
+            auto start = Clock::now();
+            SearchResult result = search.run(pos, {}, limits, stop);
+            seconds += std::chrono::duration<double>(Clock::now() - start).count();
+            nodes += result.nodes;
+            depthSum += result.depth;
+        }
+        double nps = nodes / seconds;
+        if (threads == 1) baseNps = nps;
+        std::printf("%7d  %9.2f  %11llu  %9.0f  %6.2fx\n", threads,
+                    static_cast<double>(depthSum) / (sizeof(kPositions) / sizeof(kPositions[0])),
+                    static_cast<unsigned long long>(nodes), nps / 1e3, nps / baseNps);
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int depth = 12;
+    int threads = 0;
+    size_t hashMb = 16;
+    bool scaling = false;
+    int scalingMs = 1000;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-d") && i + 1 < argc) depth = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-t") && i + 1 < argc) threads = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-H") && i + 1 < argc) hashMb = std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "-n") && i + 1 < argc) {
+            std::string error;
+            std::shared_ptr<const Network> network = Network::load(argv[++i], &error);
+            if (!network) {
+                std::fprintf(stderr, "network not loaded: %s\n", error.c_str());
+                return 1;
+            }
+            setCurrentNetwork(std::move(network));
+        }
+        else if (!std::strcmp(argv[i], "--scaling")) {
+            scaling = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') scalingMs = std::atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (scaling) return runScaling(hashMb, threads > 0 ? threads : 8, scalingMs);
+
+    TranspositionTable tt(hashMb);
+    Search search(tt, threads > 0 ? threads : 1);
+    std::atomic<bool> stop{false};
+    SearchLimits limits;
+    limits.depth = depth;
+
+    uint64_t totalNodes = 0;
+    double totalTime = 0;
+    for (const char* fen : kPositions) {
+        Position pos;
+        if (!pos.setFen(fen)) {
+            std::fprintf(stderr, "bad fen: %s\n", fen);
+            return 1;
+        }
+        tt.clear();
+        search.newGame();
+        auto start = Clock::now();
+        SearchResult result = search.run(pos, {}, limits, stop);
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        totalNodes += result.nodes;
+        totalTime += elapsed;
+        std::printf("%-6s %6d  %10llu  %7.3f s  %6.0f knps  %s\n", Position::toUci(result.best).c_str(),
+                    result.score, static_cast<unsigned long long>(result.nodes), elapsed,
+                    result.nodes / elapsed / 1e3, fen);
+    }
+    TTStats table = tt.stats();
+    std::printf("hash %zu MB: %.1f%% hits of %llu probes, last position filled %d permille\n", table.sizeMb,
+                table.probes ? 100.0 * table.hits / table.probes : 0.0, static_cast<unsigned long long>(table.probes),
+                table.fillPermille);
+    std::printf("bench depth %d, %d threads: %llu nodes in %.3f s, %.0f knps\n", depth, search.threads(),
+                static_cast<unsigned long long>(totalNodes), totalTime, totalNodes / totalTime / 1e3);
+    return 0;
+}
@@ -0,0 +1,242 @@
+// Sync convergence benchmark on the simulated network (NetworkSim.h).
+//
+// Built by AEGIS_BUILD_TOOLS:
+//   `aegis_sim_sync [nodes] [writesPerNode] [seed] [dir]`
+//
+// Every scenario starts a full mesh of PeerSync nodes (DeltaSync, AppendLog,
+// MerkleIndex and an in-memory store each) on a fresh SimNetwork, has every
+// node write writesPerNode updates to a shared keyspace at random virtual
+// times, and runs until all MerkleIndex roots match. Nodes run anti-entropy
+// every second, as the app does on aegis_flutter_trigger_sync. Links are
+// reliable (loss shows up as retransmission delay), like the socket
+// transport PeerSync is built for. Everything runs on this thread in
+// virtual time, so a given seed always prints the same numbers.
+
+#include "AppendLog.h"
+#include "DeltaSync.h"
+#include "HybridClock.h"
+#include "MerkleIndex.h"
+#include "NetworkSim.h"
+#include "PeerSync.h"
+#include "SimTransport.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace aegis;
+
+namespace {
+
+constexpr int64_t kMs = 1000;
+constexpr int64_t kWriteWindowUs = 2000 * kMs;   // writes spread over the first 2 s
+constexpr int64_t kAntiEntropyUs = 1000 * kMs;
+constexpr int64_t kLimitUs = 120000 * kMs;       // give up after 2 virtual minutes
+constexpr size_t kKeys = 64;
+
+struct Scenario {
+    const char* name;
+    LinkProfile link;
+    bool partition = false; // split the mesh in half for the write window
+};
+
+struct Node {
+    std::string id;
+    SyncMetrics metrics;
+    DeltaSync delta{metrics};
+    AppendLog log;
+    MerkleIndex index;
+    std::map<std::string, std::vector<uint8_t>> store;
+    std::shared_ptr<SimTransport> transport;
+    std::shared_ptr<PeerSync> peers;
+    uint64_t lastHlc = 0;
+    std::vector<std::string> paths;
+
+    ~Node() {
+        if (transport) transport->stop();
+        index.close();
+        log.close();
+        for (const auto& path : paths) unlink(path.c_str());
+    }
+};
+
+// Scenario-local RNG so write schedules do not depend on the network's draws
+uint64_t nextRandom(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void localWrite(Node& node, SimNetwork& net, const std::string& key, std::vector<uint8_t> value) {
+    // Virtual-time HLC, so stamps are reproducible too
+    node.lastHlc = std::max(node.lastHlc + 1, HybridClock::pack(net.nowUs() / kMs, 0));
+    storage::SyncMetadata meta;
+    meta.timestamp = static_cast<int64_t>(node.lastHlc);
+    meta.clientId = node.id;
+
+    node.index.update(key, value, VersionStamp{node.lastHlc, node.index.clientIndex(node.id)});
+    node.delta.recordLocal(key, value);
+    OutboundItem item;
+    item.mutation.key = key;
+    item.mutation.data = value;
+    item.mutation.meta = meta;
+    item.bytes = key.size() + value.size();
+    node.store[key] = std::move(value);
+    node.peers->publish({item});
+}
+
+bool converged(const std::vector<std::unique_ptr<Node>>& nodes) {
+    for (size_t i = 1; i < nodes.size(); i++) {
+        if (nodes[i]->index.root() != nodes[0]->index.root()) return false;
+    }
+    return true;
+}
+
+void runScenario(const Scenario& scenario, size_t nodeCount, size_t writesPerNode, uint64_t seed, const std::string& dir) {
+    NetworkSimConfig config;
+    config.seed = seed;
+    config.link = scenario.link;
+    SimNetwork net(config);
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    for (size_t i = 0; i < nodeCount; i++) {
+        auto node = std::make_unique<Node>();
+        node->id = "node" + std::to_string(i);
+        std::string path = dir + "/aegis_sim_" + std::to_string(getpid()) + "_" + node->id + ".log";
+        node->paths = {path, path + "-wal", path + "-shm"};
+        for (const auto& p : node->paths) unlink(p.c_str());
+        if (!node->log.open(path) || !node->index.open(path)) {
+            std::fprintf(stderr, "sim_sync: cannot open %s\n", path.c_str());
+            return;
+        }
+        Node* self = node.get();
+        node->transport = std::make_shared<SimTransport>(net, node->id, node->metrics);
+        node->peers = std::make_shared<PeerSync>(
+            node->transport, node->delta, node->log, node->metrics,
+            [self](const std::string& key, const std::vector<uint8_t>& data, const storage::SyncMetadata& meta) {
+                VersionStamp stamp{HybridClock::normalize(meta.timestamp), self->index.clientIndex(meta.clientId)};
+                self->lastHlc = std::max(self->lastHlc, stamp.hlc); // HybridClock::observe
+                if (!self->index.admit(key, stamp)) return;
+                self->store[key] = data;
+                self->index.update(key, data, stamp);
+            });
+        node->peers->setAntiEntropy(&node->index, [self](const std::string& key) -> std::optional<std::vector<uint8_t>> {
+            auto it = self->store.find(key);
+            if (it == self->store.end()) return std::nullopt;
+            return it->second;
+        });
+        node->transport->start(node->peers->handlers());
+        nodes.push_back(std::move(node));
+    }
+
+    for (size_t i = 0; i < nodeCount; i++) {
+        for (size_t j = i + 1; j < nodeCount; j++) nodes[i]->transport->connect(nodes[j]->id, 0);
+    }
+    net.runUntilIdle(10000 * kMs);
+
+    int64_t startUs = net.nowUs();
+    if (scenario.partition) {
+        std::vector<std::string> half;
+        for (size_t i = 0; i < nodeCount / 2; i++) half.push_back(nodes[i]->id);
+        net.partition(half);
+        net.schedule(kWriteWindowUs, [&net] { net.heal(); });
+    }
+
+    // Writes: small edits of a per-key value, so DeltaSync has bases to work from
+    uint64_t rng = seed * 0x2545f4914f6cdd1dULL + 1;
+    for (auto& node : nodes) {
+        Node* self = node.get();
+        for (size_t w = 0; w < writesPerNode; w++) {
+            int64_t at = static_cast<int64_t>(nextRandom(rng) % kWriteWindowUs);
+            std::string key = "doc:" + std::to_string(nextRandom(rng) % kKeys);
+            uint64_t edit = nextRandom(rng);
+            net.schedule(at, [self, &net, key, edit] {
+                auto it = self->store.find(key);
+                std::vector<uint8_t> value = it != self->store.end() ? it->second : std::vector<uint8_t>(256, 0);
+                value[edit % value.size()] = static_cast<uint8_t>(edit >> 8);
+                value[(edit >> 16) % value.size()] = static_cast<uint8_t>(edit >> 24);
+                localWrite(*self, net, key, std::move(value));
+            });
+        }
+    }
+
+    // Periodic anti-entropy (what triggerSync does in the app)
+    std::function<void()> antiEntropy = [&] {
+        for (auto& node : nodes) {
+            for (const auto& peer : node->transport->peers()) node->peers->startAntiEntropy(peer);
+        }
+        net.schedule(kAntiEntropyUs, antiEntropy);
+    };
+    net.schedule(kAntiEntropyUs, antiEntropy);
+
+    // Step in 1 ms slices until every replica summarises the same state
+    int64_t t = startUs + kWriteWindowUs;
+    net.runUntil(t);
+    while (!converged(nodes) && t < startUs + kLimitUs) {
+        t += kMs;
+        net.runUntil(t);
+    }
+    bool done = converged(nodes);
+
+    auto stats = net.stats();
+    uint64_t deltaFrames = 0, fullFrames = 0, repaired = 0;
+    for (auto& node : nodes) {
+        deltaFrames += node->metrics.deltaFrames;
+        fullFrames += node->metrics.fullFrames;
+        repaired += node->metrics.antiEntropyKeys;
+    }
+    // Settle time: from the end of the write window to matching summaries
+    std::printf("%-10s %-9s settle %8.1f ms  msgs %8lu  bytes %10lu  rexmit %6lu  cut %5lu  delta/full %lu/%lu  repaired %lu\n",
+                scenario.name, done ? "converged" : "DIVERGED", (t - startUs - kWriteWindowUs) / 1000.0,
+                (unsigned long)stats.messagesDelivered, (unsigned long)stats.bytesDelivered,
+                (unsigned long)stats.retransmits, (unsigned long)stats.messagesCut, (unsigned long)deltaFrames,
+                (unsigned long)fullFrames, (unsigned long)repaired);
+
+    for (auto& node : nodes) node->transport->stop();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t nodes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+    size_t writes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+    uint64_t seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1;
+    std::string dir = argc > 4 ? argv[4] : "/tmp";
+    if (nodes < 2) {
+        std::fprintf(stderr, "usage: %s [nodes>=2] [writesPerNode] [seed] [dir]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<Scenario> scenarios;
+    Scenario lan{"lan", {}};
+    lan.link.latencyModel = LatencyModel::Fixed;
+    lan.link.latencyMs = 1;
+    scenarios.push_back(lan);
+
+    Scenario wifi{"wifi", {}};
+    wifi.link.latencyModel = LatencyModel::Normal;
+    wifi.link.latencyMs = 15;
+    wifi.link.jitterMs = 8;
+    wifi.link.lossRate = 0.005;
+    scenarios.push_back(wifi);
+
+    Scenario cellular{"cellular", {}};
+    cellular.link.latencyModel = LatencyModel::Pareto;
+    cellular.link.latencyMs = 60;
+    cellular.link.jitterMs = 40;
+    cellular.link.lossRate = 0.02;
+    cellular.link.bandwidthKbps = 2000;
+    scenarios.push_back(cellular);
+
+    Scenario split{"partition", wifi.link, true};
+    scenarios.push_back(split);
+
+    std::printf("%zu nodes, %zu writes/node, %zu keys, seed %lu\n", nodes, writes, kKeys, (unsigned long)seed);
+    for (const auto& scenario : scenarios) runScenario(scenario, nodes, writes, seed, dir);
+    return 0;
+}
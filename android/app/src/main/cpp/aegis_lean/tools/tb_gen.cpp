@@ -0,0 +1,108 @@
+// Endgame tablebase generator: builds the 3- and 4-piece tables.
+//
+// Built by AEGIS_BUILD_TOOLS:
+//   `aegis_tb_gen [-t threads] [-p pieces] dir`
+//
+// Tables already in dir are kept. For every table the time it took (next
+// to nothing for kept ones), the number of won and lost entries and the
+// longest mate are printed; known longest mates are KQvK 10 moves, KRvK
+// 16, KBNvK 33, KQvKR 35 and KRvKN 40, which makes a quick check of the
+// generator. Afterwards the directory is opened the way the engine opens
+// it and a few positions are probed.
+
+#include "ChessTablebase.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace aegis::chess;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const kProbes[] = {
+    "8/8/8/4k3/8/8/8/KQ6 w - - 0 1",
+    "8/8/8/8/8/2k5/8/K1R5 b - - 0 1",
+    "7k/8/8/8/8/8/8/KBN5 w - - 0 1",
+    "8/8/8/8/3k4/8/3P4/3K4 w - - 0 1",
+    "8/8/8/8/3k4/8/3P4/3K4 b - - 0 1",
+    "3k4/3r4/8/8/8/8/8/3QK3 w - - 0 1",
+};
+
+int usage(const char* argv0) {
+    std::fprintf(stderr, "usage: %s [-t threads] [-p pieces] dir\n", argv0);
+    return 2;
+}
+
+// Won/lost counts and longest mate, straight from the file
+void printStats(const std::string& path, const std::string& name, double seconds) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return;
+    std::vector<unsigned char> buffer(1 << 20);
+    uint64_t won = 0, lost = 0, entries = 0;
+    int longest = 0;
+    size_t n;
+    bool header = true;
+    while ((n = std::fread(buffer.data(), 1, buffer.size(), f)) > 0) {
+        size_t start = header ? 32 : 0;
+        header = false;
+        for (size_t i = start; i < n; i++) {
+            TablebaseResult r = tablebaseValue(buffer[i]);
+            if (r.wdl == Wdl::Win) won++;
+            if (r.wdl == Wdl::Loss) lost++;
+            if (r.dtm > longest) longest = r.dtm;
+        }
+        entries += n - start;
+    }
+    std::fclose(f);
+    std::printf("%-8s %9.1f MB %7.1f s  won %10llu  lost %10llu  longest mate %3d moves\n", name.c_str(),
+                entries / 1e6, seconds, static_cast<unsigned long long>(won), static_cast<unsigned long long>(lost),
+                (longest + 1) / 2);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int threads = 0;
+    int pieces = kTablebaseMaxPieces;
+    const char* dir = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "-t") && i + 1 < argc) threads = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "-p") && i + 1 < argc) pieces = std::atoi(argv[++i]);
+        else if (!dir) dir = argv[i];
+        else return usage(argv[0]);
+    }
+    if (!dir) return usage(argv[0]);
+
+    auto start = Clock::now();
+    auto last = start;
+    std::string error;
+    int written = generateTablebases(dir, pieces, threads, [&](const std::string& table, int, int) {
+        auto now = Clock::now();
+        printStats(std::string(dir) + "/" + table + ".atb", table, std::chrono::duration<double>(now - last).count());
+        std::fflush(stdout);
+        last = now;
+    }, &error);
+    if (written < 0) {
+        std::fprintf(stderr, "generation failed: %s\n", error.c_str());
+        return 1;
+    }
+    std::printf("%d tables written in %.1f s\n", written, std::chrono::duration<double>(Clock::now() - start).count());
+
+    std::shared_ptr<const Tablebases> tables = Tablebases::open(dir, &error);
+    if (!tables) {
+        std::fprintf(stderr, "tables not opened: %s\n", error.c_str());
+        return 1;
+    }
+    for (const char* fen : kProbes) {
+        Position pos;
+        TablebaseResult r;
+        if (!pos.setFen(fen) || !tables->probe(pos, r)) continue;
+        const char* wdl = r.wdl == Wdl::Win ? "win" : r.wdl == Wdl::Loss ? "loss" : "draw";
+        std::printf("%-40s %-4s  dtm %d\n", fen, wdl, r.dtm);
+    }
+    return 0;
+}
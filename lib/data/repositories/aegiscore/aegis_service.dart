@@ -6,6 +6,8 @@ import 'dart:convert';
 import 'dart:async';
 import 'package:ffi/ffi.dart';
 import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+import 'package:path_provider/path_provider.dart';
 import 'package:flutter_chess/data/repositories/aegiscore/models/peer.dart';
 
 /// High-level Dart service for AegisCore SDK
@@ -163,6 +165,11 @@ class AegisService {
       ffi.Pointer<ffi.Char> Function(
           ffi.Pointer<ffi.Int32>)>('aegis_flutter_get_bandwidth_stats');
 
+  // Chess evaluation
+  late final _aegis_chess_load_network = _lib.lookupFunction<
+      ffi.Bool Function(ffi.Pointer<ffi.Char>),
+      bool Function(ffi.Pointer<ffi.Char>)>('aegis_chess_load_network');
+
   final _typingController = StreamController<PeerTypingEvent>.broadcast();
   final _peerDiscoveredController = StreamController<Peer>.broadcast();
 
@@ -611,6 +618,56 @@ class AegisService {
       malloc.free(lenPtr);
     }
   }
+
+  // ==================== CHESS ENGINE ====================
+
+  /// Load an NNUE network bundled as a Flutter asset, e.g.
+  /// 'assets/nnue/aegis.nnue', for searches started afterwards.
+  ///
+  /// Assets live inside the APK, while the engine maps a file, so the asset
+  /// is copied to the application support directory first (again only when
+  /// it changed with an app update). Returns false when the asset is not
+  /// bundled or the engine rejects the file; the piece-square evaluation
+  /// stays in use then.
+  Future<bool> loadChessNetwork(String asset) async {
+    final ByteData data;
+    try {
+      data = await rootBundle.load(asset);
+    } catch (e) {
+      debugPrint('[AegisService] No network asset $asset: $e');
+      return false;
+    }
+    final bytes =
+        data.buffer.asUint8List(data.offsetInBytes, data.lengthInBytes);
+
+    final support = await getApplicationSupportDirectory();
+    final dir = Directory('${support.path}/nnue');
+    final file = File('${dir.path}/${asset.split('/').last}');
+    if (!await _sameContents(file, bytes)) {
+      await dir.create(recursive: true);
+      // Written aside and renamed, so a crash never leaves a torn file that
+      // the next start would map
+      final tmp = File('${file.path}.tmp');
+      await tmp.writeAsBytes(bytes, flush: true);
+      await tmp.rename(file.path);
+    }
+
+    final pathPtr = file.path.toNativeUtf8();
+    try {
+      final ok = _aegis_chess_load_network(pathPtr.cast<ffi.Char>());
+      if (!ok) debugPrint('[AegisService] Engine rejected ${file.path}');
+      return ok;
+    } finally {
+      malloc.free(pathPtr);
+    }
+  }
+
+  static Future<bool> _sameContents(File file, Uint8List bytes) async {
+    if (!await file.exists() || await file.length() != bytes.length) {
+      return false;
+    }
+    return listEquals(await file.readAsBytes(), bytes);
+  }
 }
 
 class PeerTypingEvent {